@@ -5,6 +5,7 @@ set(CPP_FILES
   mitkAbstractClassifier.cpp
   mitkAbstractGlobalImageFeature.cpp
   mitkIntensityQuantifier.cpp
+  mitkGlobalImageFeatureContext.cpp
 )
 
 set( TOOL_FILES
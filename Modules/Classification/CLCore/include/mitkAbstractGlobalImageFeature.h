@@ -26,6 +26,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkCommandLineParser.h>
 
 #include <mitkIntensityQuantifier.h>
+#include <mitkGlobalImageFeatureContext.h>
 
 // STD Includes
 
@@ -149,6 +150,14 @@ public:
   */
   virtual void CalculateFeaturesUsingParameters(const Image::Pointer & feature, const Image::Pointer &mask, const Image::Pointer &maskNoNAN, FeatureListType &featureList) = 0;
 
+  /**
+  * \brief Calls CalculateFeaturesUsingParameters of all given feature classes and appends the results in the order of the classes.
+  *
+  * If parallel is true, the feature classes are calculated concurrently. Each class writes into its own list, so that the
+  * result does not depend on the order in which the calculations finish. The classes may share a GlobalImageFeatureContext.
+  */
+  static void CalculateFeatureClassesUsingParameters(const std::vector<AbstractGlobalImageFeature::Pointer> &features, const Image::Pointer & feature, const Image::Pointer &mask, const Image::Pointer &maskNoNAN, FeatureListType &featureList, bool parallel);
+
   /**
   * \brief Returns a list of the names of all features that are calculated from this class
   */
@@ -204,6 +213,15 @@ public:
   itkGetConstMacro(Binsize, double);
   itkGetConstMacro(UseBinsize, bool);
 
+  /**
+  * \brief Context that is shared between feature classes calculated on the same images.
+  *
+  * If a context is set, the quantifier and texture matrices are taken from the context if they
+  * have already been calculated by another feature class. See GlobalImageFeatureContext.
+  */
+  itkSetMacro(Context, GlobalImageFeatureContext::Pointer);
+  itkGetConstMacro(Context, GlobalImageFeatureContext::Pointer);
+
   itkSetMacro(MorphMask, mitk::Image::Pointer);
   itkGetConstMacro(MorphMask, mitk::Image::Pointer);
 
@@ -281,6 +299,7 @@ private:
   bool m_IgnoreMask = false;
 
   mitk::Image::Pointer m_MorphMask = nullptr;
+  GlobalImageFeatureContext::Pointer m_Context = nullptr;
 //#endif // Skip Doxygen
 
 };
@@ -0,0 +1,189 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef mitkGlobalImageFeatureContext_h
+#define mitkGlobalImageFeatureContext_h
+
+#include <MitkCLCoreExports.h>
+
+#include <mitkCommon.h>
+#include <mitkImage.h>
+#include <mitkImageCast.h>
+#include <mitkIntensityQuantifier.h>
+
+#include <itkObject.h>
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+// STD Includes
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+
+// Eigen
+#include <Eigen/Dense>
+
+namespace mitk
+{
+  /**
+  * \brief Shares intermediate results between feature classes that are calculated on the same images.
+  *
+  * Each feature class derived from AbstractGlobalImageFeature initializes its own intensity quantifier,
+  * casts the mask to an itk image and calculates its own texture matrices. If several feature classes
+  * are calculated for the same image / mask combination, an instance of this class can be passed to
+  * all of them (AbstractGlobalImageFeature::SetContext). Then
+  *  - the quantifier is only initialized once for each histogram configuration,
+  *  - the mask is only cast once for each itk image type (GetItkMask()),
+  *  - the quantized image is only calculated once for each quantification (GetQuantizedImage()), and
+  *  - texture matrices are only calculated once for each key (for example direction and bin settings).
+  *
+  * All keys contain the address and modification time of the image and mask they were calculated from.
+  * Cached objects are shared between the feature classes and must not be modified. Call Clear() or use a
+  * new context for each image / mask combination, so that the cache does not grow unbounded.
+  *
+  * All methods are thread safe, so the feature classes sharing a context can be calculated concurrently.
+  */
+  class MITKCLCORE_EXPORT GlobalImageFeatureContext : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(GlobalImageFeatureContext, itk::Object)
+    itkFactorylessNewMacro(Self)
+
+    typedef std::function<void(IntensityQuantifier *)> QuantifierInitializerType;
+    typedef std::function<Eigen::MatrixXd()> MatrixCalculatorType;
+    typedef std::function<itk::DataObject::Pointer()> DataCalculatorType;
+
+    /**
+    * \brief Returns the quantifier for the given images and configuration key.
+    *
+    * If no quantifier with this key has been created so far, a new quantifier is created and
+    * initialized by the given function.
+    */
+    IntensityQuantifier::Pointer GetQuantifier(const Image *image, const Image *mask, const std::string &key, QuantifierInitializerType initializer);
+
+    /**
+    * \brief Returns the matrix for the given images and key. It is calculated by the given function if it is not cached yet.
+    */
+    Eigen::MatrixXd GetMatrix(const Image *image, const Image *mask, const std::string &key, MatrixCalculatorType calculator);
+
+    /**
+    * \brief Returns the data object (for example an itk image) for the given images and key. It is created by the given function if it is not cached yet.
+    */
+    itk::DataObject::Pointer GetData(const Image *image, const Image *mask, const std::string &key, DataCalculatorType calculator);
+
+    /**
+    * \brief Returns the mask cast to the given itk image type.
+    *
+    * Without a context (nullptr) the mask is cast on every call.
+    */
+    template <typename TMaskImage>
+    static typename TMaskImage::Pointer GetItkMask(GlobalImageFeatureContext *context, const Image *mask);
+
+    /**
+    * \brief Returns an image that contains the bin index (IntensityQuantifier::IntensityToIndex()) of every voxel.
+    *
+    * All voxels are quantized, not only the masked ones. Without a context (nullptr) the image is calculated on every call.
+    */
+    template <typename TPixel, unsigned int VImageDimension>
+    static typename itk::Image<unsigned int, VImageDimension>::Pointer GetQuantizedImage(GlobalImageFeatureContext *context,
+      const Image *image, itk::Image<TPixel, VImageDimension> *itkImage, IntensityQuantifier *quantifier);
+
+    /**
+    * \brief Removes all cached values.
+    */
+    void Clear();
+
+    unsigned long GetNumberOfCacheHits();
+    unsigned long GetNumberOfCacheMisses();
+
+  protected:
+    GlobalImageFeatureContext();
+    ~GlobalImageFeatureContext() override;
+
+  private:
+    static std::string CreateKey(const Image *image, const Image *mask, const std::string &key);
+
+    std::mutex m_Mutex;
+    std::map<std::string, IntensityQuantifier::Pointer> m_Quantifiers;
+    std::map<std::string, Eigen::MatrixXd> m_Matrices;
+    std::map<std::string, itk::DataObject::Pointer> m_Data;
+
+    unsigned long m_NumberOfCacheHits;
+    unsigned long m_NumberOfCacheMisses;
+  };
+}
+
+template <typename TMaskImage>
+typename TMaskImage::Pointer mitk::GlobalImageFeatureContext::GetItkMask(GlobalImageFeatureContext *context, const Image *mask)
+{
+  auto castMask = [mask]() -> itk::DataObject::Pointer
+  {
+    typename TMaskImage::Pointer itkMask = TMaskImage::New();
+    mitk::CastToItkImage(mask, itkMask);
+    return itkMask.GetPointer();
+  };
+
+  if (context == nullptr)
+  {
+    return static_cast<TMaskImage *>(castMask().GetPointer());
+  }
+
+  std::string key = std::string("ItkMask_") + typeid(TMaskImage).name();
+  return dynamic_cast<TMaskImage *>(context->GetData(nullptr, mask, key, castMask).GetPointer());
+}
+
+template <typename TPixel, unsigned int VImageDimension>
+typename itk::Image<unsigned int, VImageDimension>::Pointer mitk::GlobalImageFeatureContext::GetQuantizedImage(GlobalImageFeatureContext *context,
+  const Image *image, itk::Image<TPixel, VImageDimension> *itkImage, IntensityQuantifier *quantifier)
+{
+  typedef itk::Image<unsigned int, VImageDimension> QuantizedImageType;
+
+  auto quantize = [itkImage, quantifier]() -> itk::DataObject::Pointer
+  {
+    typename QuantizedImageType::Pointer quantizedImage = QuantizedImageType::New();
+    quantizedImage->CopyInformation(itkImage);
+    quantizedImage->SetRegions(itkImage->GetLargestPossibleRegion());
+    quantizedImage->Allocate();
+
+    itk::ImageRegionConstIterator<itk::Image<TPixel, VImageDimension> > imageIter(itkImage, itkImage->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<QuantizedImageType> quantizedIter(quantizedImage, quantizedImage->GetLargestPossibleRegion());
+    for (; !imageIter.IsAtEnd(); ++imageIter, ++quantizedIter)
+    {
+      quantizedIter.Set(quantifier->IntensityToIndex(imageIter.Get()));
+    }
+    return quantizedImage.GetPointer();
+  };
+
+  if (context == nullptr)
+  {
+    return static_cast<QuantizedImageType *>(quantize().GetPointer());
+  }
+
+  // The quantized image does not depend on the mask, only on the image and the quantification
+  std::ostringstream key;
+  key.precision(17);
+  key << "QuantizedImage_" << typeid(TPixel).name() << "-" << VImageDimension;
+  key << "_Min-" << quantifier->GetMinimum() << "_Max-" << quantifier->GetMaximum();
+  key << "_Bins-" << quantifier->GetBins() << "_BS-" << quantifier->GetBinsize();
+  return dynamic_cast<QuantizedImageType *>(context->GetData(image, nullptr, key.str(), quantize).GetPointer());
+}
+
+#endif //mitkGlobalImageFeatureContext_h
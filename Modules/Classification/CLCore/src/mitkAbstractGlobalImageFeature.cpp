@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageCast.h>
 #include <mitkITKImageImport.h>
 #include <iterator>
+#include <sstream>
 
 static void
 ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
@@ -233,46 +234,67 @@ void  mitk::AbstractGlobalImageFeature::InitializeQuantifier(const Image::Pointe
 {
   MITK_INFO << GetUseMinimumIntensity() << " " << GetUseMaximumIntensity() << " " << GetUseBins() << " " << GetUseBinsize();
 
-  m_Quantifier = IntensityQuantifier::New();
-  if (GetUseMinimumIntensity() && GetUseMaximumIntensity() && GetUseBinsize())
-    m_Quantifier->InitializeByBinsizeAndMaximum(GetMinimumIntensity(), GetMaximumIntensity(), GetBinsize());
-  else if (GetUseMinimumIntensity() && GetUseBins() && GetUseBinsize())
-    m_Quantifier->InitializeByBinsizeAndBins(GetMinimumIntensity(), GetBins(), GetBinsize());
-  else if (GetUseMinimumIntensity() && GetUseMaximumIntensity() && GetUseBins())
-    m_Quantifier->InitializeByMinimumMaximum(GetMinimumIntensity(), GetMaximumIntensity(), GetBins());
-  // Intialize from Image and Binsize
-  else if (GetUseBinsize() && GetIgnoreMask() && GetUseMinimumIntensity())
-    m_Quantifier->InitializeByImageAndBinsizeAndMinimum(feature, GetMinimumIntensity(), GetBinsize());
-  else if (GetUseBinsize() && GetIgnoreMask() && GetUseMaximumIntensity())
-    m_Quantifier->InitializeByImageAndBinsizeAndMaximum(feature, GetMaximumIntensity(), GetBinsize());
-  else if (GetUseBinsize() && GetIgnoreMask())
-    m_Quantifier->InitializeByImageAndBinsize(feature, GetBinsize());
-  // Initialize form Image, Mask and Binsize
-  else if (GetUseBinsize() && GetUseMinimumIntensity())
-    m_Quantifier->InitializeByImageRegionAndBinsizeAndMinimum(feature, mask, GetMinimumIntensity(), GetBinsize());
-  else if (GetUseBinsize() && GetUseMaximumIntensity())
-    m_Quantifier->InitializeByImageRegionAndBinsizeAndMaximum(feature, mask, GetMaximumIntensity(), GetBinsize());
-  else if (GetUseBinsize())
-    m_Quantifier->InitializeByImageRegionAndBinsize(feature, mask, GetBinsize());
-  // Intialize from Image and Bins
-  else if (GetUseBins() && GetIgnoreMask() && GetUseMinimumIntensity())
-    m_Quantifier->InitializeByImageAndMinimum(feature, GetMinimumIntensity(), GetBins());
-  else if (GetUseBins() && GetIgnoreMask() && GetUseMaximumIntensity())
-    m_Quantifier->InitializeByImageAndMaximum(feature, GetMaximumIntensity(), GetBins());
-  else if (GetUseBins())
-    m_Quantifier->InitializeByImage(feature, GetBins());
-  // Intialize from Image, Mask and Bins
-  else if (GetUseBins() && GetUseMinimumIntensity())
-    m_Quantifier->InitializeByImageRegionAndMinimum(feature, mask, GetMinimumIntensity(), GetBins());
-  else if (GetUseBins() && GetUseMaximumIntensity())
-    m_Quantifier->InitializeByImageRegionAndMaximum(feature, mask, GetMaximumIntensity(), GetBins());
-  else if (GetUseBins())
-    m_Quantifier->InitializeByImageRegion(feature, mask, GetBins());
-  // Default
-  else if (GetIgnoreMask())
-    m_Quantifier->InitializeByImage(feature, GetBins());
-  else
-    m_Quantifier->InitializeByImageRegion(feature, mask, defaultBins);
+  auto initializer = [&](IntensityQuantifier *quantifier)
+  {
+    if (GetUseMinimumIntensity() && GetUseMaximumIntensity() && GetUseBinsize())
+      quantifier->InitializeByBinsizeAndMaximum(GetMinimumIntensity(), GetMaximumIntensity(), GetBinsize());
+    else if (GetUseMinimumIntensity() && GetUseBins() && GetUseBinsize())
+      quantifier->InitializeByBinsizeAndBins(GetMinimumIntensity(), GetBins(), GetBinsize());
+    else if (GetUseMinimumIntensity() && GetUseMaximumIntensity() && GetUseBins())
+      quantifier->InitializeByMinimumMaximum(GetMinimumIntensity(), GetMaximumIntensity(), GetBins());
+    // Intialize from Image and Binsize
+    else if (GetUseBinsize() && GetIgnoreMask() && GetUseMinimumIntensity())
+      quantifier->InitializeByImageAndBinsizeAndMinimum(feature, GetMinimumIntensity(), GetBinsize());
+    else if (GetUseBinsize() && GetIgnoreMask() && GetUseMaximumIntensity())
+      quantifier->InitializeByImageAndBinsizeAndMaximum(feature, GetMaximumIntensity(), GetBinsize());
+    else if (GetUseBinsize() && GetIgnoreMask())
+      quantifier->InitializeByImageAndBinsize(feature, GetBinsize());
+    // Initialize form Image, Mask and Binsize
+    else if (GetUseBinsize() && GetUseMinimumIntensity())
+      quantifier->InitializeByImageRegionAndBinsizeAndMinimum(feature, mask, GetMinimumIntensity(), GetBinsize());
+    else if (GetUseBinsize() && GetUseMaximumIntensity())
+      quantifier->InitializeByImageRegionAndBinsizeAndMaximum(feature, mask, GetMaximumIntensity(), GetBinsize());
+    else if (GetUseBinsize())
+      quantifier->InitializeByImageRegionAndBinsize(feature, mask, GetBinsize());
+    // Intialize from Image and Bins
+    else if (GetUseBins() && GetIgnoreMask() && GetUseMinimumIntensity())
+      quantifier->InitializeByImageAndMinimum(feature, GetMinimumIntensity(), GetBins());
+    else if (GetUseBins() && GetIgnoreMask() && GetUseMaximumIntensity())
+      quantifier->InitializeByImageAndMaximum(feature, GetMaximumIntensity(), GetBins());
+    else if (GetUseBins())
+      quantifier->InitializeByImage(feature, GetBins());
+    // Intialize from Image, Mask and Bins
+    else if (GetUseBins() && GetUseMinimumIntensity())
+      quantifier->InitializeByImageRegionAndMinimum(feature, mask, GetMinimumIntensity(), GetBins());
+    else if (GetUseBins() && GetUseMaximumIntensity())
+      quantifier->InitializeByImageRegionAndMaximum(feature, mask, GetMaximumIntensity(), GetBins());
+    else if (GetUseBins())
+      quantifier->InitializeByImageRegion(feature, mask, GetBins());
+    // Default
+    else if (GetIgnoreMask())
+      quantifier->InitializeByImage(feature, GetBins());
+    else
+      quantifier->InitializeByImageRegion(feature, mask, defaultBins);
+  };
+
+  if (m_Context.IsNull())
+  {
+    m_Quantifier = IntensityQuantifier::New();
+    initializer(m_Quantifier);
+    return;
+  }
+
+  // The key contains all settings that influence the initialization of the quantifier
+  std::ostringstream key;
+  key.precision(17);
+  key << "Quantifier";
+  key << "_Min-" << GetUseMinimumIntensity() << "-" << GetMinimumIntensity();
+  key << "_Max-" << GetUseMaximumIntensity() << "-" << GetMaximumIntensity();
+  key << "_Bins-" << GetUseBins() << "-" << GetBins();
+  key << "_BS-" << GetUseBinsize() << "-" << GetBinsize();
+  key << "_IgnoreMask-" << GetIgnoreMask();
+  key << "_DefaultBins-" << defaultBins;
+  m_Quantifier = m_Context->GetQuantifier(feature, mask, key.str(), initializer);
 }
 
 std::string mitk::AbstractGlobalImageFeature::GetCurrentFeatureEncoding()
@@ -336,6 +358,22 @@ std::string mitk::AbstractGlobalImageFeature::QuantifierParameterString()
   return ss.str();
 }
 
+void mitk::AbstractGlobalImageFeature::CalculateFeatureClassesUsingParameters(const std::vector<AbstractGlobalImageFeature::Pointer> &features, const Image::Pointer & feature, const Image::Pointer &mask, const Image::Pointer &maskNoNAN, FeatureListType &featureList, bool parallel)
+{
+  std::vector<FeatureListType> featureLists(features.size());
+  const int numberOfFeatures = static_cast<int>(features.size());
+#pragma omp parallel for schedule(dynamic, 1) if (parallel)
+  for (int i = 0; i < numberOfFeatures; ++i)
+  {
+    features[i]->CalculateFeaturesUsingParameters(feature, mask, maskNoNAN, featureLists[i]);
+  }
+
+  for (const auto &list : featureLists)
+  {
+    featureList.insert(featureList.end(), list.begin(), list.end());
+  }
+}
+
 mitk::AbstractGlobalImageFeature::FeatureListType mitk::AbstractGlobalImageFeature::CalculateFeaturesSlicewise(const Image::Pointer & feature, const Image::Pointer &mask, int sliceID)
 {
   std::vector<mitk::Image::Pointer> imageVector;
@@ -0,0 +1,128 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkGlobalImageFeatureContext.h>
+
+// STD
+#include <sstream>
+
+mitk::GlobalImageFeatureContext::GlobalImageFeatureContext() :
+  m_NumberOfCacheHits(0),
+  m_NumberOfCacheMisses(0)
+{
+}
+
+mitk::GlobalImageFeatureContext::~GlobalImageFeatureContext()
+{
+}
+
+std::string mitk::GlobalImageFeatureContext::CreateKey(const Image *image, const Image *mask, const std::string &key)
+{
+  // Images are identified by their address and modification time, so that a modified
+  // image does not return outdated results.
+  std::ostringstream ss;
+  ss << static_cast<const void*>(image);
+  if (image != nullptr)
+    ss << "-" << image->GetMTime();
+  ss << "_" << static_cast<const void*>(mask);
+  if (mask != nullptr)
+    ss << "-" << mask->GetMTime();
+  ss << "_" << key;
+  return ss.str();
+}
+
+mitk::IntensityQuantifier::Pointer mitk::GlobalImageFeatureContext::GetQuantifier(const Image *image, const Image *mask, const std::string &key, QuantifierInitializerType initializer)
+{
+  std::string fullKey = CreateKey(image, mask, key);
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Quantifiers.find(fullKey);
+    if (iter != m_Quantifiers.end())
+    {
+      ++m_NumberOfCacheHits;
+      return iter->second;
+    }
+    ++m_NumberOfCacheMisses;
+  }
+
+  // The initialization may require a pass over the whole image and is therefore done
+  // without holding the lock. If two threads initialize the same quantifier, the first one is kept.
+  IntensityQuantifier::Pointer quantifier = IntensityQuantifier::New();
+  initializer(quantifier);
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Quantifiers.emplace(fullKey, quantifier).first->second;
+}
+
+Eigen::MatrixXd mitk::GlobalImageFeatureContext::GetMatrix(const Image *image, const Image *mask, const std::string &key, MatrixCalculatorType calculator)
+{
+  std::string fullKey = CreateKey(image, mask, key);
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Matrices.find(fullKey);
+    if (iter != m_Matrices.end())
+    {
+      ++m_NumberOfCacheHits;
+      return iter->second;
+    }
+    ++m_NumberOfCacheMisses;
+  }
+
+  Eigen::MatrixXd matrix = calculator();
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Matrices.emplace(fullKey, matrix).first->second;
+}
+
+itk::DataObject::Pointer mitk::GlobalImageFeatureContext::GetData(const Image *image, const Image *mask, const std::string &key, DataCalculatorType calculator)
+{
+  std::string fullKey = CreateKey(image, mask, key);
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Data.find(fullKey);
+    if (iter != m_Data.end())
+    {
+      ++m_NumberOfCacheHits;
+      return iter->second;
+    }
+    ++m_NumberOfCacheMisses;
+  }
+
+  itk::DataObject::Pointer data = calculator();
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Data.emplace(fullKey, data).first->second;
+}
+
+unsigned long mitk::GlobalImageFeatureContext::GetNumberOfCacheHits()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_NumberOfCacheHits;
+}
+
+unsigned long mitk::GlobalImageFeatureContext::GetNumberOfCacheMisses()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_NumberOfCacheMisses;
+}
+
+void mitk::GlobalImageFeatureContext::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Quantifiers.clear();
+  m_Matrices.clear();
+  m_Data.clear();
+}
@@ -666,12 +666,16 @@ int main(int argc, char* argv[])
 
     mitk::AbstractGlobalImageFeature::FeatureListType stats;
 
+    // The context shares the quantifier, the cast masks, the quantized image and the
+    // texture matrices between all feature classes of the current image / slice.
+    mitk::GlobalImageFeatureContext::Pointer context = mitk::GlobalImageFeatureContext::New();
     for (auto cFeature : features)
     {
       log << " Calculating " << cFeature->GetFeatureClassName() << " -";
       cFeature->SetMorphMask(cMorphMask);
-      cFeature->CalculateFeaturesUsingParameters(cImage, cMask, cMaskNoNaN, stats);
+      cFeature->SetContext(context);
     }
+    mitk::AbstractGlobalImageFeature::CalculateFeatureClassesUsingParameters(features, cImage, cMask, cMaskNoNaN, stats, param.parallelFeatures);
 
     for (std::size_t i = 0; i < stats.size(); ++i)
     {
@@ -169,6 +169,9 @@ namespace mitk
       double MaximumIntensity;
       int Bins;
       std::string prefix;
+
+      GlobalImageFeatureContext* Context = nullptr;
+      const Image* InputImage = nullptr;
     };
 
     private:
@@ -110,6 +110,8 @@ namespace mitk
       double MaximumIntensity;
       int Bins;
       std::string featurePrefix;
+
+      GlobalImageFeatureContext* Context = nullptr;
     };
 
   private:
@@ -108,6 +108,10 @@ namespace mitk
       double MaximumIntensity;
       int Bins;
       std::string prefix;
+
+      GlobalImageFeatureContext* Context = nullptr;
+      const Image* InputImage = nullptr;
+      const Image* InputMask = nullptr;
     };
   };
 
@@ -141,6 +141,8 @@ namespace mitk
       double MaximumIntensity;
       int Bins;
       std::string FeatureEncoding;
+
+      GlobalImageFeatureContext* Context = nullptr;
     };
 
     private:
@@ -71,6 +71,7 @@ namespace mitk
       bool useDecimalPoint;
       char decimalPoint;
       bool encodeParameter;
+      bool parallelFeatures;
 
     private:
       void ParseFileLocations(std::map<std::string, us::Any> &parsedArgs);
@@ -374,8 +374,7 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
   double rangeMax = config.MaximumIntensity;
   int numberOfBins = config.Bins;
 
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
+  typename MaskType::Pointer maskImage = mitk::GlobalImageFeatureContext::GetItkMask<MaskType>(config.Context, mask);
 
   //Find possible directions
   std::vector < itk::Offset<VImageDimension> > offsetVector;
@@ -425,7 +424,23 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
     offset = offsetVector[i];
     mitk::CoocurenceMatrixHolder holder(rangeMin, rangeMax, numberOfBins);
     mitk::CoocurenceMatrixFeatures coocResults;
-    CalculateCoOcMatrix<TPixel, VImageDimension>(itkImage, maskImage, offset, config.range, holder);
+    if (config.Context != nullptr)
+    {
+      // Matrices only depend on the offset and the quantification, so they can be shared
+      std::ostringstream key;
+      key.precision(17);
+      key << "Cooccurence2_Offset-" << offset << "_Range-" << config.range;
+      key << "_Min-" << rangeMin << "_Max-" << rangeMax << "_Bins-" << numberOfBins;
+      holder.m_Matrix = config.Context->GetMatrix(config.InputImage, config.InputMask, key.str(), [&]()
+      {
+        CalculateCoOcMatrix<TPixel, VImageDimension>(itkImage, maskImage, offset, config.range, holder);
+        return holder.m_Matrix;
+      });
+    }
+    else
+    {
+      CalculateCoOcMatrix<TPixel, VImageDimension>(itkImage, maskImage, offset, config.range, holder);
+    }
     holderOverall.m_Matrix += holder.m_Matrix;
     CalculateFeatures(holder, coocResults);
     resultVector.push_back(coocResults);
@@ -628,6 +643,9 @@ mitk::GIFCooccurenceMatrix2::FeatureListType mitk::GIFCooccurenceMatrix2::Calcul
   config.MaximumIntensity = GetQuantifier()->GetMaximum();
   config.Bins = GetQuantifier()->GetBins();
   config.prefix = FeatureDescriptionPrefix();
+  config.Context = GetContext();
+  config.InputImage = image;
+  config.InputMask = mask;
 
   AccessByItk_3(image, CalculateCoocurenceFeatures, mask, featureList,config);
 
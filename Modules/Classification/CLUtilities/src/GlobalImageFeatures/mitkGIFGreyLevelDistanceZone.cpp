@@ -20,8 +20,6 @@ namespace mitk{
   public:
     GreyLevelDistanceZoneMatrixHolder(mitk::IntensityQuantifier::Pointer quantifier, int number, int maxSize);
 
-    int IntensityToIndex(double intensity);
-
     int m_NumberOfBins;
     int m_MaximumSize;
     int m_NumerOfVoxels;
@@ -48,26 +46,21 @@ mitk::GreyLevelDistanceZoneMatrixHolder::GreyLevelDistanceZoneMatrixHolder(mitk:
   m_Matrix.fill(0);
 }
 
-int mitk::GreyLevelDistanceZoneMatrixHolder::IntensityToIndex(double intensity)
-{
-  return m_Quantifier->IntensityToIndex(intensity);
-}
-
 
 template<typename TPixel, unsigned int VImageDimension>
 int
-CalculateGlSZMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
+CalculateGlSZMatrix(itk::Image<unsigned int, VImageDimension>* quantizedImage,
                     itk::Image<unsigned short, VImageDimension>* mask,
                     itk::Image<unsigned short, VImageDimension>* distanceImage,
                     std::vector<itk::Offset<VImageDimension> > offsets,
                     bool estimateLargestRegion,
                     mitk::GreyLevelDistanceZoneMatrixHolder &holder)
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<unsigned int, VImageDimension> QuantizedImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
-  typedef typename ImageType::IndexType IndexType;
+  typedef typename QuantizedImageType::IndexType IndexType;
 
-  typedef itk::ImageRegionIteratorWithIndex<ImageType> ConstIterType;
+  typedef itk::ImageRegionIteratorWithIndex<QuantizedImageType> ConstIterType;
   typedef itk::ImageRegionIteratorWithIndex<MaskImageType> ConstMaskIterType;
 
   auto region = mask->GetLargestPossibleRegion();
@@ -75,7 +68,7 @@ CalculateGlSZMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
   newRegion.SetSize(region.GetSize());
   newRegion.SetIndex(region.GetIndex());
 
-  ConstIterType imageIter(itkImage, itkImage->GetLargestPossibleRegion());
+  ConstIterType imageIter(quantizedImage, quantizedImage->GetLargestPossibleRegion());
   ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion());
 
   typename MaskImageType::Pointer visitedImage = MaskImageType::New();
@@ -90,7 +83,7 @@ CalculateGlSZMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
   {
     if (maskIter.Value() > 0 )
     {
-      auto startIntensityIndex = holder.IntensityToIndex(imageIter.Value());
+      auto startIntensityIndex = imageIter.Value();
       std::vector<IndexType> indices;
       indices.push_back(maskIter.GetIndex());
       unsigned int steps = 0;
@@ -107,7 +100,7 @@ CalculateGlSZMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
         }
 
         auto wasVisited = visitedImage->GetPixel(currentIndex);
-        auto newIntensityIndex = holder.IntensityToIndex(itkImage->GetPixel(currentIndex));
+        auto newIntensityIndex = quantizedImage->GetPixel(currentIndex);
         auto isInMask = mask->GetPixel(currentIndex);
 
         if ((isInMask > 0) &&
@@ -322,8 +315,8 @@ CalculateGreyLevelDistanceZoneFeatures(itk::Image<TPixel, VImageDimension>* itkI
   typename MaskType::Pointer distanceImage = MaskType::New();
   mitk::CastToItkImage(mitkDistanceImage, distanceImage);
 
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
+  typename MaskType::Pointer maskImage = mitk::GlobalImageFeatureContext::GetItkMask<MaskType>(config.Context, mask);
+  auto quantizedImage = mitk::GlobalImageFeatureContext::GetQuantizedImage(config.Context, config.InputImage, itkImage, config.Quantifier.GetPointer());
 
   //Find possible directions
   std::vector < itk::Offset<VImageDimension> > offsetVector;
@@ -360,7 +353,7 @@ CalculateGreyLevelDistanceZoneFeatures(itk::Image<TPixel, VImageDimension>* itkI
   std::vector<mitk::GreyLevelDistanceZoneFeatures> resultVector;
   mitk::GreyLevelDistanceZoneMatrixHolder holderOverall(config.Quantifier, config.Bins, maximumDistance + 1);
   mitk::GreyLevelDistanceZoneFeatures overallFeature;
-  CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, distanceImage, offsetVector, false, holderOverall);
+  CalculateGlSZMatrix<TPixel, VImageDimension>(quantizedImage, maskImage, distanceImage, offsetVector, false, holderOverall);
   CalculateFeatures(holderOverall, overallFeature);
 
   MatrixFeaturesTo(overallFeature, config.prefix, featureList);
@@ -422,6 +415,8 @@ mitk::GIFGreyLevelDistanceZone::FeatureListType mitk::GIFGreyLevelDistanceZone::
   config.Bins = GetQuantifier()->GetBins();
   config.prefix = FeatureDescriptionPrefix();
   config.Quantifier = GetQuantifier();
+  config.Context = GetContext();
+  config.InputImage = image;
 
   AccessByItk_3(image, CalculateGreyLevelDistanceZoneFeatures, mask, featureList, config);
 
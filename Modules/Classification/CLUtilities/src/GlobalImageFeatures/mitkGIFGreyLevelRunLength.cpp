@@ -36,8 +36,7 @@ void
   typedef itk::Statistics::EnhancedScalarImageToRunLengthFeaturesFilter<ImageType> FilterType;
   typedef typename FilterType::RunLengthFeaturesFilterType TextureFilterType;
 
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
+  typename MaskType::Pointer maskImage = mitk::GlobalImageFeatureContext::GetItkMask<MaskType>(params.Context, mask);
 
   typename FilterType::Pointer filter = FilterType::New();
   typename FilterType::Pointer filter2 = FilterType::New();
@@ -238,6 +237,7 @@ mitk::GIFGreyLevelRunLength::FeatureListType mitk::GIFGreyLevelRunLength::Calcul
   params.MinimumIntensity = GetQuantifier()->GetMinimum();
   params.MaximumIntensity = GetQuantifier()->GetMaximum();
   params.Bins = GetQuantifier()->GetBins();
+  params.Context = GetContext();
   params.featurePrefix = FeatureDescriptionPrefix();
 
   MITK_INFO << params.MinimumIntensity;
@@ -9,6 +9,7 @@
 #include <itkImageRegionIteratorWithIndex.h>
 
 // STL
+#include <sstream>
 
 namespace mitk
 {
@@ -298,8 +299,7 @@ CalculateGreyLevelSizeZoneFeatures(itk::Image<TPixel, VImageDimension>* itkImage
   double rangeMax = config.MaximumIntensity;
   int numberOfBins = config.Bins;
 
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
+  typename MaskType::Pointer maskImage = mitk::GlobalImageFeatureContext::GetItkMask<MaskType>(config.Context, mask);
 
   //Find possible directions
   std::vector < itk::Offset<VImageDimension> > offsetVector;
@@ -333,12 +333,34 @@ CalculateGreyLevelSizeZoneFeatures(itk::Image<TPixel, VImageDimension>* itkImage
     offsetVector.push_back(offset);
   }
 
-  std::vector<mitk::GreyLevelSizeZoneFeatures> resultVector;
-  mitk::GreyLevelSizeZoneMatrixHolder tmpHolder(rangeMin, rangeMax, numberOfBins, 3);
-  int largestRegion = CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, true, tmpHolder);
-  mitk::GreyLevelSizeZoneMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins,largestRegion);
+  auto calculateMatrix = [&]()
+  {
+    mitk::GreyLevelSizeZoneMatrixHolder tmpHolder(rangeMin, rangeMax, numberOfBins, 3);
+    int largestRegion = CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, true, tmpHolder);
+    mitk::GreyLevelSizeZoneMatrixHolder holder(rangeMin, rangeMax, numberOfBins, largestRegion);
+    CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, false, holder);
+    return holder.m_Matrix;
+  };
+
+  Eigen::MatrixXd matrix;
+  if (config.Context != nullptr)
+  {
+    // The matrix only depends on the directions and the quantification
+    std::ostringstream key;
+    key.precision(17);
+    key << "SizeZone_Direction-" << config.direction;
+    key << "_Min-" << rangeMin << "_Max-" << rangeMax << "_Bins-" << numberOfBins;
+    matrix = config.Context->GetMatrix(config.InputImage, config.InputMask, key.str(), calculateMatrix);
+  }
+  else
+  {
+    matrix = calculateMatrix();
+  }
+
+  // The number of columns is the size of the largest region
+  mitk::GreyLevelSizeZoneMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins, matrix.cols());
+  holderOverall.m_Matrix = matrix;
   mitk::GreyLevelSizeZoneFeatures overallFeature;
-  CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, false, holderOverall);
   CalculateFeatures(holderOverall, overallFeature);
 
   MatrixFeaturesTo(overallFeature, config.prefix, featureList);
@@ -390,6 +412,9 @@ mitk::GIFGreyLevelSizeZone::FeatureListType mitk::GIFGreyLevelSizeZone::Calculat
   config.MaximumIntensity = GetQuantifier()->GetMaximum();
   config.Bins = GetQuantifier()->GetBins();
   config.prefix = FeatureDescriptionPrefix();
+  config.Context = GetContext();
+  config.InputImage = image;
+  config.InputMask = mask;
 
   AccessByItk_3(image, CalculateGreyLevelSizeZoneFeatures, mask, featureList, config);
 
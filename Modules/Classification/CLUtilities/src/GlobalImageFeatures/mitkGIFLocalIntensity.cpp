@@ -24,10 +24,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImagePixelReadAccessor.h>
 
 // ITK
-#include <itkImageRegionIteratorWithIndex.h>
-#include <itkNeighborhoodIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
 // STL
 #include <limits>
+#include <vector>
 
 struct GIFLocalIntensityParameter
 {
@@ -42,69 +42,122 @@ CalculateIntensityPeak(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Imag
 {
   typedef itk::Image<TPixel, VImageDimension> ImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskType;
+  typedef itk::Offset<VImageDimension> OffsetType;
 
   typename MaskType::Pointer itkMask = MaskType::New();
   mitk::CastToItkImage(mask, itkMask);
 
   double range = params.range;
   double minimumSpacing = std::numeric_limits<double>::max();
-  itkImage->GetSpacing();
   for (unsigned int i = 0; i < VImageDimension; ++i)
   {
     minimumSpacing = (minimumSpacing < itkImage->GetSpacing()[i]) ? minimumSpacing : itkImage->GetSpacing()[i];
   }
-  typename ImageType::SizeType regionSize;
   int offset = std::ceil(range / minimumSpacing);
-  regionSize.Fill(offset);
 
-  itk::NeighborhoodIterator<ImageType> iter(regionSize, itkImage, itkImage->GetLargestPossibleRegion());
-  itk::NeighborhoodIterator<MaskType> iterMask(regionSize, itkMask, itkMask->GetLargestPossibleRegion());
+  // The distance between two voxels only depends on their index offset, so the
+  // spherical neighbourhood is converted once into a list of index offsets.
+  // The neighbourhood box is defined by the range, the sphere by the fixed radius of 6.2 mm.
+  // The offsets of the box are enumerated directly, as the box around the index origin
+  // is not part of the image.
+  std::vector<OffsetType> sphereOffsets;
+  {
+    typename ImageType::IndexType zeroIndex;
+    zeroIndex.Fill(0);
+    typename ImageType::PointType origin;
+    typename ImageType::PointType localPoint;
+    itkImage->TransformIndexToPhysicalPoint(zeroIndex, origin);
+
+    OffsetType boxOffset;
+    boxOffset.Fill(-offset);
+    bool boxFinished = false;
+    while (!boxFinished)
+    {
+      itkImage->TransformIndexToPhysicalPoint(zeroIndex + boxOffset, localPoint);
+      if (origin.EuclideanDistanceTo(localPoint) < 6.2)
+      {
+        sphereOffsets.push_back(boxOffset);
+      }
+
+      // Next offset of the box, first dimension running fastest
+      unsigned int dim = 0;
+      for (; dim < VImageDimension; ++dim)
+      {
+        if (boxOffset[dim] < offset)
+        {
+          ++boxOffset[dim];
+          break;
+        }
+        boxOffset[dim] = -offset;
+      }
+      boxFinished = (dim == VImageDimension);
+    }
+  }
 
-  typename ImageType::PointType origin;
-  typename ImageType::PointType localPoint;
-  itk::Index<VImageDimension> index;
+  std::vector<typename ImageType::IndexType> maskedIndices;
+  itk::ImageRegionConstIteratorWithIndex<MaskType> maskIter(itkMask, itkMask->GetBufferedRegion());
+  for (maskIter.GoToBegin(); !maskIter.IsAtEnd(); ++maskIter)
+  {
+    if (maskIter.Get() > 0)
+      maskedIndices.push_back(maskIter.GetIndex());
+  }
+
+  const typename ImageType::RegionType imageRegion = itkImage->GetBufferedRegion();
+  const TPixel * imageBuffer = itkImage->GetBufferPointer();
 
-  double tmpPeakValue;
   double globalPeakValue = 0;
   double localPeakValue = 0;
   TPixel localMaximum = 0;
 
-  int count = 0;
-  while (!iter.IsAtEnd())
+  const long numberOfMaskedVoxels = static_cast<long>(maskedIndices.size());
+#pragma omp parallel
   {
-    if (iterMask.GetCenterPixel() > 0)
+    double threadGlobalPeakValue = 0;
+    double threadLocalPeakValue = 0;
+    TPixel threadLocalMaximum = 0;
+
+#pragma omp for schedule(dynamic, 64)
+    for (long voxel = 0; voxel < numberOfMaskedVoxels; ++voxel)
     {
-      tmpPeakValue = 0;
-      count = 0;
-      index = iter.GetIndex();
-      itkImage->TransformIndexToPhysicalPoint(index, origin);
-      for (itk::SizeValueType i = 0; i < iter.Size(); ++i)
+      const typename ImageType::IndexType & index = maskedIndices[voxel];
+      double tmpPeakValue = 0;
+      int count = 0;
+      for (const auto & sphereOffset : sphereOffsets)
       {
-        itkImage->TransformIndexToPhysicalPoint(iter.GetIndex(i), localPoint);
-        double dist = origin.EuclideanDistanceTo(localPoint);
-        if (dist < 6.2)
+        typename ImageType::IndexType neighbourIndex = index + sphereOffset;
+        if (imageRegion.IsInside(neighbourIndex))
         {
-          if (iter.IndexInBounds(i))
-          {
-            tmpPeakValue += iter.GetPixel(i);
-            ++count;
-          }
+          tmpPeakValue += imageBuffer[itkImage->ComputeOffset(neighbourIndex)];
+          ++count;
         }
       }
       tmpPeakValue /= count;
-      globalPeakValue = std::max<double>(tmpPeakValue, globalPeakValue);
-      if (localMaximum == iter.GetCenterPixel())
+      const TPixel centerValue = imageBuffer[itkImage->ComputeOffset(index)];
+      threadGlobalPeakValue = std::max<double>(tmpPeakValue, threadGlobalPeakValue);
+      if (threadLocalMaximum == centerValue)
+      {
+        threadLocalPeakValue = std::max<double>(tmpPeakValue, threadLocalPeakValue);
+      }
+      else if (threadLocalMaximum < centerValue)
+      {
+        threadLocalMaximum = centerValue;
+        threadLocalPeakValue = tmpPeakValue;
+      }
+    }
+
+#pragma omp critical
+    {
+      globalPeakValue = std::max<double>(threadGlobalPeakValue, globalPeakValue);
+      if (localMaximum == threadLocalMaximum)
       {
-        localPeakValue = std::max<double>(tmpPeakValue,localPeakValue);
+        localPeakValue = std::max<double>(threadLocalPeakValue, localPeakValue);
       }
-      else if (localMaximum < iter.GetCenterPixel())
+      else if (localMaximum < threadLocalMaximum)
       {
-        localMaximum = iter.GetCenterPixel();
-        localPeakValue = tmpPeakValue;
+        localMaximum = threadLocalMaximum;
+        localPeakValue = threadLocalPeakValue;
       }
     }
-    ++iterMask;
-    ++iter;
   }
   featureList.push_back(std::make_pair(params.prefix + "Local Intensity Peak", localPeakValue));
   featureList.push_back(std::make_pair(params.prefix + "Global Intensity Peak", globalPeakValue));
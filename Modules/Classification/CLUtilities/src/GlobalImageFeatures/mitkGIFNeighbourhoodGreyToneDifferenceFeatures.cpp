@@ -28,43 +28,47 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkNeighborhoodIterator.h>
 // STL
 #include <limits>
+#include <sstream>
 
 struct GIFNeighbourhoodGreyToneDifferenceParameter
 {
   int Range = 1;
   mitk::IntensityQuantifier::Pointer quantifier;
   std::string prefix;
+
+  mitk::GlobalImageFeatureContext* Context = nullptr;
+  const mitk::Image* InputImage = nullptr;
+  const mitk::Image* InputMask = nullptr;
 };
 
 template<typename TPixel, unsigned int VImageDimension>
-static void
-CalculateIntensityPeak(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, GIFNeighbourhoodGreyToneDifferenceParameter params, mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::FeatureListType & featureList)
+static Eigen::MatrixXd
+CalculateNeighbourhoodGreyToneDifferenceMatrix(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, GIFNeighbourhoodGreyToneDifferenceParameter params)
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<unsigned int, VImageDimension> QuantizedImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskType;
 
-  typename MaskType::Pointer itkMask = MaskType::New();
-  mitk::CastToItkImage(mask, itkMask);
+  typename MaskType::Pointer itkMask = mitk::GlobalImageFeatureContext::GetItkMask<MaskType>(params.Context, mask);
+  typename QuantizedImageType::Pointer quantizedImage = mitk::GlobalImageFeatureContext::GetQuantizedImage(params.Context, params.InputImage, itkImage, params.quantifier.GetPointer());
 
-  typename ImageType::SizeType regionSize;
+  typename QuantizedImageType::SizeType regionSize;
   regionSize.Fill(params.Range);
 
-  itk::NeighborhoodIterator<ImageType> iter(regionSize, itkImage, itkImage->GetLargestPossibleRegion());
+  itk::NeighborhoodIterator<QuantizedImageType> iter(regionSize, quantizedImage, quantizedImage->GetLargestPossibleRegion());
   itk::NeighborhoodIterator<MaskType> iterMask(regionSize, itkMask, itkMask->GetLargestPossibleRegion());
 
-  std::vector<double> pVector;
-  std::vector<double> sVector;
-  pVector.resize(params.quantifier->GetBins(), 0);
-  sVector.resize(params.quantifier->GetBins(), 0);
+  // The first column holds the number of voxels of each grey level,
+  // the second column the sum of the differences to the neighbourhood mean.
+  Eigen::MatrixXd matrix(params.quantifier->GetBins(), 2);
+  matrix.fill(0);
 
-  int count = 0;
   while (!iter.IsAtEnd())
   {
     if (iterMask.GetCenterPixel() > 0)
     {
       int localCount = 0;
       double localMean = 0;
-      unsigned int localIndex = params.quantifier->IntensityToIndex(iter.GetCenterPixel());
+      unsigned int localIndex = iter.GetCenterPixel();
       for (itk::SizeValueType i = 0; i < iter.Size(); ++i)
       {
         if (i == (iter.Size() / 2))
@@ -72,24 +76,59 @@ CalculateIntensityPeak(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Imag
         if (iterMask.GetPixel(i) > 0)
         {
           ++localCount;
-          localMean += params.quantifier->IntensityToIndex(iter.GetPixel(i)) + 1;
+          localMean += iter.GetPixel(i) + 1;
         }
       }
       if (localCount > 0)
       {
         localMean /= localCount;
       }
-        localMean = std::abs<double>(localIndex + 1 - localMean);
-
-        pVector[localIndex] += 1;
-        sVector[localIndex] += localMean;
-        ++count;
-
+      localMean = std::abs<double>(localIndex + 1 - localMean);
 
+      matrix(localIndex, 0) += 1;
+      matrix(localIndex, 1) += localMean;
     }
     ++iterMask;
     ++iter;
   }
+  return matrix;
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void
+CalculateIntensityPeak(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, GIFNeighbourhoodGreyToneDifferenceParameter params, mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::FeatureListType & featureList)
+{
+  Eigen::MatrixXd matrix;
+  if (params.Context != nullptr)
+  {
+    // The matrix only depends on the neighbourhood range and the quantification
+    std::ostringstream key;
+    key.precision(17);
+    key << "NeighbourhoodGreyToneDifference_Range-" << params.Range;
+    key << "_Min-" << params.quantifier->GetMinimum() << "_Max-" << params.quantifier->GetMaximum();
+    key << "_Bins-" << params.quantifier->GetBins() << "_BS-" << params.quantifier->GetBinsize();
+    matrix = params.Context->GetMatrix(params.InputImage, params.InputMask, key.str(), [&]()
+    {
+      return CalculateNeighbourhoodGreyToneDifferenceMatrix<TPixel, VImageDimension>(itkImage, mask, params);
+    });
+  }
+  else
+  {
+    matrix = CalculateNeighbourhoodGreyToneDifferenceMatrix<TPixel, VImageDimension>(itkImage, mask, params);
+  }
+
+  std::vector<double> pVector;
+  std::vector<double> sVector;
+  pVector.resize(params.quantifier->GetBins(), 0);
+  sVector.resize(params.quantifier->GetBins(), 0);
+
+  int count = 0;
+  for (unsigned int i = 0; i < params.quantifier->GetBins(); ++i)
+  {
+    pVector[i] = matrix(i, 0);
+    sVector[i] = matrix(i, 1);
+    count += static_cast<int>(matrix(i, 0));
+  }
 
   unsigned int Ngp = 0;
   for (unsigned int i = 0; i < params.quantifier->GetBins(); ++i)
@@ -166,6 +205,9 @@ mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::FeatureListType mitk::GIFNeigh
   params.Range = GetRange();
   params.quantifier = GetQuantifier();
   params.prefix = FeatureDescriptionPrefix();
+  params.Context = GetContext();
+  params.InputImage = image;
+  params.InputMask = mask;
 
   AccessByItk_3(image, CalculateIntensityPeak, mask, params, featureList);
   return featureList;
@@ -347,8 +347,7 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
   double rangeMax = config.MaximumIntensity;
   int numberOfBins = config.Bins;
 
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
+  typename MaskType::Pointer maskImage = mitk::GlobalImageFeatureContext::GetItkMask<MaskType>(config.Context, mask);
 
   std::vector<mitk::NGLDMMatrixFeatures> resultVector;
   int numberofDependency = 37;
@@ -422,6 +421,7 @@ mitk::GIFNeighbouringGreyLevelDependenceFeature::FeatureListType mitk::GIFNeighb
   config.Bins = GetQuantifier()->GetBins();
 
   config.FeatureEncoding = FeatureDescriptionPrefix();
+  config.Context = GetContext();
 
   AccessByItk_3(image, CalculateCoocurenceFeatures, mask, featureList,config);
 
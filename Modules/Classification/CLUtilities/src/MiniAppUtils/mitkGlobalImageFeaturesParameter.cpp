@@ -59,6 +59,7 @@ void mitk::cl::GlobalImageFeaturesParameter::AddParameter(mitkCommandLineParser
   parser.addArgument("binsize", "binsize", mitkCommandLineParser::Float, "Int", "Size of bins that is used. If set, it is overwritten by more specific bin count", us::Any());
   parser.addArgument("ignore-mask-for-histogram", "ignore-mask", mitkCommandLineParser::Bool, "Bool", "If the whole image is used to calculate the histogram. ", us::Any());
   parser.addArgument("encode-parameter-in-name", "encode-parameter", mitkCommandLineParser::Bool, "Bool", "If true, the parameters used for each feature is encoded in its name. ", us::Any());
+  parser.addArgument("parallel-features", "parallel", mitkCommandLineParser::Bool, "Bool", "If true, independent feature classes are calculated concurrently. ", us::Any());
 }
 
 void mitk::cl::GlobalImageFeaturesParameter::ParseParameter(std::map<std::string, us::Any> parsedArgs)
@@ -198,6 +199,7 @@ void mitk::cl::GlobalImageFeaturesParameter::ParseGlobalFeatureParameter(std::ma
   defineGlobalMaximumIntensity = false;
   defineGlobalNumberOfBins = false;
   encodeParameter = false;
+  parallelFeatures = false;
   if (parsedArgs.count("minimum-intensity"))
   {
     defineGlobalMinimumIntensity = true;
@@ -217,4 +219,8 @@ void mitk::cl::GlobalImageFeaturesParameter::ParseGlobalFeatureParameter(std::ma
   {
     encodeParameter = true;
   }
+  if (parsedArgs.count("parallel-features"))
+  {
+    parallelFeatures = us::any_cast<bool>(parsedArgs["parallel-features"]);
+  }
 }
@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cmath>
 
 #include <mitkGIFLocalIntensity.h>
+#include <mitkITKImageImport.h>
+#include <itkImage.h>
 
 class mitkGIFLocalIntensityTestSuite : public mitk::TestFixture
 {
@@ -28,6 +30,7 @@ class mitkGIFLocalIntensityTestSuite : public mitk::TestFixture
   MITK_TEST(ImageDescription_PhantomTest_Small);
   MITK_TEST(ImageDescription_PhantomTest_Large);
   MITK_TEST(ImageDescription_PhantomTest_Large_RangeChanged);
+  MITK_TEST(ImageDescription_SyntheticImage);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -109,6 +112,56 @@ public:
     CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Local Intensity::Global Intensity Peak with Large IBSI Phantom Image", 3.15, results["Local Intensity::Global Intensity Peak"], 0.01);
   }
 
+  void ImageDescription_SyntheticImage()
+  {
+    // 5x5x5 image with 1 mm spacing, only two voxels are set and masked
+    typedef itk::Image<double, 3> ImageType;
+    typedef itk::Image<unsigned short, 3> MaskType;
+
+    ImageType::SizeType size;
+    size.Fill(5);
+    ImageType::RegionType region(size);
+
+    ImageType::Pointer itkImage = ImageType::New();
+    itkImage->SetRegions(region);
+    itkImage->Allocate();
+    itkImage->FillBuffer(0);
+
+    MaskType::Pointer itkMask = MaskType::New();
+    itkMask->SetRegions(region);
+    itkMask->Allocate();
+    itkMask->FillBuffer(0);
+
+    ImageType::IndexType center;
+    center.Fill(2);
+    ImageType::IndexType corner;
+    corner.Fill(0);
+    itkImage->SetPixel(center, 100);
+    itkImage->SetPixel(corner, 54);
+    itkMask->SetPixel(center, 1);
+    itkMask->SetPixel(corner, 1);
+
+    mitk::Image::Pointer image = mitk::GrabItkImageMemory(itkImage);
+    mitk::Image::Pointer mask = mitk::GrabItkImageMemory(itkMask);
+
+    mitk::GIFLocalIntensity::Pointer featureCalculator = mitk::GIFLocalIntensity::New();
+    featureCalculator->SetRange(1);
+
+    auto featureList = featureCalculator->CalculateFeatures(image, mask);
+
+    std::map<std::string, double> results;
+    for (auto valuePair : featureList)
+    {
+      results[valuePair.first] = valuePair.second;
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Image Diagnostics should calculate 2 features.", std::size_t(2), featureList.size());
+
+    // The center voxel is the maximum, its 3x3x3 neighbourhood lies completely inside the image.
+    // Only the 2x2x2 neighbourhood of the corner voxel lies inside the image, which gives the larger peak.
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Local Intensity::Local Intensity Peak with synthetic image", 100.0 / 27.0, results["Local Intensity::Local Intensity Peak"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Local Intensity::Global Intensity Peak with synthetic image", 54.0 / 8.0, results["Local Intensity::Global Intensity Peak"], 1e-9);
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkGIFLocalIntensity )
\ No newline at end of file
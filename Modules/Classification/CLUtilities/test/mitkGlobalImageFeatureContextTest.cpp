@@ -0,0 +1,189 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include "mitkIOUtil.h"
+
+#include <mitkGlobalImageFeatureContext.h>
+#include <mitkGIFCooccurenceMatrix2.h>
+#include <mitkGIFGreyLevelDistanceZone.h>
+#include <mitkGIFGreyLevelRunLength.h>
+#include <mitkGIFGreyLevelSizeZone.h>
+#include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
+#include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
+
+class mitkGlobalImageFeatureContextTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkGlobalImageFeatureContextTestSuite);
+
+  MITK_TEST(SharedContext_SameFeaturesAsWithoutContext);
+  MITK_TEST(SharedContext_ReusesResultsOfOtherFeatureClasses);
+  MITK_TEST(SharedContext_ReusesMatrices);
+  MITK_TEST(SharedContext_ParallelFeatureClassesAsSerial);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_IBSI_Phantom_Image_Large;
+  mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
+
+  std::vector<mitk::AbstractGlobalImageFeature::Pointer> CreateFeatureClasses()
+  {
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> features;
+    features.push_back(mitk::GIFCooccurenceMatrix2::New().GetPointer());
+    features.push_back(mitk::GIFGreyLevelDistanceZone::New().GetPointer());
+    features.push_back(mitk::GIFGreyLevelRunLength::New().GetPointer());
+    features.push_back(mitk::GIFGreyLevelSizeZone::New().GetPointer());
+    features.push_back(mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::New().GetPointer());
+    features.push_back(mitk::GIFNeighbouringGreyLevelDependenceFeature::New().GetPointer());
+
+    for (auto feature : features)
+    {
+      feature->SetUseBinsize(true);
+      feature->SetBinsize(1.0);
+      feature->SetUseMinimumIntensity(true);
+      feature->SetUseMaximumIntensity(true);
+      feature->SetMinimumIntensity(0.5);
+      feature->SetMaximumIntensity(6.5);
+    }
+    return features;
+  }
+
+  mitk::AbstractGlobalImageFeature::FeatureListType CalculateFeatureClassesWithParameters(bool parallel)
+  {
+    auto features = CreateFeatureClasses();
+    mitk::AbstractGlobalImageFeature::ParameterTypes parameter;
+    parameter["minimum-intensity"] = us::Any(0.5f);
+    parameter["maximum-intensity"] = us::Any(6.5f);
+    parameter["binsize"] = us::Any(1.0f);
+    for (auto feature : features)
+      parameter[feature->GetLongName()] = us::Any(true);
+
+    mitk::GlobalImageFeatureContext::Pointer context = mitk::GlobalImageFeatureContext::New();
+    for (auto feature : features)
+    {
+      feature->SetParameter(parameter);
+      feature->SetContext(context);
+    }
+
+    mitk::AbstractGlobalImageFeature::FeatureListType featureList;
+    mitk::AbstractGlobalImageFeature::CalculateFeatureClassesUsingParameters(features, m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, m_IBSI_Phantom_Mask_Large, featureList, parallel);
+    return featureList;
+  }
+
+public:
+
+  void setUp(void) override
+  {
+    m_IBSI_Phantom_Image_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Large.nrrd"));
+    m_IBSI_Phantom_Mask_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Large.nrrd"));
+  }
+
+  void SharedContext_SameFeaturesAsWithoutContext()
+  {
+    auto features = CreateFeatureClasses();
+    mitk::AbstractGlobalImageFeature::FeatureListType withoutContext;
+    for (auto feature : features)
+    {
+      auto featureList = feature->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+      withoutContext.insert(withoutContext.end(), featureList.begin(), featureList.end());
+    }
+
+    features = CreateFeatureClasses();
+    mitk::GlobalImageFeatureContext::Pointer context = mitk::GlobalImageFeatureContext::New();
+    mitk::AbstractGlobalImageFeature::FeatureListType withContext;
+    for (auto feature : features)
+    {
+      feature->SetContext(context);
+      auto featureList = feature->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+      withContext.insert(withContext.end(), featureList.begin(), featureList.end());
+    }
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The same features should be calculated with a shared context.", withoutContext.size(), withContext.size());
+    for (std::size_t i = 0; i < withoutContext.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Features should be in the same order with a shared context.", withoutContext[i].first, withContext[i].first);
+      bool bothNaN = (withoutContext[i].second != withoutContext[i].second) && (withContext[i].second != withContext[i].second);
+      CPPUNIT_ASSERT_MESSAGE(withContext[i].first + " should not change with a shared context.", bothNaN || withoutContext[i].second == withContext[i].second);
+    }
+  }
+
+  void SharedContext_ReusesResultsOfOtherFeatureClasses()
+  {
+    mitk::GlobalImageFeatureContext::Pointer context = mitk::GlobalImageFeatureContext::New();
+
+    mitk::GIFGreyLevelSizeZone::Pointer sizeZone = mitk::GIFGreyLevelSizeZone::New();
+    sizeZone->SetContext(context);
+    sizeZone->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The first feature class should not find cached values.", 0ul, context->GetNumberOfCacheHits());
+
+    // Same quantification and mask as the size zone features
+    mitk::GIFCooccurenceMatrix2::Pointer cooccurence = mitk::GIFCooccurenceMatrix2::New();
+    cooccurence->SetContext(context);
+    cooccurence->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    CPPUNIT_ASSERT_MESSAGE("Quantifier and mask should be taken from the context.", context->GetNumberOfCacheHits() >= 2);
+
+    context->Clear();
+    unsigned long hits = context->GetNumberOfCacheHits();
+    sizeZone->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("A cleared context should not return cached values.", hits, context->GetNumberOfCacheHits());
+  }
+
+  void SharedContext_ReusesMatrices()
+  {
+    mitk::GlobalImageFeatureContext::Pointer context = mitk::GlobalImageFeatureContext::New();
+
+    mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::Pointer first = mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::New();
+    first->SetContext(context);
+    auto firstList = first->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    unsigned long misses = context->GetNumberOfCacheMisses();
+
+    mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::Pointer second = mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::New();
+    second->SetContext(context);
+    auto secondList = second->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The second calculation should be answered from the context.", misses, context->GetNumberOfCacheMisses());
+
+    CPPUNIT_ASSERT_EQUAL(firstList.size(), secondList.size());
+    for (std::size_t i = 0; i < firstList.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(firstList[i].first, firstList[i].second, secondList[i].second);
+    }
+
+    // Modifying the image invalidates the cached values
+    m_IBSI_Phantom_Image_Large->Modified();
+    second->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    CPPUNIT_ASSERT_MESSAGE("A modified image should not use cached values.", context->GetNumberOfCacheMisses() > misses);
+  }
+
+  void SharedContext_ParallelFeatureClassesAsSerial()
+  {
+    auto serial = CalculateFeatureClassesWithParameters(false);
+    auto parallel = CalculateFeatureClassesWithParameters(true);
+
+    CPPUNIT_ASSERT_MESSAGE("Features should be calculated.", !serial.empty());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The same features should be calculated concurrently.", serial.size(), parallel.size());
+    for (std::size_t i = 0; i < serial.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Features should be in the order of the feature classes.", serial[i].first, parallel[i].first);
+      bool bothNaN = (serial[i].second != serial[i].second) && (parallel[i].second != parallel[i].second);
+      CPPUNIT_ASSERT_MESSAGE(parallel[i].first + " should not change if the feature classes are calculated concurrently.", bothNaN || serial[i].second == parallel[i].second);
+    }
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkGlobalImageFeatureContext)
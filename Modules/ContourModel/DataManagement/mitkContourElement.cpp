@@ -13,19 +13,55 @@ A PARTICULAR PURPOSE.
 See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
-#include <algorithm>
 #include <mitkContourElement.h>
 #include <vtkMath.h>
 
-mitk::ContourElement::ContourElement()
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <set>
+
+namespace
+{
+  // the grid has at most 2^20 cells in each direction, so a cell key fits into 64 bits
+  const long long MaxNumberOfCells = 1 << 20;
+
+  // squared distance of a point to the segment v1-v2, computed in the same way as before the spatial index existed
+  double SquaredDistanceToSegment(const mitk::Point3D &point, const mitk::Point3D &v1, const mitk::Point3D &v2)
+  {
+    const float l2 = v1.SquaredEuclideanDistanceTo(v2);
+
+    mitk::Vector3D p_v1 = point - v1;
+    mitk::Vector3D v2_v1 = v2 - v1;
+
+    double tc = (p_v1 * v2_v1) / l2;
+
+    // take into account we have line segments and not (infinite) lines
+    if (tc < 0.0)
+      tc = 0.0;
+    if (tc > 1.0)
+      tc = 1.0;
+
+    mitk::Point3D crossPoint = v1 + v2_v1 * tc;
+
+    return point.SquaredEuclideanDistanceTo(crossPoint);
+  }
+}
+
+mitk::ContourElement::ContourElement() : m_Storage(std::make_shared<VertexStorageType>())
 {
   this->m_Vertices = new VertexListType();
   this->m_IsClosed = false;
 }
 
 mitk::ContourElement::ContourElement(const mitk::ContourElement &other)
-  : itk::LightObject(), m_Vertices(other.m_Vertices), m_IsClosed(other.m_IsClosed)
+  : itk::LightObject(),
+    m_Vertices(new VertexListType(*other.m_Vertices)),
+    m_IsClosed(other.m_IsClosed),
+    m_Storage(std::make_shared<VertexStorageType>())
 {
+  // the copy uses the same vertices as the original
+  this->ReferenceStorageOf(&other);
 }
 
 mitk::ContourElement::~ContourElement()
@@ -33,24 +69,57 @@ mitk::ContourElement::~ContourElement()
   delete this->m_Vertices;
 }
 
+mitk::ContourElement::VertexType *mitk::ContourElement::CreateVertex(mitk::Point3D &point, bool isControlPoint)
+{
+  // adding elements at the end of a deque does not move the existing ones
+  this->m_Storage->Vertices.emplace_back(point, isControlPoint);
+  return &this->m_Storage->Vertices.back();
+}
+
+void mitk::ContourElement::ReferenceStorageOf(const ContourElement *other)
+{
+  if (other == this)
+    return;
+
+  auto reference = [this](const VertexStoragePointer &storage) {
+    if (storage != this->m_Storage &&
+        std::find(this->m_ReferencedStorages.begin(), this->m_ReferencedStorages.end(), storage) ==
+          this->m_ReferencedStorages.end())
+    {
+      this->m_ReferencedStorages.push_back(storage);
+    }
+  };
+
+  reference(other->m_Storage);
+  for (const auto &storage : other->m_ReferencedStorages)
+  {
+    reference(storage);
+  }
+}
+
 void mitk::ContourElement::AddVertex(mitk::Point3D &vertex, bool isControlPoint)
 {
-  this->m_Vertices->push_back(new VertexType(vertex, isControlPoint));
+  this->m_Vertices->push_back(this->CreateVertex(vertex, isControlPoint));
+  this->InvalidateOwnSpatialIndex();
 }
 
 void mitk::ContourElement::AddVertex(VertexType &vertex)
 {
-  this->m_Vertices->push_back(&vertex);
+  // the vertex may belong to another (temporary) contour, so it is copied into the own storage
+  this->m_Vertices->push_back(this->CreateVertex(vertex.Coordinates, vertex.IsControlPoint));
+  this->InvalidateOwnSpatialIndex();
 }
 
 void mitk::ContourElement::AddVertexAtFront(mitk::Point3D &vertex, bool isControlPoint)
 {
-  this->m_Vertices->push_front(new VertexType(vertex, isControlPoint));
+  this->m_Vertices->push_front(this->CreateVertex(vertex, isControlPoint));
+  this->InvalidateOwnSpatialIndex();
 }
 
 void mitk::ContourElement::AddVertexAtFront(VertexType &vertex)
 {
-  this->m_Vertices->push_front(&vertex);
+  this->m_Vertices->push_front(this->CreateVertex(vertex.Coordinates, vertex.IsControlPoint));
+  this->InvalidateOwnSpatialIndex();
 }
 
 void mitk::ContourElement::InsertVertexAtIndex(mitk::Point3D &vertex, bool isControlPoint, int index)
@@ -59,7 +128,8 @@ void mitk::ContourElement::InsertVertexAtIndex(mitk::Point3D &vertex, bool isCon
   {
     auto _where = this->m_Vertices->begin();
     _where += index;
-    this->m_Vertices->insert(_where, new VertexType(vertex, isControlPoint));
+    this->m_Vertices->insert(_where, this->CreateVertex(vertex, isControlPoint));
+    this->InvalidateOwnSpatialIndex();
   }
 }
 
@@ -68,6 +138,7 @@ void mitk::ContourElement::SetVertexAt(int pointId, const Point3D &point)
   if (pointId >= 0 && this->GetSize() > pointId)
   {
     this->m_Vertices->at(pointId)->Coordinates = point;
+    this->InvalidateSpatialIndex();
   }
 }
 
@@ -77,6 +148,7 @@ void mitk::ContourElement::SetVertexAt(int pointId, const VertexType *vertex)
   {
     this->m_Vertices->at(pointId)->Coordinates = vertex->Coordinates;
     this->m_Vertices->at(pointId)->IsControlPoint = vertex->IsControlPoint;
+    this->InvalidateSpatialIndex();
   }
 }
 
@@ -92,16 +164,216 @@ bool mitk::ContourElement::IsEmpty()
 
 mitk::ContourElement::VertexType *mitk::ContourElement::GetVertexAt(const mitk::Point3D &point, float eps)
 {
-  /* current version iterates over the whole deque - should some kind of an octree with spatial query*/
-
   if (eps > 0)
   {
-    // currently no method with better performance is available
-    return BruteForceGetVertexAt(point, eps);
+    std::vector<unsigned int> indices;
+    this->FindVerticesInRadius(point, eps, indices);
+
+    // same selection as BruteForceGetVertexAt: follow the vertices in the order of the contour and remember each
+    // one that is closer than all before. The closest control point of these is preferred.
+    std::vector<std::pair<double, VertexType *>> nearestlist;
+    for (unsigned int index : indices)
+    {
+      VertexType *vertex = this->m_SpatialIndex.Vertices[index];
+      double distance = vertex->Coordinates.EuclideanDistanceTo(point);
+      if (nearestlist.empty() || distance < nearestlist.back().first)
+      {
+        nearestlist.push_back(std::make_pair(distance, vertex));
+      }
+    }
+
+    for (auto it = nearestlist.rbegin(); it != nearestlist.rend(); ++it)
+    {
+      if (it->second->IsControlPoint)
+      {
+        return it->second;
+      }
+    }
+    if (!nearestlist.empty())
+    {
+      return nearestlist.back().second;
+    }
   } // if eps < 0
   return nullptr;
 }
 
+void mitk::ContourElement::InvalidateSpatialIndex()
+{
+  // the moved vertex may be shared with other elements, their indices are outdated via the storages
+  this->InvalidateOwnSpatialIndex();
+  ++this->m_Storage->ModificationCount;
+  for (const auto &storage : this->m_ReferencedStorages)
+  {
+    ++storage->ModificationCount;
+  }
+}
+
+void mitk::ContourElement::InvalidateOwnSpatialIndex()
+{
+  this->m_SpatialIndex.Valid = false;
+}
+
+unsigned long long mitk::ContourElement::GetStorageModificationCount() const
+{
+  unsigned long long modificationCount = this->m_Storage->ModificationCount;
+  for (const auto &storage : this->m_ReferencedStorages)
+  {
+    modificationCount += storage->ModificationCount;
+  }
+  return modificationCount;
+}
+
+unsigned long long mitk::ContourElement::GetCellKey(long long x, long long y, long long z) const
+{
+  return (static_cast<unsigned long long>(x) << 42) | (static_cast<unsigned long long>(y) << 21) |
+         static_cast<unsigned long long>(z);
+}
+
+void mitk::ContourElement::UpdateSpatialIndex()
+{
+  SpatialIndex &index = this->m_SpatialIndex;
+  const unsigned long long modificationCount = this->GetStorageModificationCount();
+  if (index.Valid && index.ModificationCount == modificationCount)
+    return;
+
+  const std::size_t numberOfVertices = this->m_Vertices->size();
+  index.X.resize(numberOfVertices);
+  index.Y.resize(numberOfVertices);
+  index.Z.resize(numberOfVertices);
+  index.Vertices.assign(this->m_Vertices->begin(), this->m_Vertices->end());
+  index.Cells.resize(numberOfVertices);
+  index.MaxSegmentLength = 0.0;
+
+  double minimum[3] = {0.0, 0.0, 0.0};
+  double maximum[3] = {0.0, 0.0, 0.0};
+  double sumOfSegmentLengths = 0.0;
+  for (std::size_t i = 0; i < numberOfVertices; ++i)
+  {
+    const mitk::Point3D &coordinates = index.Vertices[i]->Coordinates;
+    index.X[i] = coordinates[0];
+    index.Y[i] = coordinates[1];
+    index.Z[i] = coordinates[2];
+
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      minimum[d] = (i == 0) ? coordinates[d] : std::min(minimum[d], coordinates[d]);
+      maximum[d] = (i == 0) ? coordinates[d] : std::max(maximum[d], coordinates[d]);
+    }
+
+    if (i > 0)
+    {
+      double length = coordinates.EuclideanDistanceTo(index.Vertices[i - 1]->Coordinates);
+      sumOfSegmentLengths += length;
+      index.MaxSegmentLength = std::max(index.MaxSegmentLength, length);
+    }
+  }
+  if (numberOfVertices > 1)
+  {
+    index.MaxSegmentLength = std::max(
+      index.MaxSegmentLength, index.Vertices.front()->Coordinates.EuclideanDistanceTo(index.Vertices.back()->Coordinates));
+  }
+
+  // a cell should contain a few consecutive vertices of the contour
+  double extent = 0.0;
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    extent = std::max(extent, maximum[d] - minimum[d]);
+  }
+  double cellSize = (numberOfVertices > 1) ? 4.0 * sumOfSegmentLengths / (numberOfVertices - 1) : 0.0;
+  cellSize = std::max(cellSize, extent / (MaxNumberOfCells - 1));
+  if (!(cellSize > 0.0) || !std::isfinite(cellSize))
+  {
+    cellSize = 1.0;
+  }
+  index.CellSize = cellSize;
+
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    index.Origin[d] = minimum[d];
+    index.MaxCell[d] = std::min(static_cast<long long>((maximum[d] - minimum[d]) / cellSize), MaxNumberOfCells - 1);
+  }
+
+  for (std::size_t i = 0; i < numberOfVertices; ++i)
+  {
+    long long cell[3];
+    const double coordinates[3] = {index.X[i], index.Y[i], index.Z[i]};
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      cell[d] = std::max(
+        0LL, std::min(static_cast<long long>((coordinates[d] - index.Origin[d]) / cellSize), index.MaxCell[d]));
+    }
+    index.Cells[i] = std::make_pair(this->GetCellKey(cell[0], cell[1], cell[2]), static_cast<unsigned int>(i));
+  }
+  std::sort(index.Cells.begin(), index.Cells.end());
+
+  index.ModificationCount = modificationCount;
+  index.Valid = true;
+}
+
+void mitk::ContourElement::FindVerticesInRadius(const mitk::Point3D &point,
+                                                double radius,
+                                                std::vector<unsigned int> &indices)
+{
+  indices.clear();
+  this->UpdateSpatialIndex();
+  const SpatialIndex &index = this->m_SpatialIndex;
+  const std::size_t numberOfVertices = index.Vertices.size();
+  if (numberOfVertices == 0 || !(radius > 0.0))
+    return;
+
+  // same computation as Point::EuclideanDistanceTo, so that results do not differ at the border of the radius
+  auto isInside = [&](std::size_t i) {
+    const double dx = index.X[i] - point[0];
+    const double dy = index.Y[i] - point[1];
+    const double dz = index.Z[i] - point[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz) < radius;
+  };
+
+  // cells overlapping the bounding box of the query sphere
+  long long first[3];
+  long long last[3];
+  double numberOfCells = 1.0;
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    const double lower = std::floor((point[d] - radius - index.Origin[d]) / index.CellSize);
+    const double upper = std::floor((point[d] + radius - index.Origin[d]) / index.CellSize);
+    if (upper < 0.0 || lower > index.MaxCell[d])
+      return;
+    first[d] = static_cast<long long>(std::max(lower, 0.0));
+    last[d] = static_cast<long long>(std::min(upper, static_cast<double>(index.MaxCell[d])));
+    numberOfCells *= (last[d] - first[d] + 1);
+  }
+
+  if (numberOfCells >= numberOfVertices)
+  {
+    // a large radius, scanning the contiguous coordinates is faster than visiting the cells
+    for (std::size_t i = 0; i < numberOfVertices; ++i)
+    {
+      if (isInside(i))
+        indices.push_back(static_cast<unsigned int>(i));
+    }
+    return;
+  }
+
+  for (long long x = first[0]; x <= last[0]; ++x)
+  {
+    for (long long y = first[1]; y <= last[1]; ++y)
+    {
+      for (long long z = first[2]; z <= last[2]; ++z)
+      {
+        const unsigned long long key = this->GetCellKey(x, y, z);
+        auto it = std::lower_bound(index.Cells.begin(), index.Cells.end(), std::make_pair(key, 0u));
+        for (; it != index.Cells.end() && it->first == key; ++it)
+        {
+          if (isInside(it->second))
+            indices.push_back(it->second);
+        }
+      }
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+}
+
 mitk::ContourElement::VertexType *mitk::ContourElement::BruteForceGetVertexAt(const mitk::Point3D &point, float eps)
 {
   if (eps > 0)
@@ -233,40 +505,27 @@ bool mitk::ContourElement::IsClosed()
 
 bool mitk::ContourElement::IsNearContour(const mitk::Point3D &point, float eps)
 {
-  ConstVertexIterator it1 = this->m_Vertices->begin();
-  ConstVertexIterator it2 = this->m_Vertices->begin();
-  it2++; // it2 runs one position ahead
+  // eps is compared to the squared distance of the point to the segments (including the one from last to first vertex)
+  if (!(eps > 0) || this->m_Vertices->empty())
+    return false;
 
-  ConstVertexIterator end = this->m_Vertices->end();
+  this->UpdateSpatialIndex();
+  const SpatialIndex &index = this->m_SpatialIndex;
+  const std::size_t numberOfVertices = index.Vertices.size();
 
-  int counter = 0;
+  // a segment closer than sqrt(eps) has an end point closer than sqrt(eps) + segment length
+  const double radius = (std::sqrt(static_cast<double>(eps)) + index.MaxSegmentLength) * (1.0 + 1e-9) + 1e-9;
+  std::vector<unsigned int> candidates;
+  this->FindVerticesInRadius(point, radius, candidates);
 
-  for (; it1 != end; it1++, it2++, counter++)
+  for (unsigned int i : candidates)
   {
-    if (it2 == end)
-      it2 = this->m_Vertices->begin();
-
-    mitk::Point3D v1 = (*it1)->Coordinates;
-    mitk::Point3D v2 = (*it2)->Coordinates;
-
-    const float l2 = v1.SquaredEuclideanDistanceTo(v2);
-
-    mitk::Vector3D p_v1 = point - v1;
-    mitk::Vector3D v2_v1 = v2 - v1;
+    const std::size_t previous = (i == 0) ? numberOfVertices - 1 : i - 1;
+    const std::size_t next = (i + 1 == numberOfVertices) ? 0 : i + 1;
+    const mitk::Point3D &v = index.Vertices[i]->Coordinates;
 
-    double tc = (p_v1 * v2_v1) / l2;
-
-    // take into account we have line segments and not (infinite) lines
-    if (tc < 0.0)
-      tc = 0.0;
-    if (tc > 1.0)
-      tc = 1.0;
-
-    mitk::Point3D crossPoint = v1 + v2_v1 * tc;
-
-    double distance = point.SquaredEuclideanDistanceTo(crossPoint);
-
-    if (distance < eps)
+    if (SquaredDistanceToSegment(point, index.Vertices[previous]->Coordinates, v) < eps ||
+        SquaredDistanceToSegment(point, v, index.Vertices[next]->Coordinates) < eps)
     {
       return true;
     }
@@ -313,35 +572,35 @@ void mitk::ContourElement::Concatenate(mitk::ContourElement *other, bool check)
 {
   if (other->GetSize() > 0)
   {
-    ConstVertexIterator otherIt = other->m_Vertices->begin();
-    ConstVertexIterator otherEnd = other->m_Vertices->end();
-    while (otherIt != otherEnd)
+    // the vertices are shared with the other element
+    this->ReferenceStorageOf(other);
+
+    typedef std::array<double, 3> CoordinatesType;
+    std::set<CoordinatesType> existingCoordinates;
+    auto toArray = [](const VertexType *vertex) {
+      return CoordinatesType{{vertex->Coordinates[0], vertex->Coordinates[1], vertex->Coordinates[2]}};
+    };
+    if (check)
     {
-      if (check)
+      for (const VertexType *vertex : *this->m_Vertices)
       {
-        ConstVertexIterator thisIt = this->m_Vertices->begin();
-        ConstVertexIterator thisEnd = this->m_Vertices->end();
-
-        bool found = false;
-        while (thisIt != thisEnd)
-        {
-          if ((*thisIt)->Coordinates == (*otherIt)->Coordinates)
-          {
-            found = true;
-            break;
-          }
-
-          thisIt++;
-        }
-        if (!found)
-          this->m_Vertices->push_back(*otherIt);
+        existingCoordinates.insert(toArray(vertex));
       }
-      else
+    }
+
+    // copy the list first, other may be this element
+    const VertexListType otherVertices(*other->m_Vertices);
+    for (VertexType *vertex : otherVertices)
+    {
+      if (check)
       {
-        this->m_Vertices->push_back(*otherIt);
+        // only add vertices whose coordinates are not yet contained
+        if (!existingCoordinates.insert(toArray(vertex)).second)
+          continue;
       }
-      otherIt++;
+      this->m_Vertices->push_back(vertex);
     }
+    this->InvalidateOwnSpatialIndex();
   }
 }
 
@@ -357,6 +616,7 @@ bool mitk::ContourElement::RemoveVertex(const VertexType *vertex)
     if ((*it) == vertex)
     {
       this->m_Vertices->erase(it);
+      this->InvalidateOwnSpatialIndex();
       return true;
     }
 
@@ -394,6 +654,7 @@ bool mitk::ContourElement::RemoveVertexAt(int index)
   if (index >= 0 && static_cast<VertexListType::size_type>(index) < this->m_Vertices->size())
   {
     this->m_Vertices->erase(this->m_Vertices->begin() + index);
+    this->InvalidateOwnSpatialIndex();
     return true;
   }
   else
@@ -404,27 +665,17 @@ bool mitk::ContourElement::RemoveVertexAt(int index)
 
 bool mitk::ContourElement::RemoveVertexAt(mitk::Point3D &point, float eps)
 {
-  /* current version iterates over the whole deque - should be some kind of an octree with spatial query*/
-
   if (eps > 0)
   {
-    auto it = this->m_Vertices->begin();
+    std::vector<unsigned int> indices;
+    this->FindVerticesInRadius(point, eps, indices);
 
-    auto end = this->m_Vertices->end();
-
-    while (it != end)
+    if (!indices.empty())
     {
-      mitk::Point3D currentPoint = (*it)->Coordinates;
-
-      if (currentPoint.EuclideanDistanceTo(point) < eps)
-      {
-        // approximate point found
-        // now erase it
-        this->m_Vertices->erase(it);
-        return true;
-      }
-
-      it++;
+      // approximate point found, the first one of the contour is removed
+      this->m_Vertices->erase(this->m_Vertices->begin() + indices.front());
+      this->InvalidateOwnSpatialIndex();
+      return true;
     }
   }
   return false;
@@ -432,7 +683,9 @@ bool mitk::ContourElement::RemoveVertexAt(mitk::Point3D &point, float eps)
 
 void mitk::ContourElement::Clear()
 {
+  // the storage is kept, vertex pointers may still be used by others
   this->m_Vertices->clear();
+  this->InvalidateOwnSpatialIndex();
 }
 //----------------------------------------------------------------------
 void mitk::ContourElement::RedistributeControlVertices(const VertexType *selected, int period)
@@ -23,6 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 //#include <ANN/ANN.h>
 
 #include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace mitk
 {
@@ -32,6 +35,15 @@ namespace mitk
   end of the contour and to iterate in both directions.
   To mark a vertex as a special one it can be set as a control point.
 
+  Vertices created by the element are allocated in contiguous blocks instead of one by one. The storage is shared
+  with all elements the vertices are concatenated to, so a vertex pointer stays valid as long as one of these
+  elements exists and can be used as a stable ID. Vertices added by reference are copied into this storage.
+
+  Spatial queries (GetVertexAt(point, eps), RemoveVertexAt(point, eps), IsNearContour()) use a uniform grid over a
+  structure-of-arrays copy of the coordinates. It is rebuilt on the first query after the contour was changed. If
+  coordinates are modified directly through a vertex pointer, InvalidateSpatialIndex() has to be called. Moving a
+  vertex outdates the grids of all elements sharing it.
+
   \Note It is highly not recommend to use this class directly as no secure mechanism is used here.
   Use mitk::ContourModel instead providing some additional features.
   */
@@ -93,7 +105,7 @@ namespace mitk
     virtual void AddVertex(mitk::Point3D &point, bool isControlPoint);
 
     /** \brief Add a vertex at the end of the contour
-    \param vertex - a contour element vertex.
+    \param vertex - a contour element vertex. It is copied, the element does not keep a reference to it.
     */
     virtual void AddVertex(VertexType &vertex);
 
@@ -104,7 +116,7 @@ namespace mitk
     virtual void AddVertexAtFront(mitk::Point3D &point, bool isControlPoint);
 
     /** \brief Add a vertex at the front of the contour
-    \param vertex - a contour element vertex.
+    \param vertex - a contour element vertex. It is copied, the element does not keep a reference to it.
     */
     virtual void AddVertexAtFront(VertexType &vertex);
 
@@ -218,6 +230,12 @@ namespace mitk
 
     VertexListType *GetControlVertices();
 
+    /** \brief Marks the spatial index as outdated.
+    Has to be called if the coordinates of vertices were changed directly, e.g. through a vertex pointer.
+    The spatial indices of all elements sharing vertices with this one are outdated as well.
+    */
+    void InvalidateSpatialIndex();
+
     /** \brief Uniformly redistribute control points with a given period (in number of vertices)
     \param vertex - the vertex around which the redistribution is done.
     \param period - number of vertices between control points.
@@ -231,8 +249,71 @@ namespace mitk
     ContourElement(const mitk::ContourElement &other);
     ~ContourElement() override;
 
+    /** \brief Contiguous vertex storage, shared by all elements that use its vertices. */
+    struct VertexStorageType
+    {
+      VertexStorageType() : ModificationCount(0) {}
+
+      std::deque<VertexType> Vertices;
+
+      // incremented whenever coordinates of shared vertices may have changed
+      unsigned long long ModificationCount;
+    };
+    typedef std::shared_ptr<VertexStorageType> VertexStoragePointer;
+
+    /** \brief Uniform grid over a contiguous copy of the coordinates, for queries in a radius around a point. */
+    struct SpatialIndex
+    {
+      SpatialIndex() : CellSize(1.0), MaxSegmentLength(0.0), ModificationCount(0), Valid(false) {}
+
+      // coordinates and vertices in the order of the contour
+      std::vector<double> X;
+      std::vector<double> Y;
+      std::vector<double> Z;
+      std::vector<VertexType *> Vertices;
+
+      double Origin[3];
+      long long MaxCell[3];
+      double CellSize;
+
+      // pairs of (cell key, vertex index), sorted by key
+      std::vector<std::pair<unsigned long long, unsigned int>> Cells;
+
+      // maximal length of all segments including the one from last to first vertex
+      double MaxSegmentLength;
+
+      // sum of the modification counts of the used storages when the index was built
+      unsigned long long ModificationCount;
+
+      bool Valid;
+    };
+
+    /** \brief Creates a vertex in the contiguous storage of this element. */
+    VertexType *CreateVertex(mitk::Point3D &point, bool isControlPoint);
+
+    /** \brief Keeps the storage of the vertices of another element alive. */
+    void ReferenceStorageOf(const ContourElement *other);
+
+    /** \brief Marks only the spatial index of this element as outdated, e.g. after vertices were added or removed. */
+    void InvalidateOwnSpatialIndex();
+
+    /** \brief Returns the sum of the modification counts of all storages used by this element. */
+    unsigned long long GetStorageModificationCount() const;
+
+    void UpdateSpatialIndex();
+
+    /** \brief Returns the (ascending) indices of all vertices with a distance to point below radius. */
+    void FindVerticesInRadius(const mitk::Point3D &point, double radius, std::vector<unsigned int> &indices);
+
+    unsigned long long GetCellKey(long long x, long long y, long long z) const;
+
     VertexListType *m_Vertices; // double ended queue with vertices
     bool m_IsClosed;
+
+    VertexStoragePointer m_Storage;                       // vertices created by this element
+    std::vector<VertexStoragePointer> m_ReferencedStorages; // storages of concatenated elements
+
+    SpatialIndex m_SpatialIndex;
   };
 } // namespace mitk
 
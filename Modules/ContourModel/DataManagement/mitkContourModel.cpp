@@ -425,6 +425,12 @@ void mitk::ContourModel::ShiftVertex(VertexType *vertex, mitk::Vector3D &vector)
   vertex->Coordinates[0] += vector[0];
   vertex->Coordinates[1] += vector[1];
   vertex->Coordinates[2] += vector[2];
+
+  // the vertex was moved behind the back of the contour elements
+  for (auto &element : this->m_ContourSeries)
+  {
+    element->InvalidateSpatialIndex();
+  }
 }
 
 void mitk::ContourModel::Clear(int timestep)
@@ -0,0 +1,245 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkContourElement.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+class mitkContourElementTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkContourElementTestSuite);
+  MITK_TEST(TestGetVertexAt_MatchesBruteForce);
+  MITK_TEST(TestRemoveVertexAt_RemovesFirstVertexInRadius);
+  MITK_TEST(TestIsNearContour_MatchesBruteForce);
+  MITK_TEST(TestModifiedVertices_UpdateSpatialIndex);
+  MITK_TEST(TestConcatenate_KeepsVerticesAlive);
+  MITK_TEST(TestSharedVertices_UpdateSpatialIndexOfOtherElements);
+  MITK_TEST(TestGetVertexAt_Benchmark);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  /** Creates a closed, noisy spiral with a control point every 10 vertices. */
+  mitk::ContourElement::Pointer CreateContour(unsigned int numberOfVertices)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> noise(-0.2, 0.2);
+
+    mitk::ContourElement::Pointer contour = mitk::ContourElement::New();
+    for (unsigned int i = 0; i < numberOfVertices; ++i)
+    {
+      const double angle = 0.01 * i;
+      const double radius = 10.0 + 0.005 * i;
+      mitk::Point3D point;
+      point[0] = radius * std::cos(angle) + noise(generator);
+      point[1] = radius * std::sin(angle) + noise(generator);
+      point[2] = 0.0;
+      contour->AddVertex(point, i % 10 == 0);
+    }
+    contour->Close();
+    return contour;
+  }
+
+  mitk::Point3D CreateQueryPoint(std::mt19937 &generator, double extent)
+  {
+    std::uniform_real_distribution<double> coordinate(-extent, extent);
+    mitk::Point3D point;
+    point[0] = coordinate(generator);
+    point[1] = coordinate(generator);
+    point[2] = 0.0;
+    return point;
+  }
+
+  /** Reference implementation of IsNearContour without spatial index. */
+  bool BruteForceIsNearContour(mitk::ContourElement *contour, const mitk::Point3D &point, float eps)
+  {
+    const int size = contour->GetSize();
+    for (int i = 0; i < size; ++i)
+    {
+      mitk::Point3D v1 = contour->GetVertexAt(i)->Coordinates;
+      mitk::Point3D v2 = contour->GetVertexAt((i + 1) % size)->Coordinates;
+      const float l2 = v1.SquaredEuclideanDistanceTo(v2);
+      double tc = ((point - v1) * (v2 - v1)) / l2;
+      tc = tc < 0.0 ? 0.0 : (tc > 1.0 ? 1.0 : tc);
+      if (point.SquaredEuclideanDistanceTo(v1 + (v2 - v1) * tc) < eps)
+        return true;
+    }
+    return false;
+  }
+
+public:
+  void TestGetVertexAt_MatchesBruteForce()
+  {
+    mitk::ContourElement::Pointer contour = CreateContour(5000);
+    std::mt19937 generator(7);
+    const float radii[] = {0.05f, 0.5f, 2.0f, 100.0f};
+    for (unsigned int i = 0; i < 500; ++i)
+    {
+      mitk::Point3D point = CreateQueryPoint(generator, 40.0);
+      for (float eps : radii)
+      {
+        CPPUNIT_ASSERT_EQUAL(contour->BruteForceGetVertexAt(point, eps), contour->GetVertexAt(point, eps));
+      }
+    }
+    CPPUNIT_ASSERT(contour->GetVertexAt(contour->GetVertexAt(17)->Coordinates, 0.0f) == nullptr);
+  }
+
+  void TestRemoveVertexAt_RemovesFirstVertexInRadius()
+  {
+    mitk::ContourElement::Pointer contour = CreateContour(2000);
+    mitk::Point3D point = contour->GetVertexAt(1500)->Coordinates;
+    const float eps = 3.0f;
+
+    int expectedIndex = -1;
+    for (int i = 0; i < contour->GetSize() && expectedIndex < 0; ++i)
+    {
+      if (contour->GetVertexAt(i)->Coordinates.EuclideanDistanceTo(point) < eps)
+        expectedIndex = i;
+    }
+    mitk::ContourElement::VertexType *expectedVertex = contour->GetVertexAt(expectedIndex);
+
+    CPPUNIT_ASSERT(contour->RemoveVertexAt(point, eps));
+    CPPUNIT_ASSERT_EQUAL(1999, contour->GetSize());
+    CPPUNIT_ASSERT_EQUAL(-1, contour->GetIndex(expectedVertex));
+
+    mitk::Point3D farAway;
+    farAway.Fill(1000.0);
+    CPPUNIT_ASSERT(!contour->RemoveVertexAt(farAway, eps));
+  }
+
+  void TestIsNearContour_MatchesBruteForce()
+  {
+    mitk::ContourElement::Pointer contour = CreateContour(3000);
+    std::mt19937 generator(11);
+    const float radii[] = {0.01f, 0.25f, 4.0f};
+    for (unsigned int i = 0; i < 500; ++i)
+    {
+      mitk::Point3D point = CreateQueryPoint(generator, 30.0);
+      for (float eps : radii)
+      {
+        CPPUNIT_ASSERT_EQUAL(BruteForceIsNearContour(contour, point, eps), contour->IsNearContour(point, eps));
+      }
+    }
+  }
+
+  void TestModifiedVertices_UpdateSpatialIndex()
+  {
+    mitk::ContourElement::Pointer contour = CreateContour(1000);
+    mitk::Point3D target;
+    target.Fill(500.0);
+    CPPUNIT_ASSERT(contour->GetVertexAt(target, 1.0f) == nullptr);
+
+    contour->SetVertexAt(123, target);
+    CPPUNIT_ASSERT_EQUAL(contour->GetVertexAt(123), contour->GetVertexAt(target, 1.0f));
+
+    mitk::Point3D added;
+    added.Fill(-500.0);
+    contour->AddVertexAtFront(added, false);
+    CPPUNIT_ASSERT_EQUAL(contour->GetVertexAt(0), contour->GetVertexAt(added, 1.0f));
+
+    // direct modification through the vertex pointer
+    mitk::ContourElement::VertexType *vertex = contour->GetVertexAt(500);
+    vertex->Coordinates.Fill(300.0);
+    contour->InvalidateSpatialIndex();
+    CPPUNIT_ASSERT_EQUAL(vertex, contour->GetVertexAt(vertex->Coordinates, 1.0f));
+  }
+
+  void TestConcatenate_KeepsVerticesAlive()
+  {
+    mitk::ContourElement::Pointer target = CreateContour(100);
+    mitk::ContourElement::VertexType *vertex = nullptr;
+    {
+      mitk::ContourElement::Pointer source = mitk::ContourElement::New();
+      mitk::Point3D point;
+      point.Fill(200.0);
+      source->AddVertex(point, true);
+      source->AddVertex(point, false); // duplicate, skipped by the check
+      vertex = source->GetVertexAt(0);
+      target->Concatenate(source, true);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(101, target->GetSize());
+    CPPUNIT_ASSERT_EQUAL(vertex, target->GetVertexAt(100));
+    CPPUNIT_ASSERT(vertex->IsControlPoint);
+    CPPUNIT_ASSERT_EQUAL(200.0, vertex->Coordinates[0]);
+
+    mitk::ContourElement::Pointer clone = target->Clone();
+    target = nullptr;
+    CPPUNIT_ASSERT_EQUAL(101, clone->GetSize());
+    CPPUNIT_ASSERT_EQUAL(200.0, clone->GetVertexAt(100)->Coordinates[1]);
+  }
+
+  void TestSharedVertices_UpdateSpatialIndexOfOtherElements()
+  {
+    mitk::ContourElement::Pointer contour = CreateContour(1000);
+    mitk::ContourElement::Pointer clone = contour->Clone();
+    mitk::ContourElement::Pointer target = CreateContour(10);
+    target->Concatenate(contour, false);
+
+    // build the grids of all elements before the shared vertex is moved
+    mitk::ContourElement::VertexType *vertex = contour->GetVertexAt(321);
+    const mitk::Point3D oldPosition = vertex->Coordinates;
+    CPPUNIT_ASSERT_EQUAL(vertex, clone->GetVertexAt(oldPosition, 0.001f));
+    CPPUNIT_ASSERT_EQUAL(vertex, target->GetVertexAt(oldPosition, 0.001f));
+
+    mitk::Point3D newPosition;
+    newPosition.Fill(500.0);
+    CPPUNIT_ASSERT(!clone->IsNearContour(newPosition, 1.0f));
+    contour->SetVertexAt(321, newPosition);
+
+    CPPUNIT_ASSERT_EQUAL(vertex, clone->GetVertexAt(newPosition, 1.0f));
+    CPPUNIT_ASSERT_EQUAL(vertex, target->GetVertexAt(newPosition, 1.0f));
+    CPPUNIT_ASSERT(clone->GetVertexAt(oldPosition, 0.001f) != vertex);
+    CPPUNIT_ASSERT(clone->IsNearContour(newPosition, 1.0f));
+
+    // moving it through the clone has to update the original as well
+    newPosition.Fill(-500.0);
+    clone->SetVertexAt(clone->GetIndex(vertex), newPosition);
+    CPPUNIT_ASSERT_EQUAL(vertex, contour->GetVertexAt(newPosition, 1.0f));
+    CPPUNIT_ASSERT(target->RemoveVertexAt(newPosition, 1.0f));
+    CPPUNIT_ASSERT_EQUAL(1000, clone->GetSize());
+  }
+
+  void TestGetVertexAt_Benchmark()
+  {
+    mitk::ContourElement::Pointer contour = CreateContour(50000);
+    std::mt19937 generator(3);
+    std::vector<mitk::Point3D> points;
+    for (unsigned int i = 0; i < 1000; ++i)
+      points.push_back(CreateQueryPoint(generator, 40.0));
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int found = 0;
+    for (const auto &point : points)
+      found += contour->BruteForceGetVertexAt(point, 1.0f) != nullptr;
+    double bruteForceMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    unsigned int foundIndexed = 0;
+    for (const auto &point : points)
+      foundIndexed += contour->GetVertexAt(point, 1.0f) != nullptr;
+    double indexedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    MITK_INFO << "1000 vertex queries on 50000 vertices: brute force " << bruteForceMs << " ms, spatial index "
+              << indexedMs << " ms (including the index construction)";
+    CPPUNIT_ASSERT_EQUAL(found, foundIndexed);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkContourElement)
@@ -400,6 +400,36 @@ static void TestContourModelAPI()
   MITK_TEST_CONDITION(contour2->GetNumberOfVertices() == 1, "Add call with another contour");
 }
 
+// Vertices added from another contour have to stay valid after that contour is destroyed
+static void TestAddVertexFromTemporaryContour()
+{
+  mitk::ContourModel::Pointer contour = mitk::ContourModel::New();
+
+  mitk::Point3D p1;
+  p1[0] = 1;
+  p1[1] = 2;
+  p1[2] = 3;
+
+  mitk::Point3D p2;
+  p2[0] = -4;
+  p2[1] = 5;
+  p2[2] = -6;
+
+  {
+    mitk::ContourModel::Pointer temporary = mitk::ContourModel::New();
+    temporary->AddVertex(p1, true);
+    temporary->AddVertex(p2);
+
+    contour->AddVertex(temporary->GetVertexAt(0));
+    contour->AddVertexAtFront(*const_cast<mitk::ContourModel::VertexType *>(temporary->GetVertexAt(1)));
+  }
+
+  MITK_TEST_CONDITION(contour->GetNumberOfVertices() == 2, "Vertices of temporary contour added");
+  MITK_TEST_CONDITION(mitk::Equal(contour->GetVertexAt(0)->Coordinates, p2), "Front vertex copied");
+  MITK_TEST_CONDITION(mitk::Equal(contour->GetVertexAt(1)->Coordinates, p1), "Back vertex copied");
+  MITK_TEST_CONDITION(contour->GetVertexAt(1)->IsControlPoint, "Control point flag copied");
+}
+
 int mitkContourModelTest(int /*argc*/, char * /*argv*/ [])
 {
   MITK_TEST_BEGIN("mitkContourModelTest")
@@ -418,6 +448,7 @@ int mitkContourModelTest(int /*argc*/, char * /*argv*/ [])
   TestSetVertices();
   TestSelectVertexAtWrongPosition();
   TestContourModelAPI();
+  TestAddVertexFromTemporaryContour();
 
   MITK_TEST_END()
 }
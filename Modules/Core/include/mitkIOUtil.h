@@ -317,6 +317,34 @@ namespace mitk
     static std::vector<BaseData::Pointer> Load(const std::vector<std::string> &paths,
                                                const ReaderOptionsFunctorBase *optionsCallback = nullptr);
 
+    /**
+     * @brief Loads a list of file paths into the given DataStorage, reading several files concurrently.
+     *
+     * Readers are selected and the options callback is called in the calling thread, in the order
+     * of \c paths. The selected readers are then run by up to \c numberOfThreads threads. The nodes are
+     * added to \c storage and to the returned set in the order of \c paths, independent of the order
+     * in which the files were read. Use this method only with readers that can run concurrently.
+     *
+     * Unlike Load(const std::vector<std::string>&, DataStorage&, const ReaderOptionsFunctorBase*),
+     * files which are read by the reader of a previous file (e.g. a DICOM series) are read again,
+     * but their result is discarded.
+     *
+     * @param paths A list of absolute file names including the file extension.
+     * @param storage A DataStorage object to which the loaded data will be added.
+     * @param numberOfThreads The maximum number of files read at the same time. Zero uses one thread per core.
+     * @param optionsCallback Pointer to a callback instance, see Load(const std::vector<std::string>&, DataStorage&, const ReaderOptionsFunctorBase*).
+     * @return The set of added DataNode objects.
+     * @throws mitk::Exception if an entry in \c paths could not be loaded.
+     */
+    static DataStorage::SetOfObjects::Pointer LoadParallel(const std::vector<std::string> &paths,
+                                                           DataStorage &storage,
+                                                           unsigned int numberOfThreads = 0,
+                                                           const ReaderOptionsFunctorBase *optionsCallback = nullptr);
+
+    static std::vector<BaseData::Pointer> LoadParallel(const std::vector<std::string> &paths,
+                                                       unsigned int numberOfThreads = 0,
+                                                       const ReaderOptionsFunctorBase *optionsCallback = nullptr);
+
     /**
      * @brief Loads the contents of a us::ModuleResource and returns the corresponding mitk::BaseData
      * @param usResource a ModuleResource, representing a BaseData object
@@ -412,6 +440,12 @@ namespace mitk
                             DataStorage *ds,
                             const ReaderOptionsFunctorBase *optionsCallback);
 
+    static std::string LoadParallel(std::vector<LoadInfo> &loadInfos,
+                                    DataStorage::SetOfObjects *nodeResult,
+                                    DataStorage *ds,
+                                    const ReaderOptionsFunctorBase *optionsCallback,
+                                    unsigned int numberOfThreads);
+
     static std::string Save(const BaseData *data,
                             const std::string &mimeType,
                             const std::string &path,
@@ -22,8 +22,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkDefaultDynamicMeshTraits.h>
 #include <itkMesh.h>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace mitk
 {
+  class PlaneGeometry;
+  class PointSetSpatialIndex;
+
   /**
    * \brief Data structure which stores a set of points. Superclass of
    * mitk::Mesh.
@@ -252,9 +259,23 @@ namespace mitk
      * \param distance is in mm.
      * returns -1 if no point is found
      * or the position in the list of the first match
+     *
+     * For larger point sets, the search uses a k-d tree (mitk::PointSetSpatialIndex) which is
+     * built on the first search after the points of the time step were modified.
      */
     int SearchPoint(Point3D point, ScalarType distance, int t = 0) const;
 
+    /**
+     * \brief Returns the IDs (ascending) of all points closer to the plane than distance
+     *
+     * The distance is measured in world coordinates, like in mitk::PlaneGeometry::DistanceFromPlane().
+     * The bounds of the plane are not considered. Uses the same spatial index as SearchPoint().
+     */
+    void SearchPointsNearPlane(const PlaneGeometry *plane,
+                               ScalarType distance,
+                               std::vector<PointIdentifier> &ids,
+                               int t = 0) const;
+
     bool IsEmptyTimeStep(unsigned int t) const override;
 
     // virtual methods, that need to be implemented
@@ -283,6 +304,14 @@ namespace mitk
     /** \brief swaps point coordinates and point data of the points with identifiers id1 and id2 */
     bool SwapPointContents(PointIdentifier id1, PointIdentifier id2, int t = 0);
 
+    /**
+    * \brief Returns the spatial index of the points of time step t (in index coordinates)
+    *
+    * The index is rebuilt if the points container of the time step was replaced or modified.
+    * Returns nullptr if the time step contains too few points for an index to pay off.
+    */
+    std::shared_ptr<const PointSetSpatialIndex> GetSpatialIndex(int t) const;
+
     typedef std::vector<DataType::Pointer> PointSetSeries;
 
     PointSetSeries m_PointSetSeries;
@@ -293,6 +322,17 @@ namespace mitk
     * @brief flag to indicate the right time to call SetBounds
     **/
     bool m_CalculateBoundingBox;
+
+  private:
+    struct SpatialIndexCacheEntry
+    {
+      const DataType::PointsContainer *Points = nullptr;
+      itk::ModifiedTimeType PointsMTime = 0;
+      std::shared_ptr<const PointSetSpatialIndex> Index;
+    };
+
+    mutable std::vector<SpatialIndexCacheEntry> m_SpatialIndexCache;
+    mutable std::mutex m_SpatialIndexMutex;
   };
 
   /**
@@ -0,0 +1,100 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkPointSetSpatialIndex_h
+#define mitkPointSetSpatialIndex_h
+
+#include <MitkCoreExports.h>
+#include <mitkNumericTypes.h>
+
+#include <itkIntTypes.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * \brief Balanced k-d tree over a contiguous copy of the points of a point set.
+   *
+   * The coordinates are stored as structure of arrays in the order of the tree, so queries touch
+   * little memory. The index is immutable after Build(); it has to be rebuilt if the points change.
+   * mitk::PointSet keeps one index per time step and rebuilds it lazily, see PointSet::SearchPoint().
+   *
+   * Results do not depend on the tree layout: ties are resolved by the smallest point ID, like in a
+   * linear scan over the point container.
+   */
+  class MITKCORE_EXPORT PointSetSpatialIndex
+  {
+  public:
+    typedef itk::IdentifierType PointIdentifier;
+
+    /** \brief Builds the tree from the given points. ids and points must have the same size. */
+    void Build(const std::vector<PointIdentifier> &ids, const std::vector<Point3D> &points);
+
+    std::size_t GetNumberOfPoints() const { return m_Ids.size(); }
+
+    /**
+     * \brief Searches the point closest to the given point with a squared distance below maxSquaredDistance.
+     *
+     * A point with exactly the coordinates of the query point is preferred to all others. Among equally
+     * distant points, the one with the smallest ID is returned.
+     * \return false if there is no such point
+     */
+    bool FindClosestPoint(const Point3D &point, ScalarType maxSquaredDistance, PointIdentifier &id) const;
+
+    /**
+     * \brief Returns the IDs (ascending) of all points p with |normal * p + offset| < distance.
+     * This is the set of points in a slab around a plane, if normal has unit length.
+     */
+    void FindPointsInSlab(const Vector3D &normal,
+                          ScalarType offset,
+                          ScalarType distance,
+                          std::vector<PointIdentifier> &ids) const;
+
+  private:
+    struct Box
+    {
+      ScalarType Min[3];
+      ScalarType Max[3];
+    };
+
+    void BuildNode(std::size_t begin, std::size_t end, const std::vector<Point3D> &points);
+
+    void FindClosestPoint(std::size_t begin,
+                          std::size_t end,
+                          const ScalarType query[3],
+                          ScalarType &bestDistance,
+                          bool &bestIsEqual,
+                          std::size_t &best) const;
+
+    void FindPointsInSlab(std::size_t begin,
+                          std::size_t end,
+                          Box box,
+                          const ScalarType normal[3],
+                          ScalarType offset,
+                          ScalarType distance,
+                          std::vector<PointIdentifier> &ids) const;
+
+    // node of the range [begin, end) is at (begin + end) / 2, its split dimension is stored there
+    std::vector<ScalarType> m_Coordinates[3];
+    std::vector<PointIdentifier> m_Ids;
+    std::vector<unsigned char> m_SplitDimensions;
+    std::vector<std::size_t> m_Order; // only used while building
+    Box m_Bounds;
+  };
+}
+
+#endif
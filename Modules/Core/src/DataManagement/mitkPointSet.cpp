@@ -16,8 +16,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkPointSet.h"
 #include "mitkInteractionConst.h"
+#include "mitkPlaneGeometry.h"
 #include "mitkPointOperation.h"
+#include "mitkPointSetSpatialIndex.h"
 
+#include <cmath>
 #include <iomanip>
 #include <mitkNumericTypes.h>
 
@@ -212,6 +215,14 @@ int mitk::PointSet::SearchPoint(Point3D point, ScalarType distance, int t) const
     distance = 0.000001;
   }
 
+  // use the k-d tree for larger point sets, it gives the same result as the linear search below
+  std::shared_ptr<const PointSetSpatialIndex> spatialIndex = this->GetSpatialIndex(t);
+  if (spatialIndex)
+  {
+    PointIdentifier id = 0;
+    return spatialIndex->FindClosestPoint(indexPoint, distance, id) ? static_cast<int>(id) : -1;
+  }
+
   ScalarType bestDist = distance;
   ScalarType dist, tmp;
 
@@ -245,6 +256,103 @@ int mitk::PointSet::SearchPoint(Point3D point, ScalarType distance, int t) const
   return bestIndex;
 }
 
+void mitk::PointSet::SearchPointsNearPlane(const PlaneGeometry *plane,
+                                           ScalarType distance,
+                                           std::vector<PointIdentifier> &ids,
+                                           int t) const
+{
+  ids.clear();
+  if (plane == nullptr || t < 0 || t >= (int)m_PointSetSeries.size())
+  {
+    return;
+  }
+
+  Vector3D normal = plane->GetNormal();
+  if (normal.GetNorm() == 0)
+  {
+    return;
+  }
+  normal.Normalize();
+
+  // the signed distance of a point p (in index coordinates) is normal * (M * p + o - origin), which is
+  // linear in p: (M^T * normal) * p + normal * (o - origin)
+  const AffineTransform3D *transform = this->GetGeometry(t)->GetIndexToWorldTransform();
+  const AffineTransform3D::MatrixType &matrix = transform->GetMatrix();
+  Vector3D indexNormal;
+  for (unsigned int j = 0; j < 3; ++j)
+  {
+    indexNormal[j] = 0;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      indexNormal[j] += matrix[i][j] * normal[i];
+    }
+  }
+  Vector3D offset = transform->GetOffset();
+  const ScalarType planeOffset = normal * (offset - plane->GetOrigin().GetVectorFromOrigin());
+
+  std::shared_ptr<const PointSetSpatialIndex> spatialIndex = this->GetSpatialIndex(t);
+  if (spatialIndex)
+  {
+    spatialIndex->FindPointsInSlab(indexNormal, planeOffset, distance, ids);
+    return;
+  }
+
+  for (PointsConstIterator it = this->Begin(t); it != this->End(t); ++it)
+  {
+    const PointType &point = it.Value();
+    const ScalarType value =
+      indexNormal[0] * point[0] + indexNormal[1] * point[1] + indexNormal[2] * point[2] + planeOffset;
+    if (std::abs(value) < distance)
+    {
+      ids.push_back(it.Index());
+    }
+  }
+}
+
+std::shared_ptr<const mitk::PointSetSpatialIndex> mitk::PointSet::GetSpatialIndex(int t) const
+{
+  // below this size, a linear search is faster than building the index
+  const std::size_t minimumNumberOfPoints = 64;
+
+  if (t < 0 || t >= (int)m_PointSetSeries.size() || m_PointSetSeries[t].IsNull())
+  {
+    return nullptr;
+  }
+  const DataType::PointsContainer *points = m_PointSetSeries[t]->GetPoints();
+  if (points == nullptr || points->Size() < minimumNumberOfPoints)
+  {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(m_SpatialIndexMutex);
+  if (m_SpatialIndexCache.size() < m_PointSetSeries.size())
+  {
+    m_SpatialIndexCache.resize(m_PointSetSeries.size());
+  }
+
+  // the points container is modified by all methods that insert, move or remove points
+  SpatialIndexCacheEntry &entry = m_SpatialIndexCache[t];
+  if (!entry.Index || entry.Points != points || entry.PointsMTime != points->GetMTime())
+  {
+    std::vector<PointIdentifier> ids;
+    std::vector<Point3D> coordinates;
+    ids.reserve(points->Size());
+    coordinates.reserve(points->Size());
+    for (auto it = points->Begin(); it != points->End(); ++it)
+    {
+      ids.push_back(it->Index());
+      coordinates.push_back(it->Value());
+    }
+
+    auto index = std::make_shared<PointSetSpatialIndex>();
+    index->Build(ids, coordinates);
+    entry.Index = index;
+    entry.Points = points;
+    entry.PointsMTime = points->GetMTime();
+  }
+  return entry.Index;
+}
+
 mitk::PointSet::PointType mitk::PointSet::GetPoint(PointIdentifier id, int t) const
 {
   PointType out;
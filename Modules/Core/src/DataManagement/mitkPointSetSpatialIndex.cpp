@@ -0,0 +1,261 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPointSetSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+  // ranges with at most this number of points are not split any further
+  const std::size_t LeafSize = 8;
+}
+
+void mitk::PointSetSpatialIndex::Build(const std::vector<PointIdentifier> &ids, const std::vector<Point3D> &points)
+{
+  const std::size_t numberOfPoints = std::min(ids.size(), points.size());
+
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    m_Bounds.Min[d] = numberOfPoints > 0 ? points[0][d] : 0.0;
+    m_Bounds.Max[d] = m_Bounds.Min[d];
+  }
+  for (std::size_t i = 1; i < numberOfPoints; ++i)
+  {
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      m_Bounds.Min[d] = std::min(m_Bounds.Min[d], points[i][d]);
+      m_Bounds.Max[d] = std::max(m_Bounds.Max[d], points[i][d]);
+    }
+  }
+
+  m_Order.resize(numberOfPoints);
+  std::iota(m_Order.begin(), m_Order.end(), 0);
+  m_SplitDimensions.assign(numberOfPoints, 0);
+  this->BuildNode(0, numberOfPoints, points);
+
+  // copy the points in the order of the tree
+  m_Ids.resize(numberOfPoints);
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    m_Coordinates[d].resize(numberOfPoints);
+  }
+  for (std::size_t i = 0; i < numberOfPoints; ++i)
+  {
+    const std::size_t source = m_Order[i];
+    m_Ids[i] = ids[source];
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      m_Coordinates[d][i] = points[source][d];
+    }
+  }
+  m_Order = std::vector<std::size_t>();
+}
+
+void mitk::PointSetSpatialIndex::BuildNode(std::size_t begin, std::size_t end, const std::vector<Point3D> &points)
+{
+  if (end - begin <= LeafSize)
+    return;
+
+  // split along the dimension with the largest spread
+  ScalarType minimum[3], maximum[3];
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    minimum[d] = maximum[d] = points[m_Order[begin]][d];
+  }
+  for (std::size_t i = begin + 1; i < end; ++i)
+  {
+    const Point3D &point = points[m_Order[i]];
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      minimum[d] = std::min(minimum[d], point[d]);
+      maximum[d] = std::max(maximum[d], point[d]);
+    }
+  }
+  unsigned char dimension = 0;
+  for (unsigned char d = 1; d < 3; ++d)
+  {
+    if (maximum[d] - minimum[d] > maximum[dimension] - minimum[dimension])
+      dimension = d;
+  }
+
+  const std::size_t middle = (begin + end) / 2;
+  std::nth_element(m_Order.begin() + begin,
+                   m_Order.begin() + middle,
+                   m_Order.begin() + end,
+                   [&points, dimension](std::size_t a, std::size_t b) { return points[a][dimension] < points[b][dimension]; });
+  m_SplitDimensions[middle] = dimension;
+
+  this->BuildNode(begin, middle, points);
+  this->BuildNode(middle + 1, end, points);
+}
+
+bool mitk::PointSetSpatialIndex::FindClosestPoint(const Point3D &point,
+                                                  ScalarType maxSquaredDistance,
+                                                  PointIdentifier &id) const
+{
+  const ScalarType query[3] = {point[0], point[1], point[2]};
+  ScalarType bestDistance = maxSquaredDistance;
+  bool bestIsEqual = false;
+  std::size_t best = std::numeric_limits<std::size_t>::max();
+
+  this->FindClosestPoint(0, m_Ids.size(), query, bestDistance, bestIsEqual, best);
+
+  if (best == std::numeric_limits<std::size_t>::max())
+    return false;
+
+  id = m_Ids[best];
+  return true;
+}
+
+void mitk::PointSetSpatialIndex::FindClosestPoint(std::size_t begin,
+                                                  std::size_t end,
+                                                  const ScalarType query[3],
+                                                  ScalarType &bestDistance,
+                                                  bool &bestIsEqual,
+                                                  std::size_t &best) const
+{
+  if (begin >= end)
+    return;
+
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  auto check = [&](std::size_t i) {
+    const ScalarType x = m_Coordinates[0][i];
+    const ScalarType y = m_Coordinates[1][i];
+    const ScalarType z = m_Coordinates[2][i];
+
+    if (x == query[0] && y == query[1] && z == query[2])
+    {
+      if (!bestIsEqual || m_Ids[i] < m_Ids[best])
+      {
+        best = i;
+        bestIsEqual = true;
+        bestDistance = 0.0;
+      }
+      return;
+    }
+    if (bestIsEqual)
+      return;
+
+    // same computation as the linear search, so that the results do not differ
+    ScalarType tmp = x - query[0];
+    ScalarType distance = tmp * tmp;
+    tmp = y - query[1];
+    distance += tmp * tmp;
+    tmp = z - query[2];
+    distance += tmp * tmp;
+
+    if (distance < bestDistance || (best != none && distance == bestDistance && m_Ids[i] < m_Ids[best]))
+    {
+      best = i;
+      bestDistance = distance;
+    }
+  };
+
+  if (end - begin <= LeafSize)
+  {
+    for (std::size_t i = begin; i < end; ++i)
+      check(i);
+    return;
+  }
+
+  const std::size_t middle = (begin + end) / 2;
+  const unsigned char dimension = m_SplitDimensions[middle];
+  check(middle);
+
+  const ScalarType difference = query[dimension] - m_Coordinates[dimension][middle];
+  if (difference <= 0)
+  {
+    this->FindClosestPoint(begin, middle, query, bestDistance, bestIsEqual, best);
+    if (difference * difference <= bestDistance)
+      this->FindClosestPoint(middle + 1, end, query, bestDistance, bestIsEqual, best);
+  }
+  else
+  {
+    this->FindClosestPoint(middle + 1, end, query, bestDistance, bestIsEqual, best);
+    if (difference * difference <= bestDistance)
+      this->FindClosestPoint(begin, middle, query, bestDistance, bestIsEqual, best);
+  }
+}
+
+void mitk::PointSetSpatialIndex::FindPointsInSlab(const Vector3D &normal,
+                                                  ScalarType offset,
+                                                  ScalarType distance,
+                                                  std::vector<PointIdentifier> &ids) const
+{
+  ids.clear();
+  if (m_Ids.empty() || !(distance > 0))
+    return;
+
+  const ScalarType n[3] = {normal[0], normal[1], normal[2]};
+  this->FindPointsInSlab(0, m_Ids.size(), m_Bounds, n, offset, distance, ids);
+  std::sort(ids.begin(), ids.end());
+}
+
+void mitk::PointSetSpatialIndex::FindPointsInSlab(std::size_t begin,
+                                                  std::size_t end,
+                                                  Box box,
+                                                  const ScalarType normal[3],
+                                                  ScalarType offset,
+                                                  ScalarType distance,
+                                                  std::vector<PointIdentifier> &ids) const
+{
+  if (begin >= end)
+    return;
+
+  // range of the plane function within the box; a small tolerance keeps rounding errors from pruning too much
+  ScalarType lower = offset;
+  ScalarType upper = offset;
+  ScalarType magnitude = std::abs(offset);
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    lower += normal[d] * (normal[d] > 0 ? box.Min[d] : box.Max[d]);
+    upper += normal[d] * (normal[d] > 0 ? box.Max[d] : box.Min[d]);
+    magnitude += std::abs(normal[d]) * std::max(std::abs(box.Min[d]), std::abs(box.Max[d]));
+  }
+  const ScalarType tolerance = 1e-9 * magnitude;
+  if (lower - tolerance >= distance || upper + tolerance <= -distance)
+    return;
+
+  auto check = [&](std::size_t i) {
+    const ScalarType value =
+      normal[0] * m_Coordinates[0][i] + normal[1] * m_Coordinates[1][i] + normal[2] * m_Coordinates[2][i] + offset;
+    if (std::abs(value) < distance)
+      ids.push_back(m_Ids[i]);
+  };
+
+  if (end - begin <= LeafSize)
+  {
+    for (std::size_t i = begin; i < end; ++i)
+      check(i);
+    return;
+  }
+
+  const std::size_t middle = (begin + end) / 2;
+  const unsigned char dimension = m_SplitDimensions[middle];
+  check(middle);
+
+  Box lowerBox = box;
+  lowerBox.Max[dimension] = m_Coordinates[dimension][middle];
+  this->FindPointsInSlab(begin, middle, lowerBox, normal, offset, distance, ids);
+
+  Box upperBox = box;
+  upperBox.Min[dimension] = m_Coordinates[dimension][middle];
+  this->FindPointsInSlab(middle + 1, end, upperBox, normal, offset, distance, ids);
+}
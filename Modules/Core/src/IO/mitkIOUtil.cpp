@@ -39,8 +39,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkSmartPointer.h>
 #include <vtkTriangleFilter.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstdlib>
+#include <map>
+#include <thread>
 
 static std::string GetLastErrorStr()
 {
@@ -318,6 +322,32 @@ namespace mitk
     static BaseData::Pointer LoadBaseDataFromFile(const std::string &path, const ReaderOptionsFunctorBase* optionsCallback = nullptr);
 
     static void SetDefaultDataNodeProperties(mitk::DataNode *node, const std::string &filePath = std::string());
+
+    enum ReaderSelection
+    {
+      ReaderSelected,
+      ReaderSkipped, ///< no reader for the file, continue with the next one
+      ReaderAborted  ///< loading was cancelled, stop loading
+    };
+
+    /** Selects the reader for a file and calls the options callback if necessary. Readers
+     *  selected by the callback are re-used for files of the same mime-type. */
+    static ReaderSelection SelectReader(LoadInfo &loadInfo,
+                                        std::map<std::string, FileReaderSelector::Item> &usedReaderItems,
+                                        const ReaderOptionsFunctorBase *optionsCallback,
+                                        std::string &errMsg);
+
+    /** Reads the file with the given reader, into \c ds if it is not nullptr. */
+    static DataStorage::SetOfObjects::Pointer Read(IFileReader *reader, DataStorage *ds);
+
+    /** Adds the data of the read nodes to the output of \c loadInfo and to \c nodeResult. */
+    static void AddOutput(LoadInfo &loadInfo,
+                          const DataStorage::SetOfObjects *nodes,
+                          DataStorage::SetOfObjects *nodeResult,
+                          std::string &errMsg);
+
+    /** Adds a node read into \c localStorage to \c ds, together with its sources. */
+    static void AddToDataStorage(DataNode *node, const DataStorage &localStorage, DataStorage &ds);
   };
 
   BaseData::Pointer IOUtil::Impl::LoadBaseDataFromFile(const std::string &path,
@@ -549,6 +579,49 @@ namespace mitk
     return nodeResult;
   }
 
+  DataStorage::SetOfObjects::Pointer IOUtil::LoadParallel(const std::vector<std::string> &paths,
+                                                          DataStorage &storage,
+                                                          unsigned int numberOfThreads,
+                                                          const ReaderOptionsFunctorBase *optionsCallback)
+  {
+    DataStorage::SetOfObjects::Pointer nodeResult = DataStorage::SetOfObjects::New();
+    std::vector<LoadInfo> loadInfos;
+    for (auto loadInfo : paths)
+    {
+      loadInfos.push_back(loadInfo);
+    }
+    std::string errMsg = LoadParallel(loadInfos, nodeResult, &storage, optionsCallback, numberOfThreads);
+    if (!errMsg.empty())
+    {
+      mitkThrow() << errMsg;
+    }
+    return nodeResult;
+  }
+
+  std::vector<BaseData::Pointer> IOUtil::LoadParallel(const std::vector<std::string> &paths,
+                                                      unsigned int numberOfThreads,
+                                                      const ReaderOptionsFunctorBase *optionsCallback)
+  {
+    std::vector<BaseData::Pointer> result;
+    std::vector<LoadInfo> loadInfos;
+    for (auto loadInfo : paths)
+    {
+      loadInfos.push_back(loadInfo);
+    }
+    std::string errMsg = LoadParallel(loadInfos, nullptr, nullptr, optionsCallback, numberOfThreads);
+    if (!errMsg.empty())
+    {
+      mitkThrow() << errMsg;
+    }
+
+    for (std::vector<LoadInfo>::const_iterator iter = loadInfos.begin(), iterEnd = loadInfos.end(); iter != iterEnd;
+         ++iter)
+    {
+      result.insert(result.end(), iter->m_Output.begin(), iter->m_Output.end());
+    }
+    return result;
+  }
+
   std::vector<BaseData::Pointer> IOUtil::Load(const std::vector<std::string> &paths, const ReaderOptionsFunctorBase *optionsCallback)
   {
     std::vector<BaseData::Pointer> result;
@@ -571,6 +644,163 @@ namespace mitk
     return result;
   }
 
+  IOUtil::Impl::ReaderSelection IOUtil::Impl::SelectReader(LoadInfo &loadInfo,
+                                                           std::map<std::string, FileReaderSelector::Item> &usedReaderItems,
+                                                           const ReaderOptionsFunctorBase *optionsCallback,
+                                                           std::string &errMsg)
+  {
+    std::vector<FileReaderSelector::Item> readers = loadInfo.m_ReaderSelector.Get();
+
+    if (readers.empty())
+    {
+      if (!itksys::SystemTools::FileExists(loadInfo.m_Path.c_str()))
+      {
+        errMsg += "File '" + loadInfo.m_Path + "' does not exist\n";
+      }
+      else
+      {
+        errMsg += "No reader available for '" + loadInfo.m_Path + "'\n";
+      }
+      return ReaderSkipped;
+    }
+
+    bool callOptionsCallback = readers.size() > 1 || !readers.front().GetReader()->GetOptions().empty();
+
+    // check if we already used a reader which should be re-used
+    std::vector<MimeType> currMimeTypes = loadInfo.m_ReaderSelector.GetMimeTypes();
+    std::string selectedMimeType;
+    for (std::vector<MimeType>::const_iterator mimeTypeIter = currMimeTypes.begin(),
+                                               mimeTypeIterEnd = currMimeTypes.end();
+         mimeTypeIter != mimeTypeIterEnd;
+         ++mimeTypeIter)
+    {
+      std::map<std::string, FileReaderSelector::Item>::const_iterator oldSelectedItemIter =
+        usedReaderItems.find(mimeTypeIter->GetName());
+      if (oldSelectedItemIter != usedReaderItems.end())
+      {
+        // we found an already used item for a mime-type which is contained
+        // in the current reader set, check all current readers if there service
+        // id equals the old reader
+        for (std::vector<FileReaderSelector::Item>::const_iterator currReaderItem = readers.begin(),
+                                                                   currReaderItemEnd = readers.end();
+             currReaderItem != currReaderItemEnd;
+             ++currReaderItem)
+        {
+          if (currReaderItem->GetMimeType().GetName() == mimeTypeIter->GetName() &&
+              currReaderItem->GetServiceId() == oldSelectedItemIter->second.GetServiceId() &&
+              currReaderItem->GetConfidenceLevel() >= oldSelectedItemIter->second.GetConfidenceLevel())
+          {
+            // okay, we used the same reader already, re-use its options
+            selectedMimeType = mimeTypeIter->GetName();
+            callOptionsCallback = false;
+            loadInfo.m_ReaderSelector.Select(oldSelectedItemIter->second.GetServiceId());
+            loadInfo.m_ReaderSelector.GetSelected().GetReader()->SetOptions(
+              oldSelectedItemIter->second.GetReader()->GetOptions());
+            break;
+          }
+        }
+        if (!selectedMimeType.empty())
+          break;
+      }
+    }
+
+    if (callOptionsCallback && optionsCallback)
+    {
+      callOptionsCallback = (*optionsCallback)(loadInfo);
+      if (!callOptionsCallback && !loadInfo.m_Cancel)
+      {
+        usedReaderItems.erase(selectedMimeType);
+        FileReaderSelector::Item selectedItem = loadInfo.m_ReaderSelector.GetSelected();
+        usedReaderItems.insert(std::make_pair(selectedItem.GetMimeType().GetName(), selectedItem));
+      }
+    }
+
+    if (loadInfo.m_Cancel)
+    {
+      errMsg += "Reading operation(s) cancelled.";
+      return ReaderAborted;
+    }
+
+    if (loadInfo.m_ReaderSelector.GetSelected().GetReader() == nullptr)
+    {
+      errMsg += "Unexpected nullptr reader.";
+      return ReaderAborted;
+    }
+    return ReaderSelected;
+  }
+
+  DataStorage::SetOfObjects::Pointer IOUtil::Impl::Read(IFileReader *reader, DataStorage *ds)
+  {
+    if (ds != nullptr)
+    {
+      return reader->Read(*ds);
+    }
+
+    DataStorage::SetOfObjects::Pointer nodes = DataStorage::SetOfObjects::New();
+    std::vector<mitk::BaseData::Pointer> baseData = reader->Read();
+    for (auto iter = baseData.begin(); iter != baseData.end(); ++iter)
+    {
+      if (iter->IsNotNull())
+      {
+        mitk::DataNode::Pointer node = mitk::DataNode::New();
+        node->SetData(*iter);
+        nodes->InsertElement(nodes->Size(), node);
+      }
+    }
+    return nodes;
+  }
+
+  void IOUtil::Impl::AddOutput(LoadInfo &loadInfo,
+                               const DataStorage::SetOfObjects *nodes,
+                               DataStorage::SetOfObjects *nodeResult,
+                               std::string &errMsg)
+  {
+    for (DataStorage::SetOfObjects::ConstIterator nodeIter = nodes->Begin(), nodeIterEnd = nodes->End();
+         nodeIter != nodeIterEnd;
+         ++nodeIter)
+    {
+      const mitk::DataNode::Pointer &node = nodeIter->Value();
+      mitk::BaseData::Pointer data = node->GetData();
+      if (data.IsNull())
+      {
+        continue;
+      }
+
+      mitk::StringProperty::Pointer pathProp = mitk::StringProperty::New(loadInfo.m_Path);
+      data->SetProperty("path", pathProp);
+
+      loadInfo.m_Output.push_back(data);
+      if (nodeResult)
+      {
+        nodeResult->push_back(nodeIter->Value());
+      }
+    }
+
+    if (loadInfo.m_Output.empty() || (nodeResult && nodeResult->Size() == 0))
+    {
+      errMsg += "Unknown read error occurred reading " + loadInfo.m_Path;
+    }
+  }
+
+  void IOUtil::Impl::AddToDataStorage(DataNode *node,
+                                      const DataStorage &localStorage,
+                                      DataStorage &ds)
+  {
+    if (ds.Exists(node))
+    {
+      return;
+    }
+    // the sources have to be added before their derivations
+    DataStorage::SetOfObjects::ConstPointer sources = localStorage.GetSources(node, nullptr, true);
+    for (DataStorage::SetOfObjects::ConstIterator sourceIter = sources->Begin(), sourceIterEnd = sources->End();
+         sourceIter != sourceIterEnd;
+         ++sourceIter)
+    {
+      AddToDataStorage(sourceIter->Value(), localStorage, ds);
+    }
+    ds.Add(node, sources);
+  }
+
   std::string IOUtil::Load(std::vector<LoadInfo> &loadInfos,
                            DataStorage::SetOfObjects *nodeResult,
                            DataStorage *ds,
@@ -594,143 +824,159 @@ namespace mitk
       if(std::find(read_files.begin(), read_files.end(), loadInfo.m_Path) != read_files.end())
         continue;
 
-      std::vector<FileReaderSelector::Item> readers = loadInfo.m_ReaderSelector.Get();
+      Impl::ReaderSelection selection = Impl::SelectReader(loadInfo, usedReaderItems, optionsCallback, errMsg);
+      if (selection == Impl::ReaderSkipped)
+        continue;
+      if (selection == Impl::ReaderAborted)
+        break;
 
-      if (readers.empty())
+      IFileReader *reader = loadInfo.m_ReaderSelector.GetSelected().GetReader();
+
+      // Do the actual reading
+      try
       {
-        if (!itksys::SystemTools::FileExists(loadInfo.m_Path.c_str()))
-        {
-          errMsg += "File '" + loadInfo.m_Path + "' does not exist\n";
-        }
-        else
+        DataStorage::SetOfObjects::Pointer nodes = Impl::Read(reader, ds);
+        if (ds != nullptr)
         {
-          errMsg += "No reader available for '" + loadInfo.m_Path + "'\n";
+          std::vector< std::string > new_files =  reader->GetReadFiles();
+          read_files.insert( read_files.end(), new_files.begin(), new_files.end() );
         }
-        continue;
+        Impl::AddOutput(loadInfo, nodes, nodeResult, errMsg);
       }
+      catch (const std::exception &e)
+      {
+        errMsg += "Exception occured when reading file " + loadInfo.m_Path + ":\n" + e.what() + "\n\n";
+      }
+      mitk::ProgressBar::GetInstance()->Progress(2);
+      --filesToRead;
+    }
 
-      bool callOptionsCallback = readers.size() > 1 || !readers.front().GetReader()->GetOptions().empty();
+    if (!errMsg.empty())
+    {
+      MITK_ERROR << errMsg;
+    }
+
+    mitk::ProgressBar::GetInstance()->Progress(2 * filesToRead);
+
+    return errMsg;
+  }
+
+  std::string IOUtil::LoadParallel(std::vector<LoadInfo> &loadInfos,
+                                   DataStorage::SetOfObjects *nodeResult,
+                                   DataStorage *ds,
+                                   const ReaderOptionsFunctorBase *optionsCallback,
+                                   unsigned int numberOfThreads)
+  {
+    if (loadInfos.empty())
+    {
+      return "No input files given";
+    }
+
+    int filesToRead = loadInfos.size();
+    mitk::ProgressBar::GetInstance()->AddStepsToDo(2 * filesToRead);
+
+    std::string errMsg;
+
+    // Readers are selected in the calling thread, since the options callback may show a dialog.
+    std::map<std::string, FileReaderSelector::Item> usedReaderItems;
+    std::vector<LoadInfo *> selectedLoadInfos;
+    for (auto &loadInfo : loadInfos)
+    {
+      Impl::ReaderSelection selection = Impl::SelectReader(loadInfo, usedReaderItems, optionsCallback, errMsg);
+      if (selection == Impl::ReaderSkipped)
+        continue;
+      if (selection == Impl::ReaderAborted)
+        break;
+      selectedLoadInfos.push_back(&loadInfo);
+    }
 
-      // check if we already used a reader which should be re-used
-      std::vector<MimeType> currMimeTypes = loadInfo.m_ReaderSelector.GetMimeTypes();
-      std::string selectedMimeType;
-      for (std::vector<MimeType>::const_iterator mimeTypeIter = currMimeTypes.begin(),
-                                                 mimeTypeIterEnd = currMimeTypes.end();
-           mimeTypeIter != mimeTypeIterEnd;
-           ++mimeTypeIter)
+    // Every file is read into its own data storage. Each reader is a separate instance
+    // of the prototype registered as a service, so no reader is used by two threads.
+    struct ReadResult
+    {
+      StandaloneDataStorage::Pointer m_Storage;
+      DataStorage::SetOfObjects::Pointer m_Nodes;
+      std::vector<std::string> m_ReadFiles;
+      std::string m_Error;
+    };
+    std::vector<ReadResult> results(selectedLoadInfos.size());
+    std::atomic<std::size_t> nextIndex(0);
+    auto readFiles = [&]()
+    {
+      for (std::size_t i = nextIndex++; i < selectedLoadInfos.size(); i = nextIndex++)
       {
-        std::map<std::string, FileReaderSelector::Item>::const_iterator oldSelectedItemIter =
-          usedReaderItems.find(mimeTypeIter->GetName());
-        if (oldSelectedItemIter != usedReaderItems.end())
+        const LoadInfo &loadInfo = *selectedLoadInfos[i];
+        IFileReader *reader = loadInfo.m_ReaderSelector.GetSelected().GetReader();
+        try
         {
-          // we found an already used item for a mime-type which is contained
-          // in the current reader set, check all current readers if there service
-          // id equals the old reader
-          for (std::vector<FileReaderSelector::Item>::const_iterator currReaderItem = readers.begin(),
-                                                                     currReaderItemEnd = readers.end();
-               currReaderItem != currReaderItemEnd;
-               ++currReaderItem)
+          if (ds != nullptr)
           {
-            if (currReaderItem->GetMimeType().GetName() == mimeTypeIter->GetName() &&
-                currReaderItem->GetServiceId() == oldSelectedItemIter->second.GetServiceId() &&
-                currReaderItem->GetConfidenceLevel() >= oldSelectedItemIter->second.GetConfidenceLevel())
-            {
-              // okay, we used the same reader already, re-use its options
-              selectedMimeType = mimeTypeIter->GetName();
-              callOptionsCallback = false;
-              loadInfo.m_ReaderSelector.Select(oldSelectedItemIter->second.GetServiceId());
-              loadInfo.m_ReaderSelector.GetSelected().GetReader()->SetOptions(
-                oldSelectedItemIter->second.GetReader()->GetOptions());
-              break;
-            }
+            results[i].m_Storage = StandaloneDataStorage::New();
           }
-          if (!selectedMimeType.empty())
-            break;
+          results[i].m_Nodes = Impl::Read(reader, results[i].m_Storage);
+          results[i].m_ReadFiles = reader->GetReadFiles();
         }
-      }
-
-      if (callOptionsCallback && optionsCallback)
-      {
-        callOptionsCallback = (*optionsCallback)(loadInfo);
-        if (!callOptionsCallback && !loadInfo.m_Cancel)
+        catch (const std::exception &e)
+        {
+          results[i].m_Error = "Exception occured when reading file " + loadInfo.m_Path + ":\n" + e.what() + "\n\n";
+        }
+        catch (...)
         {
-          usedReaderItems.erase(selectedMimeType);
-          FileReaderSelector::Item selectedItem = loadInfo.m_ReaderSelector.GetSelected();
-          usedReaderItems.insert(std::make_pair(selectedItem.GetMimeType().GetName(), selectedItem));
+          results[i].m_Error = "Unknown exception occured when reading file " + loadInfo.m_Path + "\n\n";
         }
       }
+    };
 
-      if (loadInfo.m_Cancel)
-      {
-        errMsg += "Reading operation(s) cancelled.";
-        break;
-      }
+    if (numberOfThreads == 0)
+    {
+      numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numberOfThreads = static_cast<unsigned int>(std::min<std::size_t>(numberOfThreads, selectedLoadInfos.size()));
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfThreads; ++i)
+    {
+      threads.push_back(std::thread(readFiles));
+    }
+    readFiles();
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
 
-      IFileReader *reader = loadInfo.m_ReaderSelector.GetSelected().GetReader();
-      if (reader == nullptr)
-      {
-        errMsg += "Unexpected nullptr reader.";
-        break;
-      }
+    // The results are merged in the order of the input files. As in Load(), files which
+    // were already read by the reader of a previous file are skipped.
+    std::vector<std::string> read_files;
+    for (std::size_t i = 0; i < selectedLoadInfos.size(); ++i)
+    {
+      LoadInfo &loadInfo = *selectedLoadInfos[i];
+      if (std::find(read_files.begin(), read_files.end(), loadInfo.m_Path) != read_files.end())
+        continue;
 
-      // Do the actual reading
-      try
+      if (results[i].m_Error.empty())
       {
-        DataStorage::SetOfObjects::Pointer nodes;
         if (ds != nullptr)
         {
-          nodes = reader->Read(*ds);
-
-          std::vector< std::string > new_files =  reader->GetReadFiles();
-          read_files.insert( read_files.end(), new_files.begin(), new_files.end() );
-        }
-        else
-        {
-          nodes = DataStorage::SetOfObjects::New();
-          std::vector<mitk::BaseData::Pointer> baseData = reader->Read();
-          for (auto iter = baseData.begin(); iter != baseData.end(); ++iter)
+          read_files.insert(read_files.end(), results[i].m_ReadFiles.begin(), results[i].m_ReadFiles.end());
+          for (DataStorage::SetOfObjects::ConstIterator nodeIter = results[i].m_Nodes->Begin(),
+                                                        nodeIterEnd = results[i].m_Nodes->End();
+               nodeIter != nodeIterEnd;
+               ++nodeIter)
           {
-            if (iter->IsNotNull())
-            {
-              mitk::DataNode::Pointer node = mitk::DataNode::New();
-              node->SetData(*iter);
-              nodes->InsertElement(nodes->Size(), node);
-            }
+            Impl::AddToDataStorage(nodeIter->Value(), *results[i].m_Storage, *ds);
           }
-
-          std::vector< std::string > new_files =  reader->GetReadFiles();
-          read_files.insert( read_files.end(), new_files.begin(), new_files.end() );
-        }
-
-        for (DataStorage::SetOfObjects::ConstIterator nodeIter = nodes->Begin(), nodeIterEnd = nodes->End();
-             nodeIter != nodeIterEnd;
-             ++nodeIter)
-        {
-          const mitk::DataNode::Pointer &node = nodeIter->Value();
-          mitk::BaseData::Pointer data = node->GetData();
-          if (data.IsNull())
-          {
-            continue;
-          }
-
-          mitk::StringProperty::Pointer pathProp = mitk::StringProperty::New(loadInfo.m_Path);
-          data->SetProperty("path", pathProp);
-
-          loadInfo.m_Output.push_back(data);
-          if (nodeResult)
+          DataStorage::SetOfObjects::ConstPointer allNodes = results[i].m_Storage->GetAll();
+          for (DataStorage::SetOfObjects::ConstIterator nodeIter = allNodes->Begin(), nodeIterEnd = allNodes->End();
+               nodeIter != nodeIterEnd;
+               ++nodeIter)
           {
-            nodeResult->push_back(nodeIter->Value());
+            Impl::AddToDataStorage(nodeIter->Value(), *results[i].m_Storage, *ds);
           }
         }
-
-        if (loadInfo.m_Output.empty() || (nodeResult && nodeResult->Size() == 0))
-        {
-          errMsg += "Unknown read error occurred reading " + loadInfo.m_Path;
-        }
+        Impl::AddOutput(loadInfo, results[i].m_Nodes, nodeResult, errMsg);
       }
-      catch (const std::exception &e)
+      else
       {
-        errMsg += "Exception occured when reading file " + loadInfo.m_Path + ":\n" + e.what() + "\n\n";
+        errMsg += results[i].m_Error;
       }
       mitk::ProgressBar::GetInstance()->Progress(2);
       --filesToRead;
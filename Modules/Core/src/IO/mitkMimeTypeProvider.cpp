@@ -23,6 +23,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itksys/SystemTools.hxx>
 
+#include <algorithm>
+#include <cctype>
+#include <typeinfo>
+
 #ifdef _MSC_VER
 #pragma warning(disable : 4503) // decorated name length exceeded, name was truncated
 #pragma warning(disable : 4355)
@@ -44,6 +48,7 @@ namespace mitk
   void MimeTypeProvider::Stop() { m_Tracker->Close(); }
   std::vector<MimeType> MimeTypeProvider::GetMimeTypes() const
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     std::vector<MimeType> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -54,12 +59,53 @@ namespace mitk
 
   std::vector<MimeType> MimeTypeProvider::GetMimeTypesForFile(const std::string &filePath) const
   {
+    // the result for the mime-types matching their extensions only depends on this suffix
+    static const std::size_t maxCachedSuffixes = 4096;
+
     std::vector<MimeType> result;
-    for (const auto &elem : m_NameToMimeType)
+    std::vector<MimeType> appliesToMimeTypes;
     {
-      if (elem.second.AppliesTo(filePath))
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      std::size_t suffixLength = m_ExtensionLengths.empty() ? 0 : *m_ExtensionLengths.rbegin();
+      std::string suffix = filePath.substr(filePath.size() - std::min(suffixLength, filePath.size()));
+      std::transform(suffix.begin(), suffix.end(), suffix.begin(), ::tolower);
+
+      auto cacheIter = m_SuffixToMimeTypes.find(suffix);
+      if (cacheIter == m_SuffixToMimeTypes.end())
       {
-        result.push_back(elem.second);
+        std::vector<MimeType> matches;
+        std::set<std::string> matchedNames;
+        for (std::size_t length : m_ExtensionLengths)
+        {
+          if (length > suffix.size())
+            break;
+          auto iter = m_ExtensionToMimeTypes.find(suffix.substr(suffix.size() - length));
+          if (iter == m_ExtensionToMimeTypes.end())
+            continue;
+          for (const MimeType &mimeType : iter->second)
+          {
+            if (matchedNames.insert(mimeType.GetName()).second)
+            {
+              matches.push_back(mimeType);
+            }
+          }
+        }
+        if (m_SuffixToMimeTypes.size() >= maxCachedSuffixes)
+        {
+          m_SuffixToMimeTypes.clear();
+        }
+        cacheIter = m_SuffixToMimeTypes.insert(std::make_pair(suffix, matches)).first;
+      }
+      result = cacheIter->second;
+      appliesToMimeTypes = m_AppliesToMimeTypes;
+    }
+
+    // AppliesTo() may look into the file, so it is called without holding the lock
+    for (const MimeType &mimeType : appliesToMimeTypes)
+    {
+      if (mimeType.AppliesTo(filePath))
+      {
+        result.push_back(mimeType);
       }
     }
     std::sort(result.begin(), result.end());
@@ -69,6 +115,7 @@ namespace mitk
 
   std::vector<MimeType> MimeTypeProvider::GetMimeTypesForCategory(const std::string &category) const
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     std::vector<MimeType> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -82,6 +129,7 @@ namespace mitk
 
   MimeType MimeTypeProvider::GetMimeTypeForName(const std::string &name) const
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     auto iter = m_NameToMimeType.find(name);
     if (iter != m_NameToMimeType.end())
       return iter->second;
@@ -90,6 +138,7 @@ namespace mitk
 
   std::vector<std::string> MimeTypeProvider::GetCategories() const
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     std::vector<std::string> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -106,14 +155,21 @@ namespace mitk
 
   MimeTypeProvider::TrackedType MimeTypeProvider::AddingService(const ServiceReferenceType &reference)
   {
-    MimeType result = this->GetMimeType(reference);
+    bool matchesExtensionOnly = false;
+    MimeType result = this->GetMimeType(reference, matchesExtensionOnly);
     if (result.IsValid())
     {
+      std::lock_guard<std::mutex> lock(m_Mutex);
       std::string name = result.GetName();
       m_NameToMimeTypes[name].insert(result);
+      if (matchesExtensionOnly)
+      {
+        m_MatchesExtensionOnly.insert(result);
+      }
 
       // get the highest ranked mime-type
       m_NameToMimeType[name] = *(m_NameToMimeTypes[name].rbegin());
+      this->RebuildIndex();
     }
     return result;
   }
@@ -125,6 +181,8 @@ namespace mitk
 
   void MimeTypeProvider::RemovedService(const ServiceReferenceType & /*reference*/, TrackedType mimeType)
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MatchesExtensionOnly.erase(mimeType);
     std::string name = mimeType.GetName();
     std::set<MimeType> &mimeTypes = m_NameToMimeTypes[name];
     mimeTypes.erase(mimeType);
@@ -138,9 +196,37 @@ namespace mitk
       // get the highest ranked mime-type
       m_NameToMimeType[name] = *(mimeTypes.rbegin());
     }
+    this->RebuildIndex();
+  }
+
+  void MimeTypeProvider::RebuildIndex()
+  {
+    m_ExtensionToMimeTypes.clear();
+    m_ExtensionLengths.clear();
+    m_AppliesToMimeTypes.clear();
+    m_SuffixToMimeTypes.clear();
+
+    for (const auto &elem : m_NameToMimeType)
+    {
+      const MimeType &mimeType = elem.second;
+      if (m_MatchesExtensionOnly.find(mimeType) == m_MatchesExtensionOnly.end())
+      {
+        m_AppliesToMimeTypes.push_back(mimeType);
+        continue;
+      }
+
+      for (std::string extension : mimeType.GetExtensions())
+      {
+        if (extension.empty())
+          continue;
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        m_ExtensionToMimeTypes[extension].push_back(mimeType);
+        m_ExtensionLengths.insert(extension.size());
+      }
+    }
   }
 
-  MimeType MimeTypeProvider::GetMimeType(const ServiceReferenceType &reference) const
+  MimeType MimeTypeProvider::GetMimeType(const ServiceReferenceType &reference, bool &matchesExtensionOnly) const
   {
     MimeType result;
     if (!reference)
@@ -159,6 +245,8 @@ namespace mitk
         }
         auto id = us::any_cast<long>(reference.GetProperty(us::ServiceConstants::SERVICE_ID()));
         result = MimeType(*mimeType, rank, id);
+        // sub-classes may override AppliesTo()
+        matchesExtensionOnly = typeid(*mimeType) == typeid(CustomMimeType);
       }
       catch (const us::BadAnyCastException &e)
       {
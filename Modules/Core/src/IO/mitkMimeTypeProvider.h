@@ -23,7 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "usServiceTracker.h"
 #include "usServiceTrackerCustomizer.h"
 
+#include <mutex>
 #include <set>
+#include <unordered_map>
 
 namespace mitk
 {
@@ -57,7 +59,17 @@ namespace mitk
     void ModifiedService(const ServiceReferenceType &reference, TrackedType service) override;
     void RemovedService(const ServiceReferenceType &reference, TrackedType service) override;
 
-    MimeType GetMimeType(const ServiceReferenceType &reference) const;
+    /**
+     * \param matchesExtensionOnly Set to true if the mime-type is a plain CustomMimeType,
+     *        i.e. it applies to a file if and only if one of its extensions matches.
+     */
+    MimeType GetMimeType(const ServiceReferenceType &reference, bool &matchesExtensionOnly) const;
+
+    /**
+     * Rebuilds the extension index from m_NameToMimeType and clears the cached results.
+     * m_Mutex has to be locked.
+     */
+    void RebuildIndex();
 
     us::ServiceTracker<CustomMimeType, MimeTypeTrackerTypeTraits> *m_Tracker;
 
@@ -65,6 +77,24 @@ namespace mitk
     MapType m_NameToMimeTypes;
 
     std::map<std::string, MimeType> m_NameToMimeType;
+
+    /** Mime-types which only match their extensions, all others have to be asked via AppliesTo(). */
+    std::set<MimeType> m_MatchesExtensionOnly;
+
+    /**
+     * Index for GetMimeTypesForFile(): the lower case extensions of all mime-types which only match
+     * their extensions and the mime-types which have to be asked for every file.
+     */
+    std::unordered_map<std::string, std::vector<MimeType>> m_ExtensionToMimeTypes;
+    std::set<std::size_t> m_ExtensionLengths;
+    std::vector<MimeType> m_AppliesToMimeTypes;
+
+    /**
+     * Mime-types found by extension, cached per lower case file name suffix with the length
+     * of the longest extension (which determines the matching extensions).
+     */
+    mutable std::unordered_map<std::string, std::vector<MimeType>> m_SuffixToMimeTypes;
+    mutable std::mutex m_Mutex;
   };
 }
 
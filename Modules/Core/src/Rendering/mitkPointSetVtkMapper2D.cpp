@@ -275,44 +275,16 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
 
   vtkLinearTransform *dataNodeTransform = input->GetGeometry()->GetVtkTransform();
 
-  int count = 0;
-
-  for (pointsIter = itkPointSet->GetPoints()->Begin(); pointsIter != itkPointSet->GetPoints()->End(); pointsIter++)
-  {
-    lastP = p;              // valid for number of points count > 0
-    preLastPt2d = lastPt2d; // valid only for count > 1
-    lastPt2d = pt2d;        // valid for number of points count > 0
-
-    lastVec = vec; // valid only for counter > 1
-
-    // get current point in point set
-    point = pointsIter->Value();
-
-    // transform point
-    {
-      float vtkp[3];
-      itk2vtk(point, vtkp);
-      dataNodeTransform->TransformPoint(vtkp, vtkp);
-      vtk2itk(vtkp, point);
-    }
-
-    p[0] = point[0];
-    p[1] = point[1];
-    p[2] = point[2];
-
-    renderer->WorldToDisplay(p, pt2d);
-
-    vec = p - lastP; // valid only for counter > 0
-
-    // compute distance to current plane
-    float dist = geo2D->Distance(point);
-
-    // draw markers on slices a certain distance away from the points
-    // location according to the tolerance threshold (m_DistanceToPlane)
+  // draws the marker and the label of a point, if it is close enough to the current plane
+  auto drawMarker = [&](const itk::Point<ScalarType> &point,
+                        const mitk::Point2D &pt2d,
+                        float dist,
+                        bool selected,
+                        mitk::PointSet::PointIdentifier pointId) {
     if (dist < m_DistanceToPlane)
     {
       // is point selected or not?
-      if (pointDataIter->Value().selected)
+      if (selected)
       {
         ls->m_SelectedPoints->InsertNextPoint(point[0], point[1], point[2]);
         // point is scaled according to its distance to the plane
@@ -335,7 +307,7 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
         if (input->GetSize() > 1)
         {
           std::stringstream ss;
-          ss << pointsIter->Index();
+          ss << pointId;
           l.append(ss.str());
         }
 
@@ -355,6 +327,80 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
         ls->m_VtkTextLabelActors.push_back(ls->m_VtkTextActor);
       }
     }
+  };
+
+  int count = 0;
+
+  // Without contour, only the points close to the plane are drawn. They are queried from the spatial
+  // index of the point set instead of projecting all points. The point set uses the geometry of the time
+  // step, so this is only done if it is the geometry used for the transformation here.
+  if (!m_ShowContour && input->GetGeometry(timestep) == input->GetGeometry())
+  {
+    // slightly larger distance, the exact test below uses the float transformation of VTK
+    std::vector<mitk::PointSet::PointIdentifier> idsNearPlane;
+    input->SearchPointsNearPlane(geo2D, m_DistanceToPlane * 1.001 + 0.001, idsNearPlane, timestep);
+
+    for (mitk::PointSet::PointIdentifier id : idsNearPlane)
+    {
+      mitk::PointSet::PointType indexPoint;
+      mitk::PointSet::PointDataType pointData;
+      if (!itkPointSet->GetPoint(id, &indexPoint) || !itkPointSet->GetPointData(id, &pointData))
+        continue;
+      point = indexPoint;
+
+      float vtkp[3];
+      itk2vtk(point, vtkp);
+      dataNodeTransform->TransformPoint(vtkp, vtkp);
+      vtk2itk(vtkp, point);
+
+      p[0] = point[0];
+      p[1] = point[1];
+      p[2] = point[2];
+      renderer->WorldToDisplay(p, pt2d);
+
+      float dist = geo2D->Distance(point);
+      drawMarker(point, pt2d, dist, pointData.selected, id);
+    }
+    pointsIter = itkPointSet->GetPoints()->End();
+  }
+  else
+  {
+    pointsIter = itkPointSet->GetPoints()->Begin();
+  }
+
+  for (; pointsIter != itkPointSet->GetPoints()->End(); pointsIter++)
+  {
+    lastP = p;              // valid for number of points count > 0
+    preLastPt2d = lastPt2d; // valid only for count > 1
+    lastPt2d = pt2d;        // valid for number of points count > 0
+
+    lastVec = vec; // valid only for counter > 1
+
+    // get current point in point set
+    point = pointsIter->Value();
+
+    // transform point
+    {
+      float vtkp[3];
+      itk2vtk(point, vtkp);
+      dataNodeTransform->TransformPoint(vtkp, vtkp);
+      vtk2itk(vtkp, point);
+    }
+
+    p[0] = point[0];
+    p[1] = point[1];
+    p[2] = point[2];
+
+    renderer->WorldToDisplay(p, pt2d);
+
+    vec = p - lastP; // valid only for counter > 0
+
+    // compute distance to current plane
+    float dist = geo2D->Distance(point);
+
+    // draw markers on slices a certain distance away from the points
+    // location according to the tolerance threshold (m_DistanceToPlane)
+    drawMarker(point, pt2d, dist, pointDataIter->Value().selected, pointsIter->Index());
 
     // draw contour, distance text and angle text in render window
 
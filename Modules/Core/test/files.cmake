@@ -56,6 +56,7 @@ set(MODULE_TESTS
   mitkPointSetWriterTest.cpp
   mitkPointSetReaderTest.cpp
   mitkPointSetPointOperationsTest.cpp
+  mitkPointSetSpatialIndexTest.cpp
   mitkProgressBarTest.cpp
   mitkPropertyTest.cpp
   mitkPropertyListTest.cpp
@@ -120,6 +121,7 @@ set(MODULE_TESTS
   mitkPropertyNameHelperTest.cpp
   mitkNodePredicateGeometryTest.cpp
   mitkPreferenceListReaderOptionsFunctorTest.cpp
+  mitkMimeTypeProviderTest.cpp
   mitkGenericIDRelationRuleTest.cpp
 )
 
@@ -20,6 +20,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkIOUtil.h>
 #include <mitkImageGenerator.h>
+#include <mitkPointSet.h>
+#include <mitkStandaloneDataStorage.h>
+#include <mitkSurface.h>
 
 #include <itksys/SystemTools.hxx>
 
@@ -33,6 +36,7 @@ class mitkIOUtilTestSuite : public mitk::TestFixture
   MITK_TEST(TestNullSave);
   MITK_TEST(TestLoadAndSavePointSet);
   MITK_TEST(TestLoadAndSaveSurface);
+  MITK_TEST(TestLoadParallel);
   MITK_TEST(TestTempMethodsForUniqueFilenames);
   MITK_TEST(TestTempMethodsForUniqueFilenames);
   CPPUNIT_TEST_SUITE_END();
@@ -230,6 +234,42 @@ public:
     // delete the files after the test is done
     std::remove(surfacePath.c_str());
   }
+
+  void TestLoadParallel()
+  {
+    std::vector<std::string> paths;
+    for (int i = 0; i < 4; ++i)
+    {
+      paths.push_back(m_ImagePath);
+      paths.push_back(m_SurfacePath);
+      paths.push_back(m_PointSetPath);
+    }
+
+    std::vector<mitk::BaseData::Pointer> data = mitk::IOUtil::LoadParallel(paths, 3);
+    CPPUNIT_ASSERT_EQUAL(paths.size(), data.size());
+
+    mitk::StandaloneDataStorage::Pointer storage = mitk::StandaloneDataStorage::New();
+    mitk::DataStorage::SetOfObjects::Pointer nodes = mitk::IOUtil::LoadParallel(paths, *storage, 3);
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(paths.size()), nodes->Size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(paths.size()), storage->GetAll()->Size());
+
+    // the results are in the order of the paths
+    for (std::size_t i = 0; i < paths.size(); i += 3)
+    {
+      CPPUNIT_ASSERT(dynamic_cast<mitk::Image *>(data[i].GetPointer()) != nullptr);
+      CPPUNIT_ASSERT(dynamic_cast<mitk::Surface *>(data[i + 1].GetPointer()) != nullptr);
+      CPPUNIT_ASSERT(dynamic_cast<mitk::PointSet *>(data[i + 2].GetPointer()) != nullptr);
+      CPPUNIT_ASSERT(dynamic_cast<mitk::Image *>(nodes->ElementAt(i)->GetData()) != nullptr);
+      CPPUNIT_ASSERT(dynamic_cast<mitk::Surface *>(nodes->ElementAt(i + 1)->GetData()) != nullptr);
+      CPPUNIT_ASSERT(dynamic_cast<mitk::PointSet *>(nodes->ElementAt(i + 2)->GetData()) != nullptr);
+    }
+
+    // the remaining files are loaded even if one file does not exist
+    paths.insert(paths.begin() + 1, "fileWhichDoesNotExist.nrrd");
+    storage = mitk::StandaloneDataStorage::New();
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::LoadParallel(paths, *storage, 3), mitk::Exception);
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(paths.size() - 1), storage->GetAll()->Size());
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkIOUtil)
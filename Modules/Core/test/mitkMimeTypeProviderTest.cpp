@@ -0,0 +1,136 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkCoreServices.h>
+#include <mitkCustomMimeType.h>
+#include <mitkIMimeTypeProvider.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <usGetModuleContext.h>
+#include <usModuleContext.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+  /** A mime-type which applies to files by their name instead of their extension. */
+  class PrefixMimeType : public mitk::CustomMimeType
+  {
+  public:
+    PrefixMimeType() : CustomMimeType("TestPrefixMimeType") {}
+
+    bool AppliesTo(const std::string &path) const override
+    {
+      return path.find("magic_") != std::string::npos;
+    }
+
+    PrefixMimeType *Clone() const override { return new PrefixMimeType(*this); }
+  };
+}
+
+class mitkMimeTypeProviderTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkMimeTypeProviderTestSuite);
+  MITK_TEST(GetMimeTypesForFile_MatchesExtensionsCaseInsensitive);
+  MITK_TEST(GetMimeTypesForFile_AsksOverriddenAppliesTo);
+  MITK_TEST(GetMimeTypesForFile_UnregisteredMimeTypeIsRemoved);
+  MITK_TEST(GetMimeTypesForFile_Benchmark);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::CustomMimeType m_MimeType;
+  PrefixMimeType m_PrefixMimeType;
+  us::ServiceRegistration<mitk::CustomMimeType> m_Registration;
+  us::ServiceRegistration<mitk::CustomMimeType> m_PrefixRegistration;
+
+  bool Contains(const std::vector<mitk::MimeType> &mimeTypes, const std::string &name)
+  {
+    return std::count_if(mimeTypes.begin(), mimeTypes.end(), [&name](const mitk::MimeType &mimeType) {
+             return mimeType.GetName() == name;
+           }) == 1;
+  }
+
+  std::vector<mitk::MimeType> GetMimeTypesForFile(const std::string &path)
+  {
+    mitk::CoreServicePointer<mitk::IMimeTypeProvider> provider(mitk::CoreServices::GetMimeTypeProvider());
+    return provider->GetMimeTypesForFile(path);
+  }
+
+public:
+  void setUp() override
+  {
+    m_MimeType = mitk::CustomMimeType("TestExtensionMimeType");
+    m_MimeType.AddExtension("tstx");
+    m_MimeType.AddExtension("tstx.gz");
+    m_Registration = us::GetModuleContext()->RegisterService<mitk::CustomMimeType>(&m_MimeType);
+    m_PrefixRegistration = us::GetModuleContext()->RegisterService<mitk::CustomMimeType>(&m_PrefixMimeType);
+  }
+
+  void tearDown() override
+  {
+    if (m_Registration)
+      m_Registration.Unregister();
+    if (m_PrefixRegistration)
+      m_PrefixRegistration.Unregister();
+  }
+
+  void GetMimeTypesForFile_MatchesExtensionsCaseInsensitive()
+  {
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/data/image.tstx"), "TestExtensionMimeType"));
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/data/image.TSTX"), "TestExtensionMimeType"));
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/data/image.tstx.gz"), "TestExtensionMimeType"));
+    CPPUNIT_ASSERT(!Contains(GetMimeTypesForFile("/data/image.tst"), "TestExtensionMimeType"));
+    CPPUNIT_ASSERT(!Contains(GetMimeTypesForFile("/data/image.gz"), "TestExtensionMimeType"));
+    CPPUNIT_ASSERT(!Contains(GetMimeTypesForFile("stx"), "TestExtensionMimeType"));
+  }
+
+  void GetMimeTypesForFile_AsksOverriddenAppliesTo()
+  {
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/data/magic_file"), "TestPrefixMimeType"));
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/data/magic_file.tstx"), "TestPrefixMimeType"));
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/data/magic_file.tstx"), "TestExtensionMimeType"));
+    CPPUNIT_ASSERT(!Contains(GetMimeTypesForFile("/data/other_file"), "TestPrefixMimeType"));
+  }
+
+  void GetMimeTypesForFile_UnregisteredMimeTypeIsRemoved()
+  {
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/data/image.tstx"), "TestExtensionMimeType"));
+    m_Registration.Unregister();
+    m_Registration = 0;
+    CPPUNIT_ASSERT(!Contains(GetMimeTypesForFile("/data/image.tstx"), "TestExtensionMimeType"));
+  }
+
+  void GetMimeTypesForFile_Benchmark()
+  {
+    const std::string extensions[] = {".nrrd", ".nii.gz", ".stl", ".vtk", ".dcm", ".tstx", ".unknown", ""};
+    mitk::CoreServicePointer<mitk::IMimeTypeProvider> provider(mitk::CoreServices::GetMimeTypeProvider());
+    std::size_t numberOfMimeTypes = provider->GetMimeTypes().size();
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::size_t found = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+      found += provider->GetMimeTypesForFile("/data/file_" + std::to_string(i) + extensions[i % 8]).size();
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    MITK_INFO << "10000 mime-type lookups with " << numberOfMimeTypes << " registered mime-types: " << ms << " ms";
+    CPPUNIT_ASSERT(found > 0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkMimeTypeProvider)
@@ -0,0 +1,189 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkPlaneGeometry.h>
+#include <mitkPointSet.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <chrono>
+#include <random>
+
+class mitkPointSetSpatialIndexTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPointSetSpatialIndexTestSuite);
+  MITK_TEST(TestSearchPoint_MatchesLinearSearch);
+  MITK_TEST(TestSearchPoint_AfterModification);
+  MITK_TEST(TestSearchPoint_PrefersEqualPointAndSmallestId);
+  MITK_TEST(TestSearchPointsNearPlane_MatchesDistanceToPlane);
+  MITK_TEST(TestSearchPoint_Benchmark);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::PointSet::Pointer m_PointSet;
+  std::mt19937 m_Generator;
+
+  mitk::Point3D RandomPoint(double extent)
+  {
+    std::uniform_real_distribution<double> coordinate(-extent, extent);
+    mitk::Point3D point;
+    for (unsigned int d = 0; d < 3; ++d)
+      point[d] = coordinate(m_Generator);
+    return point;
+  }
+
+  /** Linear search with the semantics of PointSet::SearchPoint, without spatial index. */
+  int LinearSearchPoint(const mitk::Point3D &point, mitk::ScalarType distance)
+  {
+    mitk::Point3D indexPoint;
+    m_PointSet->GetGeometry()->WorldToIndex(point, indexPoint);
+    distance = distance == 0.0 ? 0.000001 : distance * distance;
+
+    int best = -1;
+    for (auto it = m_PointSet->Begin(); it != m_PointSet->End(); ++it)
+    {
+      if (indexPoint == it.Value())
+        return it.Index();
+      mitk::ScalarType dist = indexPoint.SquaredEuclideanDistanceTo(it.Value());
+      if (dist < distance)
+      {
+        best = it.Index();
+        distance = dist;
+      }
+    }
+    return best;
+  }
+
+public:
+  void setUp() override
+  {
+    m_Generator.seed(42);
+    m_PointSet = mitk::PointSet::New();
+    for (unsigned int i = 0; i < 5000; ++i)
+      m_PointSet->InsertPoint(i, RandomPoint(100.0));
+  }
+
+  void tearDown() override { m_PointSet = nullptr; }
+
+  void TestSearchPoint_MatchesLinearSearch()
+  {
+    const mitk::ScalarType distances[] = {0.0, 1.0, 5.0, 1000.0};
+    for (unsigned int i = 0; i < 300; ++i)
+    {
+      mitk::Point3D query = RandomPoint(110.0);
+      for (mitk::ScalarType distance : distances)
+      {
+        CPPUNIT_ASSERT_EQUAL(LinearSearchPoint(query, distance), m_PointSet->SearchPoint(query, distance));
+      }
+    }
+  }
+
+  void TestSearchPoint_AfterModification()
+  {
+    mitk::Point3D target;
+    target.Fill(500.0);
+    CPPUNIT_ASSERT_EQUAL(-1, m_PointSet->SearchPoint(target, 1.0));
+
+    m_PointSet->SetPoint(1234, target);
+    CPPUNIT_ASSERT_EQUAL(1234, m_PointSet->SearchPoint(target, 1.0));
+
+    m_PointSet->RemovePointIfExists(1234);
+    CPPUNIT_ASSERT_EQUAL(-1, m_PointSet->SearchPoint(target, 1.0));
+
+    m_PointSet->InsertPoint(7000, target);
+    CPPUNIT_ASSERT_EQUAL(7000, m_PointSet->SearchPoint(target, 1.0));
+
+    // direct modification of the ITK point set
+    target.Fill(-500.0);
+    m_PointSet->GetPointSet()->GetPoints()->InsertElement(7001, target);
+    CPPUNIT_ASSERT_EQUAL(7001, m_PointSet->SearchPoint(target, 1.0));
+  }
+
+  void TestSearchPoint_PrefersEqualPointAndSmallestId()
+  {
+    mitk::Point3D point;
+    point.Fill(300.0);
+    mitk::Point3D nearPoint = point;
+    nearPoint[0] += 0.5;
+
+    m_PointSet->InsertPoint(9000, nearPoint);
+    m_PointSet->InsertPoint(9001, point);
+    m_PointSet->InsertPoint(9002, point);
+    CPPUNIT_ASSERT_EQUAL(9001, m_PointSet->SearchPoint(point, 2.0));
+
+    mitk::Point3D between = point;
+    between[0] += 0.25;
+    CPPUNIT_ASSERT_EQUAL(LinearSearchPoint(between, 2.0), m_PointSet->SearchPoint(between, 2.0));
+    CPPUNIT_ASSERT_EQUAL(9000, m_PointSet->SearchPoint(between, 2.0));
+  }
+
+  void TestSearchPointsNearPlane_MatchesDistanceToPlane()
+  {
+    mitk::Vector3D spacing;
+    spacing[0] = 2.0;
+    spacing[1] = 1.0;
+    spacing[2] = 0.5;
+    m_PointSet->GetGeometry()->SetSpacing(spacing);
+
+    for (unsigned int i = 0; i < 20; ++i)
+    {
+      mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
+      mitk::Vector3D normal = RandomPoint(1.0).GetVectorFromOrigin();
+      plane->InitializePlane(RandomPoint(50.0), normal);
+      const mitk::ScalarType distance = 2.0;
+
+      std::vector<mitk::PointSet::PointIdentifier> expected;
+      for (auto it = m_PointSet->Begin(); it != m_PointSet->End(); ++it)
+      {
+        if (plane->DistanceFromPlane(m_PointSet->GetPoint(it.Index())) < distance)
+          expected.push_back(it.Index());
+      }
+
+      std::vector<mitk::PointSet::PointIdentifier> ids;
+      m_PointSet->SearchPointsNearPlane(plane, distance, ids);
+      CPPUNIT_ASSERT(ids == expected);
+    }
+  }
+
+  void TestSearchPoint_Benchmark()
+  {
+    m_PointSet = mitk::PointSet::New();
+    for (unsigned int i = 0; i < 100000; ++i)
+      m_PointSet->InsertPoint(i, RandomPoint(100.0));
+
+    std::vector<mitk::Point3D> queries;
+    for (unsigned int i = 0; i < 200; ++i)
+      queries.push_back(RandomPoint(100.0));
+
+    auto start = std::chrono::steady_clock::now();
+    int linearSum = 0;
+    for (const auto &query : queries)
+      linearSum += LinearSearchPoint(query, 2.0);
+    double linearMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    int indexedSum = 0;
+    for (const auto &query : queries)
+      indexedSum += m_PointSet->SearchPoint(query, 2.0);
+    double indexedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    MITK_INFO << "200 searches in 100000 points: linear " << linearMs << " ms, k-d tree " << indexedMs
+              << " ms (including the construction of the tree)";
+    CPPUNIT_ASSERT_EQUAL(linearSum, indexedSum);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPointSetSpatialIndex)
@@ -28,6 +28,8 @@
 #include "usServicePropertiesImpl_p.h"
 #include "usAtomicInt_p.h"
 
+#include <atomic>
+
 US_BEGIN_NAMESPACE
 
 class ModulePrivate;
@@ -100,8 +102,9 @@ public:
   /**
    * Is service available. I.e., if <code>true</code> then holders
    * of a ServiceReference for the service are allowed to get it.
+   * It is read without holding the registry lock.
    */
-  volatile bool available;
+  std::atomic<bool> available;
 
   /**
    * Avoid recursive unregistrations. I.e., if <code>true</code> then
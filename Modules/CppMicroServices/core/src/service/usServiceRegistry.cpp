@@ -20,6 +20,7 @@
 =============================================================================*/
 
 #include <iterator>
+#include <memory>
 #include <stdexcept>
 #include <cassert>
 
@@ -66,7 +67,8 @@ ServicePropertiesImpl ServiceRegistry::CreateServiceProperties(const ServiceProp
 }
 
 ServiceRegistry::ServiceRegistry(CoreModuleContext* coreCtx)
-  : core(coreCtx)
+  : classServices(std::make_shared<MapClassServices>())
+  , core(coreCtx)
 {
 
 }
@@ -80,10 +82,39 @@ void ServiceRegistry::Clear()
 {
   services.clear();
   serviceRegistrations.clear();
-  classServices.clear();
+  std::atomic_store(&classServices, std::shared_ptr<const MapClassServices>(std::make_shared<MapClassServices>()));
+  {
+    MutexLock lock(ldapCacheMutex);
+    ldapCache.clear();
+  }
   core = nullptr;
 }
 
+template<class Modifier>
+void ServiceRegistry::ModifyClassServices_unlocked(const std::vector<std::string>& classes, Modifier modify)
+{
+  // only the pointers to the lists are copied, lists of other classes are shared
+  std::shared_ptr<MapClassServices> newClassServices = std::make_shared<MapClassServices>(*classServices);
+  for (std::vector<std::string>::const_iterator i = classes.begin();
+       i != classes.end(); ++i)
+  {
+    MapClassServices::const_iterator it = newClassServices->find(*i);
+    std::shared_ptr<std::vector<ServiceRegistrationBase> > s = (it != newClassServices->end())
+        ? std::make_shared<std::vector<ServiceRegistrationBase> >(*it->second)
+        : std::make_shared<std::vector<ServiceRegistrationBase> >();
+    modify(*s);
+    if (s->empty())
+    {
+      newClassServices->erase(*i);
+    }
+    else
+    {
+      (*newClassServices)[*i] = s;
+    }
+  }
+  std::atomic_store(&classServices, std::shared_ptr<const MapClassServices>(newClassServices));
+}
+
 ServiceRegistrationBase ServiceRegistry::RegisterService(ModulePrivate* module,
                                                      const InterfaceMap& service,
                                                      const ServiceProperties& properties)
@@ -115,14 +146,10 @@ ServiceRegistrationBase ServiceRegistry::RegisterService(ModulePrivate* module,
     MutexLock lock(mutex);
     services.insert(std::make_pair(res, classes));
     serviceRegistrations.push_back(res);
-    for (std::vector<std::string>::const_iterator i = classes.begin();
-         i != classes.end(); ++i)
+    ModifyClassServices_unlocked(classes, [&res](std::vector<ServiceRegistrationBase>& s)
     {
-      std::vector<ServiceRegistrationBase>& s = classServices[*i];
-      std::vector<ServiceRegistrationBase>::iterator ip =
-          std::lower_bound(s.begin(), s.end(), res);
-      s.insert(ip, res);
-    }
+      s.insert(std::lower_bound(s.begin(), s.end(), res), res);
+    });
   }
 
   ServiceReferenceBase r = res.GetReference(std::string());
@@ -138,39 +165,36 @@ void ServiceRegistry::UpdateServiceRegistrationOrder(const ServiceRegistrationBa
                                                      const std::vector<std::string>& classes)
 {
   MutexLock lock(mutex);
-  for (std::vector<std::string>::const_iterator i = classes.begin();
-       i != classes.end(); ++i)
+  ModifyClassServices_unlocked(classes, [&sr](std::vector<ServiceRegistrationBase>& s)
   {
-    std::vector<ServiceRegistrationBase>& s = classServices[*i];
     s.erase(std::remove(s.begin(), s.end(), sr), s.end());
     s.insert(std::lower_bound(s.begin(), s.end(), sr), sr);
-  }
+  });
 }
 
 void ServiceRegistry::Get(const std::string& clazz,
                           std::vector<ServiceRegistrationBase>& serviceRegs) const
 {
-  MutexLock lock(mutex);
   Get_unlocked(clazz, serviceRegs);
 }
 
 void ServiceRegistry::Get_unlocked(const std::string& clazz,
                                    std::vector<ServiceRegistrationBase>& serviceRegs) const
 {
-  MapClassServices::const_iterator i = classServices.find(clazz);
-  if (i != classServices.end())
+  std::shared_ptr<const MapClassServices> snapshot = std::atomic_load(&classServices);
+  MapClassServices::const_iterator i = snapshot->find(clazz);
+  if (i != snapshot->end())
   {
-    serviceRegs = i->second;
+    serviceRegs = *i->second;
   }
 }
 
 ServiceReferenceBase ServiceRegistry::Get(ModulePrivate* module, const std::string& clazz) const
 {
-  MutexLock lock(mutex);
   try
   {
     std::vector<ServiceReferenceBase> srs;
-    Get_unlocked(clazz, "", module, srs);
+    Get(clazz, "", module, srs);
     US_DEBUG << "get service ref " << clazz << " for module "
              << module->info.name << " = " << srs.size() << " refs";
 
@@ -185,16 +209,38 @@ ServiceReferenceBase ServiceRegistry::Get(ModulePrivate* module, const std::stri
   return ServiceReferenceBase();
 }
 
-void ServiceRegistry::Get(const std::string& clazz, const std::string& filter,
-                          ModulePrivate* module, std::vector<ServiceReferenceBase>& res) const
+LDAPExpr ServiceRegistry::GetLDAPExpr(const std::string& filter) const
 {
-  MutexLock lock(mutex);
-  Get_unlocked(clazz, filter, module, res);
+  // the cache is flushed when it grows too large, e.g. if filters are built from changing values
+  static const std::size_t maxCachedFilters = 1024;
+  {
+    MutexLock lock(ldapCacheMutex);
+    MapFilterExpressions::const_iterator i = ldapCache.find(filter);
+    if (i != ldapCache.end())
+    {
+      return i->second;
+    }
+  }
+
+  // parse outside of the lock, invalid filters throw and are not cached
+  LDAPExpr ldap(filter);
+  {
+    MutexLock lock(ldapCacheMutex);
+    if (ldapCache.size() >= maxCachedFilters)
+    {
+      ldapCache.clear();
+    }
+    ldapCache.insert(std::make_pair(filter, ldap));
+  }
+  return ldap;
 }
 
-void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string& filter,
+void ServiceRegistry::Get(const std::string& clazz, const std::string& filter,
                           ModulePrivate* module, std::vector<ServiceReferenceBase>& res) const
 {
+  // Registrations which are removed concurrently may still be contained in the
+  // snapshot, they are skipped if they are not available anymore.
+  std::shared_ptr<const MapClassServices> snapshot = std::atomic_load(&classServices);
   std::vector<ServiceRegistrationBase>::const_iterator s;
   std::vector<ServiceRegistrationBase>::const_iterator send;
   std::vector<ServiceRegistrationBase> v;
@@ -203,7 +249,7 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string&
   {
     if (!filter.empty())
     {
-      ldap = LDAPExpr(filter);
+      ldap = GetLDAPExpr(filter);
       LDAPExpr::ObjectClassSet matched;
       if (ldap.GetMatchedObjectClasses(matched))
       {
@@ -211,10 +257,10 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string&
         for(LDAPExpr::ObjectClassSet::const_iterator className = matched.begin();
             className != matched.end(); ++className)
         {
-          MapClassServices::const_iterator i = classServices.find(*className);
-          if (i != classServices.end())
+          MapClassServices::const_iterator i = snapshot->find(*className);
+          if (i != snapshot->end())
           {
-            std::copy(i->second.begin(), i->second.end(), std::back_inserter(v));
+            std::copy(i->second->begin(), i->second->end(), std::back_inserter(v));
           }
         }
         if (!v.empty())
@@ -229,23 +275,27 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string&
       }
       else
       {
-        s = serviceRegistrations.begin();
-        send = serviceRegistrations.end();
+        MutexLock lock(mutex);
+        v = serviceRegistrations;
+        s = v.begin();
+        send = v.end();
       }
     }
     else
     {
-      s = serviceRegistrations.begin();
-      send = serviceRegistrations.end();
+      MutexLock lock(mutex);
+      v = serviceRegistrations;
+      s = v.begin();
+      send = v.end();
     }
   }
   else
   {
-    MapClassServices::const_iterator it = classServices.find(clazz);
-    if (it != classServices.end())
+    MapClassServices::const_iterator it = snapshot->find(clazz);
+    if (it != snapshot->end())
     {
-      s = it->second.begin();
-      send = it->second.end();
+      s = it->second->begin();
+      send = it->second->end();
     }
     else
     {
@@ -253,17 +303,24 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string&
     }
     if (!filter.empty())
     {
-      ldap = LDAPExpr(filter);
+      ldap = GetLDAPExpr(filter);
     }
   }
 
   for (; s != send; ++s)
   {
-    ServiceReferenceBase sri = s->GetReference(clazz);
+    if (!s->d->available)
+    {
+      continue;
+    }
 
     if (filter.empty() || ldap.Evaluate(s->d->properties, false))
     {
-      res.push_back(sri);
+      // The registration may be unregistered concurrently, so the
+      // reference is not obtained via the throwing GetReference()
+      ServiceReferenceBase ref = s->d->reference;
+      ref.SetInterfaceId(clazz);
+      res.push_back(ref);
     }
   }
 
@@ -290,19 +347,10 @@ void ServiceRegistry::RemoveServiceRegistration(const ServiceRegistrationBase& s
   services.erase(sr);
   serviceRegistrations.erase(std::remove(serviceRegistrations.begin(), serviceRegistrations.end(), sr),
                              serviceRegistrations.end());
-  for (std::vector<std::string>::const_iterator i = classes.begin();
-       i != classes.end(); ++i)
+  ModifyClassServices_unlocked(classes, [&sr](std::vector<ServiceRegistrationBase>& s)
   {
-    std::vector<ServiceRegistrationBase>& s = classServices[*i];
-    if (s.size() > 1)
-    {
-      s.erase(std::remove(s.begin(), s.end(), sr), s.end());
-    }
-    else
-    {
-      classServices.erase(*i);
-    }
-  }
+    s.erase(std::remove(s.begin(), s.end(), sr), s.end());
+  });
 }
 
 void ServiceRegistry::GetRegisteredByModule(ModulePrivate* p,
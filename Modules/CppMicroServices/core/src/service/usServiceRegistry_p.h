@@ -27,6 +27,9 @@
 #include "usServiceRegistration.h"
 
 #include "usThreads_p.h"
+#include "usLDAPExpr_p.h"
+
+#include <memory>
 
 US_BEGIN_NAMESPACE
 
@@ -61,7 +64,8 @@ public:
                                                        bool isFactory = false, bool isPrototypeFactory = false, long sid = -1);
 
   typedef US_UNORDERED_MAP_TYPE<ServiceRegistrationBase, std::vector<std::string> > MapServiceClasses;
-  typedef US_UNORDERED_MAP_TYPE<std::string, std::vector<ServiceRegistrationBase> > MapClassServices;
+  typedef std::shared_ptr<const std::vector<ServiceRegistrationBase> > ServiceRegistrationsPtr;
+  typedef US_UNORDERED_MAP_TYPE<std::string, ServiceRegistrationsPtr> MapClassServices;
 
   /**
    * All registered services in the current framework.
@@ -76,8 +80,14 @@ public:
    * Mapping of classname to registered service.
    * The List of registered services are ordered with the highest
    * ranked service first.
+   *
+   * The map and the lists are never modified after they were published.
+   * Writers hold the mutex, copy the map, replace the lists of the
+   * affected classes and store the new map with std::atomic_store.
+   * Lookups only load the current map with std::atomic_load and do not
+   * lock the mutex.
    */
-  MapClassServices classServices;
+  std::shared_ptr<const MapClassServices> classServices;
 
   CoreModuleContext* core;
 
@@ -175,8 +185,25 @@ private:
 
   void Get_unlocked(const std::string& clazz, std::vector<ServiceRegistrationBase>& serviceRegs) const;
 
-  void Get_unlocked(const std::string& clazz, const std::string& filter,
-                    ModulePrivate* module, std::vector<ServiceReferenceBase>& serviceRefs) const;
+  /**
+   * Returns the compiled LDAP expression for a filter string. Compiled
+   * expressions are cached, since the same filters are used over and over.
+   *
+   * @throws std::invalid_argument If the filter is not a valid LDAP filter.
+   */
+  LDAPExpr GetLDAPExpr(const std::string& filter) const;
+
+  /**
+   * Replaces the lists of the given classes in classServices by modified
+   * copies and publishes the new map. The mutex has to be locked.
+   */
+  template<class Modifier>
+  void ModifyClassServices_unlocked(const std::vector<std::string>& classes, Modifier modify);
+
+  typedef US_UNORDERED_MAP_TYPE<std::string, LDAPExpr> MapFilterExpressions;
+
+  mutable MutexType ldapCacheMutex;
+  mutable MapFilterExpressions ldapCache;
 
   // purposely not implemented
   ServiceRegistry(const ServiceRegistry&);
@@ -48,6 +48,10 @@ US_USE_NAMESPACE
 
 #include <vector>
 
+#ifdef US_ENABLE_THREADING_SUPPORT
+#include <thread>
+#endif
+
 class HighPrecisionTimer
 {
 
@@ -205,6 +209,7 @@ public:
   void TestRegisterServices();
 
   void TestModifyServices();
+  void TestGetServiceReferences();
   void TestUnregisterServices();
 
 private:
@@ -385,6 +390,93 @@ void ServiceRegistryPerformanceTest::ModifyServices()
   }
 }
 
+void ServiceRegistryPerformanceTest::TestGetServiceReferences()
+{
+  class PerfTestService : public IPerfTestService
+  {
+  };
+
+  // the additional services do not match the filter of the listeners
+  const int nAdditionalServices = 4000;
+  const std::size_t nLookups = 1000;
+  Log() << "Register " << nAdditionalServices << " additional services and look up services with filters\n";
+
+  std::vector<ServiceRegistration<IPerfTestService> > additionalRegs;
+  std::vector<PerfTestService*> additionalServices;
+  for (int i = 0; i < nAdditionalServices; i++)
+  {
+    ServiceProperties props;
+    props["perf.lookup.value"] = i;
+    PerfTestService* service = new PerfTestService();
+    additionalServices.push_back(service);
+    additionalRegs.push_back(mc->RegisterService<IPerfTestService>(service, props));
+  }
+
+  // after ModifyServices(), half of the services have a value >= nServices
+  std::stringstream ss;
+  ss << "(perf.service.value>=" << nServices << ")";
+  const std::string filter = ss.str();
+
+  HighPrecisionTimer t;
+  t.Start();
+  std::size_t found = 0;
+  for (std::size_t i = 0; i < nLookups; i++)
+  {
+    found += mc->GetServiceReferences<IPerfTestService>(filter).size();
+  }
+  long long ms = t.ElapsedMilli();
+  Log() << nLookups << " lookups of " << filter << " among " << nServices + nAdditionalServices
+        << " services took " << ms << "ms\n";
+  US_TEST_CONDITION_REQUIRED(found == nLookups * static_cast<std::size_t>(nServices / 2), "Number of services found by class and filter");
+
+  const std::string objectClassFilter = "(&(" + ServiceConstants::OBJECTCLASS() + "=" +
+      us_service_interface_iid<IPerfTestService>() + ")(perf.lookup.value<100))";
+  t.Start();
+  found = 0;
+  for (std::size_t i = 0; i < nLookups; i++)
+  {
+    found += mc->GetServiceReferences("", objectClassFilter).size();
+  }
+  ms = t.ElapsedMilli();
+  Log() << nLookups << " lookups of " << objectClassFilter << " took " << ms << "ms\n";
+  US_TEST_CONDITION_REQUIRED(found == nLookups * 100, "Number of services found by object class filter");
+
+#ifdef US_ENABLE_THREADING_SUPPORT
+  const std::size_t nThreads = 4;
+  std::vector<std::size_t> foundPerThread(nThreads, 0);
+  std::vector<std::thread> threads;
+  t.Start();
+  for (std::size_t i = 0; i < nThreads; i++)
+  {
+    threads.push_back(std::thread([this, &filter, &foundPerThread, i, nLookups, nThreads]()
+    {
+      for (std::size_t j = 0; j < nLookups / nThreads; j++)
+      {
+        foundPerThread[i] += mc->GetServiceReferences<IPerfTestService>(filter).size();
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < nThreads; i++)
+  {
+    threads[i].join();
+  }
+  ms = t.ElapsedMilli();
+  Log() << nLookups << " lookups of " << filter << " in " << nThreads << " threads took " << ms << "ms\n";
+  found = 0;
+  for (std::size_t i = 0; i < nThreads; i++)
+  {
+    found += foundPerThread[i];
+  }
+  US_TEST_CONDITION_REQUIRED(found == nLookups * static_cast<std::size_t>(nServices / 2), "Number of services found concurrently");
+#endif
+
+  for (std::size_t i = 0; i < additionalRegs.size(); i++)
+  {
+    additionalRegs[i].Unregister();
+    delete additionalServices[i];
+  }
+}
+
 void ServiceRegistryPerformanceTest::TestUnregisterServices()
 {
   Log() << "Unregister all services, and check that we get #of services ("
@@ -421,6 +513,7 @@ int usServiceRegistryPerformanceTest(int /*argc*/, char* /*argv*/[])
   perfTest.TestAddListeners();
   perfTest.TestRegisterServices();
   perfTest.TestModifyServices();
+  perfTest.TestGetServiceReferences();
   perfTest.TestUnregisterServices();
   perfTest.CleanupTestCase();
 
@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkConnectomicsStatisticsCalculator.h"
 #include "mitkConnectomicsNetworkConverter.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include <boost/graph/clustering_coefficient.hpp>
@@ -26,42 +27,32 @@ See LICENSE.txt or http://www.mitk.org for details.
 # pragma warning(disable: 4172)
 #endif
 #include <boost/graph/connected_components.hpp>
-#include <boost/graph/betweenness_centrality.hpp>
 
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
 
-#include <boost/graph/visitors.hpp>
-
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 
-template<typename GraphType>
-class all_pairs_shortest_recorder : public boost::default_bfs_visitor
-{
-public:
-  typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexType;
-  typedef typename boost::graph_traits<GraphType>::edge_descriptor EdgeType;
+#include <omp.h>
 
-  all_pairs_shortest_recorder(int* dist, int &max, unsigned int &size)
+namespace
+{
+  inline unsigned int LowestSetBit(std::uint64_t bits)
   {
-    d = dist;
-    ecc = &max;
-    component_size = &size;
-  }
-
-  void tree_edge(EdgeType edge, const GraphType& graph) {
-    VertexType u = boost::source(edge, graph);
-    VertexType v = boost::target(edge, graph);
-    d[v] = d[u] + 1;
-    *ecc = d[v];
-    *component_size = *component_size + 1;
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_ctzll(bits));
+#else
+    unsigned int index = 0;
+    while ((bits & 1)==0)
+    {
+      bits >>= 1;
+      ++index;
+    }
+    return index;
+#endif
   }
-private:
-  int* d;
-  int* ecc;
-  unsigned int* component_size;
-};
+}
 
 mitk::ConnectomicsStatisticsCalculator::ConnectomicsStatisticsCalculator()
   : m_Network( nullptr )
@@ -132,6 +123,7 @@ void mitk::ConnectomicsStatisticsCalculator::Update()
 {
   CalculateNumberOfVertices();
   CalculateNumberOfEdges();
+  CalculateAdjacency();
   CalculateAverageDegree();
   CalculateConnectionDensity();
   CalculateNumberOfConnectedComponents();
@@ -159,6 +151,128 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateNumberOfEdges()
   m_NumberOfEdges = boost::num_edges(  *(m_Network->GetBoostGraph()) );
 }
 
+void mitk::ConnectomicsStatisticsCalculator::CalculateAdjacency()
+{
+  NetworkType* graph = m_Network->GetBoostGraph();
+
+  // edges are indexed in the order of boost::edges, as for the edge betweenness centralities
+  EdgeIndexStdMapType stdEdgeIndex;
+  EdgeIteratorType ei, ei_end;
+  int i(0);
+  for( boost::tie( ei, ei_end ) = boost::edges( *graph ); ei != ei_end; ++ei, ++i )
+  {
+    stdEdgeIndex.insert( std::pair< EdgeDescriptorType, int >( *ei, i ) );
+  }
+
+  m_AdjacencyOffsets.assign( m_NumberOfVertices + 1, 0 );
+  m_AdjacentVertices.clear();
+  m_AdjacentEdges.clear();
+  m_AdjacentVertices.reserve( 2 * m_NumberOfEdges );
+  m_AdjacentEdges.reserve( 2 * m_NumberOfEdges );
+  for( unsigned int v = 0; v < m_NumberOfVertices; ++v )
+  {
+    NetworkType::out_edge_iterator oe, oe_end;
+    for( boost::tie( oe, oe_end ) = boost::out_edges( v, *graph ); oe != oe_end; ++oe )
+    {
+      m_AdjacentVertices.push_back( boost::target( *oe, *graph ) );
+      m_AdjacentEdges.push_back( stdEdgeIndex[ *oe ] );
+    }
+    m_AdjacencyOffsets[ v + 1 ] = m_AdjacentVertices.size();
+  }
+
+  // A bit parallel BFS costs V/64 word operations per vertex, the queue based BFS one operation per
+  // edge. The bit matrix is therefore only used if the average degree exceeds V/64.
+  m_AdjacencyBits.clear();
+  m_AdjacencyBitsStride = ( m_NumberOfVertices + 63 ) / 64;
+  if( m_NumberOfVertices <= 65536 && 128.0 * m_NumberOfEdges >= (double) m_NumberOfVertices * m_NumberOfVertices )
+  {
+    m_AdjacencyBits.assign( (std::size_t) m_NumberOfVertices * m_AdjacencyBitsStride, 0 );
+    for( unsigned int v = 0; v < m_NumberOfVertices; ++v )
+    {
+      std::uint64_t* row = &m_AdjacencyBits[ (std::size_t) v * m_AdjacencyBitsStride ];
+      for( unsigned int k = m_AdjacencyOffsets[ v ]; k < m_AdjacencyOffsets[ v + 1 ]; ++k )
+      {
+        row[ m_AdjacentVertices[ k ] / 64 ] |= std::uint64_t( 1 ) << ( m_AdjacentVertices[ k ] % 64 );
+      }
+    }
+  }
+}
+
+void mitk::ConnectomicsStatisticsCalculator::CalculateDistances( unsigned int source, std::vector<int>& distances, int& maxDistance, unsigned int& size ) const
+{
+  distances.assign( m_NumberOfVertices, 0 );
+  maxDistance = 0;
+  size = 0;
+
+  if( !m_AdjacencyBits.empty() )
+  {
+    // level synchronous BFS: the next frontier is the union of the adjacency rows of the current frontier
+    const unsigned int stride = m_AdjacencyBitsStride;
+    std::vector< std::uint64_t > visited( stride, 0 );
+    std::vector< std::uint64_t > next( stride, 0 );
+    visited[ source / 64 ] |= std::uint64_t( 1 ) << ( source % 64 );
+    std::vector< std::uint64_t > frontier( visited );
+
+    for( int level = 1; ; ++level )
+    {
+      std::fill( next.begin(), next.end(), 0 );
+      for( unsigned int w = 0; w < stride; ++w )
+      {
+        for( std::uint64_t bits = frontier[ w ]; bits != 0; bits &= bits - 1 )
+        {
+          const std::uint64_t* row = &m_AdjacencyBits[ (std::size_t) ( 64 * w + LowestSetBit( bits ) ) * stride ];
+          for( unsigned int k = 0; k < stride; ++k )
+          {
+            next[ k ] |= row[ k ];
+          }
+        }
+      }
+
+      bool empty = true;
+      for( unsigned int w = 0; w < stride; ++w )
+      {
+        next[ w ] &= ~visited[ w ];
+        visited[ w ] |= next[ w ];
+        for( std::uint64_t bits = next[ w ]; bits != 0; bits &= bits - 1 )
+        {
+          distances[ 64 * w + LowestSetBit( bits ) ] = level;
+          ++size;
+          empty = false;
+        }
+      }
+      if( empty )
+      {
+        break;
+      }
+      maxDistance = level;
+      frontier.swap( next );
+    }
+    return;
+  }
+
+  std::vector< unsigned char > discovered( m_NumberOfVertices, 0 );
+  std::vector< unsigned int > queue;
+  queue.reserve( m_NumberOfVertices );
+  queue.push_back( source );
+  discovered[ source ] = 1;
+  for( std::size_t head = 0; head < queue.size(); ++head )
+  {
+    unsigned int u = queue[ head ];
+    for( unsigned int k = m_AdjacencyOffsets[ u ]; k < m_AdjacencyOffsets[ u + 1 ]; ++k )
+    {
+      unsigned int v = m_AdjacentVertices[ k ];
+      if( !discovered[ v ] )
+      {
+        discovered[ v ] = 1;
+        distances[ v ] = distances[ u ] + 1;
+        maxDistance = distances[ v ];
+        ++size;
+        queue.push_back( v );
+      }
+    }
+  }
+}
+
 void  mitk::ConnectomicsStatisticsCalculator::CalculateAverageDegree()
 {
   m_AverageDegree = ( ( (double) m_NumberOfEdges * 2.0 ) / (double) m_NumberOfVertices );
@@ -210,28 +324,34 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateHopPlotValues()
 {
   std::vector<int> bins( m_NumberOfVertices );
 
-  VertexIteratorType vi, vi_end;
   unsigned int index( 0 );
 
-  for( boost::tie( vi, vi_end ) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi != vi_end; ++vi)
+#pragma omp parallel
   {
-    std::vector<int> distances(m_NumberOfVertices, 0);
-    int max_distance = 0;
-    VertexDescriptorType src = *vi;
-    distances[src] = 0;
-    unsigned int size = 0;
+    std::vector<int> threadBins( m_NumberOfVertices, 0 );
+    std::vector<int> distances;
 
-    boost::breadth_first_search(*(m_Network->GetBoostGraph()), src,
-      visitor(all_pairs_shortest_recorder< NetworkType >
-      (&distances[0], max_distance, size)));
-
-    for(index=0; index < distances.size(); index++)
+#pragma omp for schedule(dynamic, 16)
+    for( int src = 0; src < (int) m_NumberOfVertices; ++src )
     {
-      if(distances[index] > 0)
+      int max_distance = 0;
+      unsigned int size = 0;
+      CalculateDistances( src, distances, max_distance, size );
+
+      for( unsigned int i = 0; i < distances.size(); i++ )
       {
-        bins[distances[index]]++;
+        if( distances[i] > 0 )
+        {
+          threadBins[distances[i]]++;
+        }
       }
     }
+
+#pragma omp critical
+    for( unsigned int i = 0; i < bins.size(); i++ )
+    {
+      bins[i] += threadBins[i];
+    }
   }
 
   bins[0] = m_NumberOfVertices;
@@ -271,49 +391,65 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateHopPlotValues()
 
 void mitk::ConnectomicsStatisticsCalculator::CalculateClusteringCoefficients()
 {
-  VertexIteratorType vi, vi_end;
   std::vector<double> m_VectorOfClusteringCoefficientsC;
   std::vector<double> m_VectorOfClusteringCoefficientsD;
   std::vector<double> m_VectorOfClusteringCoefficientsE;
-  typedef std::set<VertexDescriptorType> NeighborSetType;
-  typedef NetworkType::out_edge_iterator OutEdgeIterType;
 
-  for(boost::tie(vi,vi_end) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi!=vi_end; ++vi)
+  // Count the neighbors and the edges in the neighborhood of every vertex in parallel.
+  std::vector<std::size_t> numbersOfNeighbors( m_NumberOfVertices, 0 );
+  std::vector<unsigned int> neighborhoodEdgeCounts( m_NumberOfVertices, 0 );
+#pragma omp parallel
   {
-    // Get the list of vertices which are in the neighborhood of vi.
-    std::pair<AdjacencyIteratorType, AdjacencyIteratorType> adjacent =
-      boost::adjacent_vertices(*vi, *(m_Network->GetBoostGraph()) );
+    std::vector<unsigned char> isNeighbor( m_NumberOfVertices, 0 );
+    std::vector<unsigned int> neighbors;
 
-    //Populate a set with the neighbors of vi
-    NeighborSetType neighbors;
-    for(; adjacent.first!=adjacent.second; ++adjacent.first)
+#pragma omp for schedule(dynamic, 16)
+    for( int v = 0; v < (int) m_NumberOfVertices; ++v )
     {
-      neighbors.insert(*adjacent.first);
-    }
+      // Get the (distinct) vertices which are in the neighborhood of v.
+      neighbors.clear();
+      for( unsigned int k = m_AdjacencyOffsets[v]; k < m_AdjacencyOffsets[v+1]; ++k )
+      {
+        if( !isNeighbor[ m_AdjacentVertices[k] ] )
+        {
+          isNeighbor[ m_AdjacentVertices[k] ] = 1;
+          neighbors.push_back( m_AdjacentVertices[k] );
+        }
+      }
 
-    // Now, count the edges between vertices in the neighborhood.
-    unsigned int neighborhood_edge_count = 0;
-    if(neighbors.size() > 0)
-    {
-      NeighborSetType::iterator iter;
-      for(iter = neighbors.begin(); iter != neighbors.end(); ++iter)
+      // Now, count the edges between vertices in the neighborhood.
+      unsigned int neighborhood_edge_count = 0;
+      for( unsigned int n : neighbors )
       {
-        std::pair<OutEdgeIterType, OutEdgeIterType> oe = out_edges(*iter, *(m_Network->GetBoostGraph()) );
-        for(; oe.first != oe.second; ++oe.first)
+        for( unsigned int k = m_AdjacencyOffsets[n]; k < m_AdjacencyOffsets[n+1]; ++k )
         {
-          if(neighbors.find(target(*oe.first, *(m_Network->GetBoostGraph()) )) != neighbors.end())
+          if( isNeighbor[ m_AdjacentVertices[k] ] )
           {
             ++neighborhood_edge_count;
           }
         }
       }
       neighborhood_edge_count /= 2;
+
+      for( unsigned int n : neighbors )
+      {
+        isNeighbor[n] = 0;
+      }
+      numbersOfNeighbors[v] = neighbors.size();
+      neighborhoodEdgeCounts[v] = neighborhood_edge_count;
     }
+  }
+
+  for( unsigned int v = 0; v < m_NumberOfVertices; ++v )
+  {
+    std::size_t numberOfNeighbors = numbersOfNeighbors[v];
+    unsigned int neighborhood_edge_count = neighborhoodEdgeCounts[v];
+
     //Clustering Coefficienct C,E
-    if(neighbors.size() > 1)
+    if(numberOfNeighbors > 1)
     {
       double num   = neighborhood_edge_count;
-      double denum = neighbors.size() * (neighbors.size()-1)/2;
+      double denum = numberOfNeighbors * (numberOfNeighbors-1)/2;
       m_VectorOfClusteringCoefficientsC.push_back( num / denum);
       m_VectorOfClusteringCoefficientsE.push_back( num / denum);
     }
@@ -323,10 +459,10 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateClusteringCoefficients()
     }
 
     //Clustering Coefficienct D
-    if(neighbors.size() > 0)
+    if(numberOfNeighbors > 0)
     {
-      double num   = neighbors.size() + neighborhood_edge_count;
-      double denum = ( (neighbors.size()+1) * neighbors.size()) / 2;
+      double num   = numberOfNeighbors + neighborhood_edge_count;
+      double denum = ( (numberOfNeighbors+1) * numberOfNeighbors) / 2;
       m_VectorOfClusteringCoefficientsD.push_back( num / denum);
     }
     else
@@ -368,18 +504,123 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateBetweennessCentrality()
   }
 
   // Define EdgeCentralityMap
-  m_VectorOfEdgeBetweennessCentralities.resize( m_NumberOfEdges, 0.0);
+  m_VectorOfEdgeBetweennessCentralities.assign( m_NumberOfEdges, 0.0);
   // Create the external property map
   m_PropertyMapOfEdgeBetweennessCentralities = EdgeIteratorPropertyMapType(m_VectorOfEdgeBetweennessCentralities.begin(), edgeIndex);
 
   // Define VertexCentralityMap
   VertexIndexMapType vertexIndex = get(boost::vertex_index, *(m_Network->GetBoostGraph()) );
-  m_VectorOfVertexBetweennessCentralities.resize( m_NumberOfVertices, 0.0);
+  m_VectorOfVertexBetweennessCentralities.assign( m_NumberOfVertices, 0.0);
   // Create the external property map
   m_PropertyMapOfVertexBetweennessCentralities = VertexIteratorPropertyMapType(m_VectorOfVertexBetweennessCentralities.begin(), vertexIndex);
 
-  boost::brandes_betweenness_centrality( *(m_Network->GetBoostGraph()),
-    m_PropertyMapOfVertexBetweennessCentralities, m_PropertyMapOfEdgeBetweennessCentralities );
+  // Brandes' algorithm, parallel over the source vertices. The single source dependencies of a block of sources
+  // are buffered and added up in source order, which reproduces boost::brandes_betweenness_centrality exactly.
+  const unsigned int numberOfVertices = m_NumberOfVertices;
+  const unsigned int numberOfEdges = m_NumberOfEdges;
+  unsigned int blockSize = std::min( numberOfVertices, std::max( (unsigned int) omp_get_max_threads(), ( 1u << 23 ) / ( numberOfVertices + numberOfEdges + 1 ) ) );
+  std::vector<double> vertexDependencies( (std::size_t) blockSize * numberOfVertices );
+  std::vector<double> edgeDependencies( (std::size_t) blockSize * numberOfEdges );
+
+  for( unsigned int first = 0; first < numberOfVertices; first += blockSize )
+  {
+    unsigned int count = std::min( blockSize, numberOfVertices - first );
+
+#pragma omp parallel
+    {
+      std::vector<int> distance( numberOfVertices );
+      std::vector<std::size_t> pathCount( numberOfVertices );
+      std::vector<double> dependency( numberOfVertices );
+      std::vector<unsigned int> order;
+      order.reserve( numberOfVertices );
+
+#pragma omp for schedule(dynamic, 1)
+      for( int b = 0; b < (int) count; ++b )
+      {
+        unsigned int s = first + b;
+        double* vertexDependency = vertexDependencies.data() + (std::size_t) b * numberOfVertices;
+        double* edgeDependency = edgeDependencies.data() + (std::size_t) b * numberOfEdges;
+        std::fill( vertexDependency, vertexDependency + numberOfVertices, 0.0 );
+        std::fill( edgeDependency, edgeDependency + numberOfEdges, 0.0 );
+        std::fill( distance.begin(), distance.end(), -1 );
+        std::fill( pathCount.begin(), pathCount.end(), 0 );
+        std::fill( dependency.begin(), dependency.end(), 0.0 );
+
+        // BFS counting the shortest paths, vertices are recorded in the order they are examined
+        order.clear();
+        order.push_back( s );
+        distance[s] = 0;
+        pathCount[s] = 1;
+        for( std::size_t head = 0; head < order.size(); ++head )
+        {
+          unsigned int v = order[head];
+          for( unsigned int k = m_AdjacencyOffsets[v]; k < m_AdjacencyOffsets[v+1]; ++k )
+          {
+            unsigned int w = m_AdjacentVertices[k];
+            if( distance[w] < 0 )
+            {
+              distance[w] = distance[v] + 1;
+              pathCount[w] = pathCount[v];
+              order.push_back( w );
+            }
+            else if( distance[w] == distance[v] + 1 )
+            {
+              pathCount[w] += pathCount[v];
+            }
+          }
+        }
+
+        // accumulate the dependencies in reverse BFS order
+        for( std::size_t i = order.size(); i-- > 0; )
+        {
+          unsigned int w = order[i];
+          for( unsigned int k = m_AdjacencyOffsets[w]; k < m_AdjacencyOffsets[w+1]; ++k )
+          {
+            unsigned int v = m_AdjacentVertices[k];
+            if( distance[v] >= 0 && distance[v] + 1 == distance[w] )
+            {
+              double factor = double( pathCount[v] ) / double( pathCount[w] );
+              factor *= ( 1.0 + dependency[w] );
+              dependency[v] += factor;
+              edgeDependency[ m_AdjacentEdges[k] ] += factor;
+            }
+          }
+          if( w != s )
+          {
+            vertexDependency[w] = dependency[w];
+          }
+        }
+      }
+    }
+
+#pragma omp parallel for
+    for( int v = 0; v < (int) numberOfVertices; ++v )
+    {
+      for( unsigned int b = 0; b < count; ++b )
+      {
+        m_VectorOfVertexBetweennessCentralities[v] += vertexDependencies[ (std::size_t) b * numberOfVertices + v ];
+      }
+    }
+
+#pragma omp parallel for
+    for( int e = 0; e < (int) numberOfEdges; ++e )
+    {
+      for( unsigned int b = 0; b < count; ++b )
+      {
+        m_VectorOfEdgeBetweennessCentralities[e] += edgeDependencies[ (std::size_t) b * numberOfEdges + e ];
+      }
+    }
+  }
+
+  // undirected graph: every path has been counted from both ends
+  for( double& c : m_VectorOfVertexBetweennessCentralities )
+  {
+    c /= 2.0;
+  }
+  for( double& c : m_VectorOfEdgeBetweennessCentralities )
+  {
+    c /= 2.0;
+  }
 
   m_AverageVertexBetweennessCentrality = std::accumulate(m_VectorOfVertexBetweennessCentralities.begin(),
     m_VectorOfVertexBetweennessCentralities.end(),
@@ -445,28 +686,67 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   //The size of the giant connected component so far.
   unsigned int giant_component_size = 0;
   VertexDescriptorType radius_src(0);
+  std::vector<unsigned int> componentSizes( m_NumberOfVertices );
+
+  //Loop over the vertices, the BFS of the different sources are independent
+  //and run in parallel.
+#pragma omp parallel
+  {
+    std::vector<int> distances;
+
+#pragma omp for schedule(dynamic, 16)
+    for( int v = 0; v < (int) m_NumberOfVertices; ++v )
+    {
+      //Store the distances of nodes from the source in distance vector.
+      //The maximum distance is stored in max_distance. size gives the
+      //number of nodes discovered during this BFS.
+      VertexDescriptorType src = v;
+      int max_distance = 0;
+      unsigned int size = 0;
+      CalculateDistances( src, distances, max_distance, size );
+
+      // vertex vi has eccentricity equal to max_distance
+      m_VectorOfEccentrities[src] = max_distance;
+      componentSizes[src] = size;
+
+      //Calculate in how many hops we can reach 90 percent of the
+      //nodes. We store the number of hops we can reach in h hops in the
+      //bucket vector. That is bucket[h] gives the number of nodes
+      //reachable in exactly h hops. sum of bucket[i<h] gives the number
+      //of nodes that are reachable in less than h hops. We also
+      //calculate sum of the distances from this node to every single
+      //other node in the graph.
+      int reachable90 = std::ceil((double)size * 0.9);
+      std::vector <int> bucket (max_distance+1);
+      int counter = 0;
+      for(unsigned int i=0; i<distances.size(); i++)
+      {
+        if(distances[i]>0)
+        {
+          bucket[distances[i]]++;
+          m_VectorOfAveragePathLengths[src] += distances[i];
+          counter ++;
+        }
+      }
+      if(counter > 0)
+      {
+        m_VectorOfAveragePathLengths[src] = m_VectorOfAveragePathLengths[src] / counter;
+      }
+
+      int eccentricity90 = 0;
+      while(reachable90 > 0)
+      {
+        eccentricity90 ++;
+        reachable90 = reachable90 - bucket[eccentricity90];
+      }
+      // vertex vi has eccentricity90 equal to eccentricity90
+      m_VectorOfEccentrities90[src] = eccentricity90;
+    }
+  }
 
-  //Loop over the vertices
   for( boost::tie(vi, vi_end) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi!=vi_end; ++vi)
   {
-    //We are going to start a BFS, initialize the neccessary
-    //structures for that.  Store the distances of nodes from the
-    //source in distance vector. The maximum distance is stored in
-    //max. The BFS will start from the node that vi is pointing, that
-    //is the src is *vi. We also init the distance of the src node to
-    //itself to 0. size gives the number of nodes discovered during
-    //this BFS.
-    std::vector<int> distances( m_NumberOfVertices );
-    int max_distance = 0;
     VertexDescriptorType src = *vi;
-    distances[src] = 0;
-    unsigned int size = 0;
-
-    breadth_first_search(*(m_Network->GetBoostGraph()), src,
-      visitor(all_pairs_shortest_recorder<NetworkType>
-      (&distances[0], max_distance, size)));
-    // vertex vi has eccentricity equal to max_distance
-    m_VectorOfEccentrities[src] = max_distance;
 
     //check whether there is any change in the diameter or the radius.
     //note that the diameter we are calculating here is also the
@@ -483,44 +763,12 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
     //found we should loop over this connected component and find the
     //minimum eccentricity which is the radius. So we keep the src
     //node, so that we can find the connected component later on.
-    if(size > giant_component_size)
+    if(componentSizes[src] > giant_component_size)
     {
-      giant_component_size = size;
+      giant_component_size = componentSizes[src];
       radius_src = src;
     }
 
-    //Calculate in how many hops we can reach 90 percent of the
-    //nodes. We store the number of hops we can reach in h hops in the
-    //bucket vector. That is bucket[h] gives the number of nodes
-    //reachable in exactly h hops. sum of bucket[i<h] gives the number
-    //of nodes that are reachable in less than h hops. We also
-    //calculate sum of the distances from this node to every single
-    //other node in the graph.
-    int reachable90 = std::ceil((double)size * 0.9);
-    std::vector <int> bucket (max_distance+1);
-    int counter = 0;
-    for(unsigned int i=0; i<distances.size(); i++)
-    {
-      if(distances[i]>0)
-      {
-        bucket[distances[i]]++;
-        m_VectorOfAveragePathLengths[src] += distances[i];
-        counter ++;
-      }
-    }
-    if(counter > 0)
-    {
-      m_VectorOfAveragePathLengths[src] = m_VectorOfAveragePathLengths[src] / counter;
-    }
-
-    int eccentricity90 = 0;
-    while(reachable90 > 0)
-    {
-      eccentricity90 ++;
-      reachable90 = reachable90 - bucket[eccentricity90];
-    }
-    // vertex vi has eccentricity90 equal to eccentricity90
-    m_VectorOfEccentrities90[src] = eccentricity90;
     if(m_VectorOfEccentrities90[src] > m_Diameter90)
     {
       m_Diameter90 = m_VectorOfEccentrities90[src];
@@ -27,6 +27,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkConnectomicsNetwork.h>
 
+#include <cstdint>
+
 namespace mitk
 {
   /**
@@ -127,6 +129,22 @@ namespace mitk
 
     void CalculateNumberOfEdges();
 
+    /**
+    * \brief Builds the compact adjacency of the network used by the parallel path based metrics
+    *
+    * Neighbours are stored in the out edge order of the boost graph, so traversals visit the vertices
+    * in the same order as the boost algorithms. Dense networks additionally get an adjacency bit matrix.
+    */
+    void CalculateAdjacency();
+
+    /**
+    * \brief Unweighted shortest path distances from source (BFS)
+    *
+    * Unreached vertices have distance 0. maxDistance is the eccentricity of the source and size
+    * the number of vertices reached, not counting the source itself.
+    */
+    void CalculateDistances( unsigned int source, std::vector<int>& distances, int& maxDistance, unsigned int& size ) const;
+
     void CalculateAverageDegree();
 
     void CalculateConnectionDensity();
@@ -178,6 +196,14 @@ namespace mitk
     // The connectomics network, which is used for statistics calculation
     mitk::ConnectomicsNetwork::Pointer m_Network;
 
+    // Adjacency (CSR), neighbours and edge indices of vertex i are stored from m_AdjacencyOffsets[i] to m_AdjacencyOffsets[i+1]-1
+    std::vector< unsigned int > m_AdjacencyOffsets;
+    std::vector< unsigned int > m_AdjacentVertices;
+    std::vector< unsigned int > m_AdjacentEdges;
+    // Adjacency bit matrix with m_AdjacencyBitsStride words per row, empty for sparse networks
+    std::vector< std::uint64_t > m_AdjacencyBits;
+    unsigned int m_AdjacencyBitsStride;
+
     // Statistics
     unsigned int m_NumberOfVertices;
     unsigned int m_NumberOfEdges;
@@ -29,6 +29,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 // VTK includes
 #include <vtkDebugLeaks.h>
 
+// boost includes
+#include <boost/graph/betweenness_centrality.hpp>
+
+#include <omp.h>
+
 
 class mitkConnectomicsStatisticsCalculatorTestSuite : public mitk::TestFixture
 {
@@ -38,6 +43,7 @@ class mitkConnectomicsStatisticsCalculatorTestSuite : public mitk::TestFixture
   vtkDebugLeaks::SetExitError(0);
 
   MITK_TEST(StatisticsCalculatorUpdate);
+  MITK_TEST(BetweennessCentralityMatchesBoost);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -136,6 +142,41 @@ public:
     CPPUNIT_ASSERT_MESSAGE( "GetSmallWorldness", mitk::Equal( statisticsCalculator->GetSmallWorldness( ), 1.72908 , eps, true ) );
 
   }
+
+  void BetweennessCentralityMatchesBoost()
+  {
+    typedef mitk::ConnectomicsStatisticsCalculator CalculatorType;
+    CalculatorType::NetworkType* graph = m_Network->GetBoostGraph();
+
+    // reference values of the boost implementation
+    CalculatorType::EdgeIndexStdMapType stdEdgeIndex;
+    CalculatorType::EdgeIndexMapType edgeIndex( stdEdgeIndex );
+    CalculatorType::EdgeIteratorType iterator, end;
+    int i(0);
+    for( boost::tie( iterator, end ) = boost::edges( *graph ); iterator != end; ++iterator, ++i )
+    {
+      stdEdgeIndex.insert( std::pair< CalculatorType::EdgeDescriptorType, int >( *iterator, i ) );
+    }
+    std::vector< double > edgeCentralities( boost::num_edges( *graph ), 0.0 );
+    std::vector< double > vertexCentralities( boost::num_vertices( *graph ), 0.0 );
+    boost::brandes_betweenness_centrality( *graph,
+      CalculatorType::VertexIteratorPropertyMapType( vertexCentralities.begin(), get( boost::vertex_index, *graph ) ),
+      CalculatorType::EdgeIteratorPropertyMapType( edgeCentralities.begin(), edgeIndex ) );
+
+    // the parallel implementation has to reproduce them exactly, independent of the number of threads
+    const int numberOfThreads = omp_get_max_threads();
+    for( int threads = 1; threads <= 4; threads *= 2 )
+    {
+      omp_set_num_threads( threads );
+      CalculatorType::Pointer statisticsCalculator = CalculatorType::New();
+      statisticsCalculator->SetNetwork( m_Network );
+      statisticsCalculator->Update();
+      omp_set_num_threads( numberOfThreads );
+
+      CPPUNIT_ASSERT_MESSAGE( "Vertex betweenness centralities", statisticsCalculator->GetVectorOfVertexBetweennessCentralities() == vertexCentralities );
+      CPPUNIT_ASSERT_MESSAGE( "Edge betweenness centralities", statisticsCalculator->GetVectorOfEdgeBetweennessCentralities() == edgeCentralities );
+    }
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkConnectomicsStatisticsCalculator)
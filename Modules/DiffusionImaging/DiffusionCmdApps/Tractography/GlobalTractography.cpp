@@ -49,6 +49,7 @@ int main(int argc, char* argv[])
   parser.addArgument("", "o", mitkCommandLineParser::OutputFile, "Output:", "output tractogram", us::Any(), false);
   parser.addArgument("parameters", "", mitkCommandLineParser::InputFile, "Parameters:", "parameter file (.gtp)", us::Any(), false);
   parser.addArgument("mask", "", mitkCommandLineParser::InputFile, "Mask:", "binary mask image");
+  parser.addArgument("chains", "", mitkCommandLineParser::Int, "Chains:", "number of tempered Markov chains that run in parallel (parallel tempering)", 1);
 
   std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
   if (parsedArgs.size()==0)
@@ -58,6 +59,10 @@ int main(int argc, char* argv[])
   std::string paramFileName = us::any_cast<std::string>(parsedArgs["parameters"]);
   std::string outFileName = us::any_cast<std::string>(parsedArgs["o"]);
 
+  int chains = 1;
+  if (parsedArgs.count("chains"))
+    chains = us::any_cast<int>(parsedArgs["chains"]);
+
   try
   {
     // instantiate gibbs tracker
@@ -106,6 +111,7 @@ int main(int argc, char* argv[])
 
     gibbsTracker->SetDuplicateImage(false);
     gibbsTracker->SetLoadParameterFile( paramFileName );
+    gibbsTracker->SetNumberOfChains( std::max(chains, 1) );
     //        gibbsTracker->SetLutPath( "" );
     gibbsTracker->Update();
 
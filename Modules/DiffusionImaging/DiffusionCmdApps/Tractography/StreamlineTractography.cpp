@@ -114,6 +114,7 @@ int main(int argc, char* argv[])
   parser.beginGroup("8. Random forest tractography specific:");
   parser.addArgument("forest", "", mitkCommandLineParser::String, "Forest:", "input random forest (HDF5 file)", us::Any());
   parser.addArgument("use_sh_features", "", mitkCommandLineParser::Bool, "Use SH features:", "use SH features");
+  parser.addArgument("lockstep_streamlines", "", mitkCommandLineParser::Int, "Streamlines in lock-step:", "number of streamlines per thread that are propagated in lock-step so that their features can be classified in batches", 64);
   parser.endGroup();
 
   parser.beginGroup("9. Additional input:");
@@ -259,6 +260,10 @@ int main(int argc, char* argv[])
   if (parsedArgs.count("trials_per_seed"))
     trials_per_seed = us::any_cast<unsigned int>(parsedArgs["trials_per_seed"]);
 
+  int lockstep_streamlines = 64;
+  if (parsedArgs.count("lockstep_streamlines"))
+    lockstep_streamlines = us::any_cast<int>(parsedArgs["lockstep_streamlines"]);
+
   float tend_f = 1;
   if (parsedArgs.count("tend_f"))
     tend_f = us::any_cast<float>(parsedArgs["tend_f"]);
@@ -529,6 +534,8 @@ int main(int argc, char* argv[])
   tracker->SetLoopCheck(loop_check);
   tracker->SetMaxNumTracts(max_tracts);
   tracker->SetTrialsPerSeed(trials_per_seed);
+  if (algorithm == "DetRF" || algorithm == "ProbRF")
+    tracker->SetLockStepBatchSize(std::max(1, lockstep_streamlines));
   tracker->SetTrackingHandler(handler);
   if (ext != ".fib" && ext != ".trk")
     tracker->SetUseOutputProbabilityMap(true);
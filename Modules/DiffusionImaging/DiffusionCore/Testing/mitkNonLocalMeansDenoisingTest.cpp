@@ -21,6 +21,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkGradientDirectionsProperty.h"
 #include "mitkITKImageImport.h"
 #include <mitkImageCast.h>
+#include <itkImageRegionConstIterator.h>
+#include <chrono>
 
 class mitkNonLocalMeansDenoisingTestSuite : public mitk::TestFixture
 {
@@ -30,6 +32,7 @@ class mitkNonLocalMeansDenoisingTestSuite : public mitk::TestFixture
   MITK_TEST(Denoise_NLMr_shouldReturnTrue);
   MITK_TEST(Denoise_NLMv_shouldReturnTrue);
   MITK_TEST(Denoise_NLMvr_shouldReturnTrue);
+  MITK_TEST(Denoise_IntegralImages_EqualsDirectComputation);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -43,6 +46,46 @@ private:
   itk::Image<short, 3>::Pointer m_ImageMask;
   itk::NonLocalMeansDenoisingFilter<short>::Pointer m_DenoisingFilter;
 
+  /** Denoises the test image directly and with integral images, returns the largest difference of both results. */
+  int CompareIntegralImageDenoising(bool rician, bool joint, int comparisonRadius)
+  {
+    VectorImagetType::Pointer vectorImage;
+    mitk::CastToItkImage(m_Image, vectorImage);
+
+    VectorImagetType::Pointer results[2];
+    double ms[2];
+    for (int i = 0; i < 2; ++i)
+    {
+      itk::NonLocalMeansDenoisingFilter<short>::Pointer filter = itk::NonLocalMeansDenoisingFilter<short>::New();
+      filter->SetInputImage(vectorImage);
+      filter->SetComparisonRadius(comparisonRadius);
+      filter->SetSearchRadius(2);
+      filter->SetVariance(500);
+      filter->SetUseRicianAdaption(rician);
+      filter->SetUseJointInformation(joint);
+      filter->SetUseIntegralImages(i == 1);
+
+      auto start = std::chrono::steady_clock::now();
+      filter->Update();
+      ms[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      results[i] = filter->GetOutput();
+    }
+    MITK_INFO << "NLM (rician " << rician << ", joint " << joint << ", comparison radius " << comparisonRadius
+              << "): direct " << ms[0] << " ms, integral images " << ms[1] << " ms";
+
+    int maxDifference = 0;
+    itk::ImageRegionConstIterator<VectorImagetType> it0(results[0], results[0]->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<VectorImagetType> it1(results[1], results[1]->GetLargestPossibleRegion());
+    for (; !it0.IsAtEnd(); ++it0, ++it1)
+    {
+      for (unsigned int c = 0; c < vectorImage->GetVectorLength(); ++c)
+      {
+        maxDifference = std::max(maxDifference, std::abs(it0.Get()[c] - it1.Get()[c]));
+      }
+    }
+    return maxDifference;
+  }
+
 public:
 
   /**
@@ -164,6 +207,18 @@ public:
     MITK_ASSERT_EQUAL( m_DenoisedImage, m_ReferenceImage, "NLMvr should always return the same result.");
   }
 
+  void Denoise_IntegralImages_EqualsDirectComputation()
+  {
+    // only the rounding of the final normalization may differ
+    for (int comparisonRadius = 1; comparisonRadius <= 2; ++comparisonRadius)
+    {
+      CPPUNIT_ASSERT_MESSAGE("NLMg with integral images differs.", CompareIntegralImageDenoising(false, false, comparisonRadius) <= 1);
+      CPPUNIT_ASSERT_MESSAGE("NLMr with integral images differs.", CompareIntegralImageDenoising(true, false, comparisonRadius) <= 1);
+      CPPUNIT_ASSERT_MESSAGE("NLMv with integral images differs.", CompareIntegralImageDenoising(false, true, comparisonRadius) <= 1);
+      CPPUNIT_ASSERT_MESSAGE("NLMvr with integral images differs.", CompareIntegralImageDenoising(true, true, comparisonRadius) <= 1);
+    }
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkNonLocalMeansDenoising)
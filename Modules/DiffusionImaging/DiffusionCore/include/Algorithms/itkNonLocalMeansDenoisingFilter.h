@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkImageToImageFilter.h"
 #include "itkVectorImage.h"
+#include <vector>
 
 
 namespace itk{
@@ -27,6 +28,14 @@ namespace itk{
    *
    * This Filter needs as an input a diffusion weigthed image, which will be denoised unsing the non-local means principle.
    * An input mask is optional to denoise only inside the mask range. All other voxels will be set to 0.
+   *
+   * If UseIntegralImages is set, the patch distances are not computed for each pair of voxels separately.
+   * Instead, for each offset in the search window the squared differences between the image and the shifted image
+   * are summed over all comparison neighborhoods at once using separable integral images. This reduces the cost
+   * per voxel from (2 * searchradius + 1)³ * (2 * comparisonradius + 1)³ to (2 * searchradius + 1)³ operations.
+   * With joint information, the squared differences of all gradient channels are summed up before they are
+   * integrated, so all channels share one integral image per offset. The results equal the direct computation
+   * up to rounding of the final normalization.
   */
 
   template< class TPixelType >
@@ -83,6 +92,12 @@ namespace itk{
      * If this flag is true the filter uses a method which is optimized for Rician distributed noise.
      */
     itkSetMacro(UseRicianAdaption, bool)
+    /**
+     * @brief Set flag to compute the patch distances with integral images
+     *
+     * Much faster, especially for larger comparison radii. Default is false.
+     */
+    itkSetMacro(UseIntegralImages, bool)
     /**
      * @brief Get the amount of calculated Voxels
      *
@@ -124,6 +139,19 @@ namespace itk{
      */
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType) override;
 
+    /**
+     * @brief Denoising procedure based on integral images of the squared patch differences
+     *
+     * @param outputRegionForThread Region to denoise for each thread.
+     */
+    void IntegralImageDenoising( const OutputImageRegionType &outputRegionForThread );
+
+    /**
+     * @brief Replaces each value of the volume by the sum over the box of the given radius around it
+     *
+     * The box is clipped at the volume borders. The sums are computed separately along each axis.
+     */
+    static void BoxSum(std::vector<double>& volume, const typename OutputImageRegionType::SizeType& size, int radius);
 
 
   private:
@@ -132,6 +160,7 @@ namespace itk{
     int m_ComparisonRadius;                           ///< Radius of the comparisonblock.
     bool m_UseJointInformation;                       ///< Flag to use joint information.
     bool m_UseRicianAdaption;                         ///< Flag to use rician adaption.
+    bool m_UseIntegralImages;                         ///< Flag to compute the patch distances with integral images.
     unsigned int m_CurrentVoxelCount;                 ///< Amount of processed voxels.
     double m_Variance;                                ///< Estimated noise variance.
     typename MaskImageType::Pointer m_Mask;           ///< Pointer to the mask image.
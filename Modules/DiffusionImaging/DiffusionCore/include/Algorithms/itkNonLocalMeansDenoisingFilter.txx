@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkNeighborhoodIterator.h"
 #include <itkImageRegionIteratorWithIndex.h>
 #include <vector>
+#include <algorithm>
 
 namespace itk {
 
@@ -39,6 +40,7 @@ NonLocalMeansDenoisingFilter< TPixelType >
     m_ComparisonRadius(1),
     m_UseJointInformation(false),
     m_UseRicianAdaption(false),
+    m_UseIntegralImages(false),
     m_Variance(1),
     m_Mask(nullptr)
 {
@@ -56,6 +58,7 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "Noisevariance: " << m_Variance;
   MITK_INFO << "Use Rician Adaption: " << std::boolalpha << m_UseRicianAdaption;
   MITK_INFO << "Use Joint Information: " << std::boolalpha << m_UseJointInformation;
+  MITK_INFO << "Use Integral Images: " << std::boolalpha << m_UseIntegralImages;
 
 
   typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
@@ -127,7 +130,24 @@ void
 NonLocalMeansDenoisingFilter< TPixelType >
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType )
 {
-
+  if (m_UseIntegralImages)
+  {
+    // denoise slabs of a few slices to limit the memory needed for the accumulated weights
+    int numChannels = this->GetInput(0)->GetVectorLength();
+    int sliceVoxels = outputRegionForThread.GetSize(0) * outputRegionForThread.GetSize(1);
+    int slabSlices = std::max(1, (1 << 22) / (sliceVoxels * (numChannels + 1)));
+    int lastSlice = outputRegionForThread.GetIndex(2) + outputRegionForThread.GetSize(2);
+    OutputImageRegionType slab = outputRegionForThread;
+    for (int z = outputRegionForThread.GetIndex(2); z < lastSlice && !this->GetAbortGenerateData(); z += slabSlices)
+    {
+      slab.SetIndex(2, z);
+      slab.SetSize(2, std::min(slabSlices, lastSlice - z));
+      IntegralImageDenoising(slab);
+      m_CurrentVoxelCount += slab.GetNumberOfPixels();
+    }
+    MITK_INFO << "One Thread finished calculation";
+    return;
+  }
 
   // initialize iterators
   typename OutputImageType::Pointer outputImage =
@@ -372,6 +392,223 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "One Thread finished calculation";
 }
 
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::BoxSum(std::vector<double>& volume, const typename OutputImageRegionType::SizeType& size, int radius)
+{
+  std::vector<double> prefix;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    int n = size[axis];
+    int stride = 1;
+    for (int a = 0; a < axis; ++a)
+    {
+      stride *= size[a];
+    }
+    int numLines = size[0] * size[1] * size[2] / n;
+    prefix.resize(n + 1);
+
+    for (int line = 0; line < numLines; ++line)
+    {
+      // start of the line: all indices except the one along the current axis
+      int start = (line / stride) * stride * n + line % stride;
+
+      // integral image along the line
+      prefix[0] = 0;
+      for (int k = 0; k < n; ++k)
+      {
+        prefix[k + 1] = prefix[k] + volume[start + k * stride];
+      }
+      for (int k = 0; k < n; ++k)
+      {
+        int first = std::max(k - radius, 0);
+        int last = std::min(k + radius, n - 1);
+        volume[start + k * stride] = prefix[last + 1] - prefix[first];
+      }
+    }
+  }
+}
+
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::IntegralImageDenoising(const OutputImageRegionType& outputRegionForThread)
+{
+  typename OutputImageType::Pointer outputImage =
+          static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
+  typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+
+  const typename InputImageType::RegionType imageRegion = inputImagePointer->GetLargestPossibleRegion();
+  const typename InputImageType::RegionType bufferedRegion = inputImagePointer->GetBufferedRegion();
+  const TPixelType* buffer = inputImagePointer->GetBufferPointer();
+  const int numChannels = inputImagePointer->GetVectorLength();
+
+  // the patch distances of the voxels of this thread need the squared differences in the surrounding region
+  OutputImageRegionType extendedRegion = outputRegionForThread;
+  extendedRegion.PadByRadius(m_ComparisonRadius);
+  extendedRegion.Crop(imageRegion);
+
+  const typename OutputImageRegionType::SizeType extendedSize = extendedRegion.GetSize();
+  const typename OutputImageRegionType::IndexType extendedStart = extendedRegion.GetIndex();
+  const typename OutputImageRegionType::SizeType regionSize = outputRegionForThread.GetSize();
+  const typename OutputImageRegionType::IndexType regionStart = outputRegionForThread.GetIndex();
+  const int numExtendedVoxels = extendedRegion.GetNumberOfPixels();
+  const int numRegionVoxels = outputRegionForThread.GetNumberOfPixels();
+
+  // offset of a voxel (in pixels) in the buffer of the input image
+  auto bufferOffset = [&](int x, int y, int z)
+  {
+    return ((z - bufferedRegion.GetIndex(2)) * (int)bufferedRegion.GetSize(1) + (y - bufferedRegion.GetIndex(1))) * (int)bufferedRegion.GetSize(0)
+        + (x - bufferedRegion.GetIndex(0));
+  };
+  auto isInside = [&](int x, int y, int z)
+  {
+    return x >= imageRegion.GetIndex(0) && x < imageRegion.GetIndex(0) + (int)imageRegion.GetSize(0)
+        && y >= imageRegion.GetIndex(1) && y < imageRegion.GetIndex(1) + (int)imageRegion.GetSize(1)
+        && z >= imageRegion.GetIndex(2) && z < imageRegion.GetIndex(2) + (int)imageRegion.GetSize(2);
+  };
+  // number of comparison offsets along one axis for which the voxel and the shifted voxel are inside the image
+  auto numValidOffsets = [&](int axis, int i, int d)
+  {
+    int first = imageRegion.GetIndex(axis);
+    int last = first + (int)imageRegion.GetSize(axis) - 1;
+    int lower = std::max(-m_ComparisonRadius, std::max(first - i, first - i - d));
+    int upper = std::min(m_ComparisonRadius, std::min(last - i, last - i - d));
+    return std::max(0, upper - lower + 1);
+  };
+
+  // with joint information, all channels share the weights
+  const int numWeights = m_UseJointInformation ? 1 : numChannels;
+  std::vector<double> sumW(numWeights * numRegionVoxels, 0.0);
+  std::vector<double> sumP(numChannels * numRegionVoxels, 0.0);
+  std::vector<double> sumk(numExtendedVoxels);
+
+  for (int dx = -m_SearchRadius; dx <= m_SearchRadius; ++dx)
+  {
+    for (int dy = -m_SearchRadius; dy <= m_SearchRadius; ++dy)
+    {
+      for (int dz = -m_SearchRadius; dz <= m_SearchRadius; ++dz)
+      {
+        if (this->GetAbortGenerateData())
+        {
+          return;
+        }
+
+        for (int c = 0; c < numWeights; ++c)
+        {
+          // squared differences between the image and the shifted image, integrated over each comparison neighborhood
+          int e = 0;
+          for (int z = extendedStart[2]; z < extendedStart[2] + (int)extendedSize[2]; ++z)
+            for (int y = extendedStart[1]; y < extendedStart[1] + (int)extendedSize[1]; ++y)
+              for (int x = extendedStart[0]; x < extendedStart[0] + (int)extendedSize[0]; ++x, ++e)
+              {
+                sumk[e] = 0;
+                if (isInside(x + dx, y + dy, z + dz))
+                {
+                  const TPixelType* pixelI = buffer + bufferOffset(x, y, z) * numChannels;
+                  const TPixelType* pixelJ = buffer + bufferOffset(x + dx, y + dy, z + dz) * numChannels;
+                  if (m_UseJointInformation)
+                  {
+                    for (int i = 0; i < numChannels; ++i)
+                    {
+                      double diff = (double)pixelI[i] - (double)pixelJ[i];
+                      sumk[e] += diff * diff;
+                    }
+                  }
+                  else
+                  {
+                    double diff = (double)pixelI[c] - (double)pixelJ[c];
+                    sumk[e] = diff * diff;
+                  }
+                }
+              }
+          BoxSum(sumk, extendedSize, m_ComparisonRadius);
+
+          // weight the shifted voxel for each voxel of the region
+          int r = 0;
+          for (int z = regionStart[2]; z < regionStart[2] + (int)regionSize[2]; ++z)
+            for (int y = regionStart[1]; y < regionStart[1] + (int)regionSize[1]; ++y)
+              for (int x = regionStart[0]; x < regionStart[0] + (int)regionSize[0]; ++x, ++r)
+              {
+                if (!isInside(x + dx, y + dy, z + dz))
+                {
+                  continue;
+                }
+                e = ((z - extendedStart[2]) * (int)extendedSize[1] + (y - extendedStart[1])) * (int)extendedSize[0] + (x - extendedStart[0]);
+                const TPixelType* pixelJ = buffer + bufferOffset(x + dx, y + dy, z + dz) * numChannels;
+
+                // number of voxel pairs of the comparison neighborhoods that are inside the image
+                double size = numValidOffsets(0, x, dx) * numValidOffsets(1, y, dy) * numValidOffsets(2, z, dz);
+
+                double w;
+                if (m_UseJointInformation)
+                {
+                  w = std::exp( - (sumk[e] / (size * (numChannels + 1))) / m_Variance);
+                }
+                else
+                {
+                  w = std::exp( - sumk[e] / size / m_Variance);
+                }
+                sumW[c * numRegionVoxels + r] += w;
+
+                int firstChannel = m_UseJointInformation ? 0 : c;
+                int lastChannel = m_UseJointInformation ? numChannels - 1 : c;
+                for (int i = firstChannel; i <= lastChannel; ++i)
+                {
+                  double p = pixelJ[i];
+                  if (m_UseRicianAdaption)
+                  {
+                    p *= p;
+                  }
+                  sumP[i * numRegionVoxels + r] += w * p;
+                }
+              }
+        }
+      }
+    }
+  }
+
+  ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
+  ImageRegionIterator< MaskImageType > mit(m_Mask, outputRegionForThread);
+  typename OutputImageType::PixelType outpix;
+  outpix.SetSize(numChannels);
+  for (int r = 0; !oit.IsAtEnd(); ++r, ++oit, ++mit)
+  {
+    if (mit.Get() == 0)
+    {
+      outpix.Fill(0);
+    }
+    else
+    {
+      for (int i = 0; i < numChannels; ++i)
+      {
+        double sumj = sumP[i * numRegionVoxels + r] / sumW[(m_UseJointInformation ? 0 : i) * numRegionVoxels + r];
+        if (m_UseRicianAdaption)
+        {
+          sumj -= 2 * m_Variance;
+        }
+        if (sumj < 0)
+        {
+          sumj = 0;
+        }
+
+        TPixelType outval;
+        if (m_UseRicianAdaption)
+        {
+          outval = std::floor(std::sqrt(sumj) + 0.5);
+        }
+        else
+        {
+          outval = std::floor(sumj + 0.5);
+        }
+        outpix.SetElement(i, outval);
+      }
+    }
+    oit.Set(outpix);
+  }
+}
+
 template< class TPixelType >
 void NonLocalMeansDenoisingFilter< TPixelType >::SetInputImage(const InputImageType* image)
 {
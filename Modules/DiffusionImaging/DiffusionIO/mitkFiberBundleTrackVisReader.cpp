@@ -29,7 +29,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itksys/SystemTools.hxx>
 #include <tinyxml.h>
 #include <vtkCleanPolyData.h>
-#include <mitkTrackvis.h>
+#include <mitkTractogramFile.h>
 #include <mitkCustomMimeType.h>
 #include "mitkDiffusionIOMimeTypes.h"
 
@@ -68,11 +68,11 @@ std::vector<itk::SmartPointer<mitk::BaseData> > mitk::FiberBundleTrackVisReader:
 
     if (ext==".trk")
     {
-      FiberBundle::Pointer mitk_fib = FiberBundle::New();
-      TrackVisFiberReader reader;
-      reader.open(this->GetInputLocation().c_str());
-      reader.read(mitk_fib.GetPointer());
+      TractogramFile reader;
+      reader.Open(filename);
+      FiberBundle::Pointer mitk_fib = reader.Read();
       result.push_back(mitk_fib.GetPointer());
+      setlocale(LC_ALL, currLocale.c_str());
       return result;
     }
 
@@ -490,6 +490,16 @@ void MetropolisHastingsSampler::ComputeEndPointProposalDistribution(EndPoint P)
     }
 }
 
+// sum up the energy of all connections and the chemical potential of all particles
+float MetropolisHastingsSampler::ComputeInternalEnergy()
+{
+    double energy = 0;
+    for (int k = 0; k < m_ParticleGrid->m_NumParticles; k++)
+        energy += m_EnergyComputer->ComputeInternalEnergy(m_ParticleGrid->GetParticle(k));
+    energy /= 2;    // each connection is counted by both of its particles
+    return energy - m_ChempotParticle*m_ParticleGrid->m_NumParticles;
+}
+
 // return number of accepted proposals
 int MetropolisHastingsSampler::GetNumAcceptedProposals()
 {
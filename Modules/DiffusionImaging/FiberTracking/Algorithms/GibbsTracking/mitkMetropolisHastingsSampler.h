@@ -51,6 +51,7 @@ public:
     int GetNumAcceptedProposals();
     void SetProbabilities(float birth, float death, float shift, float optShift, float connect);    ///< update the probabilities of the single proposals
     void PrintProposalTimes();  ///< print the state of the proposal time probes
+    float ComputeInternalEnergy();  ///< internal energy of the current particle configuration (including the chemical potential of the particles), needed to swap configurations between chains of different temperature
 
 protected:
 
@@ -31,4 +31,11 @@ TrackingDataHandler::TrackingDataHandler()
 {
 
 }
+
+void TrackingDataHandler::ProposeDirections(const std::vector< itk::Point<float, 3> >& positions, const std::vector< std::deque< TrackingDirectionType >* >& olddirs, const std::vector< itk::Index<3>* >& oldIndices, std::vector< TrackingDirectionType >& directions)
+{
+  directions.resize(positions.size());
+  for (unsigned int i=0; i<positions.size(); i++)
+    directions[i] = ProposeDirection(positions[i], *olddirs[i], *oldIndices[i]);
+}
 }
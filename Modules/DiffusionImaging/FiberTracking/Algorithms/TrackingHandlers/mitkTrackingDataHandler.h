@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkPoint.h>
 #include <itkImage.h>
 #include <deque>
+#include <vector>
 #include <MitkFiberTrackingExports.h>
 #include <boost/random/discrete_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
@@ -57,6 +58,9 @@ public:
 
   virtual TrackingDirectionType ProposeDirection(const itk::Point<float, 3>& pos, std::deque< TrackingDirectionType >& olddirs, itk::Index<3>& oldIndex) = 0;  ///< predicts next progression direction at the given position
 
+  /** Predicts the next progression directions for a batch of positions. The default implementation calls ProposeDirection for each position. Handlers with a high per-call overhead (e.g. classifiers) override this to process the whole batch at once. */
+  virtual void ProposeDirections(const std::vector< itk::Point<float, 3> >& positions, const std::vector< std::deque< TrackingDirectionType >* >& olddirs, const std::vector< itk::Index<3>* >& oldIndices, std::vector< TrackingDirectionType >& directions);
+
   virtual void InitForTracking() = 0;
   virtual itk::Vector<double, 3> GetSpacing() = 0;
   virtual itk::Point<float,3> GetOrigin() = 0;
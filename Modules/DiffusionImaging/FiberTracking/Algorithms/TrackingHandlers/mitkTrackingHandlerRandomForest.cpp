@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTrackingHandlerRandomForest.h"
 #include <itkTractDensityImageFilter.h>
 #include <mitkDiffusionPropertyHelper.h>
+#include <omp.h>
 
 namespace mitk
 {
@@ -175,185 +176,232 @@ void TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::InitForTrac
 
     m_NeedsDataInit = false;
   }
+
+  // one generator per thread so that probabilistic direction sampling needs no synchronization
+  m_ThreadRngs.clear();
+  for (int i=0; i<omp_get_max_threads(); i++)
+    m_ThreadRngs.push_back(BoostRngType(m_Rng()));
 }
 
 template< int ShOrder, int NumberOfSignalFeatures >
 vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::ProposeDirection(const itk::Point<float, 3>& pos, std::deque<vnl_vector_fixed<float, 3> >& olddirs, itk::Index<3>& oldIndex)
 {
+  std::vector< itk::Point<float, 3> > positions(1, pos);
+  std::vector< std::deque< vnl_vector_fixed<float,3> >* > dirs(1, &olddirs);
+  std::vector< itk::Index<3>* > indices(1, &oldIndex);
+  std::vector< vnl_vector_fixed<float,3> > directions;
+  ProposeDirections(positions, dirs, indices, directions);
+  return directions.at(0);
+}
 
-  vnl_vector_fixed<float,3> output_direction; output_direction.fill(0);
+template< int ShOrder, int NumberOfSignalFeatures >
+void TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::ProposeDirections(const std::vector< itk::Point<float, 3> >& positions, const std::vector< std::deque< vnl_vector_fixed<float,3> >* >& olddirs, const std::vector< itk::Index<3>* >& oldIndices, std::vector< vnl_vector_fixed<float,3> >& directions)
+{
+  int numPositions = positions.size();
+  directions.resize(numPositions);
 
-  itk::Index<3> idx;
-  m_DwiFeatureImages.at(0)->TransformPhysicalPointToIndex(pos, idx);
+  vnl_matrix_fixed<double,3,3> direction_matrix = m_DwiFeatureImages.at(0)->GetDirection().GetVnlMatrix();
+  vnl_matrix_fixed<double,3,3> inverse_direction_matrix = m_DwiFeatureImages.at(0)->GetInverseDirection().GetVnlMatrix();
 
-  bool check_last_dir = false;
-  vnl_vector_fixed<float,3> last_dir;
-  if (!olddirs.empty())
+  // determine which positions need to be classified, the others keep their last direction
+  std::vector< int > rows(numPositions, -1);
+  std::vector< vnl_vector_fixed<float,3> > last_dirs(numPositions);
+  std::vector< bool > check_last_dirs(numPositions, false);
+  int numRows = 0;
+  for (int p=0; p<numPositions; p++)
   {
-    last_dir = olddirs.back();
-    if (last_dir.magnitude()>0.5)
-      check_last_dir = true;
-  }
+    last_dirs[p].fill(0);
+    if (!olddirs[p]->empty())
+    {
+      last_dirs[p] = olddirs[p]->back();
+      if (last_dirs[p].magnitude()>0.5)
+        check_last_dirs[p] = true;
+    }
 
-  if (!m_Interpolate && oldIndex==idx)
-    return last_dir;
+    itk::Index<3> idx;
+    m_DwiFeatureImages.at(0)->TransformPhysicalPointToIndex(positions[p], idx);
+    if (!m_Interpolate && *oldIndices[p]==idx)
+      directions[p] = last_dirs[p];
+    else
+      rows[p] = numRows++;
+  }
+  if (numRows==0)
+    return;
 
-  // store feature pixel values in a vigra data type
-  vigra::MultiArray<2, float> featureData = vigra::MultiArray<2, float>( vigra::Shape2(1,m_Forest->GetNumFeatures()) );
+  // store feature pixel values of all positions in a vigra data type, one row per position
+  vigra::MultiArray<2, float> featureData = vigra::MultiArray<2, float>( vigra::Shape2(numRows,m_Forest->GetNumFeatures()) );
   featureData.init(0.0);
-  typename DwiFeatureImageType::PixelType dwiFeaturePixel = mitk::imv::GetImageValue< typename DwiFeatureImageType::PixelType >(pos, m_Interpolate, m_DwiFeatureImageInterpolator);
-  for (unsigned int f=0; f<NumberOfSignalFeatures; f++)
-    featureData(0,f) = dwiFeaturePixel[f];
-
-  vnl_matrix_fixed<double,3,3> direction_matrix = m_DwiFeatureImages.at(0)->GetDirection().GetVnlMatrix();
-  vnl_matrix_fixed<double,3,3> inverse_direction_matrix = m_DwiFeatureImages.at(0)->GetInverseDirection().GetVnlMatrix();
-
-  // append normalized previous direction(s) to feature vector
-  int i = 0;
   vnl_vector_fixed<double,3> ref; ref.fill(0); ref[0]=1;
-
-  for (auto d : olddirs)
+  for (int p=0; p<numPositions; p++)
   {
-    vnl_vector_fixed<double,3> tempD;
-    tempD[0] = d[0]; tempD[1] = d[1]; tempD[2] = d[2];
-
-    if (m_FlipX)
-        tempD[0] *= -1;
-    if (m_FlipY)
-        tempD[1] *= -1;
-    if (m_FlipZ)
-        tempD[2] *= -1;
-
-    tempD = inverse_direction_matrix * tempD;
-    last_dir[0] = tempD[0];
-    last_dir[1] = tempD[1];
-    last_dir[2] = tempD[2];
-
-    int c = 0;
-    for (int f=NumberOfSignalFeatures+3*i; f<NumberOfSignalFeatures+3*(i+1); f++)
+    int r = rows[p];
+    if (r<0)
+      continue;
+
+    typename DwiFeatureImageType::PixelType dwiFeaturePixel = mitk::imv::GetImageValue< typename DwiFeatureImageType::PixelType >(positions[p], m_Interpolate, m_DwiFeatureImageInterpolator);
+    for (unsigned int f=0; f<NumberOfSignalFeatures; f++)
+      featureData(r,f) = dwiFeaturePixel[f];
+
+    // append normalized previous direction(s) to feature vector
+    int i = 0;
+    for (auto d : *olddirs[p])
     {
-      if (dot_product(ref, tempD)<0)
-        featureData(0,f) = -tempD[c];
-      else
-        featureData(0,f) = tempD[c];
-      c++;
+      vnl_vector_fixed<double,3> tempD;
+      tempD[0] = d[0]; tempD[1] = d[1]; tempD[2] = d[2];
+
+      if (m_FlipX)
+          tempD[0] *= -1;
+      if (m_FlipY)
+          tempD[1] *= -1;
+      if (m_FlipZ)
+          tempD[2] *= -1;
+
+      tempD = inverse_direction_matrix * tempD;
+      last_dirs[p][0] = tempD[0];
+      last_dirs[p][1] = tempD[1];
+      last_dirs[p][2] = tempD[2];
+
+      int c = 0;
+      for (int f=NumberOfSignalFeatures+3*i; f<NumberOfSignalFeatures+3*(i+1); f++)
+      {
+        if (dot_product(ref, tempD)<0)
+          featureData(r,f) = -tempD[c];
+        else
+          featureData(r,f) = tempD[c];
+        c++;
+      }
+      i++;
     }
-    i++;
-  }
 
-  // additional feature images
-  if (m_AdditionalFeatureImages.size()>0)
-  {
-    int c = 0;
-    for (auto interpolator : m_AdditionalFeatureImageInterpolators.at(0))
+    // additional feature images
+    if (m_AdditionalFeatureImages.size()>0)
     {
-      float v = mitk::imv::GetImageValue<float>(pos, false, interpolator);
-      featureData(0,NumberOfSignalFeatures+m_NumPreviousDirections*3+c) = v;
-      c++;
+      int c = 0;
+      for (auto interpolator : m_AdditionalFeatureImageInterpolators.at(0))
+      {
+        float v = mitk::imv::GetImageValue<float>(positions[p], false, interpolator);
+        featureData(r,NumberOfSignalFeatures+m_NumPreviousDirections*3+c) = v;
+        c++;
+      }
     }
   }
 
-  // perform classification
-  vigra::MultiArray<2, float> probs(vigra::Shape2(1, m_Forest->GetNumClasses()));
+  // perform classification of the whole batch
+  vigra::MultiArray<2, float> probs(vigra::Shape2(numRows, m_Forest->GetNumClasses()));
   m_Forest->PredictProbabilities(featureData, probs);
 
-  vnl_vector< float > angles = m_OdfFloatDirs*last_dir;
-  vnl_vector< float > probs2; probs2.set_size(m_DirectionContainer.size()); probs2.fill(0.0); // used for probabilistic direction sampling
-  float probs_sum = 0;
+  for (int p=0; p<numPositions; p++)
+  {
+    int r = rows[p];
+    if (r<0)
+      continue;
 
-  float pNonFib = 0;     // probability that we left the white matter
-  float w = 0;           // weight of the predicted direction
+    const vnl_vector_fixed<float,3>& last_dir = last_dirs[p];
+    bool check_last_dir = check_last_dirs[p];
+    vnl_vector_fixed<float,3> output_direction; output_direction.fill(0);
 
-  for (int i=0; i<m_Forest->GetNumClasses(); i++)   // for each class (number of possible directions + out-of-wm class)
-  {
-    if (probs(0,i)>0)   // if probability of respective class is 0, do nothing
-    {
-      // get label of class (does not correspond to the loop variable i)
-      unsigned int classLabel = m_Forest->IndexToClassLabel(i);
+    vnl_vector< float > angles = m_OdfFloatDirs*last_dir;
+    vnl_vector< float > probs2; probs2.set_size(m_DirectionContainer.size()); probs2.fill(0.0); // used for probabilistic direction sampling
+    float probs_sum = 0;
 
-      if (classLabel<m_DirectionContainer.size())   // does class label correspond to a direction or to the out-of-wm class?
+    float pNonFib = 0;     // probability that we left the white matter
+    float w = 0;           // weight of the predicted direction
+
+    for (int i=0; i<m_Forest->GetNumClasses(); i++)   // for each class (number of possible directions + out-of-wm class)
+    {
+      if (probs(r,i)>0)   // if probability of respective class is 0, do nothing
       {
-        float angle = angles[classLabel];
-        float abs_angle = fabs(angle);
+        // get label of class (does not correspond to the loop variable i)
+        unsigned int classLabel = m_Forest->IndexToClassLabel(i);
 
-        if (m_Mode==MODE::PROBABILISTIC)
-        {
-          probs2[classLabel] = probs(0,i);
-          if (check_last_dir)
-            probs2[classLabel] *= abs_angle;
-          probs_sum += probs2[classLabel];
-        }
-        else if (m_Mode==MODE::DETERMINISTIC)
+        if (classLabel<m_DirectionContainer.size())   // does class label correspond to a direction or to the out-of-wm class?
         {
-          vnl_vector_fixed<float,3> d = m_DirectionContainer.at(classLabel);  // get direction vector assiciated with the respective direction index
-          if (check_last_dir)   // do we have a previous streamline direction or did we just start?
+          float angle = angles[classLabel];
+          float abs_angle = fabs(angle);
+
+          if (m_Mode==MODE::PROBABILISTIC)
           {
-            if (abs_angle>=m_AngularThreshold)         // is angle between the directions smaller than our hard threshold?
-            {
-              if (angle<0)                          // make sure we don't walk backwards
-                d *= -1;
-              float w_i = probs(0,i)*abs_angle;
-              output_direction += w_i*d; // weight contribution to output direction with its probability and the angular deviation from the previous direction
-              w += w_i;           // increase output weight of the final direction
-            }
+            probs2[classLabel] = probs(r,i);
+            if (check_last_dir)
+              probs2[classLabel] *= abs_angle;
+            probs_sum += probs2[classLabel];
           }
-          else
+          else if (m_Mode==MODE::DETERMINISTIC)
           {
-            output_direction += probs(0,i)*d;
-            w += probs(0,i);
+            vnl_vector_fixed<float,3> d = m_DirectionContainer.at(classLabel);  // get direction vector assiciated with the respective direction index
+            if (check_last_dir)   // do we have a previous streamline direction or did we just start?
+            {
+              if (abs_angle>=m_AngularThreshold)         // is angle between the directions smaller than our hard threshold?
+              {
+                if (angle<0)                          // make sure we don't walk backwards
+                  d *= -1;
+                float w_i = probs(r,i)*abs_angle;
+                output_direction += w_i*d; // weight contribution to output direction with its probability and the angular deviation from the previous direction
+                w += w_i;           // increase output weight of the final direction
+              }
+            }
+            else
+            {
+              output_direction += probs(r,i)*d;
+              w += probs(r,i);
+            }
           }
         }
+        else
+          pNonFib += probs(r,i);  // probability that we are not in the white matter anymore
       }
-      else
-        pNonFib += probs(0,i);  // probability that we are not in the white matter anymore
     }
-  }
 
 
-  if (m_Mode==MODE::PROBABILISTIC && pNonFib<0.5)
-  {
-    boost::random::discrete_distribution<int, float> dist(probs2.begin(), probs2.end());
-    int sampled_idx = 0;
-
-    for (int i=0; i<50; i++)  // we allow 50 trials to exceed m_AngularThreshold
+    if (m_Mode==MODE::PROBABILISTIC && pNonFib<0.5)
     {
-  #pragma omp critical
+      boost::random::discrete_distribution<int, float> dist(probs2.begin(), probs2.end());
+      boost::random::variate_generator<boost::random::mt19937&, boost::random::discrete_distribution<int,float>> sampler(GetThreadRng(), dist);
+      int sampled_idx = 0;
+
+      for (int i=0; i<50; i++)  // we allow 50 trials to exceed m_AngularThreshold
       {
-        boost::random::variate_generator<boost::random::mt19937&, boost::random::discrete_distribution<int,float>> sampler(m_Rng, dist);
         sampled_idx = sampler();
+        if ( probs2[sampled_idx]>0.1 && (!check_last_dir || (check_last_dir && fabs(angles[sampled_idx])>=m_AngularThreshold)) )
+          break;
       }
 
-      if ( probs2[sampled_idx]>0.1 && (!check_last_dir || (check_last_dir && fabs(angles[sampled_idx])>=m_AngularThreshold)) )
-        break;
+      output_direction = m_DirectionContainer.at(sampled_idx);
+      w = probs2[sampled_idx];
+      if (check_last_dir && angles[sampled_idx]<0)                          // make sure we don't walk backwards
+          output_direction *= -1;
     }
 
-    output_direction = m_DirectionContainer.at(sampled_idx);
-    w = probs2[sampled_idx];
-    if (check_last_dir && angles[sampled_idx]<0)                          // make sure we don't walk backwards
-        output_direction *= -1;
-  }
+    // if we did not find a suitable direction, make sure that we return (0,0,0)
+    if (pNonFib>w && w>0)
+      output_direction.fill(0.0);
+    else
+    {
+      vnl_vector_fixed<double,3> tempD;
+      tempD[0] = output_direction[0]; tempD[1] = output_direction[1]; tempD[2] = output_direction[2];
+      tempD = direction_matrix * tempD;
+      output_direction[0] = tempD[0];
+      output_direction[1] = tempD[1];
+      output_direction[2] = tempD[2];
+
+      if (m_FlipX)
+        output_direction[0] *= -1;
+      if (m_FlipY)
+        output_direction[1] *= -1;
+      if (m_FlipZ)
+        output_direction[2] *= -1;
+    }
 
-  // if we did not find a suitable direction, make sure that we return (0,0,0)
-  if (pNonFib>w && w>0)
-    output_direction.fill(0.0);
-  else
-  {
-    vnl_vector_fixed<double,3> tempD;
-    tempD[0] = output_direction[0]; tempD[1] = output_direction[1]; tempD[2] = output_direction[2];
-    tempD = direction_matrix * tempD;
-    output_direction[0] = tempD[0];
-    output_direction[1] = tempD[1];
-    output_direction[2] = tempD[2];
-
-    if (m_FlipX)
-      output_direction[0] *= -1;
-    if (m_FlipY)
-      output_direction[1] *= -1;
-    if (m_FlipZ)
-      output_direction[2] *= -1;
+    directions[p] = output_direction * w;
   }
+}
 
-  return output_direction * w;
+template< int ShOrder, int NumberOfSignalFeatures >
+typename TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::BoostRngType& TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::GetThreadRng()
+{
+  if (m_ThreadRngs.empty())
+    return m_Rng;
+  return m_ThreadRngs.at(omp_get_thread_num() % m_ThreadRngs.size());
 }
 
 template< int ShOrder, int NumberOfSignalFeatures >
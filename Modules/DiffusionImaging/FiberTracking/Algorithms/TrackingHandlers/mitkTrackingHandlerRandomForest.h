@@ -92,6 +92,7 @@ public:
 
   void InitForTracking() override;     ///< calls InputDataValidForTracking() and creates feature images
   vnl_vector_fixed<float,3> ProposeDirection(const itk::Point<float, 3>& pos, std::deque< vnl_vector_fixed<float,3> >& olddirs, itk::Index<3>& oldIndex) override;  ///< predicts next progression direction at the given position
+  void ProposeDirections(const std::vector< itk::Point<float, 3> >& positions, const std::vector< std::deque< vnl_vector_fixed<float,3> >* >& olddirs, const std::vector< itk::Index<3>* >& oldIndices, std::vector< vnl_vector_fixed<float,3> >& directions) override;  ///< classifies the features of all positions in one batch
   bool WorldToIndex(itk::Point<float, 3>& pos, itk::Index<3>& index) override;
 
   bool IsForestValid();   ///< true is forest is not null, has more than 0 trees and the correct number of features (NumberOfSignalFeatures + 3)
@@ -116,6 +117,7 @@ protected:
   void InputDataValidForTraining();       ///< Check if everything is tehere for training (raw datasets, fiber tracts)
   void InitForTraining();  ///< Generate masks if necessary, resample fibers, spherically interpolate raw DWIs
   void CalculateTrainingSamples();    ///< Calculate GM and WM features using the interpolated raw data, the WM masks and the fibers
+  BoostRngType& GetThreadRng();       ///< random number generator of the calling thread
 
   std::vector< Image::Pointer >                               m_InputDwis;                ///< original input DWI data
   mitk::TractographyForest::Pointer                           m_Forest;                   ///< random forest classifier
@@ -157,6 +159,7 @@ protected:
 
   typename DwiFeatureImageInterpolatorType::Pointer           m_DwiFeatureImageInterpolator;
   std::vector< std::vector< FloatImageInterpolatorType::Pointer > >   m_AdditionalFeatureImageInterpolators;
+  std::vector< BoostRngType >                                 m_ThreadRngs;                   ///< per-thread generators for probabilistic direction sampling, seeded from m_Rng in InitForTracking()
 };
 
 }
@@ -22,8 +22,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <boost/progress.hpp>
+#include <mitkParallelProgressDisplay.h>
 #include <mitkDiffusionFunctionCollection.h>
 #include <boost/lexical_cast.hpp>
+#include <itkImageRegionConstIteratorWithIndex.h>
 
 namespace itk{
 
@@ -110,41 +112,85 @@ std::vector< std::string > FiberExtractionFilter< PixelType >::GetPositiveLabels
 }
 
 template< class PixelType >
-void FiberExtractionFilter< PixelType >::ExtractOverlap(mitk::FiberBundle::Pointer fib)
+std::vector< unsigned char > FiberExtractionFilter< PixelType >::GetCandidateFibers(ItkInputImgType* roi, const mitk::FiberSpatialIndex* index)
 {
-  MITK_INFO << "Extracting fibers (min. overlap " << m_OverlapFraction << ")";
-  vtkSmartPointer<vtkPolyData> polydata = fib->GetFiberPolyData();
+  // world space half extent of a voxel (accounts for the image orientation)
+  double halfExtent[3];
+  for (int d=0; d<3; ++d)
+  {
+    halfExtent[d] = 0.001*index->GetCellSize();
+    for (int k=0; k<3; ++k)
+      halfExtent[d] += 0.5*std::fabs(roi->GetDirection()[d][k]*roi->GetSpacing()[k]);
+  }
 
-  std::vector< std::vector< unsigned int > > positive_ids;  // one ID vector per ROI
-  positive_ids.resize(m_RoiImages.size());
+  std::vector< unsigned char > cells(index->GetNumberOfCells(), 0);
+  itk::ImageRegionConstIteratorWithIndex< ItkInputImgType > it(roi, roi->GetLargestPossibleRegion());
+  while (!it.IsAtEnd())
+  {
+    if (it.Get()>=m_Threshold)
+    {
+      itk::Point<double, 3> p;
+      roi->TransformIndexToPhysicalPoint(it.GetIndex(), p);
+      double min[3], max[3];
+      for (int d=0; d<3; ++d)
+      {
+        min[d] = p[d] - halfExtent[d];
+        max[d] = p[d] + halfExtent[d];
+      }
+      index->MarkCells(min, max, cells);
+    }
+    ++it;
+  }
 
-  std::vector< unsigned int > negative_ids; // fibers not overlapping with ANY mask
+  std::vector< unsigned char > candidates(m_InputFiberBundle->GetNumFibers(), 0);
+  for (auto i : index->GetFibers(cells))
+    candidates[i] = 1;
+  return candidates;
+}
 
-  boost::progress_display disp(m_InputFiberBundle->GetNumFibers());
-  for (unsigned int i=0; i<m_InputFiberBundle->GetNumFibers(); i++)
+template< class PixelType >
+void FiberExtractionFilter< PixelType >::ExtractOverlap(mitk::FiberBundle::Pointer fib)
+{
+  MITK_INFO << "Extracting fibers (min. overlap " << m_OverlapFraction << ")";
+
+  // Only fibers passing through a voxel with value >= threshold can have a positive overlap.
+  // These candidates are looked up in the spatial index of the bundle and verified exactly below.
+  const mitk::FiberSpatialIndex* index = fib->GetSpatialIndex();
+  std::vector< std::vector< unsigned char > > candidates;
+  for (auto roi : m_RoiImages)
+    candidates.push_back(GetCandidateFibers(roi, index));
+
+  std::vector< int > best_roi(fib->GetNumFibers(), -1);
+  mitk::ParallelProgressDisplay disp(fib->GetNumFibers());
+#pragma omp parallel for schedule(dynamic, 100)
+  for (int i=0; i<static_cast<int>(fib->GetNumFibers()); i++)
   {
     ++disp;
-    vtkCell* cell = polydata->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
 
+    unsigned int numPoints = fib->GetNumberOfFiberPoints(static_cast<unsigned int>(i));
     float best_ol = 0;
     int best_ol_idx = -1;
     for (unsigned int m=0; m<m_RoiImages.size(); ++m)
     {
+      if (!candidates[m][static_cast<unsigned int>(i)])
+        continue;
+
       auto roi = m_RoiImages.at(m);
-      m_Interpolator->SetInputImage(roi);
       PixelType inside = 0;
       PixelType outside = 0;
-      for (int j=0; j<numPoints-1; j++)
+      for (unsigned int j=0; j+1<numPoints; j++)
       {
-        itk::Point<float, 3> startVertex = mitk::imv::GetItkPoint(points->GetPoint(j));
+        const float* p1 = fib->GetFiberPoint(static_cast<unsigned int>(i), j);
+        itk::Point<float, 3> startVertex;
+        startVertex[0] = p1[0]; startVertex[1] = p1[1]; startVertex[2] = p1[2];
         itk::Index<3> startIndex;
         itk::ContinuousIndex<float, 3> startIndexCont;
         roi->TransformPhysicalPointToIndex(startVertex, startIndex);
         roi->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
 
-        itk::Point<float, 3> endVertex = mitk::imv::GetItkPoint(points->GetPoint(j + 1));
+        const float* p2 = fib->GetFiberPoint(static_cast<unsigned int>(i), j+1);
+        itk::Point<float, 3> endVertex;
+        endVertex[0] = p2[0]; endVertex[1] = p2[1]; endVertex[2] = p2[2];
         itk::Index<3> endIndex;
         itk::ContinuousIndex<float, 3> endIndexCont;
         roi->TransformPhysicalPointToIndex(endVertex, endIndex);
@@ -169,10 +215,19 @@ void FiberExtractionFilter< PixelType >::ExtractOverlap(mitk::FiberBundle::Point
         best_ol = overlap;
       }
     }
-    if (best_ol_idx<0)
+    best_roi[static_cast<unsigned int>(i)] = best_ol_idx;
+  }
+  disp.Finish();
+
+  std::vector< std::vector< unsigned int > > positive_ids;  // one ID vector per ROI
+  positive_ids.resize(m_RoiImages.size());
+  std::vector< unsigned int > negative_ids; // fibers not overlapping with ANY mask
+  for (unsigned int i=0; i<fib->GetNumFibers(); i++)
+  {
+    if (best_roi[i]<0)
       negative_ids.push_back(i);
     else
-      positive_ids.at(best_ol_idx).push_back(i);
+      positive_ids.at(static_cast<unsigned int>(best_roi[i])).push_back(i);
   }
 
   if (!m_NoNegatives)
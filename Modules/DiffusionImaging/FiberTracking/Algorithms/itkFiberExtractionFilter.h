@@ -93,6 +93,7 @@ protected:
   ~FiberExtractionFilter() override;
 
   mitk::FiberBundle::Pointer CreateFib(std::vector< unsigned int >& ids);
+  std::vector< unsigned char > GetCandidateFibers(ItkInputImgType* roi, const mitk::FiberSpatialIndex* index); ///< Flags fibers that may pass through a ROI voxel >= threshold
   void ExtractOverlap(mitk::FiberBundle::Pointer fib);
   void ExtractEndpoints(mitk::FiberBundle::Pointer fib);
   void ExtractLabels(mitk::FiberBundle::Pointer fib);
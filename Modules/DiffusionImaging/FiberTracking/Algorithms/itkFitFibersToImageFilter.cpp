@@ -1,7 +1,8 @@
 #include "itkFitFibersToImageFilter.h"
 
-#include <boost/progress.hpp>
+#include <mitkParallelProgressDisplay.h>
 #include <mitkDiffusionFunctionCollection.h>
+#include <algorithm>
 
 namespace itk{
 
@@ -23,6 +24,7 @@ FitFibersToImageFilter::FitFibersToImageFilter()
   , m_MinWeight(1.0)
   , m_MaxWeight(1.0)
   , m_Verbose(true)
+  , m_Solver(LBFGSB)
   , m_NumUnknowns(0)
   , m_NumResiduals(0)
   , m_NumCoveredDirections(0)
@@ -43,6 +45,45 @@ FitFibersToImageFilter::~FitFibersToImageFilter()
 
 }
 
+void FitFibersToImageFilter::GetFiberIds(std::vector< unsigned int >& bundle_ids, std::vector< unsigned int >& fiber_ids)
+{
+  bundle_ids.clear();
+  fiber_ids.clear();
+  m_GroupSizes.clear();
+  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
+  {
+    m_GroupSizes.push_back(m_Tractograms.at(bundle)->GetNumFibers());
+    for (unsigned int i=0; i<m_Tractograms.at(bundle)->GetNumFibers(); ++i)
+    {
+      bundle_ids.push_back(bundle);
+      fiber_ids.push_back(i);
+    }
+  }
+}
+
+void FitFibersToImageFilter::SetSystemMatrix(std::vector< FitSparseMatrix::ColumnType >& columns)
+{
+  // the entries of each column are in fiber order; a stable sort and sequential sum of duplicate rows reproduces
+  // the accumulation order of the former serial assembly exactly
+#pragma omp parallel for schedule(dynamic, 100)
+  for (int c=0; c<static_cast<int>(columns.size()); ++c)
+  {
+    FitSparseMatrix::ColumnType& column = columns[c];
+    std::stable_sort(column.begin(), column.end(), [](const std::pair< unsigned int, double >& a, const std::pair< unsigned int, double >& b){ return a.first<b.first; });
+
+    std::size_t n = 0;
+    for (std::size_t k=0; k<column.size(); ++k)
+    {
+      if (n>0 && column[n-1].first==column[k].first)
+        column[n-1].second += column[k].second;
+      else
+        column[n++] = column[k];
+    }
+    column.resize(n);
+  }
+  A.set(m_NumResiduals, columns);
+}
+
 void FitFibersToImageFilter::CreateDiffSystem()
 {
   sz_x = m_DiffImage->GetLargestPossibleRegion().GetSize(0);
@@ -65,7 +106,6 @@ void FitFibersToImageFilter::CreateDiffSystem()
   MITK_INFO << "Num. residuals: " << m_NumResiduals;
   MITK_INFO << "Creating system ...";
 
-  A.set_size(m_NumResiduals, m_NumUnknowns);
   b.set_size(m_NumResiduals); b.fill(0.0);
 
   m_MeanTractDensity = 0;
@@ -74,100 +114,115 @@ void FitFibersToImageFilter::CreateDiffSystem()
   fiber_count = 0;
   vnl_vector<int> voxel_indicator; voxel_indicator.set_size(sz_x*sz_y*sz_z); voxel_indicator.fill(0);
 
-  unsigned int numFibers = 0;
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
-    numFibers += m_Tractograms.at(bundle)->GetNumFibers();
-  boost::progress_display disp(numFibers);
-  m_GroupSizes.clear();
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
-  {
-    vtkSmartPointer<vtkPolyData> polydata = m_Tractograms.at(bundle)->GetFiberPolyData();
-    m_GroupSizes.push_back(m_Tractograms.at(bundle)->GetNumFibers());
-    for (unsigned int i=0; i<m_Tractograms.at(bundle)->GetNumFibers(); ++i)
-    {
-      ++disp;
-      vtkCell* cell = polydata->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
+  std::vector< unsigned int > bundle_ids;
+  std::vector< unsigned int > fiber_ids;
+  GetFiberIds(bundle_ids, fiber_ids);
+  int numFibers = bundle_ids.size();
 
-      if (numPoints<2)
-        MITK_INFO << "FIBER WITH ONLY ONE POINT ENCOUNTERED!";
+  // voxels traversed by each fiber segment together with the segment length and direction
+  struct DiffSegment
+  {
+    itk::Index<3>                                 index;
+    double                                        length;
+    mitk::DiffusionSignalModel<>::GradientType    dir;
+  };
+  std::vector< std::vector< DiffSegment > > fiber_segments(numFibers);
+
+  mitk::ParallelProgressDisplay disp(numFibers);
+#pragma omp parallel for schedule(dynamic, 100)
+  for (int f=0; f<numFibers; ++f)
+  {
+    ++disp;
 
-      for (int j=0; j<numPoints-1; ++j)
-      {
-        PointType3 startVertex = mitk::imv::GetItkPoint(points->GetPoint(j));
-        itk::Index<3> startIndex;
-        itk::ContinuousIndex<float, 3> startIndexCont;
-        m_DiffImage->TransformPhysicalPointToIndex(startVertex, startIndex);
-        m_DiffImage->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
-
-        PointType3 endVertex = mitk::imv::GetItkPoint(points->GetPoint(j+1));
-        itk::Index<3> endIndex;
-        itk::ContinuousIndex<float, 3> endIndexCont;
-        m_DiffImage->TransformPhysicalPointToIndex(endVertex, endIndex);
-        m_DiffImage->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
-
-        mitk::DiffusionSignalModel<>::GradientType fiber_dir;
-        fiber_dir[0] = endVertex[0]-startVertex[0];
-        fiber_dir[1] = endVertex[1]-startVertex[1];
-        fiber_dir[2] = endVertex[2]-startVertex[2];
-        fiber_dir.Normalize();
-
-        std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(spacing, startIndex, endIndex, startIndexCont, endIndexCont);
-        for (std::pair< itk::Index<3>, double > seg : segments)
-        {
-          if (!m_DiffImage->GetLargestPossibleRegion().IsInside(seg.first) || (m_MaskImage.IsNotNull() && m_MaskImage->GetPixel(seg.first)==0))
-            continue;
+    mitk::FiberBundle* fib = m_Tractograms.at(bundle_ids[f]);
+    int numPoints = fib->GetNumberOfFiberPoints(fiber_ids[f]);
 
-          int x = seg.first[0];
-          int y = seg.first[1];
-          int z = seg.first[2];
+    if (numPoints<2)
+    {
+#pragma omp critical
+      MITK_INFO << "FIBER WITH ONLY ONE POINT ENCOUNTERED!";
+    }
 
-          mitk::DiffusionSignalModel<>::PixelType simulated_pixel = m_SignalModel->SimulateMeasurement(fiber_dir)*seg.second;
-          VectorImgType::PixelType measured_pixel = m_DiffImage->GetPixel(seg.first);
+    for (int j=0; j<numPoints-1; ++j)
+    {
+      const float* p = fib->GetFiberPoint(fiber_ids[f], j);
+      PointType3 startVertex;
+      startVertex[0] = p[0]; startVertex[1] = p[1]; startVertex[2] = p[2];
+      itk::Index<3> startIndex;
+      itk::ContinuousIndex<float, 3> startIndexCont;
+      m_DiffImage->TransformPhysicalPointToIndex(startVertex, startIndex);
+      m_DiffImage->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
+
+      p = fib->GetFiberPoint(fiber_ids[f], j+1);
+      PointType3 endVertex;
+      endVertex[0] = p[0]; endVertex[1] = p[1]; endVertex[2] = p[2];
+      itk::Index<3> endIndex;
+      itk::ContinuousIndex<float, 3> endIndexCont;
+      m_DiffImage->TransformPhysicalPointToIndex(endVertex, endIndex);
+      m_DiffImage->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
+
+      mitk::DiffusionSignalModel<>::GradientType fiber_dir;
+      fiber_dir[0] = endVertex[0]-startVertex[0];
+      fiber_dir[1] = endVertex[1]-startVertex[1];
+      fiber_dir[2] = endVertex[2]-startVertex[2];
+      fiber_dir.Normalize();
+
+      std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(spacing, startIndex, endIndex, startIndexCont, endIndexCont);
+      for (std::pair< itk::Index<3>, double > seg : segments)
+      {
+        if (!m_DiffImage->GetLargestPossibleRegion().IsInside(seg.first) || (m_MaskImage.IsNotNull() && m_MaskImage->GetPixel(seg.first)==0))
+          continue;
+        fiber_segments[f].push_back({seg.first, seg.second, fiber_dir});
+      }
+    }
+  }
+  disp.Finish();
 
-          double simulated_mean = 0;
-          double measured_mean = 0;
-          int num_nonzero_g = 0;
-          for (int g=0; g<dim_four_size; ++g)
-          {
-            if( m_SignalModel->GetGradientDirection(g).GetNorm()<mitk::eps )
-              continue;
-            simulated_mean += simulated_pixel[g];
-            measured_mean += (double)measured_pixel[g];
-            ++num_nonzero_g;
-          }
-          simulated_mean /= num_nonzero_g;
-          measured_mean /= num_nonzero_g;
-          simulated_pixel -= simulated_mean;
+  // the signal models are not necessarily thread safe (random models), so the signal is simulated in fiber order
+  std::vector< FitSparseMatrix::ColumnType > columns(m_NumUnknowns);
+  for (int f=0; f<numFibers; ++f)
+  {
+    unsigned int column = m_FitIndividualFibers ? fiber_count : bundle_ids[f];
+    for (const DiffSegment& seg : fiber_segments[f])
+    {
+      int x = seg.index[0];
+      int y = seg.index[1];
+      int z = seg.index[2];
 
-          if (voxel_indicator[x + sz_x*y + sz_x*sz_y*z]==0)
-            m_MeanSignal += measured_mean;
-          m_MeanTractDensity += simulated_mean;
-          voxel_indicator[x + sz_x*y + sz_x*sz_y*z] = 1;
+      mitk::DiffusionSignalModel<>::PixelType simulated_pixel = m_SignalModel->SimulateMeasurement(seg.dir)*seg.length;
+      VectorImgType::PixelType measured_pixel = m_DiffImage->GetPixel(seg.index);
 
-          for (int g=0; g<dim_four_size; ++g)
-          {
-            unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z + sz_x*sz_y*sz_z*g;
+      double simulated_mean = 0;
+      double measured_mean = 0;
+      int num_nonzero_g = 0;
+      for (int g=0; g<dim_four_size; ++g)
+      {
+        if( m_SignalModel->GetGradientDirection(g).GetNorm()<mitk::eps )
+          continue;
+        simulated_mean += simulated_pixel[g];
+        measured_mean += (double)measured_pixel[g];
+        ++num_nonzero_g;
+      }
+      simulated_mean /= num_nonzero_g;
+      measured_mean /= num_nonzero_g;
+      simulated_pixel -= simulated_mean;
 
-            if (m_FitIndividualFibers)
-            {
-              b[linear_index] = (double)measured_pixel[g] - measured_mean;
-              A.put(linear_index, fiber_count, A.get(linear_index, fiber_count) + simulated_pixel[g]);
-            }
-            else
-            {
-              b[linear_index] = (double)measured_pixel[g] - measured_mean;
-              A.put(linear_index, bundle, A.get(linear_index, bundle) + simulated_pixel[g]);
-            }
-          }
-        }
+      if (voxel_indicator[x + sz_x*y + sz_x*sz_y*z]==0)
+        m_MeanSignal += measured_mean;
+      m_MeanTractDensity += simulated_mean;
+      voxel_indicator[x + sz_x*y + sz_x*sz_y*z] = 1;
 
+      for (int g=0; g<dim_four_size; ++g)
+      {
+        unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z + sz_x*sz_y*sz_z*g;
+        b[linear_index] = (double)measured_pixel[g] - measured_mean;
+        columns[column].push_back(std::make_pair(linear_index, simulated_pixel[g]));
       }
-
-      ++fiber_count;
     }
+    std::vector< DiffSegment >().swap(fiber_segments[f]);
+    ++fiber_count;
   }
+  SetSystemMatrix(columns);
 
   m_NumCoveredDirections = voxel_indicator.sum();
 
@@ -234,7 +289,6 @@ void FitFibersToImageFilter::CreatePeakSystem()
   MITK_INFO << "Num. residuals: " << m_NumResiduals;
   MITK_INFO << "Creating system ...";
 
-  A.set_size(m_NumResiduals, m_NumUnknowns);
   b.set_size(m_NumResiduals); b.fill(0.0);
 
   m_MeanTractDensity = 0;
@@ -242,95 +296,104 @@ void FitFibersToImageFilter::CreatePeakSystem()
   m_NumCoveredDirections = 0;
   fiber_count = 0;
 
-  m_GroupSizes.clear();
+  std::vector< unsigned int > bundle_ids;
+  std::vector< unsigned int > fiber_ids;
+  GetFiberIds(bundle_ids, fiber_ids);
+  int numFibers = bundle_ids.size();
 
-  int numFibers = 0;
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
-    numFibers += m_Tractograms.at(bundle)->GetNumFibers();
-  boost::progress_display disp(numFibers);
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
+  std::vector< std::vector< SystemEntry > > fiber_entries(numFibers);
+
+  mitk::ParallelProgressDisplay disp(numFibers);
+#pragma omp parallel for schedule(dynamic, 100)
+  for (int f=0; f<numFibers; ++f)
   {
-    vtkSmartPointer<vtkPolyData> polydata = m_Tractograms.at(bundle)->GetFiberPolyData();
+    ++disp;
 
-    m_GroupSizes.push_back(m_Tractograms.at(bundle)->GetNumFibers());
-    for (unsigned int i=0; i<m_Tractograms.at(bundle)->GetNumFibers(); ++i)
-    {
-      ++disp;
-      vtkCell* cell = polydata->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
+    mitk::FiberBundle* fib = m_Tractograms.at(bundle_ids[f]);
+    int numPoints = fib->GetNumberOfFiberPoints(fiber_ids[f]);
 
-      if (numPoints<2)
-        MITK_INFO << "FIBER WITH ONLY ONE POINT ENCOUNTERED!";
+    if (numPoints<2)
+    {
+#pragma omp critical
+      MITK_INFO << "FIBER WITH ONLY ONE POINT ENCOUNTERED!";
+    }
 
-      for (int j=0; j<numPoints-1; ++j)
+    for (int j=0; j<numPoints-1; ++j)
+    {
+      const float* p = fib->GetFiberPoint(fiber_ids[f], j);
+      PointType3 startVertex;
+      startVertex[0] = p[0]; startVertex[1] = p[1]; startVertex[2] = p[2];
+      itk::Index<3> startIndex;
+      itk::ContinuousIndex<float, 3> startIndexCont;
+      m_MaskImage->TransformPhysicalPointToIndex(startVertex, startIndex);
+      m_MaskImage->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
+
+      p = fib->GetFiberPoint(fiber_ids[f], j+1);
+      PointType3 endVertex;
+      endVertex[0] = p[0]; endVertex[1] = p[1]; endVertex[2] = p[2];
+      itk::Index<3> endIndex;
+      itk::ContinuousIndex<float, 3> endIndexCont;
+      m_MaskImage->TransformPhysicalPointToIndex(endVertex, endIndex);
+      m_MaskImage->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
+
+      vnl_vector_fixed<float,3> fiber_dir;
+      fiber_dir[0] = endVertex[0]-startVertex[0];
+      fiber_dir[1] = endVertex[1]-startVertex[1];
+      fiber_dir[2] = endVertex[2]-startVertex[2];
+      fiber_dir.normalize();
+
+      std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(spacing, startIndex, endIndex, startIndexCont, endIndexCont);
+      for (std::pair< itk::Index<3>, double > seg : segments)
       {
-        PointType3 startVertex = mitk::imv::GetItkPoint(points->GetPoint(j));
-        itk::Index<3> startIndex;
-        itk::ContinuousIndex<float, 3> startIndexCont;
-        m_MaskImage->TransformPhysicalPointToIndex(startVertex, startIndex);
-        m_MaskImage->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
-
-        PointType3 endVertex = mitk::imv::GetItkPoint(points->GetPoint(j+1));
-        itk::Index<3> endIndex;
-        itk::ContinuousIndex<float, 3> endIndexCont;
-        m_MaskImage->TransformPhysicalPointToIndex(endVertex, endIndex);
-        m_MaskImage->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
-
-        vnl_vector_fixed<float,3> fiber_dir;
-        fiber_dir[0] = endVertex[0]-startVertex[0];
-        fiber_dir[1] = endVertex[1]-startVertex[1];
-        fiber_dir[2] = endVertex[2]-startVertex[2];
-        fiber_dir.normalize();
-
-        std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(spacing, startIndex, endIndex, startIndexCont, endIndexCont);
-        for (std::pair< itk::Index<3>, double > seg : segments)
-        {
-          if (!m_MaskImage->GetLargestPossibleRegion().IsInside(seg.first) || m_MaskImage->GetPixel(seg.first)==0)
-            continue;
-
-          itk::Index<4> idx4;
-          idx4[0]=seg.first[0];
-          idx4[1]=seg.first[1];
-          idx4[2]=seg.first[2];
-          idx4[3]=0;
-
-          double w = 1;
-          int peak_id = dim_four_size-1;
+        if (!m_MaskImage->GetLargestPossibleRegion().IsInside(seg.first) || m_MaskImage->GetPixel(seg.first)==0)
+          continue;
 
-          double peak_mag = 0;
-          GetClosestPeak(idx4, m_PeakImage, fiber_dir, peak_id, w, peak_mag);
-          w *= seg.second;
+        itk::Index<4> idx4;
+        idx4[0]=seg.first[0];
+        idx4[1]=seg.first[1];
+        idx4[2]=seg.first[2];
+        idx4[3]=0;
 
-          int x = idx4[0];
-          int y = idx4[1];
-          int z = idx4[2];
+        double w = 1;
+        int peak_id = dim_four_size-1;
 
-          unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z + sz_x*sz_y*sz_z*peak_id;
+        double peak_mag = 0;
+        GetClosestPeak(idx4, m_PeakImage, fiber_dir, peak_id, w, peak_mag);
+        w *= seg.second;
 
-          if (b[linear_index] == 0 && peak_id<dim_four_size-1)
-          {
-            m_NumCoveredDirections++;
-            m_MeanSignal += peak_mag;
-          }
-          m_MeanTractDensity += w;
+        int x = idx4[0];
+        int y = idx4[1];
+        int z = idx4[2];
 
-          if (m_FitIndividualFibers)
-          {
-            b[linear_index] = peak_mag;
-            A.put(linear_index, fiber_count, A.get(linear_index, fiber_count) + w);
-          }
-          else
-          {
-            b[linear_index] = peak_mag;
-            A.put(linear_index, bundle, A.get(linear_index, bundle) + w);
-          }
-        }
+        unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z + sz_x*sz_y*sz_z*peak_id;
+        fiber_entries[f].push_back({linear_index, w, peak_mag});
       }
+    }
+  }
+  disp.Finish();
 
-      ++fiber_count;
+  // merge in fiber order
+  unsigned int peak_offset = sz_x*sz_y*sz_z*(dim_four_size-1);
+  std::vector< FitSparseMatrix::ColumnType > columns(m_NumUnknowns);
+  for (int f=0; f<numFibers; ++f)
+  {
+    unsigned int column = m_FitIndividualFibers ? fiber_count : bundle_ids[f];
+    for (const SystemEntry& e : fiber_entries[f])
+    {
+      if (b[e.row] == 0 && e.row<peak_offset)
+      {
+        m_NumCoveredDirections++;
+        m_MeanSignal += e.b;
+      }
+      m_MeanTractDensity += e.a;
+      b[e.row] = e.b;
+      columns[column].push_back(std::make_pair(e.row, e.a));
     }
+    std::vector< SystemEntry >().swap(fiber_entries[f]);
+    ++fiber_count;
   }
+  SetSystemMatrix(columns);
+
   m_MeanTractDensity /= (m_NumCoveredDirections*fiber_count);
   m_MeanSignal /= m_NumCoveredDirections;
   A /= m_MeanTractDensity;
@@ -363,7 +426,6 @@ void FitFibersToImageFilter::CreateScalarSystem()
   MITK_INFO << "Num. residuals: " << m_NumResiduals;
   MITK_INFO << "Creating system ...";
 
-  A.set_size(m_NumResiduals, m_NumUnknowns);
   b.set_size(m_NumResiduals); b.fill(0.0);
 
   m_MeanTractDensity = 0;
@@ -371,73 +433,79 @@ void FitFibersToImageFilter::CreateScalarSystem()
   int numCoveredVoxels = 0;
   fiber_count = 0;
 
-  int numFibers = 0;
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
-    numFibers += m_Tractograms.at(bundle)->GetNumFibers();
-  boost::progress_display disp(numFibers);
-  m_GroupSizes.clear();
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
-  {
-    vtkSmartPointer<vtkPolyData> polydata = m_Tractograms.at(bundle)->GetFiberPolyData();
+  std::vector< unsigned int > bundle_ids;
+  std::vector< unsigned int > fiber_ids;
+  GetFiberIds(bundle_ids, fiber_ids);
+  int numFibers = bundle_ids.size();
 
-    m_GroupSizes.push_back(m_Tractograms.at(bundle)->GetNumFibers());
-    for (unsigned int i=0; i<m_Tractograms.at(bundle)->GetNumFibers(); ++i)
-    {
-      ++disp;
-      vtkCell* cell = polydata->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
+  std::vector< std::vector< SystemEntry > > fiber_entries(numFibers);
 
-      for (int j=0; j<numPoints-1; ++j)
-      {
-        PointType3 startVertex = mitk::imv::GetItkPoint(points->GetPoint(j));
-        itk::Index<3> startIndex;
-        itk::ContinuousIndex<float, 3> startIndexCont;
-        m_ScalarImage->TransformPhysicalPointToIndex(startVertex, startIndex);
-        m_ScalarImage->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
-
-        PointType3 endVertex = mitk::imv::GetItkPoint(points->GetPoint(j+1));
-        itk::Index<3> endIndex;
-        itk::ContinuousIndex<float, 3> endIndexCont;
-        m_ScalarImage->TransformPhysicalPointToIndex(endVertex, endIndex);
-        m_ScalarImage->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
-
-        std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(spacing, startIndex, endIndex, startIndexCont, endIndexCont);
-        for (std::pair< itk::Index<3>, double > seg : segments)
-        {
-          if (!m_ScalarImage->GetLargestPossibleRegion().IsInside(seg.first) || (m_MaskImage.IsNotNull() && m_MaskImage->GetPixel(seg.first)==0))
-            continue;
+  mitk::ParallelProgressDisplay disp(numFibers);
+#pragma omp parallel for schedule(dynamic, 100)
+  for (int f=0; f<numFibers; ++f)
+  {
+    ++disp;
 
-          float image_value = m_ScalarImage->GetPixel(seg.first);
-          int x = seg.first[0];
-          int y = seg.first[1];
-          int z = seg.first[2];
+    mitk::FiberBundle* fib = m_Tractograms.at(bundle_ids[f]);
+    int numPoints = fib->GetNumberOfFiberPoints(fiber_ids[f]);
 
-          unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z;
+    for (int j=0; j<numPoints-1; ++j)
+    {
+      const float* p = fib->GetFiberPoint(fiber_ids[f], j);
+      PointType3 startVertex;
+      startVertex[0] = p[0]; startVertex[1] = p[1]; startVertex[2] = p[2];
+      itk::Index<3> startIndex;
+      itk::ContinuousIndex<float, 3> startIndexCont;
+      m_ScalarImage->TransformPhysicalPointToIndex(startVertex, startIndex);
+      m_ScalarImage->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
+
+      p = fib->GetFiberPoint(fiber_ids[f], j+1);
+      PointType3 endVertex;
+      endVertex[0] = p[0]; endVertex[1] = p[1]; endVertex[2] = p[2];
+      itk::Index<3> endIndex;
+      itk::ContinuousIndex<float, 3> endIndexCont;
+      m_ScalarImage->TransformPhysicalPointToIndex(endVertex, endIndex);
+      m_ScalarImage->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
+
+      std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(spacing, startIndex, endIndex, startIndexCont, endIndexCont);
+      for (std::pair< itk::Index<3>, double > seg : segments)
+      {
+        if (!m_ScalarImage->GetLargestPossibleRegion().IsInside(seg.first) || (m_MaskImage.IsNotNull() && m_MaskImage->GetPixel(seg.first)==0))
+          continue;
 
-          if (b[linear_index] == 0)
-          {
-            numCoveredVoxels++;
-            m_MeanSignal += image_value;
-          }
-          m_MeanTractDensity += seg.second;
+        float image_value = m_ScalarImage->GetPixel(seg.first);
+        int x = seg.first[0];
+        int y = seg.first[1];
+        int z = seg.first[2];
 
-          if (m_FitIndividualFibers)
-          {
-            b[linear_index] = image_value;
-            A.put(linear_index, fiber_count, A.get(linear_index, fiber_count) + seg.second);
-          }
-          else
-          {
-            b[linear_index] = image_value;
-            A.put(linear_index, bundle, A.get(linear_index, bundle) + seg.second);
-          }
-        }
+        unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z;
+        fiber_entries[f].push_back({linear_index, seg.second, image_value});
       }
+    }
+  }
+  disp.Finish();
 
-      ++fiber_count;
+  // merge in fiber order
+  std::vector< FitSparseMatrix::ColumnType > columns(m_NumUnknowns);
+  for (int f=0; f<numFibers; ++f)
+  {
+    unsigned int column = m_FitIndividualFibers ? fiber_count : bundle_ids[f];
+    for (const SystemEntry& e : fiber_entries[f])
+    {
+      if (b[e.row] == 0)
+      {
+        numCoveredVoxels++;
+        m_MeanSignal += e.b;
+      }
+      m_MeanTractDensity += e.a;
+      b[e.row] = e.b;
+      columns[column].push_back(std::make_pair(e.row, e.a));
     }
+    std::vector< SystemEntry >().swap(fiber_entries[f]);
+    ++fiber_count;
   }
+  SetSystemMatrix(columns);
+
   m_MeanTractDensity /= (numCoveredVoxels*fiber_count);
   m_MeanSignal /= numCoveredVoxels;
   A /= m_MeanTractDensity;
@@ -548,8 +616,14 @@ void FitFibersToImageFilter::GenerateData()
   MITK_INFO << "Fitting fibers";
   minimizer.set_trace(m_Verbose);
 
-  minimizer.set_max_function_evals(m_MaxIterations);
-  minimizer.minimize(m_Weights);
+  unsigned int num_iterations = 0;
+  if (m_Solver==PROJECTED_GRADIENT)
+    num_iterations = MinimizeProjectedGradient(m_Weights, nullptr);
+  else
+  {
+    minimizer.set_max_function_evals(m_MaxIterations);
+    minimizer.minimize(m_Weights);
+  }
 
   std::vector< double > weights;
   if (m_FilterOutliers)
@@ -559,10 +633,15 @@ void FitFibersToImageFilter::GenerateData()
     std::sort(weights.begin(), weights.end());
     MITK_INFO << "Setting upper weight bound to " << weights.at(m_NumUnknowns*0.99);
     vnl_vector<double> u; u.set_size(m_NumUnknowns); u.fill(weights.at(m_NumUnknowns*0.99));
-    minimizer.set_upper_bound(u);
-    bound_selection.fill(2);
-    minimizer.set_bound_selection(bound_selection);
-    minimizer.minimize(m_Weights);
+    if (m_Solver==PROJECTED_GRADIENT)
+      num_iterations += MinimizeProjectedGradient(m_Weights, &u);
+    else
+    {
+      minimizer.set_upper_bound(u);
+      bound_selection.fill(2);
+      minimizer.set_bound_selection(bound_selection);
+      minimizer.minimize(m_Weights);
+    }
     weights.clear();
   }
 
@@ -589,10 +668,18 @@ void FitFibersToImageFilter::GenerateData()
   MITK_INFO << "Min: " << m_MinWeight;
   MITK_INFO << "Max: " << m_MaxWeight;
   MITK_INFO << "*************************";
-  MITK_INFO << "NumEvals: " << minimizer.get_num_evaluations();
-  MITK_INFO << "NumIterations: " << minimizer.get_num_iterations();
-  MITK_INFO << "Residual cost: " << minimizer.get_end_error();
-  m_RMSE = cost.S->get_rms_error(m_Weights);
+  if (m_Solver==PROJECTED_GRADIENT)
+  {
+    MITK_INFO << "NumIterations: " << num_iterations;
+    MITK_INFO << "Residual cost: " << cost.f(m_Weights);
+  }
+  else
+  {
+    MITK_INFO << "NumEvals: " << minimizer.get_num_evaluations();
+    MITK_INFO << "NumIterations: " << minimizer.get_num_iterations();
+    MITK_INFO << "Residual cost: " << minimizer.get_end_error();
+  }
+  m_RMSE = cost.GetRmsError(m_Weights);
   MITK_INFO << "Final RMSE: " << m_RMSE;
 
   clock.Stop();
@@ -622,7 +709,7 @@ void FitFibersToImageFilter::GenerateData()
 
         ++fiber_count;
       }
-      double d_rms = cost.S->get_rms_error(temp_weights) - m_RMSE;
+      double d_rms = cost.GetRmsError(temp_weights) - m_RMSE;
       m_RmsDiffPerBundle[bundle] = d_rms;
     }
   }
@@ -634,7 +721,7 @@ void FitFibersToImageFilter::GenerateData()
       temp_weights.set_size(m_Weights.size());
       temp_weights.copy_in(m_Weights.data_block());
       temp_weights[i] = 0;
-      double d_rms = cost.S->get_rms_error(temp_weights) - m_RMSE;
+      double d_rms = cost.GetRmsError(temp_weights) - m_RMSE;
       m_RmsDiffPerBundle[i] = d_rms;
 
       m_Tractograms.at(i)->SetFiberWeights(m_Weights[i]);
@@ -661,6 +748,73 @@ void FitFibersToImageFilter::GenerateData()
   MITK_INFO << std::fixed << "Overshoot: " << setprecision(2) << 100.0*m_Overshoot << "%";
 }
 
+unsigned int FitFibersToImageFilter::MinimizeProjectedGradient(vnl_vector<double>& x, const vnl_vector<double>* upper)
+{
+  // spectral (Barzilai-Borwein) projected gradient with Armijo backtracking on the feasible set 0 <= x <= upper
+  int n = x.size();
+  auto project = [&](vnl_vector<double>& v)
+  {
+#pragma omp parallel for
+    for (int i=0; i<n; ++i)
+    {
+      if (v[i]<0)
+        v[i] = 0;
+      else if (upper!=nullptr && v[i]>(*upper)[i])
+        v[i] = (*upper)[i];
+    }
+  };
+
+  project(x);
+  vnl_vector<double> g; g.set_size(n);
+  vnl_vector<double> x_new; x_new.set_size(n);
+  vnl_vector<double> g_new; g_new.set_size(n);
+  double fx = cost.f(x);
+  cost.gradf(x, g);
+
+  double alpha = 1.0/std::max(g.inf_norm(), mitk::eps);
+  unsigned int iteration = 0;
+  for (; iteration<static_cast<unsigned int>(m_MaxIterations); ++iteration)
+  {
+    // infinity norm of the projected gradient
+    x_new = x - g;
+    project(x_new);
+    double pg_norm = (x_new - x).inf_norm();
+    if (m_Verbose)
+      MITK_INFO << "Iteration " << iteration << ": cost " << fx << ", projected gradient " << pg_norm;
+    if (pg_norm<m_GradientTolerance)
+      break;
+
+    double step = alpha;
+    double f_new = fx;
+    bool decreased = false;
+    for (int ls=0; ls<30 && !decreased; ++ls)
+    {
+      x_new = x - step*g;
+      project(x_new);
+      f_new = cost.f(x_new);
+      decreased = f_new <= fx + 1e-4*dot_product(g, x_new - x);
+      if (!decreased)
+        step *= 0.5;
+    }
+    if (!decreased)
+      break;
+
+    cost.gradf(x_new, g_new);
+    vnl_vector<double> s = x_new - x;
+    vnl_vector<double> y = g_new - g;
+    double ss = dot_product(s, s);
+    double sy = dot_product(s, y);
+    alpha = sy>0 ? std::min(1e10, std::max(1e-10, ss/sy)) : 2*step;
+
+    x.swap(x_new);
+    g.swap(g_new);
+    fx = f_new;
+    if (ss==0)
+      break;
+  }
+  return iteration;
+}
+
 void FitFibersToImageFilter::GenerateOutputDiffImages()
 {
   VectorImgType::PixelType pix; pix.SetSize(m_DiffImage->GetVectorLength()); pix.Fill(0);
@@ -686,7 +840,7 @@ void FitFibersToImageFilter::GenerateOutputDiffImages()
   m_FittedImageDiff->FillBuffer(pix);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.mult(m_Weights, fitted_b);
 
   itk::ImageRegionIterator<VectorImgType> it1 = itk::ImageRegionIterator<VectorImgType>(m_DiffImage, m_DiffImage->GetLargestPossibleRegion());
   itk::ImageRegionIterator<VectorImgType> it2 = itk::ImageRegionIterator<VectorImgType>(m_FittedImageDiff, m_FittedImageDiff->GetLargestPossibleRegion());
@@ -777,7 +931,7 @@ void FitFibersToImageFilter::GenerateOutputScalarImages()
   m_FittedImageScalar->FillBuffer(0);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.mult(m_Weights, fitted_b);
 
   itk::ImageRegionIterator<DoubleImgType> it1 = itk::ImageRegionIterator<DoubleImgType>(m_ScalarImage, m_ScalarImage->GetLargestPossibleRegion());
   itk::ImageRegionIterator<DoubleImgType> it2 = itk::ImageRegionIterator<DoubleImgType>(m_FittedImageScalar, m_FittedImageScalar->GetLargestPossibleRegion());
@@ -863,7 +1017,7 @@ void FitFibersToImageFilter::GenerateOutputPeakImages()
   m_FittedImage->FillBuffer(0.0);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.mult(m_Weights, fitted_b);
 
   for (unsigned int r=0; r<b.size(); r++)
   {
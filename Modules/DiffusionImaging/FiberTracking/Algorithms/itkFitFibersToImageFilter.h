@@ -6,14 +6,137 @@
 #include <itkImageSource.h>
 #include <mitkPeakImage.h>
 #include <vnl/algo/vnl_lbfgsb.h>
-#include <vnl/vnl_sparse_matrix.h>
-#include <vnl/vnl_sparse_matrix_linear_system.h>
 #include <itkImageDuplicator.h>
 #include <itkTimeProbe.h>
 #include <itkMersenneTwisterRandomVariateGenerator.h>
 #include <mitkDiffusionPropertyHelper.h>
 #include <mitkDiffusionSignalModel.h>
 
+/**
+* \brief Sparse system matrix of the fiber fit stored in compressed row AND compressed column format.
+*
+* The matrix is assembled once and multiplied in every cost function evaluation. Keeping both layouts allows computing
+* A*x (over rows) and A^T*x (over columns) in parallel without write conflicts. The summation order of each element
+* equals the one of vnl_sparse_matrix::mult and vnl_sparse_matrix::pre_mult. */
+class FitSparseMatrix
+{
+public:
+
+  typedef std::vector< std::pair< unsigned int, double > > ColumnType;
+
+  FitSparseMatrix() : m_Rows(0), m_Cols(0) {}
+
+  unsigned int rows() const { return m_Rows; }
+  unsigned int cols() const { return m_Cols; }
+  std::size_t nonzeros() const { return m_RowValues.size(); }
+
+  // each column has to be sorted by row index without duplicate rows; the columns are cleared
+  void set(unsigned int rows, std::vector< ColumnType >& columns)
+  {
+    m_Rows = rows;
+    m_Cols = static_cast<unsigned int>(columns.size());
+
+    m_ColOffsets.assign(m_Cols+1, 0);
+    m_RowOffsets.assign(m_Rows+1, 0);
+    for (unsigned int c=0; c<m_Cols; ++c)
+    {
+      m_ColOffsets[c+1] = m_ColOffsets[c] + columns[c].size();
+      for (const auto& e : columns[c])
+        m_RowOffsets[e.first+1]++;
+    }
+    for (unsigned int r=0; r<m_Rows; ++r)
+      m_RowOffsets[r+1] += m_RowOffsets[r];
+
+    m_RowIds.resize(m_ColOffsets.back());
+    m_ColValues.resize(m_ColOffsets.back());
+    m_ColumnIds.resize(m_ColOffsets.back());
+    m_RowValues.resize(m_ColOffsets.back());
+    std::vector< std::size_t > cursor(m_RowOffsets.begin(), m_RowOffsets.end()-1);
+    for (unsigned int c=0; c<m_Cols; ++c)
+    {
+      std::size_t k = m_ColOffsets[c];
+      for (const auto& e : columns[c])
+      {
+        m_RowIds[k] = e.first;
+        m_ColValues[k++] = e.second;
+        std::size_t pos = cursor[e.first]++;
+        m_ColumnIds[pos] = c;
+        m_RowValues[pos] = e.second;
+      }
+      ColumnType().swap(columns[c]);
+    }
+  }
+
+  // y = A*x
+  void mult(vnl_vector<double> const &x, vnl_vector<double> &y) const
+  {
+    y.set_size(m_Rows);
+#pragma omp parallel for schedule(dynamic, 1000)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+    {
+      double sum = 0;
+      for (std::size_t k=m_RowOffsets[r]; k<m_RowOffsets[r+1]; ++k)
+        sum += m_RowValues[k] * x[m_ColumnIds[k]];
+      y[r] = sum;
+    }
+  }
+
+  // y = A^T*x
+  void pre_mult(vnl_vector<double> const &x, vnl_vector<double> &y) const
+  {
+    y.set_size(m_Cols);
+#pragma omp parallel for schedule(dynamic, 1000)
+    for (int c=0; c<static_cast<int>(m_Cols); ++c)
+    {
+      double sum = 0;
+      for (std::size_t k=m_ColOffsets[c]; k<m_ColOffsets[c+1]; ++k)
+        sum += m_ColValues[k] * x[m_RowIds[k]];
+      y[c] = sum;
+    }
+  }
+
+  // y = P*x, where P is the sparsity pattern of A (all entries set to 1)
+  void mult_pattern(vnl_vector<double> const &x, vnl_vector<double> &y) const
+  {
+    y.set_size(m_Rows);
+#pragma omp parallel for schedule(dynamic, 1000)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+    {
+      double sum = 0;
+      for (std::size_t k=m_RowOffsets[r]; k<m_RowOffsets[r+1]; ++k)
+        sum += x[m_ColumnIds[k]];
+      y[r] = sum;
+    }
+  }
+
+  FitSparseMatrix& operator*=(double s)
+  {
+    for (auto& v : m_RowValues)
+      v *= s;
+    for (auto& v : m_ColValues)
+      v *= s;
+    return *this;
+  }
+
+  FitSparseMatrix& operator/=(double s)
+  {
+    for (auto& v : m_RowValues)
+      v /= s;
+    for (auto& v : m_ColValues)
+      v /= s;
+    return *this;
+  }
+
+  unsigned int                  m_Rows;
+  unsigned int                  m_Cols;
+  std::vector< std::size_t >    m_RowOffsets;
+  std::vector< unsigned int >   m_ColumnIds;
+  std::vector< double >         m_RowValues;
+  std::vector< std::size_t >    m_ColOffsets;
+  std::vector< unsigned int >   m_RowIds;
+  std::vector< double >         m_ColValues;
+};
+
 class VnlCostFunction : public vnl_cost_function
 {
 public:
@@ -29,9 +152,7 @@ public:
     NONE
   };
 
-  vnl_sparse_matrix_linear_system< double >* S;
-  vnl_sparse_matrix< double > m_A;
-  vnl_sparse_matrix< double > m_A_Ones; // matrix indicating active weights with 1
+  const FitSparseMatrix* m_A;
   vnl_vector< double > m_b;
   double m_Lambda;  // regularization factor
 
@@ -40,40 +161,42 @@ public:
   REGU regularization;
   std::vector<unsigned int> group_sizes;
 
-  void SetProblem(vnl_sparse_matrix< double >& A, vnl_vector<double>& b, double lambda, REGU regu)
+  void SetProblem(const FitSparseMatrix& A, vnl_vector<double>& b, double lambda, REGU regu)
   {
-    S = new vnl_sparse_matrix_linear_system<double>(A, b);
-    m_A = A;
+    m_A = &A;
     m_b = b;
     m_Lambda = lambda;
 
-    m_A_Ones.set_size(m_A.rows(), m_A.cols());
-    m_A.reset();
-    while (m_A.next())
-      m_A_Ones.put(m_A.getrow(), m_A.getcolumn(), 1);
-
     unsigned int N = m_b.size();
-    vnl_vector<double> ones; ones.set_size(dim); ones.fill(1.0);
     row_sums.set_size(N);
-    m_A_Ones.mult(ones, row_sums);
+    for (unsigned int r=0; r<N; ++r)
+      row_sums[r] = m_A->m_RowOffsets[r+1] - m_A->m_RowOffsets[r];
     local_weight_means.set_size(N);
     regularization = regu;
   }
 
+  double GetRmsError(vnl_vector<double> const &x)
+  {
+    vnl_vector<double> d; d.set_size(m_b.size());
+    m_A->mult(x,d);
+    d -= m_b;
+    return d.rms();
+  }
+
   void SetGroupSizes(std::vector<unsigned int> sizes)
   {
     unsigned int sum = 0;
     for (auto s : sizes)
       sum += s;
-    if (sum!=m_A.cols())
+    if (sum!=m_A->cols())
     {
-      MITK_INFO << "Group sizes do not match number of unknowns (" << sum << " vs. " << m_A.cols() << ")";
+      MITK_INFO << "Group sizes do not match number of unknowns (" << sum << " vs. " << m_A->cols() << ")";
       return;
     }
     group_sizes = sizes;
   }
 
-  VnlCostFunction(const int NumVars=0) : vnl_cost_function(NumVars)
+  VnlCostFunction(const int NumVars=0) : vnl_cost_function(NumVars), m_A(nullptr)
   {
   }
 
@@ -121,20 +244,27 @@ public:
   // Regularization: voxel-weise mean squared deaviation of weights from voxel-wise mean weight (enforce locally uniform weights)
   void regu_VoxelVariance(vnl_vector<double> const &x, double& cost)
   {
-    m_A_Ones.mult(x, local_weight_means);
+    m_A->mult_pattern(x, local_weight_means);
     local_weight_means = element_quotient(local_weight_means, row_sums);
 
-    m_A_Ones.reset();
+    // squared deviations are computed in parallel and summed up in the original (row major) order
+    std::vector< double > sq(m_A->nonzeros());
+#pragma omp parallel for schedule(dynamic, 1000)
+    for (int r=0; r<static_cast<int>(m_A->rows()); ++r)
+      for (std::size_t k=m_A->m_RowOffsets[r]; k<m_A->m_RowOffsets[r+1]; ++k)
+      {
+        unsigned int c = m_A->m_ColumnIds[k];
+        double d = 0;
+        if (x[c]>local_weight_means[r])
+          d = std::exp(x[c]) - std::exp(local_weight_means[r]);
+        else
+          d = x[c] - local_weight_means[r];
+        sq[k] = d*d;
+      }
+
     double regu = 0;
-    while (m_A_Ones.next())
-    {
-      double d = 0;
-      if (x[m_A_Ones.getcolumn()]>local_weight_means[m_A_Ones.getrow()])
-        d = std::exp(x[m_A_Ones.getcolumn()]) - std::exp(local_weight_means[m_A_Ones.getrow()]);
-      else
-        d = x[m_A_Ones.getcolumn()] - local_weight_means[m_A_Ones.getrow()];
-      regu += d*d;
-    }
+    for (auto d : sq)
+      regu += d;
     cost += m_Lambda*regu/dim;
   }
 
@@ -195,24 +325,23 @@ public:
 
   void grad_regu_VoxelVariance(vnl_vector<double> const &x, vnl_vector<double> &dx)
   {
-    m_A_Ones.mult(x, local_weight_means);
+    m_A->mult_pattern(x, local_weight_means);
     local_weight_means = element_quotient(local_weight_means, row_sums);
 
     vnl_vector<double> exp_x = x.apply(std::exp);
     vnl_vector<double> exp_means = local_weight_means.apply(std::exp);
 
     vnl_vector<double> tdx(dim, 0);
-    m_A_Ones.reset();
-    while (m_A_Ones.next())
-    {
-      int c = m_A_Ones.getcolumn();
-      int r = m_A_Ones.getrow();
-
-      if (x[c]>local_weight_means[r])
-        tdx[c] += exp_x[c] * ( exp_x[c] - exp_means[r] );
-      else
-        tdx[c] += x[c] - local_weight_means[r];
-    }
+#pragma omp parallel for schedule(dynamic, 1000)
+    for (int c=0; c<dim; ++c)
+      for (std::size_t k=m_A->m_ColOffsets[c]; k<m_A->m_ColOffsets[c+1]; ++k)
+      {
+        unsigned int r = m_A->m_RowIds[k];
+        if (x[c]>local_weight_means[r])
+          tdx[c] += exp_x[c] * ( exp_x[c] - exp_means[r] );
+        else
+          tdx[c] += x[c] - local_weight_means[r];
+      }
     dx += tdx*2.0*m_Lambda/dim;
   }
 
@@ -275,7 +404,7 @@ public:
     // RMS error
     unsigned int N = m_b.size();
     vnl_vector<double> d; d.set_size(N);
-    S->multiply(x,d);
+    m_A->mult(x,d);
     double cost = (d - m_b).squared_magnitude()/N;
 
     // regularize
@@ -292,12 +421,12 @@ public:
 
     // calculate output difference d
     vnl_vector<double> d; d.set_size(N);
-    S->multiply(x,d);
+    m_A->mult(x,d);
     d -= m_b;
 
     // (f(u(x)))' = f'(u(x)) * u'(x)
     // d/dx_j = 1/N * Sum_i A_i,j * 2*(A_i,j * x_j - b_i)
-    S->transpose_multiply(d, dx);
+    m_A->pre_mult(d, dx);
     dx *= 2.0/N;
 
     calc_regularization_gradient(x,dx);
@@ -327,6 +456,12 @@ public:
   typedef itk::Image<unsigned char, 3>              UcharImgType;
   typedef itk::Image<double, 3>                     DoubleImgType;
 
+  enum SOLVER
+  {
+    LBFGSB,
+    PROJECTED_GRADIENT  ///< parallel spectral projected gradient; MaxIterations limits the number of iterations instead of function evaluations
+  };
+
   itkFactorylessNewMacro(Self)
   itkCloneMacro(Self)
   itkTypeMacro( FitFibersToImageFilter, ImageSource )
@@ -351,6 +486,8 @@ public:
   itkGetMacro( FilterOutliers, bool)
   itkSetMacro( Verbose, bool)
   itkGetMacro( Verbose, bool)
+  itkSetMacro( Solver, SOLVER)
+  itkGetMacro( Solver, SOLVER)
 
   itkGetMacro( Weights, vnl_vector<double>)
   itkGetMacro( RmsDiffPerBundle, vnl_vector<double>)
@@ -399,9 +536,20 @@ protected:
 
   void GetClosestPeak(itk::Index<4> idx, PeakImgType::Pointer m_PeakImage , vnl_vector_fixed<float,3> fiber_dir, int& id, double& w, double& peak_mag );
 
+  /** Contribution of one fiber segment to one residual. */
+  struct SystemEntry
+  {
+    unsigned int  row;
+    double        a;
+    double        b;
+  };
+
   void CreatePeakSystem();
   void CreateDiffSystem();
   void CreateScalarSystem();
+  void GetFiberIds(std::vector< unsigned int >& bundle_ids, std::vector< unsigned int >& fiber_ids);
+  void SetSystemMatrix(std::vector< FitSparseMatrix::ColumnType >& columns);
+  unsigned int MinimizeProjectedGradient(vnl_vector<double>& x, const vnl_vector<double>* upper);
 
   void GenerateOutputPeakImages();
   void GenerateOutputDiffImages();
@@ -425,6 +573,7 @@ protected:
   double                                      m_MinWeight;
   double                                      m_MaxWeight;
   bool                                        m_Verbose;
+  SOLVER                                      m_Solver;
   unsigned int                                m_NumUnknowns;
   unsigned int                                m_NumResiduals;
   unsigned int                                m_NumCoveredDirections;
@@ -450,7 +599,7 @@ protected:
 
   mitk::DiffusionSignalModel<>*               m_SignalModel;
 
-  vnl_sparse_matrix<double>                   A;
+  FitSparseMatrix                             A;
   vnl_vector<double>                          b;
   VnlCostFunction                             cost;
   unsigned int                                sz_x;
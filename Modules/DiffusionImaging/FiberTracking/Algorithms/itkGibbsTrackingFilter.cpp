@@ -32,6 +32,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // MISC
 #include <fstream>
+#include <cmath>
+#include <algorithm>
 // #include <QFile>
 #include <tinyxml.h>
 #include <boost/progress.hpp>
@@ -65,7 +67,11 @@ GibbsTrackingFilter< ItkOdfImageType >::GibbsTrackingFilter():
   m_RandomSeed(-1),
   m_LoadParameterFile(""),
   m_LutPath(""),
-  m_IsInValidState(true)
+  m_IsInValidState(true),
+  m_NumberOfChains(1),
+  m_TemperatureLadderFactor(1.5),
+  m_SwapInterval(10000),
+  m_SwapAcceptance(0)
 {
 
 }
@@ -273,6 +279,12 @@ void GibbsTrackingFilter< ItkOdfImageType >::GenerateData()
   MITK_INFO << "Min. fiber length: " << m_MinFiberLength;
   MITK_INFO << "Curvature threshold: " << m_CurvatureThreshold;
   MITK_INFO << "Random seed: " << m_RandomSeed;
+  if (m_NumberOfChains>1)
+  {
+    MITK_INFO << "Tempered chains: " << m_NumberOfChains;
+    MITK_INFO << "Temperature ladder factor: " << m_TemperatureLadderFactor;
+    MITK_INFO << "Swap interval: " << m_SwapInterval;
+  }
   MITK_INFO << "----------------------------------------";
 
   // main loop
@@ -280,43 +292,50 @@ void GibbsTrackingFilter< ItkOdfImageType >::GenerateData()
   TimeProbe clock; clock.Start();
   m_NumAcceptedFibers = 0;
   m_CurrentIteration = 0;
-  bool just_built_fibers = false;
-  boost::progress_display disp(m_Iterations);
-  if (!m_AbortTracking)
-    while (m_CurrentIteration<m_Iterations)
-    {
-      just_built_fibers = false;
-      ++disp;
-      m_CurrentIteration++;
-      if (m_AbortTracking)
-        break;
-
-      // update temperatur for simulated annealing process
-      float temperature = m_StartTemperature * exp(alpha*m_CurrentIteration/m_Iterations);
-      sampler->SetTemperature(temperature);
-      sampler->MakeProposal();
-
-      m_ProposalAcceptance = (float)sampler->GetNumAcceptedProposals()/m_CurrentIteration;
-      m_NumParticles = particleGrid->m_NumParticles;
-      m_NumConnections = particleGrid->m_NumConnections;
-
-      if (m_AbortTracking)
-        break;
-
-      if (m_BuildFibers)
+  if (m_NumberOfChains>1)
+  {
+    RunTemperedChains(particleGrid, encomp, sampler, interpolator, randGen, alpha);
+  }
+  else
+  {
+    bool just_built_fibers = false;
+    boost::progress_display disp(m_Iterations);
+    if (!m_AbortTracking)
+      while (m_CurrentIteration<m_Iterations)
       {
-        FiberBuilder fiberBuilder(particleGrid, m_MaskImage);
-        m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
-        m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
-        m_BuildFibers = false;
-        just_built_fibers = true;
+        just_built_fibers = false;
+        ++disp;
+        m_CurrentIteration++;
+        if (m_AbortTracking)
+          break;
+
+        // update temperatur for simulated annealing process
+        float temperature = m_StartTemperature * exp(alpha*m_CurrentIteration/m_Iterations);
+        sampler->SetTemperature(temperature);
+        sampler->MakeProposal();
+
+        m_ProposalAcceptance = (float)sampler->GetNumAcceptedProposals()/m_CurrentIteration;
+        m_NumParticles = particleGrid->m_NumParticles;
+        m_NumConnections = particleGrid->m_NumConnections;
+
+        if (m_AbortTracking)
+          break;
+
+        if (m_BuildFibers)
+        {
+          FiberBuilder fiberBuilder(particleGrid, m_MaskImage);
+          m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
+          m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
+          m_BuildFibers = false;
+          just_built_fibers = true;
+        }
       }
+    if (!just_built_fibers)
+    {
+      FiberBuilder fiberBuilder(particleGrid, m_MaskImage);
+      m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
+      m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
     }
-  if (!just_built_fibers)
-  {
-    FiberBuilder fiberBuilder(particleGrid, m_MaskImage);
-    m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
-    m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
   }
   clock.Stop();
 
@@ -341,6 +360,152 @@ void GibbsTrackingFilter< ItkOdfImageType >::GenerateData()
   SaveParameters();
 }
 
+// run several tempered chains in parallel and swap their configurations (parallel tempering)
+template< class ItkOdfImageType >
+void GibbsTrackingFilter< ItkOdfImageType >::RunTemperedChains(ParticleGrid* particleGrid, GibbsEnergyComputer* encomp, MetropolisHastingsSampler* sampler, SphereInterpolator* interpolator, Statistics::MersenneTwisterRandomVariateGenerator* randGen, float alpha)
+{
+  typedef Statistics::MersenneTwisterRandomVariateGenerator RandGenType;
+  struct TemperedChain
+  {
+    RandGenType::Pointer        randGen;
+    SphereInterpolator*         interpolator;
+    ParticleGrid*               particleGrid;
+    GibbsEnergyComputer*        encomp;
+    MetropolisHastingsSampler*  sampler;
+  };
+
+  // the swap moves and the seeds of the additional chains are drawn from a separate generator, so the result only depends on the random seed
+  RandGenType::Pointer swapRandGen = RandGenType::New();
+  swapRandGen->SetSeed(randGen->GetIntegerVariate());
+
+  // the first chain uses the components of the single chain tracking, each additional chain gets its own copies
+  std::vector< TemperedChain > chains;
+  chains.push_back({randGen, interpolator, particleGrid, encomp, sampler});
+  for (unsigned int k=1; k<m_NumberOfChains; k++)
+  {
+    TemperedChain chain = {RandGenType::New(), new SphereInterpolator(*interpolator), nullptr, nullptr, nullptr};
+    chain.randGen->SetSeed(swapRandGen->GetIntegerVariate());
+    try
+    {
+      chain.particleGrid = new ParticleGrid(m_MaskImage, m_ParticleLength, m_ParticleGridCellCapacity);
+      chain.encomp = new GibbsEnergyComputer(m_OdfImage, m_MaskImage, chain.particleGrid, chain.interpolator, chain.randGen);
+      chain.encomp->SetParameters(m_ParticleWeight,m_ParticleWidth,m_ConnectionPotential*m_ParticleLength*m_ParticleLength,m_CurvatureThreshold,m_InexBalance,m_ParticlePotential);
+      chain.sampler = new MetropolisHastingsSampler(chain.particleGrid, chain.encomp, chain.randGen, m_CurvatureThreshold);
+    }
+    catch(...)
+    {
+      MITK_WARN << "GibbsTrackingFilter: particle grid allocation for chain " << k+1 << " failed. Not enough memory? Using " << k << " chains.";
+      delete chain.encomp;
+      delete chain.particleGrid;
+      delete chain.interpolator;
+      break;
+    }
+    chains.push_back(chain);
+  }
+  const unsigned int numChains = chains.size();
+
+  std::vector< unsigned int > chainOfRank(numChains);     // chain at each temperature, rank 0 is the coldest
+  std::vector< float > temperatureFactor(numChains);
+  for (unsigned int r=0; r<numChains; r++)
+  {
+    chainOfRank[r] = r;
+    temperatureFactor[r] = std::pow(m_TemperatureLadderFactor, (float)r);
+  }
+  std::vector< unsigned long > swapAttempts(numChains, 0);
+  std::vector< unsigned long > acceptedSwaps(numChains, 0);
+
+  boost::progress_display disp(m_Iterations);
+  bool just_built_fibers = false;
+  unsigned long swapRound = 0;
+  unsigned long swapInterval = std::max(m_SwapInterval, 1u);
+  while (m_CurrentIteration<m_Iterations && !m_AbortTracking)
+  {
+    just_built_fibers = false;
+    double startIteration = m_CurrentIteration;
+    unsigned long steps = std::min((double)swapInterval, m_Iterations-m_CurrentIteration);
+
+    // the chains only share read-only data, so they can be updated concurrently
+#pragma omp parallel for
+    for (int r=0; r<(int)numChains; r++)
+    {
+      TemperedChain& chain = chains[chainOfRank[r]];
+      for (unsigned long i=1; i<=steps; i++)
+      {
+        if (m_AbortTracking)
+          break;
+
+        // update temperatur for simulated annealing process
+        float temperature = m_StartTemperature * exp(alpha*(startIteration+i)/m_Iterations) * temperatureFactor[r];
+        chain.sampler->SetTemperature(temperature);
+        chain.sampler->MakeProposal();
+      }
+    }
+    m_CurrentIteration += steps;
+    disp += steps;
+
+    // swap configurations of neighbouring temperatures, alternating between even and odd pairs
+    float temperature = m_StartTemperature * exp(alpha*m_CurrentIteration/m_Iterations);
+    for (unsigned int r=swapRound%2; r+1<numChains; r+=2)
+    {
+      MetropolisHastingsSampler* cold = chains[chainOfRank[r]].sampler;
+      MetropolisHastingsSampler* hot = chains[chainOfRank[r+1]].sampler;
+      double delta = ((double)hot->ComputeInternalEnergy() - cold->ComputeInternalEnergy())
+          * (1.0/(temperature*temperatureFactor[r]) - 1.0/(temperature*temperatureFactor[r+1]));
+
+      swapAttempts[r]++;
+      if (std::isfinite(delta) && (delta>=0 || swapRandGen->GetVariate()<exp(delta)))
+      {
+        std::swap(chainOfRank[r], chainOfRank[r+1]);
+        acceptedSwaps[r]++;
+      }
+    }
+    swapRound++;
+
+    TemperedChain& coldest = chains[chainOfRank[0]];
+    m_ProposalAcceptance = (float)coldest.sampler->GetNumAcceptedProposals()/m_CurrentIteration;
+    m_NumParticles = coldest.particleGrid->m_NumParticles;
+    m_NumConnections = coldest.particleGrid->m_NumConnections;
+
+    if (m_BuildFibers)
+    {
+      FiberBuilder fiberBuilder(coldest.particleGrid, m_MaskImage);
+      m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
+      m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
+      m_BuildFibers = false;
+      just_built_fibers = true;
+    }
+  }
+  if (!just_built_fibers)
+  {
+    FiberBuilder fiberBuilder(chains[chainOfRank[0]].particleGrid, m_MaskImage);
+    m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
+    m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
+  }
+
+  // acceptance statistics
+  unsigned long totalAttempts = 0;
+  unsigned long totalAccepted = 0;
+  for (unsigned int k=0; k<numChains; k++)
+    MITK_INFO << "GibbsTrackingFilter: chain " << k << " accepted " << 100.0*chains[k].sampler->GetNumAcceptedProposals()/std::max(m_CurrentIteration, 1.0) << "% of its proposals";
+  for (unsigned int r=0; r+1<numChains; r++)
+  {
+    MITK_INFO << "GibbsTrackingFilter: swap acceptance between temperature " << r << " and " << r+1 << ": "
+              << 100.0*acceptedSwaps[r]/std::max(swapAttempts[r], 1ul) << "%";
+    totalAttempts += swapAttempts[r];
+    totalAccepted += acceptedSwaps[r];
+  }
+  m_SwapAcceptance = (float)totalAccepted/std::max(totalAttempts, 1ul);
+
+  // the components of the first chain are deleted by the caller
+  for (unsigned int k=1; k<numChains; k++)
+  {
+    delete chains[k].sampler;
+    delete chains[k].encomp;
+    delete chains[k].particleGrid;
+    delete chains[k].interpolator;
+  }
+}
+
 template< class ItkOdfImageType >
 void GibbsTrackingFilter< ItkOdfImageType >::PrepareMaskImage()
 {
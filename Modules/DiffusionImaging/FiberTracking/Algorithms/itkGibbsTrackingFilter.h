@@ -19,6 +19,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK
 #include <mitkSphereInterpolator.h>
 #include <mitkFiberBundle.h>
+#include <mitkMetropolisHastingsSampler.h>
+#include <mitkGibbsEnergyComputer.h>
 
 // ITK
 #include <itkProcessObject.h>
@@ -36,7 +38,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace itk{
 
 /**
-* \brief Performes global fiber tractography on the input ODF or tensor image (Gibbs tracking, Reisert 2010).   */
+* \brief Performes global fiber tractography on the input ODF or tensor image (Gibbs tracking, Reisert 2010).
+*
+* If more than one chain is used, the tracking runs several Markov chains in parallel (parallel tempering). The chains
+* are annealed like the single chain, but each one at a temperature that is TemperatureLadderFactor times higher than
+* the one of the next colder chain. After every SwapInterval proposals, the configurations of chains with neighbouring
+* temperatures are exchanged according to the Metropolis criterion. Hot chains explore the configuration space faster,
+* so the coldest chain, from which the fibers are built, usually needs fewer iterations. For a given random seed the
+* result does not depend on the number of threads. Each chain needs its own particle grid. */
 
 template< class ItkOdfImageType >
 class GibbsTrackingFilter : public ProcessObject
@@ -74,6 +83,9 @@ public:
     itkSetMacro( LoadParameterFile, std::string )   ///< Parameter file.
     itkSetMacro( SaveParameterFile, std::string )
     itkSetMacro( LutPath, std::string )             ///< Path to lookuptables. Default is binary directory.
+    itkSetMacro( NumberOfChains, unsigned int )     ///< Number of tempered Markov chains that run in parallel. Default is 1 (single chain).
+    itkSetMacro( TemperatureLadderFactor, float )   ///< Temperature ratio between two neighbouring chains.
+    itkSetMacro( SwapInterval, unsigned int )       ///< Number of proposals of each chain between two swap moves.
 
     /** Getter. */
     itkGetMacro( ParticleWeight, float )
@@ -83,6 +95,8 @@ public:
     itkGetMacro( NumConnections, int )
     itkGetMacro( NumAcceptedFibers, int )
     itkGetMacro( ProposalAcceptance, float )
+    itkGetMacro( SwapAcceptance, float )            ///< fraction of accepted swap moves between chains
+    itkGetMacro( NumberOfChains, unsigned int )
     itkGetMacro( CurrentIteration, double)
     itkGetMacro( Iterations, double)
     itkGetMacro( IsInValidState, bool)
@@ -109,6 +123,7 @@ protected:
     void PrepareMaskImage();
     bool LoadParameters();
     bool SaveParameters();
+    void RunTemperedChains(mitk::ParticleGrid* particleGrid, GibbsEnergyComputer* encomp, mitk::MetropolisHastingsSampler* sampler, SphereInterpolator* interpolator, Statistics::MersenneTwisterRandomVariateGenerator* randGen, float alpha);
 
     // Input Images
     typename ItkOdfImageType::Pointer m_OdfImage;
@@ -141,6 +156,10 @@ protected:
     std::string     m_SaveParameterFile;    ///< filename of parameter file (writer)
     std::string     m_LutPath;              ///< path to lookuptables used by the sphere interpolator
     bool            m_IsInValidState;       ///< Whether the filter is in a valid state, false if error occured
+    unsigned int    m_NumberOfChains;       ///< number of tempered Markov chains
+    float           m_TemperatureLadderFactor;  ///< temperature ratio between neighbouring chains
+    unsigned int    m_SwapInterval;         ///< proposals per chain between two swap moves
+    float           m_SwapAcceptance;       ///< swap acceptance rate (0-1)
 
     FiberPolyDataType m_FiberPolyData;      ///< container for reconstructed fibers
 
@@ -19,6 +19,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cstdlib>
 
 #include <omp.h>
+#include <atomic>
+#include <iterator>
+#include <mutex>
 #include "itkStreamlineTrackingFilter.h"
 #include <itkImageRegionConstIterator.h>
 #include <itkImageRegionConstIteratorWithIndex.h>
@@ -41,7 +44,6 @@ StreamlineTrackingFilter
   : m_PauseTracking(false)
   , m_AbortTracking(false)
   , m_BuildFibersFinished(false)
-  , m_BuildFibersReady(0)
   , m_FiberPolyData(nullptr)
   , m_Points(nullptr)
   , m_Cells(nullptr)
@@ -81,6 +83,7 @@ StreamlineTrackingFilter
   , m_InterpolateMasks(true)
   , m_TrialsPerSeed(10)
   , m_EndpointConstraint(EndpointConstraints::NONE)
+  , m_LockStepBatchSize(1)
   , m_IntroduceDirectionsFromPrior(true)
   , m_TrackingPriorAsMask(true)
   , m_TrackingPriorWeight(1.0)
@@ -91,13 +94,15 @@ StreamlineTrackingFilter
 
 std::string StreamlineTrackingFilter::GetStatusText()
 {
-  std::string status = "Seedpoints processed: " + boost::lexical_cast<std::string>(m_Progress) + "/" + boost::lexical_cast<std::string>(m_SeedPoints.size());
+  unsigned int progress = m_Progress.load();
+  unsigned int current_tracts = m_CurrentTracts.load();
+  std::string status = "Seedpoints processed: " + boost::lexical_cast<std::string>(progress) + "/" + boost::lexical_cast<std::string>(m_SeedPoints.size());
   if (m_SeedPoints.size()>0)
-    status += " (" + boost::lexical_cast<std::string>(100*m_Progress/m_SeedPoints.size()) + "%)";
+    status += " (" + boost::lexical_cast<std::string>(100*progress/m_SeedPoints.size()) + "%)";
   if (m_MaxNumTracts>0)
-    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts) + "/" + boost::lexical_cast<std::string>(m_MaxNumTracts);
+    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(current_tracts) + "/" + boost::lexical_cast<std::string>(m_MaxNumTracts);
   else
-    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts);
+    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(current_tracts);
 
   return status;
 }
@@ -263,7 +268,6 @@ void StreamlineTrackingFilter::BeforeTracking()
   if (m_SeedPoints.empty())
     GetSeedPointsFromSeedImage();
 
-  m_BuildFibersReady = 0;
   m_BuildFibersFinished = false;
   m_Tractogram.clear();
   m_SamplingPointset = mitk::PointSet::New();
@@ -274,6 +278,10 @@ void StreamlineTrackingFilter::BeforeTracking()
   if (m_DemoMode)
     omp_set_num_threads(1);
 
+  // accepted fibers are collected per thread and merged in AfterTracking()
+  m_ThreadTractograms.clear();
+  m_ThreadTractograms.resize(omp_get_max_threads());
+
   if (m_TrackingHandler->GetMode()==mitk::TrackingDataHandler::MODE::DETERMINISTIC)
     std::cout << "StreamlineTracking - Mode: deterministic" << std::endl;
   else if(m_TrackingHandler->GetMode()==mitk::TrackingDataHandler::MODE::PROBABILISTIC)
@@ -308,6 +316,8 @@ void StreamlineTrackingFilter::BeforeTracking()
   std::cout << "StreamlineTracking - Loop check: " << m_LoopCheck << "°" << std::endl;
 
   std::cout << "StreamlineTracking - Num. neighborhood samples: " << m_NumberOfSamples << std::endl;
+  if (m_LockStepBatchSize>1 && !m_DemoMode)
+    std::cout << "StreamlineTracking - Streamlines per thread in lock-step: " << m_LockStepBatchSize << std::endl;
   std::cout << "StreamlineTracking - Max. sampling distance: " << m_SamplingDistance << "mm (" << m_SamplingDistance/m_MinVoxelSize << "*vox)" << std::endl;
   std::cout << "StreamlineTracking - Deflection modifier: " << m_DeflectionMod << std::endl;
 
@@ -374,6 +384,17 @@ std::vector< vnl_vector_fixed<float,3> > StreamlineTrackingFilter::CreateDirecti
 
 
 vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::Point<float, 3> &pos, std::deque<vnl_vector_fixed<float, 3> >& olddirs, itk::Index<3> &oldIndex)
+{
+  std::vector< itk::Point<float, 3> > positions(1, pos);
+  std::vector< std::deque< vnl_vector_fixed<float,3> >* > dirs(1, &olddirs);
+  std::vector< itk::Index<3>* > indices(1, &oldIndex);
+  std::vector< vnl_vector_fixed<float,3> > directions;
+  GetNewDirections(positions, dirs, indices, directions);
+  return directions.at(0);
+}
+
+
+void StreamlineTrackingFilter::GetNewDirections(const std::vector< itk::Point<float, 3> >& positions, const std::vector< std::deque< vnl_vector_fixed<float,3> >* >& olddirs, const std::vector< itk::Index<3>* >& oldIndices, std::vector< vnl_vector_fixed<float,3> >& directions)
 {
   if (m_DemoMode)
   {
@@ -381,120 +402,223 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
     m_AlternativePointset->Clear();
     m_StopVotePointset->Clear();
   }
-  vnl_vector_fixed<float,3> direction; direction.fill(0);
-
-  if (mitk::imv::IsInsideMask<float>(pos, m_InterpolateMasks, m_MaskInterpolator) && !mitk::imv::IsInsideMask<float>(pos, m_InterpolateMasks, m_StopInterpolator))
-    direction = m_TrackingHandler->ProposeDirection(pos, olddirs, oldIndex); // get direction proposal at current streamline position
-  else
-    return direction;
 
-  int stop_votes = 0;
-  int possible_stop_votes = 0;
-  if (!olddirs.empty())
+  struct SamplingPoint
   {
-    vnl_vector_fixed<float,3> olddir = olddirs.back();
-    std::vector< vnl_vector_fixed<float,3> > probeVecs = CreateDirections(m_NumberOfSamples);
-    itk::Point<float, 3> sample_pos;
-    int alternatives = 1;
+    unsigned int                index;              ///< index in the sampling pattern
+    vnl_vector_fixed<float,3>   d;                  ///< offset from the current position
+    itk::Point<float, 3>        pos;
+    bool                        is_stop_voter;
+    int                         request;            ///< index of the direction proposal, -1 if outside of the mask
+    vnl_vector_fixed<float,3>   alternative_d;      ///< reflected offset used if the sample is outside of the white matter
+    itk::Point<float, 3>        alternative_pos;
+    int                         alternative_request;
+  };
+
+  // all direction proposals are requested from the tracking handler in as few batches as possible
+  std::vector< itk::Point<float, 3> > request_positions;
+  std::vector< std::deque< vnl_vector_fixed<float,3> >* > request_olddirs;
+  std::vector< itk::Index<3>* > request_indices;
+  std::vector< vnl_vector_fixed<float,3> > proposals;
+  std::vector< vnl_vector_fixed<float,3> > alternative_proposals;
+  auto add_request = [&](const itk::Point<float, 3>& pos, unsigned int p)
+  {
+    request_positions.push_back(pos);
+    request_olddirs.push_back(olddirs[p]);
+    request_indices.push_back(oldIndices[p]);
+    return (int)request_positions.size()-1;
+  };
+
+  unsigned int num_positions = positions.size();
+  vnl_vector_fixed<float,3> zero_dir; zero_dir.fill(0);
+  directions.assign(num_positions, zero_dir);
+  std::vector< int > center_requests(num_positions, -1);
+  std::vector< int > possible_stop_votes(num_positions, 0);
+  std::vector< unsigned int > samples_begin(num_positions+1, 0);
+  std::vector< SamplingPoint > samples;
+  std::vector< vnl_vector_fixed<float,3> > probeVecs = CreateDirections(m_NumberOfSamples);
+
+  // first pass: current positions and neighborhood samples
+  for (unsigned int p=0; p<num_positions; p++)
+  {
+    samples_begin[p] = samples.size();
+    const itk::Point<float, 3>& pos = positions[p];
+    if (!mitk::imv::IsInsideMask<float>(pos, m_InterpolateMasks, m_MaskInterpolator) || mitk::imv::IsInsideMask<float>(pos, m_InterpolateMasks, m_StopInterpolator))
+      continue;
+    center_requests[p] = add_request(pos, p); // get direction proposal at current streamline position
+
+    if (olddirs[p]->empty())
+      continue;
+
+    vnl_vector_fixed<float,3> olddir = olddirs[p]->back();
     for (unsigned int i=0; i<probeVecs.size(); i++)
     {
-      vnl_vector_fixed<float,3> d;
-      bool is_stop_voter = false;
+      SamplingPoint sample;
+      sample.index = i;
+      sample.is_stop_voter = false;
+      sample.alternative_request = -1;
       if (m_Random && m_RandomSampling)
       {
-        d[0] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
-        d[1] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
-        d[2] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
-        d.normalize();
-        d *= m_TrackingHandler->GetRandDouble(0,m_SamplingDistance);
+        sample.d[0] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
+        sample.d[1] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
+        sample.d[2] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
+        sample.d.normalize();
+        sample.d *= m_TrackingHandler->GetRandDouble(0,m_SamplingDistance);
       }
       else
       {
-        d = probeVecs.at(i);
-        float dot = dot_product(d, olddir);
+        sample.d = probeVecs.at(i);
+        float dot = dot_product(sample.d, olddir);
         if (m_UseStopVotes && dot>0.7)
         {
-          is_stop_voter = true;
-          possible_stop_votes++;
+          sample.is_stop_voter = true;
+          possible_stop_votes[p]++;
         }
         else if (m_OnlyForwardSamples && dot<0)
           continue;
-        d *= m_SamplingDistance;
+        sample.d *= m_SamplingDistance;
+      }
+
+      sample.pos[0] = pos[0] + sample.d[0];
+      sample.pos[1] = pos[1] + sample.d[1];
+      sample.pos[2] = pos[2] + sample.d[2];
+
+      sample.request = -1;
+      if (mitk::imv::IsInsideMask<float>(sample.pos, m_InterpolateMasks, m_MaskInterpolator))
+        sample.request = add_request(sample.pos, p); // sample neighborhood
+      samples.push_back(sample);
+    }
+  }
+  samples_begin[num_positions] = samples.size();
+  m_TrackingHandler->ProposeDirections(request_positions, request_olddirs, request_indices, proposals);
+
+  // second pass: samples outside of the white matter look a bit further into the other direction
+  request_positions.clear();
+  request_olddirs.clear();
+  request_indices.clear();
+  for (unsigned int p=0; p<num_positions; p++)
+  {
+    if (center_requests[p]<0)
+      continue;
+    for (unsigned int s=samples_begin[p]; s<samples_begin[p+1]; s++)
+    {
+      SamplingPoint& sample = samples[s];
+      if (sample.request>=0 && proposals[sample.request].magnitude()>mitk::eps)
+        continue;
+
+      vnl_vector_fixed<float,3> olddir = olddirs[p]->back();
+      if (m_AvoidStop && olddir.magnitude()>0.5) // out of white matter
+      {
+        vnl_vector_fixed<float,3> d = sample.d;
+        float dot = dot_product(d, olddir);
+        if (dot >= 0.0) // in front of plane defined by pos and olddir
+          d = -d + 2*dot*olddir; // reflect
+        else
+          d = -d; // invert
+
+        sample.alternative_d = d;
+        sample.alternative_pos[0] = positions[p][0] + d[0];
+        sample.alternative_pos[1] = positions[p][1] + d[1];
+        sample.alternative_pos[2] = positions[p][2] + d[2];
+        if (mitk::imv::IsInsideMask<float>(sample.alternative_pos, m_InterpolateMasks, m_MaskInterpolator))
+          sample.alternative_request = add_request(sample.alternative_pos, p); // sample neighborhood
       }
+    }
+  }
+  if (!request_positions.empty())
+    m_TrackingHandler->ProposeDirections(request_positions, request_olddirs, request_indices, alternative_proposals);
 
-      sample_pos[0] = pos[0] + d[0];
-      sample_pos[1] = pos[1] + d[1];
-      sample_pos[2] = pos[2] + d[2];
+  // accumulate the votes in the order of the sampling pattern
+  std::vector< bool > valid(num_positions, false);
+  for (unsigned int p=0; p<num_positions; p++)
+  {
+    if (center_requests[p]<0)
+      continue;
 
+    vnl_vector_fixed<float,3> direction = proposals[center_requests[p]];
+    int stop_votes = 0;
+    int alternatives = 1;
+    for (unsigned int s=samples_begin[p]; s<samples_begin[p+1]; s++)
+    {
+      const SamplingPoint& sample = samples[s];
       vnl_vector_fixed<float,3> tempDir; tempDir.fill(0.0);
-      if (mitk::imv::IsInsideMask<float>(sample_pos, m_InterpolateMasks, m_MaskInterpolator))
-        tempDir = m_TrackingHandler->ProposeDirection(sample_pos, olddirs, oldIndex); // sample neighborhood
+      if (sample.request>=0)
+        tempDir = proposals[sample.request];
       if (tempDir.magnitude()>mitk::eps)
       {
         direction += tempDir;
 
         if(m_DemoMode)
-          m_SamplingPointset->InsertPoint(i, sample_pos);
+          m_SamplingPointset->InsertPoint(sample.index, sample.pos);
       }
-      else if (m_AvoidStop && olddir.magnitude()>0.5) // out of white matter
+      else if (m_AvoidStop && olddirs[p]->back().magnitude()>0.5) // out of white matter
       {
-        if (is_stop_voter)
+        if (sample.is_stop_voter)
           stop_votes++;
         if (m_DemoMode)
-          m_StopVotePointset->InsertPoint(i, sample_pos);
+          m_StopVotePointset->InsertPoint(sample.index, sample.pos);
 
-        float dot = dot_product(d, olddir);
-        if (dot >= 0.0) // in front of plane defined by pos and olddir
-          d = -d + 2*dot*olddir; // reflect
-        else
-          d = -d; // invert
-
-        // look a bit further into the other direction
-        sample_pos[0] = pos[0] + d[0];
-        sample_pos[1] = pos[1] + d[1];
-        sample_pos[2] = pos[2] + d[2];
         alternatives++;
         vnl_vector_fixed<float,3> tempDir; tempDir.fill(0.0);
-        if (mitk::imv::IsInsideMask<float>(sample_pos, m_InterpolateMasks, m_MaskInterpolator))
-          tempDir = m_TrackingHandler->ProposeDirection(sample_pos, olddirs, oldIndex); // sample neighborhood
+        if (sample.alternative_request>=0)
+          tempDir = alternative_proposals[sample.alternative_request];
 
         if (tempDir.magnitude()>mitk::eps)  // are we back in the white matter?
         {
-          direction += d * m_DeflectionMod;         // go into the direction of the white matter
+          direction += sample.alternative_d * m_DeflectionMod;         // go into the direction of the white matter
           direction += tempDir;  // go into the direction of the white matter direction at this location
 
           if(m_DemoMode)
-            m_AlternativePointset->InsertPoint(alternatives, sample_pos);
+            m_AlternativePointset->InsertPoint(alternatives, sample.alternative_pos);
         }
         else
         {
           if (m_DemoMode)
-            m_StopVotePointset->InsertPoint(i, sample_pos);
+            m_StopVotePointset->InsertPoint(sample.index, sample.alternative_pos);
         }
       }
       else
       {
         if (m_DemoMode)
-          m_StopVotePointset->InsertPoint(i, sample_pos);
+          m_StopVotePointset->InsertPoint(sample.index, sample.pos);
 
-        if (is_stop_voter)
+        if (sample.is_stop_voter)
           stop_votes++;
       }
     }
-  }
 
-  bool valid = false;
-  if (direction.magnitude()>0.001 && (possible_stop_votes==0 || (float)stop_votes/possible_stop_votes<0.5) )
-  {
-    direction.normalize();
-    valid = true;
+    if (direction.magnitude()>0.001 && (possible_stop_votes[p]==0 || (float)stop_votes/possible_stop_votes[p]<0.5) )
+    {
+      direction.normalize();
+      valid[p] = true;
+    }
+    else
+      direction.fill(0);
+    directions[p] = direction;
   }
-  else
-    direction.fill(0);
 
-  if (m_TrackingPriorHandler!=nullptr && (m_IntroduceDirectionsFromPrior || valid))
+  if (m_TrackingPriorHandler==nullptr)
+    return;
+
+  request_positions.clear();
+  request_olddirs.clear();
+  request_indices.clear();
+  std::vector< int > prior_requests(num_positions, -1);
+  for (unsigned int p=0; p<num_positions; p++)
+    if (center_requests[p]>=0 && (m_IntroduceDirectionsFromPrior || valid[p]))
+      prior_requests[p] = add_request(positions[p], p);
+  if (request_positions.empty())
+    return;
+
+  std::vector< vnl_vector_fixed<float,3> > priors;
+  m_TrackingPriorHandler->ProposeDirections(request_positions, request_olddirs, request_indices, priors);
+  for (unsigned int p=0; p<num_positions; p++)
   {
-    vnl_vector_fixed<float,3> prior = m_TrackingPriorHandler->ProposeDirection(pos, olddirs, oldIndex);
+    if (prior_requests[p]<0)
+      continue;
+
+    vnl_vector_fixed<float,3>& direction = directions[p];
+    vnl_vector_fixed<float,3> prior = priors[prior_requests[p]];
     if (prior.magnitude()>0.001)
     {
       prior.normalize();
@@ -506,8 +630,6 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
     else if (m_TrackingPriorAsMask)
       direction.fill(0.0);
   }
-
-  return direction;
 }
 
 
@@ -557,15 +679,11 @@ float StreamlineTrackingFilter::FollowStreamline(itk::Point<float, 3> pos, vnl_v
 
     if (m_DemoMode && !m_UseOutputProbabilityMap) // CHECK: warum sind die samplingpunkte der streamline in der visualisierung immer einen schritt voras?
     {
-#pragma omp critical
-      {
-        m_BuildFibersReady++;
-        m_Tractogram.push_back(*fib);
-        BuildFibers(true);
-        m_Stop = true;
+      // the demo mode always runs with a single thread
+      BuildFibers(fib);
+      m_Stop = true;
 
-        while (m_Stop){
-        }
+      while (m_Stop){
       }
     }
 
@@ -583,6 +701,202 @@ float StreamlineTrackingFilter::FollowStreamline(itk::Point<float, 3> pos, vnl_v
 }
 
 
+void StreamlineTrackingFilter::FollowStreamlines(std::vector< StreamlineState* >& streamlines)
+{
+  vnl_vector_fixed<float,3> zero_dir; zero_dir.fill(0.0);
+  for (auto s : streamlines)
+  {
+    s->last_dirs.clear();
+    for (unsigned int i=0; i<m_NumPreviousDirections-1; i++)
+      s->last_dirs.push_back(zero_dir);
+    s->step = 0;
+  }
+
+  std::vector< StreamlineState* > active = streamlines;
+  std::vector< itk::Point<float, 3> > positions;
+  std::vector< std::deque< vnl_vector_fixed<float,3> >* > olddirs;
+  std::vector< itk::Index<3>* > indices;
+  std::vector< vnl_vector_fixed<float,3> > directions;
+  while (!active.empty())
+  {
+    // perform one step for each active streamline, same as in FollowStreamline
+    positions.clear();
+    olddirs.clear();
+    indices.clear();
+    std::vector< StreamlineState* > stepped;
+    for (auto s : active)
+    {
+      if (s->step>=m_MaxLength/2 || m_AbortTracking)
+        continue;
+      s->step++;
+
+      m_TrackingHandler->WorldToIndex(s->pos, s->oldIndex);
+      CalculateNewPosition(s->pos, s->dir);
+
+      if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(s->pos, m_InterpolateMasks, m_ExclusionInterpolator))
+      {
+        s->exclude = true;
+        continue;
+      }
+
+      s->dir.normalize();
+      if (s->front)
+      {
+        s->fib.push_front(s->pos);
+        s->container.push_front(s->dir);
+      }
+      else
+      {
+        s->fib.push_back(s->pos);
+        s->container.push_back(s->dir);
+      }
+      s->tractLength += m_StepSize;
+
+      if (m_LoopCheck>=0 && CheckCurvature(&s->container, s->front)>m_LoopCheck)
+        continue;
+
+      if (s->tractLength>m_MaxTractLength)
+        continue;
+
+      s->last_dirs.push_back(s->dir);
+      if (s->last_dirs.size()>m_NumPreviousDirections)
+        s->last_dirs.pop_front();
+
+      positions.push_back(s->pos);
+      olddirs.push_back(&s->last_dirs);
+      indices.push_back(&s->oldIndex);
+      stepped.push_back(s);
+    }
+
+    // new directions of all streamlines in one batch
+    if (!stepped.empty())
+      GetNewDirections(positions, olddirs, indices, directions);
+
+    while (m_PauseTracking){}
+
+    active.clear();
+    for (unsigned int i=0; i<stepped.size(); i++)
+    {
+      stepped[i]->dir = directions[i];
+      if (directions[i].magnitude()>=0.0001)
+        active.push_back(stepped[i]);
+    }
+  }
+}
+
+
+void StreamlineTrackingFilter::TrackSeedsInLockStep(int first_seed, int num_seeds)
+{
+  if (m_TrialsPerSeed==0)
+    return;
+
+  std::vector< unsigned int > trials(num_seeds, 0);
+  std::vector< int > pending;
+  for (int s=0; s<num_seeds; s++)
+    pending.push_back(s);
+
+  itk::Index<3> zeroIndex; zeroIndex.Fill(0);
+  while (!pending.empty() && !m_StopTracking)
+  {
+    // get starting directions
+    std::vector< itk::Point<float, 3> > positions;
+    std::vector< std::deque< vnl_vector_fixed<float,3> > > olddirs(pending.size());
+    std::vector< std::deque< vnl_vector_fixed<float,3> >* > olddir_pointers;
+    std::vector< itk::Index<3> > zeroIndices(pending.size(), zeroIndex);
+    std::vector< itk::Index<3>* > index_pointers;
+    for (unsigned int i=0; i<pending.size(); i++)
+    {
+      positions.push_back(m_SeedPoints.at(first_seed + pending[i]));
+      olddir_pointers.push_back(&olddirs[i]);
+      index_pointers.push_back(&zeroIndices[i]);
+    }
+    std::vector< vnl_vector_fixed<float,3> > start_dirs;
+    GetNewDirections(positions, olddir_pointers, index_pointers, start_dirs);
+
+    std::vector< StreamlineState > streamlines(pending.size());
+    std::vector< StreamlineState* > forward;
+    for (unsigned int i=0; i<pending.size(); i++)
+    {
+      StreamlineState& s = streamlines[i];
+      s.seed_pos = positions[i];
+      s.start_dir = start_dirs[i] * 0.5f;
+      s.pos = s.seed_pos;
+      s.dir = s.start_dir;
+      s.tractLength = 0;
+      s.front = false;
+      s.exclude = m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(positions[i], m_InterpolateMasks, m_ExclusionInterpolator);
+      s.started = s.dir.magnitude()>0.0001 && !s.exclude;
+      if (s.started)
+        forward.push_back(&s);
+    }
+
+    // forward tracking
+    FollowStreamlines(forward);
+
+    // backward tracking
+    std::vector< StreamlineState* > backward;
+    for (auto s : forward)
+    {
+      s->fib.push_front(s->seed_pos);
+      if (!s->exclude)
+      {
+        s->pos = s->seed_pos;
+        s->dir = -s->start_dir;
+        s->front = true;
+        backward.push_back(s);
+      }
+    }
+    FollowStreamlines(backward);
+
+    std::vector< int > retry;
+    for (unsigned int i=0; i<pending.size(); i++)
+    {
+      StreamlineState& s = streamlines[i];
+      bool success = false;
+      if (s.started && s.tractLength>=m_MinTractLength && s.fib.size()>=2 && !s.exclude)
+        success = StoreFiber(&s.fib);
+
+      // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
+      if (!success && m_TrackingHandler->GetMode()==mitk::TrackingDataHandler::PROBABILISTIC && ++trials[pending[i]]<m_TrialsPerSeed)
+        retry.push_back(pending[i]);
+    }
+    pending = retry;
+  }
+}
+
+
+bool StreamlineTrackingFilter::StoreFiber(FiberType* fib)
+{
+  if (m_StopTracking || !IsValidFiber(fib))
+    return false;
+
+  // reserve a slot without locking, fibers exceeding the maximum number of tracts are discarded
+  unsigned int accepted = m_CurrentTracts.load();
+  do
+  {
+    if (m_MaxNumTracts > 0 && accepted>=static_cast<unsigned int>(m_MaxNumTracts))
+    {
+      m_StopTracking = true;
+      return false;
+    }
+  }
+  while (!m_CurrentTracts.compare_exchange_weak(accepted, accepted+1));
+
+  if (!m_UseOutputProbabilityMap)
+    m_ThreadTractograms.at(omp_get_thread_num()).push_back(*fib);
+  else
+    FiberToProbmap(fib);
+
+  if (m_MaxNumTracts > 0 && accepted+1==static_cast<unsigned int>(m_MaxNumTracts))
+  {
+    std::cout << "                                                                                                     \r";
+    MITK_INFO << "Reconstructed maximum number of tracts (" << accepted+1 << "). Stopping tractography.";
+    m_StopTracking = true;
+  }
+  return true;
+}
+
+
 float StreamlineTrackingFilter::CheckCurvature(DirectionContainer* fib, bool front)
 {
   if (fib->size()<8)
@@ -682,6 +996,50 @@ void StreamlineTrackingFilter::GetSeedPointsFromSeedImage()
   }
 }
 
+void StreamlineTrackingFilter::TrackSeed(int seed)
+{
+  const itk::Point<float> worldPos = m_SeedPoints.at(seed);
+  itk::Index<3> zeroIndex; zeroIndex.Fill(0);
+
+  for (unsigned int trials=0; trials<m_TrialsPerSeed; ++trials)
+  {
+    FiberType fib;
+    DirectionContainer direction_container;
+    float tractLength = 0;
+    unsigned int counter = 0;
+
+    // get starting direction
+    vnl_vector_fixed<float,3> dir; dir.fill(0.0);
+    std::deque< vnl_vector_fixed<float,3> > olddirs;
+    dir = GetNewDirection(worldPos, olddirs, zeroIndex) * 0.5f;
+
+    bool exclude = false;
+    if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(worldPos, m_InterpolateMasks, m_ExclusionInterpolator))
+      exclude = true;
+
+    bool success = false;
+    if (dir.magnitude()>0.0001 && !exclude)
+    {
+      // forward tracking
+      tractLength = FollowStreamline(worldPos, dir, &fib, &direction_container, 0, false, exclude);
+      fib.push_front(worldPos);
+
+      // backward tracking
+      if (!exclude)
+        tractLength = FollowStreamline(worldPos, -dir, &fib, &direction_container, tractLength, true, exclude);
+
+      counter = fib.size();
+
+      if (tractLength>=m_MinTractLength && counter>=2 && !exclude)
+        success = StoreFiber(&fib);
+    }
+
+    if (success || m_TrackingHandler->GetMode()!=mitk::TrackingDataHandler::PROBABILISTIC)
+      break;  // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
+
+  }// trials per seed
+}
+
 void StreamlineTrackingFilter::GenerateData()
 {
   this->BeforeTracking();
@@ -690,100 +1048,43 @@ void StreamlineTrackingFilter::GenerateData()
 
   m_CurrentTracts = 0;
   int num_seeds = m_SeedPoints.size();
-  itk::Index<3> zeroIndex; zeroIndex.Fill(0);
   m_Progress = 0;
-  int i = 0;
   int print_interval = num_seeds/100;
   if (print_interval<100)
     m_Verbose=false;
 
+  // streamlines in lock-step need a batch of seeds per thread, the demo mode visualizes single streamlines
+  int batch_size = m_DemoMode ? 1 : std::max(1, static_cast<int>(m_LockStepBatchSize));
+
+  // seed batches are handed out by an atomic counter, so threads that finish early just fetch the next batch
+  std::atomic<int> next_seed(0);
+  std::mutex print_mutex;
+
 #pragma omp parallel
-  while (i<num_seeds && !m_StopTracking)
+  while (!m_StopTracking)
   {
-    int temp_i = 0;
-#pragma omp critical
-    {
-      temp_i = i;
-      i++;
-    }
+    int first_seed = next_seed.fetch_add(batch_size);
+    if (first_seed>=num_seeds)
+      break;
+    int count = std::min(batch_size, num_seeds-first_seed);
 
-    if (temp_i>=num_seeds || m_StopTracking)
-      continue;
-    else if (m_Verbose && i%print_interval==0)
-#pragma omp critical
+    if (count>1)
+      TrackSeedsInLockStep(first_seed, count);
+    else
+      TrackSeed(first_seed);
+
+    // progress snapshot, skipped if another thread is currently printing
+    unsigned int progress = m_Progress += count;
+    if (m_Verbose && progress/print_interval != (progress-count)/print_interval && print_mutex.try_lock())
     {
-      m_Progress += print_interval;
       std::cout << "                                                                                                     \r";
       if (m_MaxNumTracts>0)
-        std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << "/" << m_MaxNumTracts << '\r';
+        std::cout << "Tried: " << progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts.load() << "/" << m_MaxNumTracts << '\r';
       else
-        std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << '\r';
+        std::cout << "Tried: " << progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts.load() << '\r';
       cout.flush();
+      print_mutex.unlock();
     }
-
-    const itk::Point<float> worldPos = m_SeedPoints.at(temp_i);
-
-    for (unsigned int trials=0; trials<m_TrialsPerSeed; ++trials)
-    {
-      FiberType fib;
-      DirectionContainer direction_container;
-      float tractLength = 0;
-      unsigned int counter = 0;
-
-      // get starting direction
-      vnl_vector_fixed<float,3> dir; dir.fill(0.0);
-      std::deque< vnl_vector_fixed<float,3> > olddirs;
-      dir = GetNewDirection(worldPos, olddirs, zeroIndex) * 0.5f;
-
-      bool exclude = false;
-      if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(worldPos, m_InterpolateMasks, m_ExclusionInterpolator))
-        exclude = true;
-
-      bool success = false;
-      if (dir.magnitude()>0.0001 && !exclude)
-      {
-        // forward tracking
-        tractLength = FollowStreamline(worldPos, dir, &fib, &direction_container, 0, false, exclude);
-        fib.push_front(worldPos);
-
-        // backward tracking
-        if (!exclude)
-          tractLength = FollowStreamline(worldPos, -dir, &fib, &direction_container, tractLength, true, exclude);
-
-        counter = fib.size();
-
-        if (tractLength>=m_MinTractLength && counter>=2 && !exclude)
-        {
-#pragma omp critical
-          if ( IsValidFiber(&fib) )
-          {
-            if (!m_StopTracking)
-            {
-              if (!m_UseOutputProbabilityMap)
-                m_Tractogram.push_back(fib);
-              else
-                FiberToProbmap(&fib);
-              m_CurrentTracts++;
-              success = true;
-            }
-            if (m_MaxNumTracts > 0 && m_CurrentTracts>=static_cast<unsigned int>(m_MaxNumTracts))
-            {
-              if (!m_StopTracking)
-              {
-                std::cout << "                                                                                                     \r";
-                MITK_INFO << "Reconstructed maximum number of tracts (" << m_CurrentTracts << "). Stopping tractography.";
-              }
-              m_StopTracking = true;
-            }
-          }
-        }
-      }
-
-      if (success || m_TrackingHandler->GetMode()!=mitk::TrackingDataHandler::PROBABILISTIC)
-        break;  // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
-
-    }// trials per seed
-
   }// seed points
 
   this->AfterTracking();
@@ -889,37 +1190,40 @@ void StreamlineTrackingFilter::FiberToProbmap(FiberType* fib)
     if (idx != last_idx)
     {
       if (m_OutputProbabilityMap->GetLargestPossibleRegion().IsInside(idx))
-        m_OutputProbabilityMap->SetPixel(idx, m_OutputProbabilityMap->GetPixel(idx)+1);
+      {
+        double* value = m_OutputProbabilityMap->GetBufferPointer() + m_OutputProbabilityMap->ComputeOffset(idx);
+#pragma omp atomic
+        *value += 1;
+      }
       last_idx = idx;
     }
   }
 }
 
-void StreamlineTrackingFilter::BuildFibers(bool check)
+void StreamlineTrackingFilter::BuildFibers(FiberType* current_fiber)
 {
-  if (m_BuildFibersReady<omp_get_num_threads() && check)
-    return;
-
   m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
   vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
   vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
 
-  for (unsigned int i=0; i<m_Tractogram.size(); i++)
+  auto add_fiber = [&](const FiberType& fib)
   {
     vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    FiberType fib = m_Tractogram.at(i);
-    for (FiberType::iterator it = fib.begin(); it!=fib.end(); ++it)
+    for (FiberType::const_iterator it = fib.begin(); it!=fib.end(); ++it)
     {
       vtkIdType id = vNewPoints->InsertNextPoint((*it).GetDataPointer());
       container->GetPointIds()->InsertNextId(id);
     }
     vNewLines->InsertNextCell(container);
-  }
+  };
 
-  if (check)
-    for (int i=0; i<m_BuildFibersReady; i++)
-      m_Tractogram.pop_back();
-  m_BuildFibersReady = 0;
+  for (const FiberType& fib : m_Tractogram)
+    add_fiber(fib);
+  for (const BundleType& bundle : m_ThreadTractograms)  // fibers that are not merged yet
+    for (const FiberType& fib : bundle)
+      add_fiber(fib);
+  if (current_fiber!=nullptr)
+    add_fiber(*current_fiber);
 
   m_FiberPolyData->SetPoints(vNewPoints);
   m_FiberPolyData->SetLines(vNewLines);
@@ -932,9 +1236,17 @@ void StreamlineTrackingFilter::AfterTracking()
     std::cout << "                                                                                                     \r";
   if (!m_UseOutputProbabilityMap)
   {
+    // merge the fibers of all threads
+    for (BundleType& bundle : m_ThreadTractograms)
+    {
+      m_Tractogram.insert(m_Tractogram.end(), std::make_move_iterator(bundle.begin()), std::make_move_iterator(bundle.end()));
+      bundle.clear();
+    }
+    m_ThreadTractograms.clear();
+
     MITK_INFO << "Reconstructed " << m_Tractogram.size() << " fibers.";
     MITK_INFO << "Generating polydata ";
-    BuildFibers(false);
+    BuildFibers();
   }
   else
   {
@@ -32,6 +32,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkSimpleFastMutexLock.h>
 #include <mitkDiffusionPropertyHelper.h>
 #include <mitkPointSet.h>
+#include <atomic>
 #include <chrono>
 #include <TrackingHandlers/mitkTrackingDataHandler.h>
 #include <MitkFiberTrackingExports.h>
@@ -83,7 +84,6 @@ public:
   volatile bool    m_PauseTracking;
   bool    m_AbortTracking;
   bool    m_BuildFibersFinished;
-  int     m_BuildFibersReady;
   volatile bool m_Stop;
   mitk::PointSet::Pointer             m_SamplingPointset;
   mitk::PointSet::Pointer             m_StopVotePointset;
@@ -133,6 +133,7 @@ public:
   itkSetMacro( TrackingPriorWeight, float)            ///< Weight between prior and data [0-1]. One mean tracking only on the prior peaks, zero only on the data.
   itkSetMacro( TrackingPriorAsMask, bool)             ///< If true, data directions in voxels where prior directions are invalid are set to zero
   itkSetMacro( IntroduceDirectionsFromPrior, bool)    ///< If false, prior voxels with invalid data voxel are ignored
+  itkSetMacro( LockStepBatchSize, unsigned int )      ///< Number of seeds per thread whose streamlines are propagated in lock-step so that the direction proposals of all of them are requested from the tracking handler in one batch. Pays off for handlers with a high per-call overhead like the random forest handler. Default is 1 (one streamline after the other).
 
   ///< Use manually defined points in physical space as seed points instead of seed image
   void SetSeedPoints( const std::vector< itk::Point<float> >& sP) {
@@ -165,6 +166,29 @@ protected:
   void CalculateNewPosition(itk::Point<float, 3>& pos, vnl_vector_fixed<float,3>& dir);    ///< Calculate next integration step.
   float FollowStreamline(itk::Point<float, 3> start_pos, vnl_vector_fixed<float,3> dir, FiberType* fib, DirectionContainer* container, float tractLength, bool front, bool& exclude);       ///< Start streamline in one direction.
   vnl_vector_fixed<float,3> GetNewDirection(const itk::Point<float, 3>& pos, std::deque< vnl_vector_fixed<float,3> >& olddirs, itk::Index<3>& oldIndex); ///< Determine new direction by sample voting at the current position taking the last progression direction into account.
+  void GetNewDirections(const std::vector< itk::Point<float, 3> >& positions, const std::vector< std::deque< vnl_vector_fixed<float,3> >* >& olddirs, const std::vector< itk::Index<3>* >& oldIndices, std::vector< vnl_vector_fixed<float,3> >& directions); ///< GetNewDirection() for several positions. All direction proposals are requested from the tracking handler in batches.
+
+  /** Streamline that is propagated in lock-step with others. */
+  struct StreamlineState
+  {
+    itk::Point<float, 3>                        seed_pos;
+    vnl_vector_fixed<float,3>                   start_dir;
+    itk::Point<float, 3>                        pos;
+    vnl_vector_fixed<float,3>                   dir;
+    FiberType                                   fib;
+    DirectionContainer                          container;
+    std::deque< vnl_vector_fixed<float,3> >     last_dirs;
+    itk::Index<3>                               oldIndex;
+    float                                       tractLength;
+    int                                         step;
+    bool                                        front;
+    bool                                        exclude;
+    bool                                        started;
+  };
+  void FollowStreamlines(std::vector< StreamlineState* >& streamlines);   ///< FollowStreamline() for several streamlines in lock-step
+  void TrackSeedsInLockStep(int first_seed, int num_seeds);               ///< Tracks the streamlines of consecutive seed points in lock-step
+  void TrackSeed(int seed);                                               ///< Tracks the streamline(s) of one seed point
+  bool StoreFiber(FiberType* fib);                                        ///< Adds the fiber to the tractogram of the calling thread if it is valid. Returns true if the fiber was added.
 
   std::vector< vnl_vector_fixed<float,3> > CreateDirections(int NPoints);
 
@@ -175,6 +199,7 @@ protected:
   vtkSmartPointer<vtkPoints>          m_Points;
   vtkSmartPointer<vtkCellArray>       m_Cells;
   BundleType                          m_Tractogram;
+  std::vector< BundleType >           m_ThreadTractograms;    ///< fibers accepted by each thread, merged into m_Tractogram after tracking
   BundleType                          m_GmStubs;
 
   ItkFloatImgType::Pointer            m_StoppingRegions;
@@ -212,14 +237,15 @@ protected:
   bool                                m_Random;
   bool                                m_UseOutputProbabilityMap;
   std::vector< itk::Point<float> >    m_SeedPoints;
-  unsigned int                        m_CurrentTracts;
-  unsigned int                        m_Progress;
-  bool                                m_StopTracking;
+  std::atomic<unsigned int>           m_CurrentTracts;
+  std::atomic<unsigned int>           m_Progress;
+  std::atomic<bool>                   m_StopTracking;
   bool                                m_InterpolateMasks;
   unsigned int                        m_TrialsPerSeed;
   EndpointConstraints                 m_EndpointConstraint;
+  unsigned int                        m_LockStepBatchSize;
 
-  void BuildFibers(bool check);
+  void BuildFibers(FiberType* current_fiber=nullptr);   ///< Builds the output polydata from all accepted fibers and, in demo mode, the fiber that is currently tracked
   float CheckCurvature(DirectionContainer *fib, bool front);
 
   // decision forest
@@ -39,7 +39,39 @@ template< class TPixelType >
 void DftImageFilter< TPixelType >
 ::BeforeThreadedGenerateData()
 {
+    typename InputImageType::Pointer inputImage  = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+
+    int szx = inputImage->GetLargestPossibleRegion().GetSize(0);
+    int szy = inputImage->GetLargestPossibleRegion().GetSize(1);
+
+    // centered coordinates: (0 -- N) --> (-N/2 -- N/2), identical for image and k-space positions
+    auto center = [](int i, int sz){ return sz%2==1 ? i-(sz-1)/2 : i-sz/2; };
+
+    std::vector< std::complex< double > > xPhaseFactors(szx*szx);
+    for (int kx=0; kx<szx; kx++)
+        for (int x=0; x<szx; x++)
+            xPhaseFactors[x + kx*szx] = std::polar(1.0, -2 * itk::Math::pi * center(kx, szx)*center(x, szx)/szx);
 
+    m_YPhaseFactors.resize(szy*szy);
+    for (int ky=0; ky<szy; ky++)
+        for (int y=0; y<szy; y++)
+            m_YPhaseFactors[y + ky*szy] = std::polar(1.0, -2 * itk::Math::pi * center(ky, szy)*center(y, szy)/szy);
+
+    // transformation along x
+    m_RowTransforms.assign(szx*szy, std::complex< double >(0,0));
+    typename InputImageType::IndexType idx;
+    for (int y=0; y<szy; y++)
+    {
+        idx[1] = y;
+        for (int x=0; x<szx; x++)
+        {
+            idx[0] = x;
+            vcl_complex<TPixelType> value = inputImage->GetPixel(idx);
+            std::complex< double > f(value.real(), value.imag());
+            for (int kx=0; kx<szx; kx++)
+                m_RowTransforms[kx + y*szx] += f * xPhaseFactors[x + kx*szx];
+        }
+    }
 }
 
 template< class TPixelType >
@@ -50,48 +82,20 @@ void DftImageFilter< TPixelType >
 
     ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
 
-    typedef ImageRegionConstIterator< InputImageType > InputIteratorType;
-    typename InputImageType::Pointer inputImage  = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
-
     int szx = outputImage->GetLargestPossibleRegion().GetSize(0);
     int szy = outputImage->GetLargestPossibleRegion().GetSize(1);
 
+    // transformation along y
     while( !oit.IsAtEnd() )
     {
-        float kx = oit.GetIndex()[0];
-        float ky = oit.GetIndex()[1];
-
-        if ((int)szx%2==1)
-            kx -= (szx-1)/2;
-        else
-            kx -= szx/2;
-        if ((int)szy%2==1)
-            ky -= (szy-1)/2;
-        else
-            ky -= szy/2;
-
-        vcl_complex<TPixelType> s(0,0);
-        InputIteratorType it(inputImage, inputImage->GetLargestPossibleRegion() );
-        while( !it.IsAtEnd() )
-        {
-            float x = it.GetIndex()[0];
-            float y = it.GetIndex()[1];
+        int kx = oit.GetIndex()[0];
+        int ky = oit.GetIndex()[1];
 
-            if ((int)szx%2==1)
-                x -= (szx-1)/2;
-            else
-                x -= szx/2;
-            if ((int)szy%2==1)
-                y -= (szy-1)/2;
-            else
-                y -= szy/2;
-
-            s += it.Get() * exp( std::complex<TPixelType>(0, -2 * itk::Math::pi * (kx*x/szx + ky*y/szy) ) );
-
-            ++it;
-        }
+        std::complex< double > s(0,0);
+        for (int y=0; y<szy; y++)
+            s += m_RowTransforms[kx + y*szx] * m_YPhaseFactors[y + ky*szy];
 
-        oit.Set(s);
+        oit.Set(vcl_complex<TPixelType>(s.real(), s.imag()));
         ++oit;
     }
 }
@@ -27,11 +27,15 @@ This file is based heavily on a corresponding ITK filter.
 #include <itkDiffusionTensor3D.h>
 #include <vcl_complex.h>
 #include <mitkFiberfoxParameters.h>
+#include <complex>
+#include <vector>
 
 namespace itk{
 
 /**
-* \brief 2D Discrete Fourier Transform Filter (complex to real). Special issue for Fiberfox -> rearranges slice. */
+* \brief 2D Discrete Fourier Transform Filter (complex to real). Special issue for Fiberfox -> rearranges slice.
+* The transformation is separated into a transformation along x, which is computed once before the threaded part,
+* and a transformation along y for each output pixel. Both use precomputed phase factors. */
 
 template< class TPixelType >
 class DftImageFilter :
@@ -68,6 +72,8 @@ protected:
 private:
 
     FiberfoxParameters  m_Parameters;
+    std::vector< std::complex< double > >   m_RowTransforms;   ///< input transformed along x, indexed by kx + y*szx
+    std::vector< std::complex< double > >   m_YPhaseFactors;   ///< exp(-i*2pi*ky*y/szy), indexed by y + ky*szy
 };
 
 }
@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <ctime>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
+#include <map>
 
 #include "itkKspaceImageFilter.h"
 #include <itkImageRegionConstIterator.h>
@@ -37,6 +39,7 @@ namespace itk {
     , m_UseConstantRandSeed(false)
     , m_SpikesPerSlice(0)
     , m_IsBaseline(true)
+    , m_MaxOffResonancePhaseStep(0.05)
   {
     m_DiffusionGradientDirection.Fill(0.0);
     m_CoilPosition.Fill(0.0);
@@ -119,6 +122,95 @@ namespace itk {
     m_ReadoutScheme->AdjustEchoTime();
 
     m_FmapInterpolator->SetInputImage(m_Parameters->m_SignalGen.m_FrequencyMap);
+
+    // precompute all voxel terms that do not depend on the k-space position
+    int xMax = m_CompartmentImages.at(0)->GetLargestPossibleRegion().GetSize(0); // scanner coverage in x-direction
+    int yMax = m_CompartmentImages.at(0)->GetLargestPossibleRegion().GetSize(1); // scanner coverage in y-direction
+    float yMaxFov = yMax;
+    if (m_Parameters->m_Misc.m_DoAddAliasing)
+        yMaxFov *= m_Parameters->m_SignalGen.m_CroppingFactor;               // actual FOV in y-direction (in x-direction FOV=xMax)
+    m_YFov = yMaxFov;
+
+    m_VoxelX.resize(xMax);
+    for (int x=0; x<xMax; x++)
+    {
+      float xc = x;
+      if (xMax%2==1){ xc -= (xMax-1)/2.0f; }
+      else{ xc -= xMax/2.0f; }
+      m_VoxelX[x] = xc;
+    }
+
+    std::vector< float > centeredY(yMax);
+    m_VoxelY.resize(yMax);
+    for (int y=0; y<yMax; y++)
+    {
+      float yc = y;
+      if (yMax%2==1){ yc -= (yMax-1)/2.0f; }
+      else{ yc -= yMax/2.0f; }
+      centeredY[y] = yc;
+
+      // if signal comes from outside FOV, mirror it back (wrap-around artifact - aliasing)
+      if (yc<-yMaxFov/2)
+        yc += yMaxFov;
+      else if (yc>=yMaxFov/2)
+        yc -= yMaxFov;
+      m_VoxelY[y] = yc;
+    }
+
+    // without relaxation, the compartment signals can be summed up right away
+    unsigned int numSignals = 1;
+    if (m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
+      numSignals = m_CompartmentImages.size();
+    m_VoxelSignals.assign(numSignals, std::vector< double >(xMax*yMax, 0.0));
+
+    bool eddy = m_Parameters->m_SignalGen.m_EddyStrength>0 && m_Parameters->m_Misc.m_DoAddEddyCurrents && !m_IsBaseline;
+    bool distortions = m_Parameters->m_Misc.m_DoAddDistortions && m_Parameters->m_SignalGen.m_FrequencyMap.IsNotNull();
+    m_EddyOffResonance.assign(eddy ? xMax*yMax : 0, 0.0);
+    m_FieldOffResonance.assign(distortions ? xMax*yMax : 0, 0.0);
+    m_MaxEddyOffResonance = 0;
+    m_MaxFieldOffResonance = 0;
+
+    for (int y=0; y<yMax; y++)
+      for (int x=0; x<xMax; x++)
+      {
+        int v = x + y*xMax;
+        typename InputImageType::IndexType input_idx; input_idx[0] = x; input_idx[1] = y;
+
+        VectorType pos; pos[0] = m_VoxelX[x]; pos[1] = centeredY[y]; pos[2] = m_Z;
+        pos = m_Transform*pos/1000;   // vector from image center to current position (in meter)
+
+        double coilSensitivity = 1;
+        if (m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
+          coilSensitivity = CoilSensitivity(pos);
+
+        for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
+          m_VoxelSignals.at(std::min(i, numSignals-1))[v] += m_CompartmentImages.at(i)->GetPixel(input_idx) * m_Parameters->m_SignalGen.m_SignalScale * coilSensitivity;
+
+        // frequency offset caused by eddy currents (without decay)
+        if (eddy)
+        {
+          m_EddyOffResonance[v] = m_DiffusionGradientDirection[0]*pos[0]+m_DiffusionGradientDirection[1]*pos[1]+m_DiffusionGradientDirection[2]*pos[2];
+          m_MaxEddyOffResonance = std::max(m_MaxEddyOffResonance, std::fabs(m_EddyOffResonance[v]));
+        }
+
+        // frequency offset caused by other distortions
+        if (distortions)
+        {
+          itk::Point<double, 3> point3D;
+          itk::Image<float, 3>::IndexType index; index[0] = x; index[1] = y; index[2] = m_Zidx;
+          if (m_Parameters->m_SignalGen.m_DoAddMotion)    // we have to account for the head motion since this also moves our frequency map
+          {
+            m_Parameters->m_SignalGen.m_FrequencyMap->TransformIndexToPhysicalPoint(index, point3D);
+            point3D = m_FiberBundle->TransformPoint( point3D.GetVnlVector(), -m_Rotation[0], -m_Rotation[1], -m_Rotation[2], -m_Translation[0], -m_Translation[1], -m_Translation[2] );
+            m_FieldOffResonance[v] = mitk::imv::GetImageValue<float>(point3D, true, m_FmapInterpolator);
+          }
+          else
+          {
+            m_FieldOffResonance[v] = m_Parameters->m_SignalGen.m_FrequencyMap->GetPixel(index);
+          }
+          m_MaxFieldOffResonance = std::max(m_MaxFieldOffResonance, std::fabs(m_FieldOffResonance[v]));
+        }
+      }
   }
 
   template< class ScalarType >
@@ -152,6 +244,117 @@ namespace itk {
     }
   }
 
+  template< class ScalarType >
+  void KspaceImageFilter< ScalarType >
+  ::ComputeSignals(std::vector< KspaceSample* >& samples, double ky)
+  {
+    int xMax = m_VoxelX.size();
+    int yMax = m_VoxelY.size();
+    unsigned int numSignals = m_VoxelSignals.size();
+    bool offResonance = !m_FieldOffResonance.empty() || !m_EddyOffResonance.empty();
+    const double twoPi = 2 * itk::Math::pi;
+
+    // phase along y is the same for all samples of the line
+    std::vector< std::complex<double> > yPhase(yMax);
+    for (int y=0; y<yMax; y++)
+      yPhase[y] = std::polar(1.0, twoPi*ky*m_VoxelY[y]/m_YFov);
+
+    std::stable_sort(samples.begin(), samples.end(), [](const KspaceSample* a, const KspaceSample* b){ return a->t < b->t; });
+
+    // select the samples at which the row transforms are computed exactly (time segments)
+    auto phaseChange = [&](const KspaceSample* a, const KspaceSample* b)
+    {
+      return twoPi*( std::fabs(b->fieldTime-a->fieldTime)*m_MaxFieldOffResonance + std::fabs(b->eddyTime-a->eddyTime)*m_MaxEddyOffResonance );
+    };
+    std::vector< unsigned int > nodes;
+    nodes.push_back(0);
+    if (offResonance)
+    {
+      unsigned int current = 0;
+      while (current+1 < samples.size())
+      {
+        unsigned int next = current+1;
+        if (m_MaxOffResonancePhaseStep>0)
+          while (next+1 < samples.size() && phaseChange(samples[current], samples[next+1]) <= m_MaxOffResonancePhaseStep)
+            next++;
+        nodes.push_back(next);
+        current = next;
+      }
+    }
+
+    // transform along y for each time segment and signal: sum_y f(x,y) * exp(i*2pi*(ky*y/yFov + omega(x,y)*t/1000))
+    std::vector< std::complex<double> > rowTransforms(nodes.size()*numSignals*xMax, std::complex<double>(0,0));
+    for (unsigned int n=0; n<nodes.size(); n++)
+    {
+      const KspaceSample* node = samples[nodes[n]];
+      std::complex<double>* transform = &rowTransforms[n*numSignals*xMax];
+      for (int y=0; y<yMax; y++)
+        for (int x=0; x<xMax; x++)
+        {
+          int v = x + y*xMax;
+          std::complex<double> phase = yPhase[y];
+          if (offResonance)
+          {
+            double omegaT = 0;
+            if (!m_EddyOffResonance.empty())
+              omegaT += m_EddyOffResonance[v]*node->eddyTime;
+            if (!m_FieldOffResonance.empty())
+              omegaT += m_FieldOffResonance[v]*node->fieldTime;
+            phase *= std::polar(1.0, twoPi*omegaT);
+          }
+          for (unsigned int i=0; i<numSignals; i++)
+            transform[i*xMax + x] += m_VoxelSignals[i][v] * phase;
+        }
+    }
+
+    // transform along x for each sample, row transforms between two time segments are interpolated linearly
+    std::vector< std::complex<double> > row(xMax);
+    unsigned int segment = 0;
+    for (unsigned int j=0; j<samples.size(); j++)
+    {
+      KspaceSample* sample = samples[j];
+      while (segment+1 < nodes.size() && nodes[segment+1] <= j)
+        segment++;
+
+      double w = 0;
+      if (segment+1 < nodes.size() && nodes[segment] != j)
+      {
+        double dt = samples[nodes[segment+1]]->t - samples[nodes[segment]]->t;
+        if (dt>0)
+          w = (sample->t - samples[nodes[segment]]->t)/dt;
+      }
+
+      std::fill(row.begin(), row.end(), std::complex<double>(0,0));
+      for (unsigned int i=0; i<numSignals; i++)
+      {
+        const std::complex<double>* t0 = &rowTransforms[(segment*numSignals + i)*xMax];
+        double r = sample->relaxation.at(i);
+        if (w>0)
+        {
+          const std::complex<double>* t1 = &rowTransforms[((segment+1)*numSignals + i)*xMax];
+          for (int x=0; x<xMax; x++)
+            row[x] += r*((1.0-w)*t0[x] + w*t1[x]);
+        }
+        else
+        {
+          for (int x=0; x<xMax; x++)
+            row[x] += r*t0[x];
+        }
+      }
+
+      // x is equally spaced, so the phase factors are computed by a recurrence
+      std::complex<double> s(0,0);
+      std::complex<double> phase = std::polar(1.0, twoPi*sample->kx*m_VoxelX[0]/xMax);
+      std::complex<double> step = std::polar(1.0, twoPi*sample->kx/xMax);
+      for (int x=0; x<xMax; x++)
+      {
+        s += row[x]*phase;
+        phase *= step;
+      }
+      sample->signal = s;
+    }
+  }
+
   template< class ScalarType >
   void KspaceImageFilter< ScalarType >
   ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType)
@@ -171,70 +374,67 @@ namespace itk {
 
     ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
 
-    typedef ImageRegionConstIterator< InputImageType > InputIteratorType;
-
     float kxMax = m_Parameters->m_SignalGen.m_CroppedRegion.GetSize(0);
     float kyMax = m_Parameters->m_SignalGen.m_CroppedRegion.GetSize(1);
-    float xMax = m_CompartmentImages.at(0)->GetLargestPossibleRegion().GetSize(0); // scanner coverage in x-direction
-    float yMax = m_CompartmentImages.at(0)->GetLargestPossibleRegion().GetSize(1); // scanner coverage in y-direction
-    float yMaxFov = yMax;
-    if (m_Parameters->m_Misc.m_DoAddAliasing)
-        yMaxFov *= m_Parameters->m_SignalGen.m_CroppingFactor;               // actual FOV in y-direction (in x-direction FOV=xMax)
 
     float numPix = kxMax*kyMax;
     // Adjust noise variance since it is the intended variance in physical space and not in k-space:
     float noiseVar = m_Parameters->m_SignalGen.m_PartialFourier*m_Parameters->m_SignalGen.m_NoiseVariance/(kyMax*kxMax);
 
+    bool eddy = !m_EddyOffResonance.empty();
+    unsigned int numSignals = m_VoxelSignals.size();
+
+    std::vector< KspaceSample > line;
     while( !oit.IsAtEnd() )
     {
-      typename OutputImageType::IndexType out_idx = oit.GetIndex();
+      // collect all samples of the current output line
+      line.clear();
+      long lineIdx = oit.GetIndex()[1];
+      while( !oit.IsAtEnd() && oit.GetIndex()[1]==lineIdx )
+      {
+        typename OutputImageType::IndexType out_idx = oit.GetIndex();
+        KspaceSample sample;
 
-      // time from maximum echo
-      float t= m_ReadoutScheme->GetTimeFromMaxEcho(out_idx);
+        // time from maximum echo
+        float t= m_ReadoutScheme->GetTimeFromMaxEcho(out_idx);
 
-      // time passed since k-space readout started
-      float tRead = m_ReadoutScheme->GetRedoutTime(out_idx);
+        // time passed since k-space readout started
+        float tRead = m_ReadoutScheme->GetRedoutTime(out_idx);
 
-      // time passes since application of the RF pulse
-      float tRf = m_Parameters->m_SignalGen.m_tEcho+t;
+        // time passes since application of the RF pulse
+        float tRf = m_Parameters->m_SignalGen.m_tEcho+t;
 
-      // calculate eddy current decay factor
-      // (TODO: vielleicht umbauen dass hier die zeit vom letzten diffusionsgradienten an genommen wird. doku dann auch entsprechend anpassen.)
-      float eddyDecay = 0;
-      if ( m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0)
-      {
-        eddyDecay = std::exp(-tRead/m_Parameters->m_SignalGen.m_Tau );
-      }
+        // calculate eddy current decay factor
+        // (TODO: vielleicht umbauen dass hier die zeit vom letzten diffusionsgradienten an genommen wird. doku dann auch entsprechend anpassen.)
+        float eddyDecay = 0;
+        if (eddy)
+          eddyDecay = std::exp(-tRead/m_Parameters->m_SignalGen.m_Tau );
 
-      // calcualte signal relaxation factors
-      std::vector< float > relaxFactor;
-      if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
-      {
-        for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
+        sample.t = t;
+        sample.fieldTime = t/1000.0;
+        sample.eddyTime = eddyDecay*t/1000.0;
+
+        // calcualte signal relaxation factors
+        sample.relaxation.assign(numSignals, 1.0);
+        if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
         {
-          relaxFactor.push_back( std::exp(-tRf/m_T2.at(i) -fabs(t)/ m_Parameters->m_SignalGen.m_tInhom)
-                                 * (1.0-std::exp(-(m_Parameters->m_SignalGen.m_tRep + tRf)/m_T1.at(i))) );
+          for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
+          {
+            sample.relaxation[i] = std::exp(-tRf/m_T2.at(i) -fabs(t)/ m_Parameters->m_SignalGen.m_tInhom)
+                                   * (1.0-std::exp(-(m_Parameters->m_SignalGen.m_tRep + tRf)/m_T1.at(i)));
+          }
         }
-      }
-      // get current k-space index (depends on the chosen k-space readout scheme)
-      itk::Index< 2 > kIdx = m_ReadoutScheme->GetActualKspaceIndex(out_idx);
+        // get current k-space index (depends on the chosen k-space readout scheme)
+        sample.kIdx = m_ReadoutScheme->GetActualKspaceIndex(out_idx);
 
-      // partial fourier
-      bool pf = false;
-      if (kIdx[1]>kyMax*m_Parameters->m_SignalGen.m_PartialFourier)
-        pf = true;
+        // partial fourier
+        sample.partialFourier = sample.kIdx[1]>kyMax*m_Parameters->m_SignalGen.m_PartialFourier;
 
-      if (!pf)
-      {
         // shift k for DFT: (0 -- N) --> (-N/2 -- N/2)
-        float kx = kIdx[0];
-        float ky = kIdx[1];
+        float kx = sample.kIdx[0];
         if ((int)kxMax%2==1){ kx -= (kxMax-1)/2; }
         else{ kx -= kxMax/2; }
 
-        if ((int)kyMax%2==1){ ky -= (kyMax-1)/2; }
-        else{ ky -= kyMax/2; }
-
         // add ghosting by adding gradient delay induced offset
         if (m_Parameters->m_Misc.m_DoAddGhosts)
         {
@@ -243,69 +443,32 @@ namespace itk {
           else
             kx += m_Parameters->m_SignalGen.m_KspaceLineOffset;
         }
+        sample.kx = kx;
 
-        vcl_complex<ScalarType> s(0,0);
-        InputIteratorType it(m_CompartmentImages.at(0), m_CompartmentImages.at(0)->GetLargestPossibleRegion() );
-        while( !it.IsAtEnd() )
-        {
-          typename InputImageType::IndexType input_idx = it.GetIndex();
-          float x = input_idx[0];
-          float y = input_idx[1];
-          if ((int)xMax%2==1){ x -= (xMax-1)/2; }
-          else{ x -= xMax/2; }
-          if ((int)yMax%2==1){ y -= (yMax-1)/2; }
-          else{ y -= yMax/2; }
-
-          VectorType pos; pos[0] = x; pos[1] = y; pos[2] = m_Z;
-          pos = m_Transform*pos/1000;   // vector from image center to current position (in meter)
-
-          vcl_complex<ScalarType> f(0, 0);
-
-          // sum compartment signals and simulate relaxation
-          for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
-            if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
-              f += std::complex<ScalarType>( m_CompartmentImages.at(i)->GetPixel(it.GetIndex()) * relaxFactor.at(i) *  m_Parameters->m_SignalGen.m_SignalScale, 0);
-            else
-              f += std::complex<ScalarType>( m_CompartmentImages.at(i)->GetPixel(it.GetIndex()) * m_Parameters->m_SignalGen.m_SignalScale, 0);
-
-          if (m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
-            f *= CoilSensitivity(pos);
-
-          // simulate eddy currents and other distortions
-          float omega = 0;   // frequency offset
-          if (  m_Parameters->m_SignalGen.m_EddyStrength>0 && m_Parameters->m_Misc.m_DoAddEddyCurrents && !m_IsBaseline)
-          {
-            omega += (m_DiffusionGradientDirection[0]*pos[0]+m_DiffusionGradientDirection[1]*pos[1]+m_DiffusionGradientDirection[2]*pos[2]) * eddyDecay;
-          }
-
-          if (m_Parameters->m_Misc.m_DoAddDistortions && m_Parameters->m_SignalGen.m_FrequencyMap.IsNotNull()) // simulate distortions
-          {
-            itk::Point<double, 3> point3D;
-            itk::Image<float, 3>::IndexType index; index[0] = input_idx[0]; index[1] = input_idx[1]; index[2] = m_Zidx;
-            if (m_Parameters->m_SignalGen.m_DoAddMotion)    // we have to account for the head motion since this also moves our frequency map
-            {
-              m_Parameters->m_SignalGen.m_FrequencyMap->TransformIndexToPhysicalPoint(index, point3D);
-              point3D = m_FiberBundle->TransformPoint( point3D.GetVnlVector(), -m_Rotation[0], -m_Rotation[1], -m_Rotation[2], -m_Translation[0], -m_Translation[1], -m_Translation[2] );
-              omega += mitk::imv::GetImageValue<float>(point3D, true, m_FmapInterpolator);
-            }
-            else
-            {
-              omega += m_Parameters->m_SignalGen.m_FrequencyMap->GetPixel(index);
-            }
-          }
+        line.push_back(sample);
+        ++oit;
+      }
 
-          // if signal comes from outside FOV, mirror it back (wrap-around artifact - aliasing)
-          if (y<-yMaxFov/2)
-            y += yMaxFov;
-          else if (y>=yMaxFov/2)
-            y -= yMaxFov;
+      // samples of the same k-space line share the transformation along y
+      std::map< long, std::vector< KspaceSample* > > kspaceLines;
+      for (auto& sample : line)
+        if (!sample.partialFourier)
+          kspaceLines[sample.kIdx[1]].push_back(&sample);
+      for (auto& kspaceLine : kspaceLines)
+      {
+        float ky = kspaceLine.first;
+        if ((int)kyMax%2==1){ ky -= (kyMax-1)/2; }
+        else{ ky -= kyMax/2; }
+        ComputeSignals(kspaceLine.second, ky);
+      }
 
-          // actual DFT term
-          s += f * std::exp( std::complex<ScalarType>(0, 2 * itk::Math::pi * (kx*x/xMax + ky*y/yMaxFov + omega*t/1000 )) );
+      // add spikes and noise in readout order
+      for (auto& sample : line)
+      {
+        if (sample.partialFourier)
+          continue;
 
-          ++it;
-        }
-        s /= numPix;
+        vcl_complex<ScalarType> s(sample.signal.real()/numPix, sample.signal.imag()/numPix);
 
         if (m_SpikesPerSlice>0 && sqrt(s.imag()*s.imag()+s.real()*s.real()) > sqrt(m_Spike.imag()*m_Spike.imag()+m_Spike.real()*m_Spike.real()) )
           m_Spike = s;
@@ -313,11 +476,9 @@ namespace itk {
         if (m_Parameters->m_SignalGen.m_NoiseVariance>0 && m_Parameters->m_Misc.m_DoAddNoise)
           s = vcl_complex<ScalarType>(s.real()+randGen->GetNormalVariate(0,noiseVar), s.imag()+randGen->GetNormalVariate(0,noiseVar));
 
-        outputImage->SetPixel(kIdx, s);
-        m_KSpaceImage->SetPixel(kIdx, sqrt(s.imag()*s.imag()+s.real()*s.real()) );
+        outputImage->SetPixel(sample.kIdx, s);
+        m_KSpaceImage->SetPixel(sample.kIdx, sqrt(s.imag()*s.imag()+s.real()*s.real()) );
       }
-
-      ++oit;
     }
   }
 
@@ -26,6 +26,7 @@ This file is based heavily on a corresponding ITK filter.
 #include <itkImageSource.h>
 #include <vcl_complex.h>
 #include <vector>
+#include <complex>
 #include <itkMersenneTwisterRandomVariateGenerator.h>
 #include <mitkFiberfoxParameters.h>
 #include <mitkFiberBundle.h>
@@ -42,7 +43,12 @@ namespace itk{
 * - Image distortions (off-frequency effects)
 * - Gibbs ringing
 * - Eddy current effects
-* Based on a discrete fourier transformation.
+* Based on a discrete fourier transformation. The transformation is separated into a transformation along the
+* image rows and one along the columns, so each k-space line only needs one pass over the image. Off-resonance
+* effects (distortions, eddy currents) make the phase of each voxel time dependent. They are handled by computing the
+* transformation exactly at a few samples of each line (time segments) and by linearly interpolating the samples
+* in between. The segments are chosen so that the phase of no voxel changes by more than MaxOffResonancePhaseStep
+* between two of them. Spikes, ghosts and noise are added to each acquired sample.
 * See "Fiberfox: Facilitating the creation of realistic white matter software phantoms" (DOI: 10.1002/mrm.25045) for details.
 */
 
@@ -81,6 +87,7 @@ namespace itk{
     itkSetMacro( Zidx, int )
     itkSetMacro( FiberBundle, FiberBundle::Pointer )
     itkSetMacro( CoilPosition, VectorType )
+    itkSetMacro( MaxOffResonancePhaseStep, double ) ///< Maximum phase change (rad) of a voxel between two time segments. 0 computes every sample exactly. Default is 0.05.
     itkGetMacro( KSpaceImage, typename InputImageType::Pointer )    ///< k-space magnitude image
     itkGetMacro( SpikeLog, std::string )
 
@@ -97,6 +104,22 @@ namespace itk{
 
     float CoilSensitivity(VectorType& pos);
 
+    /** k-space sample of the currently simulated line */
+    struct KspaceSample
+    {
+      itk::Index< 2 >           kIdx;
+      bool                      partialFourier; ///< sample is not acquired but filled using the k-space symmetry
+      double                    kx;             ///< shifted k-space position in x, including the ghosting offset
+      double                    t;              ///< time from maximum echo
+      double                    fieldTime;      ///< factor of the frequency map in the phase
+      double                    eddyTime;       ///< factor of the eddy current frequency offset in the phase
+      std::vector< double >     relaxation;     ///< relaxation factor of each entry of m_VoxelSignals
+      std::complex< double >    signal;
+    };
+
+    /** Computes the signal of all samples. All samples have to be in the same k-space line (ky). */
+    void ComputeSignals(std::vector< KspaceSample* >& samples, double ky);
+
     void BeforeThreadedGenerateData() override;
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType threadID) override;
     void AfterThreadedGenerateData() override;
@@ -129,6 +152,18 @@ namespace itk{
 
     itk::LinearInterpolateImageFunction< itk::Image< float, 3 >, float >::Pointer   m_FmapInterpolator;
 
+    double                                  m_MaxOffResonancePhaseStep;
+
+    // the following is independent of the k-space position and computed once per slice
+    std::vector< std::vector< double > >    m_VoxelSignals;         ///< signal of each compartment with coil sensitivity, summed up if relaxation is not simulated
+    std::vector< double >                   m_VoxelX;               ///< centered x coordinate of each image column
+    std::vector< double >                   m_VoxelY;               ///< centered y coordinate of each image row, wrapped into the FOV
+    std::vector< double >                   m_FieldOffResonance;    ///< frequency map value of each voxel, empty if distortions are not simulated
+    std::vector< double >                   m_EddyOffResonance;     ///< eddy current frequency offset of each voxel without decay, empty if not simulated
+    double                                  m_MaxFieldOffResonance;
+    double                                  m_MaxEddyOffResonance;
+    double                                  m_YFov;
+
   private:
 
   };
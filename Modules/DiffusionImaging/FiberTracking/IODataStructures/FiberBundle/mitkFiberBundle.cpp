@@ -28,7 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolyLine.h>
 #include <vtkCellArray.h>
 #include <vtkCellData.h>
-#include <vtkIdFilter.h>
+#include <vtkIdTypeArray.h>
 #include <vtkClipPolyData.h>
 #include <vtkPlane.h>
 #include <vtkDoubleArray.h>
@@ -38,6 +38,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolygon.h>
 #include <vtkCleanPolyData.h>
 #include <boost/progress.hpp>
+#include <omp.h>
+#include <mitkParallelProgressDisplay.h>
 #include <vtkTransformPolyDataFilter.h>
 #include <mitkTransferFunction.h>
 #include <vtkLookupTable.h>
@@ -48,6 +50,54 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 const char* mitk::FiberBundle::FIBER_ID_ARRAY = "Fiber_IDs";
 
+// build polydata with one polyline per fiber from the contiguous fiber store
+static vtkSmartPointer<vtkPolyData> CreatePolyData(const std::vector< float >& points, const std::vector< vtkIdType >& offsets)
+{
+  auto numFibers = static_cast<vtkIdType>(offsets.size())-1;
+  vtkIdType numPoints = offsets.back();
+
+  vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(numPoints);
+  std::copy(points.begin(), points.begin()+3*numPoints, coordinates->GetPointer(0));
+  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
+  vtkNewPoints->SetData(coordinates);
+
+  // legacy cell array layout: (number of points, point ids ...) for each fiber
+  vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues(numFibers + numPoints);
+  vtkIdType* cells = connectivity->GetPointer(0);
+#pragma omp parallel for
+  for (vtkIdType i=0; i<numFibers; ++i)
+  {
+    vtkIdType* cell = cells + offsets[i] + i;
+    cell[0] = offsets[i+1]-offsets[i];
+    for (vtkIdType j=0; j<cell[0]; ++j)
+      cell[j+1] = offsets[i]+j;
+  }
+  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+  vtkNewCells->SetCells(numFibers, connectivity);
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(vtkNewPoints);
+  polyData->SetLines(vtkNewCells);
+  return polyData;
+}
+
+// concatenate individually processed fibers into a contiguous fiber store
+static void ConcatenateFibers(const std::vector< std::vector< float > >& fibers, std::vector< float >& points, std::vector< vtkIdType >& offsets)
+{
+  offsets.resize(fibers.size()+1);
+  offsets[0] = 0;
+  for (std::size_t i=0; i<fibers.size(); ++i)
+    offsets[i+1] = offsets[i] + static_cast<vtkIdType>(fibers[i].size()/3);
+
+  points.resize(3*static_cast<std::size_t>(offsets.back()));
+#pragma omp parallel for
+  for (int i=0; i<static_cast<int>(fibers.size()); ++i)
+    std::copy(fibers[i].begin(), fibers[i].end(), points.begin()+3*offsets[i]);
+}
+
 mitk::FiberBundle::FiberBundle( vtkPolyData* fiberPolyData )
   : m_NumFibers(0)
 {
@@ -64,7 +114,6 @@ mitk::FiberBundle::FiberBundle( vtkPolyData* fiberPolyData )
   }
 
   this->UpdateFiberGeometry();
-  this->GenerateFiberIds();
   this->ColorFibersByOrientation();
 }
 
@@ -75,48 +124,68 @@ mitk::FiberBundle::~FiberBundle()
 
 mitk::FiberBundle::Pointer mitk::FiberBundle::GetDeepCopy()
 {
-  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(m_FiberPolyData);
+  std::vector< float > points = m_FiberPoints;
+  std::vector< vtkIdType > offsets = m_FiberPointOffsets;
+  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New();
+  newFib->SetFiberStore(points, offsets);
   newFib->SetFiberColors(this->m_FiberColors);
   newFib->SetFiberWeights(this->m_FiberWeights);
   return newFib;
 }
 
-vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vector<unsigned int> fiberIds, vtkSmartPointer<vtkFloatArray> weights)
+// copy the selected fibers into a new contiguous fiber store
+static void CopyFibers(const mitk::FiberBundle* fib, const std::vector<unsigned int>& fiberIds, std::vector< float >& points, std::vector< vtkIdType >& offsets)
 {
-  vtkSmartPointer<vtkPolyData> newFiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  vtkSmartPointer<vtkCellArray> newLineSet = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkPoints> newPointSet = vtkSmartPointer<vtkPoints>::New();
-  weights->SetNumberOfValues(fiberIds.size());
+  offsets.assign(fiberIds.size()+1, 0);
+  for (std::size_t i=0; i<fiberIds.size(); ++i)
+    offsets[i+1] = offsets[i] + fib->GetNumberOfFiberPoints(fiberIds[i]);
 
-  int counter = 0;
-  auto finIt = fiberIds.begin();
-  while ( finIt != fiberIds.end() )
+  points.resize(3*static_cast<std::size_t>(offsets.back()));
+#pragma omp parallel for
+  for (int i=0; i<static_cast<int>(fiberIds.size()); ++i)
   {
-    if (*finIt>GetNumFibers()){
-      MITK_INFO << "FiberID can not be negative or >NumFibers!!! check id Extraction!" << *finIt;
+    const float* p = fib->GetFiberPoint(fiberIds[i], 0);
+    std::copy(p, p+3*(offsets[i+1]-offsets[i]), points.begin()+3*offsets[i]);
+  }
+}
+
+vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vector<unsigned int> fiberIds, vtkSmartPointer<vtkFloatArray> weights)
+{
+  for (std::size_t i=0; i<fiberIds.size(); ++i)
+    if (fiberIds[i]>=GetNumFibers())
+    {
+      MITK_INFO << "FiberID can not be negative or >NumFibers!!! check id Extraction!" << fiberIds[i];
+      fiberIds.resize(i);
       break;
     }
 
-    vtkSmartPointer<vtkCell> fiber = m_FiberIdDataSet->GetCell(*finIt);//->DeepCopy(fiber);
-    vtkSmartPointer<vtkPoints> fibPoints = fiber->GetPoints();
-    vtkSmartPointer<vtkPolyLine> newFiber = vtkSmartPointer<vtkPolyLine>::New();
-    newFiber->GetPointIds()->SetNumberOfIds( fibPoints->GetNumberOfPoints() );
+  std::vector< float > points;
+  std::vector< vtkIdType > offsets;
+  CopyFibers(this, fiberIds, points, offsets);
 
-    for(int i=0; i<fibPoints->GetNumberOfPoints(); i++)
-    {
-      newFiber->GetPointIds()->SetId(i, newPointSet->GetNumberOfPoints());
-      newPointSet->InsertNextPoint(fibPoints->GetPoint(i)[0], fibPoints->GetPoint(i)[1], fibPoints->GetPoint(i)[2]);
-    }
+  weights->SetNumberOfValues(static_cast<vtkIdType>(fiberIds.size()));
+  for (std::size_t i=0; i<fiberIds.size(); ++i)
+    weights->SetValue(static_cast<vtkIdType>(i), this->GetFiberWeight(fiberIds[i]));
 
-    weights->InsertValue(counter, this->GetFiberWeight(*finIt));
-    newLineSet->InsertNextCell(newFiber);
-    ++finIt;
-    ++counter;
-  }
+  return CreatePolyData(points, offsets);
+}
+
+mitk::FiberBundle::Pointer mitk::FiberBundle::GenerateFiberBundleByIds(const std::vector<unsigned int>& fiberIds)
+{
+  std::vector< float > points;
+  std::vector< vtkIdType > offsets;
+  CopyFibers(this, fiberIds, points, offsets);
+
+  vtkSmartPointer<vtkFloatArray> weights = vtkSmartPointer<vtkFloatArray>::New();
+  weights->SetName("FIBER_WEIGHTS");
+  weights->SetNumberOfValues(static_cast<vtkIdType>(fiberIds.size()));
+  for (std::size_t i=0; i<fiberIds.size(); ++i)
+    weights->SetValue(static_cast<vtkIdType>(i), this->GetFiberWeight(fiberIds[i]));
 
-  newFiberPolyData->SetPoints(newPointSet);
-  newFiberPolyData->SetLines(newLineSet);
-  return newFiberPolyData;
+  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New();
+  newFib->SetFiberStore(points, offsets);
+  newFib->SetFiberWeights(weights);
+  return newFib;
 }
 
 // merge two fiber bundles
@@ -135,9 +204,9 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundles(std::vector< mitk::Fibe
   weights->SetNumberOfValues(num_weights);
 
   unsigned int counter = 0;
-  for (unsigned int i=0; i<m_FiberPolyData->GetNumberOfCells(); ++i)
+  for (unsigned int i=0; i<GetFiberPolyData()->GetNumberOfCells(); ++i)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -206,9 +275,9 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
   weights->SetNumberOfValues(this->GetNumFibers()+fib->GetNumFibers());
 
   unsigned int counter = 0;
-  for (unsigned int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  for (unsigned int i=0; i<GetFiberPolyData()->GetNumberOfCells(); i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -260,59 +329,23 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
 // Only retain fibers with a weight larger than the specified threshold
 mitk::FiberBundle::Pointer mitk::FiberBundle::FilterByWeights(float weight_thr, bool invert)
 {
-  vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
-  vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
-
-  std::vector<float> weights;
-
+  std::vector< unsigned int > ids;
   for (unsigned int i=0; i<this->GetNumFibers(); i++)
   {
     if ( (invert && this->GetFiberWeight(i)>weight_thr) || (!invert && this->GetFiberWeight(i)<=weight_thr))
       continue;
-
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      double p[3];
-      points->GetPoint(j, p);
-
-      vtkIdType id = vNewPoints->InsertNextPoint(p);
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vNewLines->InsertNextCell(container);
-    weights.push_back(this->GetFiberWeight(i));
+    ids.push_back(i);
   }
 
-  // initialize PolyData
-  vNewPolyData->SetPoints(vNewPoints);
-  vNewPolyData->SetLines(vNewLines);
-
-  // initialize fiber bundle
-  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(vNewPolyData);
-  for (unsigned int i=0; i<weights.size(); ++i)
-    newFib->SetFiberWeight(i, weights.at(i));
-  return newFib;
+  return GenerateFiberBundleByIds(ids);
 }
 
 // Only retain a subsample of the fibers
 mitk::FiberBundle::Pointer mitk::FiberBundle::SubsampleFibers(float factor, bool random_seed)
 {
-  vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
-  vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
-
   unsigned int new_num_fibs = static_cast<unsigned int>(std::round(this->GetNumFibers()*factor));
   MITK_INFO << "Subsampling fibers with factor " << factor << "(" << new_num_fibs << "/" << this->GetNumFibers() << ")";
 
-  // add current fiber bundle
-  vtkSmartPointer<vtkFloatArray> weights = vtkSmartPointer<vtkFloatArray>::New();
-  weights->SetNumberOfValues(new_num_fibs);
-
   std::vector< unsigned int > ids;
   for (unsigned int i=0; i<this->GetNumFibers(); i++)
     ids.push_back(i);
@@ -321,36 +354,9 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubsampleFibers(float factor, bool
   else
     std::srand(0);
   std::random_shuffle(ids.begin(), ids.end());
+  ids.resize(std::min(new_num_fibs, static_cast<unsigned int>(ids.size())));
 
-  unsigned int counter = 0;
-  for (unsigned int i=0; i<new_num_fibs; i++)
-  {
-    vtkCell* cell = m_FiberPolyData->GetCell(ids.at(i));
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      double p[3];
-      points->GetPoint(j, p);
-
-      vtkIdType id = vNewPoints->InsertNextPoint(p);
-      container->GetPointIds()->InsertNextId(id);
-    }
-    weights->InsertValue(counter, this->GetFiberWeight(ids.at(i)));
-    vNewLines->InsertNextCell(container);
-    counter++;
-  }
-
-  // initialize PolyData
-  vNewPolyData->SetPoints(vNewPoints);
-  vNewPolyData->SetLines(vNewLines);
-
-  // initialize fiber bundle
-  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(vNewPolyData);
-  newFib->SetFiberWeights(weights);
-  return newFib;
+  return GenerateFiberBundleByIds(ids);
 }
 
 // subtract two fiber bundles
@@ -367,7 +373,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
   std::vector< std::vector< itk::Point<float, 3> > > points1;
   for(unsigned int i=0; i<m_NumFibers; i++ )
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -455,7 +461,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
 
   for( int i : ids )
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -485,43 +491,107 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
  */
 void mitk::FiberBundle::SetFiberPolyData(vtkSmartPointer<vtkPolyData> fiberPD, bool updateGeometry)
 {
-  if (fiberPD == nullptr)
-    this->m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  else
+  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
+  if (fiberPD != nullptr)
     m_FiberPolyData->DeepCopy(fiberPD);
 
   m_NumFibers = static_cast<unsigned int>(m_FiberPolyData->GetNumberOfLines());
 
   if (updateGeometry)
     UpdateFiberGeometry();
-  GenerateFiberIds();
+  else
+    UpdateFiberStore();
   ColorFibersByOrientation();
 }
 
+// remove fibers with less than two points from the fiber store, as vtkCleanPolyData does for polydata input
+static void RemoveDegenerateFibers(std::vector< float >& points, std::vector< vtkIdType >& offsets)
+{
+  bool degenerate = false;
+  for (std::size_t i=0; i+1<offsets.size() && !degenerate; ++i)
+    degenerate = offsets[i+1]-offsets[i]<2;
+  if (!degenerate)
+    return;
+
+  std::size_t numFibers = 0;
+  vtkIdType numPoints = 0;
+  for (std::size_t i=0; i+1<offsets.size(); ++i)
+  {
+    vtkIdType fiberPoints = offsets[i+1]-offsets[i];
+    if (fiberPoints<2)
+      continue;
+    std::copy(points.begin()+3*offsets[i], points.begin()+3*offsets[i+1], points.begin()+3*numPoints);
+    offsets[numFibers++] = numPoints;
+    numPoints += fiberPoints;
+  }
+  offsets[numFibers] = numPoints;
+  offsets.resize(numFibers+1);
+  points.resize(3*static_cast<std::size_t>(numPoints));
+}
+
+/*
+ * replace the fibers by the given contiguous fiber store (the input vectors are swapped into the bundle)
+ */
+void mitk::FiberBundle::SetFiberStore(std::vector< float >& points, std::vector< vtkIdType >& offsets)
+{
+  m_FiberPoints.swap(points);
+  m_FiberPointOffsets.swap(offsets);
+  m_SpatialIndex = nullptr;
+  if (m_FiberPointOffsets.empty())
+    m_FiberPointOffsets.push_back(0);
+  RemoveDegenerateFibers(m_FiberPoints, m_FiberPointOffsets);
+  m_FiberPolyData = nullptr;
+
+  // resets the color coding to the fiber orientation
+  m_FiberColors = nullptr;
+  UpdateFiberStatistics();
+}
+
+const mitk::FiberSpatialIndex* mitk::FiberBundle::GetSpatialIndex() const
+{
+  if (m_SpatialIndex==nullptr)
+    m_SpatialIndex = std::make_shared< FiberSpatialIndex >(this);
+  return m_SpatialIndex.get();
+}
+
 /*
- * return vtkPolyData
+ * return vtkPolyData, it is built from the fiber store on first access after the fibers have changed
  */
 vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GetFiberPolyData() const
 {
+  if (m_FiberPolyData==nullptr)
+    m_FiberPolyData = CreatePolyData(m_FiberPoints, m_FiberPointOffsets);
   return m_FiberPolyData;
 }
 
+static vtkSmartPointer<vtkUnsignedCharArray> CreateColorArray(vtkIdType numPoints)
+{
+  vtkSmartPointer<vtkUnsignedCharArray> colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  colors->SetNumberOfComponents(4);
+  colors->SetNumberOfTuples(numPoints);
+  colors->SetName("FIBER_COLORS");
+  std::fill(colors->GetPointer(0), colors->GetPointer(0)+4*numPoints, 0);
+  return colors;
+}
+
+static inline vnl_vector_fixed< double, 3 > GetVnlPoint(const float* p)
+{
+  vnl_vector_fixed< double, 3 > v;
+  v[0] = static_cast<double>(p[0]);
+  v[1] = static_cast<double>(p[1]);
+  v[2] = static_cast<double>(p[2]);
+  return v;
+}
+
 void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
 {
   if (m_MaxFiberLength<=0)
     return;
 
-  auto numOfPoints = this->GetNumberOfPoints();
+  m_FiberColors = CreateColorArray(this->GetNumberOfPoints());
+  unsigned char* colors = m_FiberColors->GetPointer(0);
 
-  //colors and alpha value for each single point, RGBA = 4 components
-  unsigned char rgba[4] = {0,0,0,0};
-  m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(numOfPoints * 4);
-  m_FiberColors->SetNumberOfComponents(4);
-  m_FiberColors->SetName("FIBER_COLORS");
-
-  auto numOfFibers = m_FiberPolyData->GetNumberOfLines();
-  if (numOfFibers < 1)
+  if (m_NumFibers < 1)
     return;
 
   mitk::LookupTable::Pointer mitkLookup = mitk::LookupTable::New();
@@ -531,12 +601,8 @@ void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
   mitkLookup->SetVtkLookupTable(lookupTable);
   mitkLookup->SetType(mitk::LookupTable::JET);
 
-  unsigned int count = 0;
-  for (unsigned int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-
     float l = m_FiberLengths.at(i)/m_MaxFiberLength;
     if (!normalize)
     {
@@ -544,21 +610,20 @@ void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
       if (l > 1.0f)
         l = 1.0;
     }
-    for (int j=0; j<numPoints; j++)
-    {
-      double color[3];
-      lookupTable->GetColor(1.0 - static_cast<double>(l), color);
-
-      rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
-      rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
-      rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
-      if (opacity)
-        rgba[3] = static_cast<unsigned char>(255.0f * l);
-      else
-        rgba[3] = static_cast<unsigned char>(255.0);
-      m_FiberColors->InsertTypedTuple(cell->GetPointId(j), rgba);
-      count++;
-    }
+    double color[3];
+    lookupTable->GetColor(1.0 - static_cast<double>(l), color);
+
+    unsigned char rgba[4] = {0,0,0,0};
+    rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
+    rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
+    rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
+    if (opacity)
+      rgba[3] = static_cast<unsigned char>(255.0f * l);
+    else
+      rgba[3] = static_cast<unsigned char>(255.0);
+
+    for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]; j++)
+      std::copy(rgba, rgba+4, colors+4*j);
   }
   m_UpdateTime3D.Modified();
   m_UpdateTime2D.Modified();
@@ -566,111 +631,58 @@ void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
 
 void mitk::FiberBundle::ColorFibersByOrientation()
 {
-  //===== FOR WRITING A TEST ========================
-  //  colorT size == tupelComponents * tupelElements
-  //  compare color results
-  //  to cover this code 100% also PolyData needed, where colorarray already exists
-  //  + one fiber with exactly 1 point
-  //  + one fiber with 0 points
-  //=================================================
-
-  vtkPoints* extrPoints = m_FiberPolyData->GetPoints();
-  vtkIdType numOfPoints = 0;
-  if (extrPoints!=nullptr)
-    numOfPoints = extrPoints->GetNumberOfPoints();
-
   //colors and alpha value for each single point, RGBA = 4 components
-  unsigned char rgba[4] = {0,0,0,0};
-  m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(numOfPoints * 4);
-  m_FiberColors->SetNumberOfComponents(4);
-  m_FiberColors->SetName("FIBER_COLORS");
+  m_FiberColors = CreateColorArray(this->GetNumberOfPoints());
+  unsigned char* colors = m_FiberColors->GetPointer(0);
 
-  auto numOfFibers = m_FiberPolyData->GetNumberOfLines();
-  if (numOfFibers < 1)
+  if (m_NumFibers < 1)
     return;
 
-  /* extract single fibers of fiberBundle */
-  vtkCellArray* fiberList = m_FiberPolyData->GetLines();
-  fiberList->InitTraversal();
-  for (int fi=0; fi<numOfFibers; ++fi) {
+#pragma omp parallel for
+  for (int fi=0; fi<static_cast<int>(m_NumFibers); ++fi)
+  {
+    auto pointsPerFiber = static_cast<int>(this->GetNumberOfFiberPoints(static_cast<unsigned int>(fi)));
 
-    vtkIdType* idList; // contains the point id's of the line
-    vtkIdType pointsPerFiber; // number of points for current line
-    fiberList->GetNextCell(pointsPerFiber, idList);
+    /* a single point does not define a fiber (use vertex mechanisms instead) */
+    if (pointsPerFiber <= 1)
+      continue;
 
-    /* single fiber checkpoints: is number of points valid */
-    if (pointsPerFiber > 1)
+    const float* points = this->GetFiberPoint(static_cast<unsigned int>(fi), 0);
+    unsigned char* rgba = colors + 4*m_FiberPointOffsets[static_cast<unsigned int>(fi)];
+    for (int i=0; i<pointsPerFiber; ++i, rgba+=4)
     {
-      /* operate on points of single fiber */
-      for (int i=0; i <pointsPerFiber; ++i)
+      vnl_vector_fixed< double, 3 > diff;
+      if (i<pointsPerFiber-1 && i > 0)
       {
-        /* process all points elastV[0]ept starting and endpoint for calculating color value take current point, previous point and next point */
-        if (i<pointsPerFiber-1 && i > 0)
-        {
-          /* The color value of the current point is influenced by the previous point and next point. */
-          vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-          vnl_vector_fixed< double, 3 > nextPntvtk(extrPoints->GetPoint(idList[i+1])[0], extrPoints->GetPoint(idList[i+1])[1], extrPoints->GetPoint(idList[i+1])[2]);
-          vnl_vector_fixed< double, 3 > prevPntvtk(extrPoints->GetPoint(idList[i-1])[0], extrPoints->GetPoint(idList[i-1])[1], extrPoints->GetPoint(idList[i-1])[2]);
-
-          vnl_vector_fixed< double, 3 > diff1;
-          diff1 = currentPntvtk - nextPntvtk;
-
-          vnl_vector_fixed< double, 3 > diff2;
-          diff2 = currentPntvtk - prevPntvtk;
-
-          vnl_vector_fixed< double, 3 > diff;
-          diff = (diff1 - diff2) / 2.0;
-          diff.normalize();
+        /* The color value of the current point is influenced by the previous point and next point. */
+        vnl_vector_fixed< double, 3 > currentPntvtk = GetVnlPoint(points+3*i);
+        vnl_vector_fixed< double, 3 > nextPntvtk = GetVnlPoint(points+3*(i+1));
+        vnl_vector_fixed< double, 3 > prevPntvtk = GetVnlPoint(points+3*(i-1));
 
-          rgba[0] = static_cast<unsigned char>(255.0 * std::fabs(diff[0]));
-          rgba[1] = static_cast<unsigned char>(255.0 * std::fabs(diff[1]));
-          rgba[2] = static_cast<unsigned char>(255.0 * std::fabs(diff[2]));
-          rgba[3] = static_cast<unsigned char>(255.0);
-        }
-        else if (i==0)
-        {
-          /* First point has no previous point, therefore only diff1 is taken */
+        vnl_vector_fixed< double, 3 > diff1;
+        diff1 = currentPntvtk - nextPntvtk;
 
-          vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-          vnl_vector_fixed< double, 3 > nextPntvtk(extrPoints->GetPoint(idList[i+1])[0], extrPoints->GetPoint(idList[i+1])[1], extrPoints->GetPoint(idList[i+1])[2]);
+        vnl_vector_fixed< double, 3 > diff2;
+        diff2 = currentPntvtk - prevPntvtk;
 
-          vnl_vector_fixed< double, 3 > diff1;
-          diff1 = currentPntvtk - nextPntvtk;
-          diff1.normalize();
-
-          rgba[0] = static_cast<unsigned char>(255.0 * std::fabs(diff1[0]));
-          rgba[1] = static_cast<unsigned char>(255.0 * std::fabs(diff1[1]));
-          rgba[2] = static_cast<unsigned char>(255.0 * std::fabs(diff1[2]));
-          rgba[3] = static_cast<unsigned char>(255.0);
-        }
-        else if (i==pointsPerFiber-1)
-        {
-          /* Last point has no next point, therefore only diff2 is taken */
-          vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-          vnl_vector_fixed< double, 3 > prevPntvtk(extrPoints->GetPoint(idList[i-1])[0], extrPoints->GetPoint(idList[i-1])[1], extrPoints->GetPoint(idList[i-1])[2]);
-
-          vnl_vector_fixed< double, 3 > diff2;
-          diff2 = currentPntvtk - prevPntvtk;
-          diff2.normalize();
-
-          rgba[0] = static_cast<unsigned char>(255.0 * std::fabs(diff2[0]));
-          rgba[1] = static_cast<unsigned char>(255.0 * std::fabs(diff2[1]));
-          rgba[2] = static_cast<unsigned char>(255.0 * std::fabs(diff2[2]));
-          rgba[3] = static_cast<unsigned char>(255.0);
-        }
-        m_FiberColors->InsertTypedTuple(idList[i], rgba);
+        diff = (diff1 - diff2) / 2.0;
       }
-    }
-    else if (pointsPerFiber == 1)
-    {
-      /* a single point does not define a fiber (use vertex mechanisms instead */
-      continue;
-    }
-    else
-    {
-      MITK_DEBUG << "Fiber with 0 points detected... please check your tractography algorithm!" ;
-      continue;
+      else if (i==0)
+      {
+        /* First point has no previous point, therefore only diff1 is taken */
+        diff = GetVnlPoint(points) - GetVnlPoint(points+3);
+      }
+      else
+      {
+        /* Last point has no next point, therefore only diff2 is taken */
+        diff = GetVnlPoint(points+3*i) - GetVnlPoint(points+3*(i-1));
+      }
+      diff.normalize();
+
+      rgba[0] = static_cast<unsigned char>(255.0 * std::fabs(diff[0]));
+      rgba[1] = static_cast<unsigned char>(255.0 * std::fabs(diff[1]));
+      rgba[2] = static_cast<unsigned char>(255.0 * std::fabs(diff[2]));
+      rgba[3] = static_cast<unsigned char>(255.0);
     }
   }
   m_UpdateTime3D.Modified();
@@ -682,11 +694,8 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
   double window = 5;
 
   //colors and alpha value for each single point, RGBA = 4 components
-  unsigned char rgba[4] = {0,0,0,0};
-  m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
-  m_FiberColors->SetNumberOfComponents(4);
-  m_FiberColors->SetName("FIBER_COLORS");
+  m_FiberColors = CreateColorArray(this->GetNumberOfPoints());
+  unsigned char* colors = m_FiberColors->GetPointer(0);
 
   mitk::LookupTable::Pointer mitkLookup = mitk::LookupTable::New();
   vtkSmartPointer<vtkLookupTable> lookupTable = vtkSmartPointer<vtkLookupTable>::New();
@@ -695,17 +704,16 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
   mitkLookup->SetVtkLookupTable(lookupTable);
   mitkLookup->SetType(mitk::LookupTable::JET);
 
-  std::vector< double > values;
-  double min = 1;
-  double max = 0;
+  std::vector< double > values(this->GetNumberOfPoints());
   MITK_INFO << "Coloring fibers by curvature";
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  mitk::ParallelProgressDisplay disp(m_NumFibers);
+#pragma omp parallel for
+  for (int i=0; i<static_cast<int>(m_NumFibers); i++)
   {
     ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+    auto numPoints = static_cast<int>(this->GetNumberOfFiberPoints(static_cast<unsigned int>(i)));
+    const float* points = this->GetFiberPoint(static_cast<unsigned int>(i), 0);
+    double* fiberValues = values.data() + m_FiberPointOffsets[static_cast<unsigned int>(i)];
 
     // calculate curvatures
     for (int j=0; j<numPoints; j++)
@@ -716,15 +724,7 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
       vnl_vector_fixed< double, 3 > meanV; meanV.fill(0.0);
       while(dist<window/2 && c>1)
       {
-        double p1[3];
-        points->GetPoint(c-1, p1);
-        double p2[3];
-        points->GetPoint(c, p2);
-
-        vnl_vector_fixed< double, 3 > v;
-        v[0] = p2[0]-p1[0];
-        v[1] = p2[1]-p1[1];
-        v[2] = p2[2]-p1[2];
+        vnl_vector_fixed< double, 3 > v = GetVnlPoint(points+3*c) - GetVnlPoint(points+3*(c-1));
         dist += v.magnitude();
         v.normalize();
         vectors.push_back(v);
@@ -735,15 +735,7 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
       dist = 0;
       while(dist<window/2 && c<numPoints-1)
       {
-        double p1[3];
-        points->GetPoint(c, p1);
-        double p2[3];
-        points->GetPoint(c+1, p2);
-
-        vnl_vector_fixed< double, 3 > v;
-        v[0] = p2[0]-p1[0];
-        v[1] = p2[1]-p1[1];
-        v[2] = p2[2]-p1[2];
+        vnl_vector_fixed< double, 3 > v = GetVnlPoint(points+3*(c+1)) - GetVnlPoint(points+3*c);
         dist += v.magnitude();
         v.normalize();
         vectors.push_back(v);
@@ -765,36 +757,36 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
       if (vectors.size()>0)
         dev /= vectors.size();
 
-      dev = 1.0-dev/180.0;
-      values.push_back(dev);
-      if (dev<min)
-        min = dev;
-      if (dev>max)
-        max = dev;
+      fiberValues[j] = 1.0-dev/180.0;
     }
   }
-  unsigned int count = 0;
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  disp.Finish();
+
+  double min = 1;
+  double max = 0;
+  for (double dev : values)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    for (int j=0; j<numPoints; j++)
-    {
-      double color[3];
-      double dev = values.at(count);
-      if (normalize)
-        dev = (dev-min)/(max-min);
-      else if (dev>1)
-        dev = 1;
-      lookupTable->GetColor(dev, color);
-
-      rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
-      rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
-      rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
-      rgba[3] = static_cast<unsigned char>(255.0);
-      m_FiberColors->InsertTypedTuple(cell->GetPointId(j), rgba);
-      count++;
-    }
+    if (dev<min)
+      min = dev;
+    if (dev>max)
+      max = dev;
+  }
+
+  for (std::size_t i=0; i<values.size(); i++)
+  {
+    double color[3];
+    double dev = values[i];
+    if (normalize)
+      dev = (dev-min)/(max-min);
+    else if (dev>1)
+      dev = 1;
+    lookupTable->GetColor(dev, color);
+
+    unsigned char* rgba = colors + 4*i;
+    rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
+    rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
+    rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
+    rgba[3] = static_cast<unsigned char>(255.0);
   }
   m_UpdateTime3D.Modified();
   m_UpdateTime2D.Modified();
@@ -830,16 +822,11 @@ void mitk::FiberBundle::ColorFibersByScalarMap(mitk::Image::Pointer FAimage, boo
 template <typename TPixel>
 void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Image::Pointer image, bool opacity, bool normalize)
 {
-  m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
-  m_FiberColors->SetNumberOfComponents(4);
-  m_FiberColors->SetName("FIBER_COLORS");
+  m_FiberColors = CreateColorArray(this->GetNumberOfPoints());
+  unsigned char* colors = m_FiberColors->GetPointer(0);
 
   mitk::ImagePixelReadAccessor<TPixel,3> readimage(image, image->GetVolumeData(0));
 
-  unsigned char rgba[4] = {0,0,0,0};
-  vtkPoints* pointSet = m_FiberPolyData->GetPoints();
-
   mitk::LookupTable::Pointer mitkLookup = mitk::LookupTable::New();
   vtkSmartPointer<vtkLookupTable> lookupTable = vtkSmartPointer<vtkLookupTable>::New();
   lookupTable->SetTableRange(0.0, 0.8);
@@ -847,29 +834,30 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
   mitkLookup->SetVtkLookupTable(lookupTable);
   mitkLookup->SetType(mitk::LookupTable::JET);
 
+  std::vector< double > values(this->GetNumberOfPoints());
+#pragma omp parallel for
+  for(long i=0; i<static_cast<long>(values.size()); ++i)
+  {
+    Point3D px;
+    px[0] = m_FiberPoints[3*i];
+    px[1] = m_FiberPoints[3*i+1];
+    px[2] = m_FiberPoints[3*i+2];
+    values[i] = static_cast<double>(readimage.GetPixelByWorldCoordinates(px));
+  }
+
   double min = 999999;
   double max = -999999;
-  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+  for (double pixelValue : values)
   {
-    Point3D px;
-    px[0] = pointSet->GetPoint(i)[0];
-    px[1] = pointSet->GetPoint(i)[1];
-    px[2] = pointSet->GetPoint(i)[2];
-    auto pixelValue = static_cast<double>(readimage.GetPixelByWorldCoordinates(px));
     if (pixelValue>max)
       max = pixelValue;
     if (pixelValue<min)
       min = pixelValue;
   }
 
-  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+  for(std::size_t i=0; i<values.size(); ++i)
   {
-    Point3D px;
-    px[0] = pointSet->GetPoint(i)[0];
-    px[1] = pointSet->GetPoint(i)[1];
-    px[2] = pointSet->GetPoint(i)[2];
-    auto pixelValue = static_cast<double>(readimage.GetPixelByWorldCoordinates(px));
-
+    double pixelValue = values[i];
     if (normalize)
       pixelValue = (pixelValue-min)/(max-min);
     else if (pixelValue>1)
@@ -878,6 +866,7 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
     double color[3];
     lookupTable->GetColor(1-pixelValue, color);
 
+    unsigned char* rgba = colors + 4*i;
     rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
     rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
     rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
@@ -885,7 +874,6 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
       rgba[3] = static_cast<unsigned char>(255.0 * pixelValue);
     else
       rgba[3] = static_cast<unsigned char>(255.0);
-    m_FiberColors->InsertTypedTuple(i, rgba);
   }
   m_UpdateTime3D.Modified();
   m_UpdateTime2D.Modified();
@@ -894,10 +882,8 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
 
 void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
 {
-  m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
-  m_FiberColors->SetNumberOfComponents(4);
-  m_FiberColors->SetName("FIBER_COLORS");
+  m_FiberColors = CreateColorArray(this->GetNumberOfPoints());
+  unsigned char* colors = m_FiberColors->GetPointer(0);
 
   mitk::LookupTable::Pointer mitkLookup = mitk::LookupTable::New();
   vtkSmartPointer<vtkLookupTable> lookupTable = vtkSmartPointer<vtkLookupTable>::New();
@@ -906,9 +892,6 @@ void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
   mitkLookup->SetVtkLookupTable(lookupTable);
   mitkLookup->SetType(mitk::LookupTable::JET);
 
-  unsigned char rgba[4] = {0,0,0,0};
-  unsigned int counter = 0;
-
   float max = -999999;
   float min = 999999;
   for (unsigned int i=0; i<m_NumFibers; i++)
@@ -927,31 +910,25 @@ void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
 
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    auto weight = this->GetFiberWeight(i);
+    float v = this->GetFiberWeight(i);
+    if (normalize)
+      v = (v-min)/(max-min);
+    else if (v>1)
+      v = 1;
+    double color[3];
+    lookupTable->GetColor(static_cast<double>(1-v), color);
 
-    for (int j=0; j<numPoints; j++)
-    {
-      float v = weight;
-      if (normalize)
-        v = (v-min)/(max-min);
-      else if (v>1)
-        v = 1;
-      double color[3];
-      lookupTable->GetColor(static_cast<double>(1-v), color);
-
-      rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
-      rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
-      rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
-      if (opacity)
-        rgba[3] = static_cast<unsigned char>(255.0f * v);
-      else
-        rgba[3] = static_cast<unsigned char>(255.0);
+    unsigned char rgba[4] = {0,0,0,0};
+    rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
+    rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
+    rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
+    if (opacity)
+      rgba[3] = static_cast<unsigned char>(255.0f * v);
+    else
+      rgba[3] = static_cast<unsigned char>(255.0);
 
-      m_FiberColors->InsertTypedTuple(counter, rgba);
-      counter++;
-    }
+    for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]; j++)
+      std::copy(rgba, rgba+4, colors+4*j);
   }
 
   m_UpdateTime3D.Modified();
@@ -960,44 +937,23 @@ void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
 
 void mitk::FiberBundle::SetFiberColors(float r, float g, float b, float alpha)
 {
-  m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
-  m_FiberColors->SetNumberOfComponents(4);
-  m_FiberColors->SetName("FIBER_COLORS");
+  m_FiberColors = CreateColorArray(this->GetNumberOfPoints());
+  unsigned char* colors = m_FiberColors->GetPointer(0);
 
   unsigned char rgba[4] = {0,0,0,0};
-  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
-  {
-    rgba[0] = static_cast<unsigned char>(r);
-    rgba[1] = static_cast<unsigned char>(g);
-    rgba[2] = static_cast<unsigned char>(b);
-    rgba[3] = static_cast<unsigned char>(alpha);
-    m_FiberColors->InsertTypedTuple(i, rgba);
-  }
+  rgba[0] = static_cast<unsigned char>(r);
+  rgba[1] = static_cast<unsigned char>(g);
+  rgba[2] = static_cast<unsigned char>(b);
+  rgba[3] = static_cast<unsigned char>(alpha);
+  for(long i=0; i<m_FiberColors->GetNumberOfTuples(); ++i)
+    std::copy(rgba, rgba+4, colors+4*i);
   m_UpdateTime3D.Modified();
   m_UpdateTime2D.Modified();
 }
 
-void mitk::FiberBundle::GenerateFiberIds()
-{
-  if (m_FiberPolyData == nullptr)
-    return;
-
-  vtkSmartPointer<vtkIdFilter> idFiberFilter = vtkSmartPointer<vtkIdFilter>::New();
-  idFiberFilter->SetInputData(m_FiberPolyData);
-  idFiberFilter->CellIdsOn();
-  //  idFiberFilter->PointIdsOn(); // point id's are not needed
-  idFiberFilter->SetIdsArrayName(FIBER_ID_ARRAY);
-  idFiberFilter->FieldDataOn();
-  idFiberFilter->Update();
-
-  m_FiberIdDataSet = idFiberFilter->GetOutput();
-
-}
-
 float mitk::FiberBundle::GetNumEpFractionInMask(ItkUcharImgType* mask, bool different_label)
 {
-  vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
+  vtkSmartPointer<vtkPolyData> PolyData = GetFiberPolyData();
 
   MITK_INFO << "Calculating EP-Fraction";
 
@@ -1039,7 +995,7 @@ float mitk::FiberBundle::GetNumEpFractionInMask(ItkUcharImgType* mask, bool diff
 
 std::tuple<float, float> mitk::FiberBundle::GetDirectionalOverlap(ItkUcharImgType* mask, mitk::PeakImage::ItkPeakImageType* peak_image)
 {
-  vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
+  vtkSmartPointer<vtkPolyData> PolyData = GetFiberPolyData();
 
   MITK_INFO << "Calculating overlap";
   auto spacing = mask->GetSpacing();
@@ -1113,7 +1069,7 @@ std::tuple<float, float> mitk::FiberBundle::GetDirectionalOverlap(ItkUcharImgTyp
 
 float mitk::FiberBundle::GetOverlap(ItkUcharImgType* mask)
 {
-  vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
+  vtkSmartPointer<vtkPolyData> PolyData = GetFiberPolyData();
 
   MITK_INFO << "Calculating overlap";
   auto spacing = mask->GetSpacing();
@@ -1161,28 +1117,27 @@ float mitk::FiberBundle::GetOverlap(ItkUcharImgType* mask)
 
 mitk::FiberBundle::Pointer mitk::FiberBundle::RemoveFibersOutside(ItkUcharImgType* mask, bool invert)
 {
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
-  std::vector< float > fib_weights;
+  // every fiber may be cut into several pieces
+  std::vector< std::vector< std::vector< float > > > fiber_pieces(m_NumFibers);
 
   MITK_INFO << "Cutting fibers";
-  boost::progress_display disp(m_NumFibers);
-  for (unsigned int i=0; i<m_NumFibers; i++)
+  mitk::ParallelProgressDisplay disp(m_NumFibers);
+#pragma omp parallel for
+  for (int i=0; i<static_cast<int>(m_NumFibers); i++)
   {
     ++disp;
 
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+    auto numPoints = static_cast<int>(this->GetNumberOfFiberPoints(static_cast<unsigned int>(i)));
+    const float* points = this->GetFiberPoint(static_cast<unsigned int>(i), 0);
+    std::vector< std::vector< float > >& pieces = fiber_pieces[static_cast<unsigned int>(i)];
 
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    int newNumPoints = 0;
+    std::vector< float > container;
     if (numPoints>1)
     {
       for (int j=0; j<numPoints; j++)
       {
-        itk::Point<float, 3> itkP =mitk::imv::GetItkPoint(points->GetPoint(j));
+        itk::Point<float, 3> itkP;
+        itkP[0] = points[3*j]; itkP[1] = points[3*j+1]; itkP[2] = points[3*j+2];
         itk::Index<3> idx;
         mask->TransformPhysicalPointToIndex(itkP, idx);
 
@@ -1190,72 +1145,47 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::RemoveFibersOutside(ItkUcharImgTyp
         if ( mask->GetLargestPossibleRegion().IsInside(idx) && mask->GetPixel(idx)!=0 )
           inside = true;
 
-        if (inside && !invert)
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(itkP.GetDataPointer());
-          container->GetPointIds()->InsertNextId(id);
-          newNumPoints++;
-        }
-        else if ( !inside && invert )
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(itkP.GetDataPointer());
-          container->GetPointIds()->InsertNextId(id);
-          newNumPoints++;
-        }
-        else if (newNumPoints>1)
-        {
-          fib_weights.push_back(this->GetFiberWeight(i));
-          vtkNewCells->InsertNextCell(container);
-          newNumPoints = 0;
-          container = vtkSmartPointer<vtkPolyLine>::New();
-        }
+        if (inside != invert)
+          container.insert(container.end(), points+3*j, points+3*j+3);
         else
         {
-          newNumPoints = 0;
-          container = vtkSmartPointer<vtkPolyLine>::New();
+          if (container.size()>3)
+            pieces.push_back(container);
+          container.clear();
         }
       }
 
-      if (newNumPoints>1)
-      {
-        fib_weights.push_back(this->GetFiberWeight(i));
-        vtkNewCells->InsertNextCell(container);
-      }
+      if (container.size()>3)
+        pieces.push_back(container);
     }
-
   }
+  disp.Finish();
 
-  vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-  newFiberWeights->SetName("FIBER_WEIGHTS");
-  newFiberWeights->SetNumberOfValues(static_cast<vtkIdType>(fib_weights.size()));
+  std::vector< std::vector< float > > new_fibers;
+  std::vector< float > fib_weights;
+  for (unsigned int i=0; i<m_NumFibers; i++)
+    for (auto& piece : fiber_pieces[i])
+    {
+      new_fibers.push_back(std::move(piece));
+      fib_weights.push_back(this->GetFiberWeight(i));
+    }
 
-  if (vtkNewCells->GetNumberOfCells()<=0)
+  if (new_fibers.empty())
     return nullptr;
 
+  vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
+  newFiberWeights->SetName("FIBER_WEIGHTS");
+  newFiberWeights->SetNumberOfValues(static_cast<vtkIdType>(fib_weights.size()));
   for (unsigned int i=0; i<newFiberWeights->GetNumberOfValues(); i++)
     newFiberWeights->SetValue(i, fib_weights.at(i));
 
-//  vtkSmartPointer<vtkUnsignedCharArray> newFiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-//  newFiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
-//  newFiberColors->SetNumberOfComponents(4);
-//  newFiberColors->SetName("FIBER_COLORS");
-
-//  unsigned char rgba[4] = {0,0,0,0};
-//  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
-//  {
-//    rgba[0] = (unsigned char) r;
-//    rgba[1] = (unsigned char) g;
-//    rgba[2] = (unsigned char) b;
-//    rgba[3] = (unsigned char) alpha;
-//    m_FiberColors->InsertTypedTuple(i, rgba);
-//  }
+  std::vector< float > new_points;
+  std::vector< vtkIdType > new_offsets;
+  ConcatenateFibers(new_fibers, new_points, new_offsets);
 
-  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
-  newPolyData->SetPoints(vtkNewPoints);
-  newPolyData->SetLines(vtkNewCells);
-  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(newPolyData);
+  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New();
+  newFib->SetFiberStore(new_points, new_offsets);
   newFib->SetFiberWeights(newFiberWeights);
-//  newFib->Compress(0.1);
   return newFib;
 }
 
@@ -1268,11 +1198,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::ExtractFiberSubset(DataNode* roi,
 
   if (tmp.size()<=0)
     return mitk::FiberBundle::New();
-  vtkSmartPointer<vtkFloatArray> weights = vtkSmartPointer<vtkFloatArray>::New();
-  vtkSmartPointer<vtkPolyData> pTmp = GeneratePolyDataByIds(tmp, weights);
-  mitk::FiberBundle::Pointer fib = mitk::FiberBundle::New(pTmp);
-  fib->SetFiberWeights(weights);
-  return fib;
+  return GenerateFiberBundleByIds(tmp);
 }
 
 std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi, DataStorage* storage)
@@ -1360,37 +1286,48 @@ std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi,
       }
 
       MITK_INFO << "Extracting with polygon";
-      boost::progress_display disp(m_NumFibers);
-      for (unsigned int i=0; i<m_NumFibers; i++)
+      std::vector< unsigned char > hit(m_NumFibers, 0);
+      mitk::ParallelProgressDisplay disp(m_NumFibers);
+#pragma omp parallel
       {
-        ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        auto numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+        // vtkPolygon uses internal scratch objects, so every thread intersects with its own copy
+        vtkSmartPointer<vtkPolygon> threadPolygon = vtkSmartPointer<vtkPolygon>::New();
+        threadPolygon->DeepCopy(polygonVtk);
 
-        for (int j=0; j<numPoints-1; j++)
+#pragma omp for
+        for (int i=0; i<static_cast<int>(m_NumFibers); i++)
         {
-          // Inputs
-          double p1[3] = {0,0,0};
-          points->GetPoint(j, p1);
-          double p2[3] = {0,0,0};
-          points->GetPoint(j+1, p2);
-          double tolerance = 0.001;
-
-          // Outputs
-          double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
-          double x[3] = {0,0,0}; // The coordinate of the intersection
-          double pcoords[3] = {0,0,0};
-          int subId = 0;
+          ++disp;
+          auto numPoints = static_cast<int>(this->GetNumberOfFiberPoints(static_cast<unsigned int>(i)));
+          const float* points = this->GetFiberPoint(static_cast<unsigned int>(i), 0);
 
-          int iD = polygonVtk->IntersectWithLine(p1, p2, tolerance, t, x, pcoords, subId);
-          if (iD!=0)
+          for (int j=0; j<numPoints-1; j++)
           {
-            result.push_back(i);
-            break;
+            // Inputs
+            double p1[3] = {points[3*j], points[3*j+1], points[3*j+2]};
+            double p2[3] = {points[3*j+3], points[3*j+4], points[3*j+5]};
+            double tolerance = 0.001;
+
+            // Outputs
+            double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
+            double x[3] = {0,0,0}; // The coordinate of the intersection
+            double pcoords[3] = {0,0,0};
+            int subId = 0;
+
+            int iD = threadPolygon->IntersectWithLine(p1, p2, tolerance, t, x, pcoords, subId);
+            if (iD!=0)
+            {
+              hit[static_cast<unsigned int>(i)] = 1;
+              break;
+            }
           }
         }
       }
+      disp.Finish();
+
+      for (unsigned int i=0; i<m_NumFibers; i++)
+        if (hit[i])
+          result.push_back(i);
     }
     else if ( dynamic_cast<mitk::PlanarCircle*>(roi->GetData()) )
     {
@@ -1406,21 +1343,20 @@ std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi,
       radius *= radius;
 
       MITK_INFO << "Extracting with circle";
-      boost::progress_display disp(m_NumFibers);
-      for (unsigned int i=0; i<m_NumFibers; i++)
+      std::vector< unsigned char > hit(m_NumFibers, 0);
+      mitk::ParallelProgressDisplay disp(m_NumFibers);
+#pragma omp parallel for
+      for (int i=0; i<static_cast<int>(m_NumFibers); i++)
       {
-        ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        auto numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+        ++disp;
+        auto numPoints = static_cast<int>(this->GetNumberOfFiberPoints(static_cast<unsigned int>(i)));
+        const float* points = this->GetFiberPoint(static_cast<unsigned int>(i), 0);
 
         for (int j=0; j<numPoints-1; j++)
         {
           // Inputs
-          double p1[3] = {0,0,0};
-          points->GetPoint(j, p1);
-          double p2[3] = {0,0,0};
-          points->GetPoint(j+1, p2);
+          double p1[3] = {points[3*j], points[3*j+1], points[3*j+2]};
+          double p2[3] = {points[3*j+3], points[3*j+4], points[3*j+5]};
 
           // Outputs
           double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
@@ -1433,12 +1369,17 @@ std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi,
             double dist = (x[0]-V1w[0])*(x[0]-V1w[0])+(x[1]-V1w[1])*(x[1]-V1w[1])+(x[2]-V1w[2])*(x[2]-V1w[2]);
             if( dist <= radius)
             {
-              result.push_back(i);
+              hit[static_cast<unsigned int>(i)] = 1;
               break;
             }
           }
         }
       }
+      disp.Finish();
+
+      for (unsigned int i=0; i<m_NumFibers; i++)
+        if (hit[i])
+          result.push_back(i);
     }
     return result;
   }
@@ -1454,13 +1395,62 @@ void mitk::FiberBundle::UpdateFiberGeometry()
   cleaner->Update();
   m_FiberPolyData = cleaner->GetOutput();
 
+  UpdateFiberStore();
+  UpdateFiberStatistics();
+}
+
+void mitk::FiberBundle::UpdateFiberStore()
+{
+  m_SpatialIndex = nullptr;
+  m_FiberPoints.clear();
+  m_FiberPointOffsets.assign(1, 0);
+
+  // the polydata is only the input here, it is rebuilt from the store when it is requested again
+  vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberPolyData;
+  m_FiberPolyData = nullptr;
+
+  vtkPoints* points = fiberPolyData->GetPoints();
+  vtkCellArray* lines = fiberPolyData->GetLines();
+  if (points==nullptr || lines==nullptr)
+    return;
+
+  std::vector< vtkIdType* > ids;
+  ids.reserve(static_cast<std::size_t>(lines->GetNumberOfCells()));
+  m_FiberPointOffsets.reserve(static_cast<std::size_t>(lines->GetNumberOfCells())+1);
+  vtkIdType numPoints = 0;
+  vtkIdType* idList = nullptr;
+  lines->InitTraversal();
+  while (lines->GetNextCell(numPoints, idList))
+  {
+    ids.push_back(idList);
+    m_FiberPointOffsets.push_back(m_FiberPointOffsets.back()+numPoints);
+  }
+
+  m_FiberPoints.resize(3*static_cast<std::size_t>(m_FiberPointOffsets.back()));
+#pragma omp parallel for
+  for (int i=0; i<static_cast<int>(ids.size()); ++i)
+  {
+    float* p = m_FiberPoints.data() + 3*m_FiberPointOffsets[static_cast<unsigned int>(i)];
+    for (vtkIdType j=0; j<m_FiberPointOffsets[i+1]-m_FiberPointOffsets[i]; ++j, p+=3)
+    {
+      double point[3];
+      points->GetPoint(ids[static_cast<unsigned int>(i)][j], point);
+      p[0] = static_cast<float>(point[0]);
+      p[1] = static_cast<float>(point[1]);
+      p[2] = static_cast<float>(point[2]);
+    }
+  }
+}
+
+void mitk::FiberBundle::UpdateFiberStatistics()
+{
   m_FiberLengths.clear();
   m_MeanFiberLength = 0;
   m_MedianFiberLength = 0;
   m_LengthStDev = 0;
-  m_NumFibers = static_cast<unsigned int>(m_FiberPolyData->GetNumberOfCells());
+  m_NumFibers = static_cast<unsigned int>(m_FiberPointOffsets.size()-1);
 
-  if (m_FiberColors==nullptr || m_FiberColors->GetNumberOfTuples()!=m_FiberPolyData->GetNumberOfPoints())
+  if (m_FiberColors==nullptr || m_FiberColors->GetNumberOfTuples()!=static_cast<vtkIdType>(this->GetNumberOfPoints()))
     this->ColorFibersByOrientation();
 
   if (m_FiberWeights->GetNumberOfValues()!=m_NumFibers)
@@ -1482,40 +1472,48 @@ void mitk::FiberBundle::UpdateFiberGeometry()
     SetGeometry(geometry);
     return;
   }
-  double b[6];
-  m_FiberPolyData->GetBounds(b);
+  double b[6] = {0, 1, 0, 1, 0, 1};
+  if (!m_FiberPoints.empty())
+  {
+    for (int c=0; c<3; ++c)
+      b[2*c] = b[2*c+1] = static_cast<double>(m_FiberPoints[static_cast<std::size_t>(c)]);
+    for (std::size_t i=0; i<m_FiberPoints.size(); i+=3)
+      for (std::size_t c=0; c<3; ++c)
+      {
+        auto v = static_cast<double>(m_FiberPoints[i+c]);
+        b[2*c] = std::min(b[2*c], v);
+        b[2*c+1] = std::max(b[2*c+1], v);
+      }
+  }
 
   // calculate statistics
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  m_FiberLengths.resize(m_NumFibers);
+#pragma omp parallel for
+  for (int i=0; i<static_cast<int>(m_NumFibers); i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto p = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+    auto p = static_cast<int>(this->GetNumberOfFiberPoints(static_cast<unsigned int>(i)));
+    const float* points = this->GetFiberPoint(static_cast<unsigned int>(i), 0);
     float length = 0;
     for (int j=0; j<p-1; j++)
     {
-      double p1[3];
-      points->GetPoint(j, p1);
-      double p2[3];
-      points->GetPoint(j+1, p2);
+      const float* p1 = points+3*j;
+      const float* p2 = points+3*j+3;
 
-      double dist = std::sqrt((p1[0]-p2[0])*(p1[0]-p2[0])+(p1[1]-p2[1])*(p1[1]-p2[1])+(p1[2]-p2[2])*(p1[2]-p2[2]));
+      double dist = std::sqrt((static_cast<double>(p1[0])-p2[0])*(static_cast<double>(p1[0])-p2[0])+(static_cast<double>(p1[1])-p2[1])*(static_cast<double>(p1[1])-p2[1])+(static_cast<double>(p1[2])-p2[2])*(static_cast<double>(p1[2])-p2[2]));
       length += dist;
     }
-    m_FiberLengths.push_back(length);
+    m_FiberLengths[static_cast<unsigned int>(i)] = length;
+  }
+
+  m_MinFiberLength = m_FiberLengths.at(0);
+  m_MaxFiberLength = m_FiberLengths.at(0);
+  for (float length : m_FiberLengths)
+  {
     m_MeanFiberLength += length;
-    if (i==0)
-    {
+    if (length<m_MinFiberLength)
       m_MinFiberLength = length;
+    if (length>m_MaxFiberLength)
       m_MaxFiberLength = length;
-    }
-    else
-    {
-      if (length<m_MinFiberLength)
-        m_MinFiberLength = length;
-      if (length>m_MaxFiberLength)
-        m_MaxFiberLength = length;
-    }
   }
   m_MeanFiberLength /= m_NumFibers;
 
@@ -1570,7 +1568,7 @@ void mitk::FiberBundle::SetFiberWeight(unsigned int fiber, float weight)
 
 void mitk::FiberBundle::SetFiberColors(vtkSmartPointer<vtkUnsignedCharArray> fiberColors)
 {
-  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+  for(long i=0; i<this->GetNumberOfPoints(); ++i)
   {
     unsigned char source[4] = {0,0,0,0};
     fiberColors->GetTypedTuple(i, source);
@@ -1665,7 +1663,7 @@ void mitk::FiberBundle::TransformFibers(itk::ScalableAffineTransform< mitk::Scal
 
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1680,10 +1678,10 @@ void mitk::FiberBundle::TransformFibers(itk::ScalableAffineTransform< mitk::Scal
     vtkNewCells->InsertNextCell(container);
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double tx, double ty, double tz)
@@ -1720,7 +1718,7 @@ void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double
 
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1742,10 +1740,10 @@ void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double
     vtkNewCells->InsertNextCell(container);
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
@@ -1780,7 +1778,7 @@ void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
 
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1802,10 +1800,10 @@ void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
     vtkNewCells->InsertNextCell(container);
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractCenter)
@@ -1822,7 +1820,7 @@ void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractC
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
     ++disp ;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1847,10 +1845,10 @@ void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractC
     vtkNewCells->InsertNextCell(container);
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
@@ -1860,7 +1858,7 @@ void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
 
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1877,10 +1875,10 @@ void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
     vtkNewCells->InsertNextCell(container);
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::MirrorFibers(unsigned int axis)
@@ -1897,7 +1895,7 @@ void mitk::FiberBundle::MirrorFibers(unsigned int axis)
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
     ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1912,10 +1910,10 @@ void mitk::FiberBundle::MirrorFibers(unsigned int axis)
     vtkNewCells->InsertNextCell(container);
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double threshold)
@@ -1924,11 +1922,11 @@ void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double thresho
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  boost::progress_display disp(static_cast<unsigned long>(GetFiberPolyData()->GetNumberOfCells()));
+  for (int i=0; i<GetFiberPolyData()->GetNumberOfCells(); i++)
   {
     ++disp ;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1971,11 +1969,11 @@ void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double thresho
     }
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
 
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  this->SetFiberPolyData(newPolyData, true);
 
   //    UpdateColorCoding();
   //    UpdateFiberGeometry();
@@ -1990,11 +1988,11 @@ bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibe
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
   MITK_INFO << "Applying curvature threshold";
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  boost::progress_display disp(static_cast<unsigned long>(GetFiberPolyData()->GetNumberOfCells()));
+  for (int i=0; i<GetFiberPolyData()->GetNumberOfCells(); i++)
   {
     ++disp ;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -2054,10 +2052,10 @@ bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibe
   if (vtkNewCells->GetNumberOfCells()<=0)
     return false;
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
   return true;
 }
 
@@ -2084,7 +2082,7 @@ bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
     ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -2106,10 +2104,10 @@ bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
   if (vtkNewCells->GetNumberOfCells()<=0)
     return false;
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
   return true;
 }
 
@@ -2129,7 +2127,7 @@ bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
     ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -2149,10 +2147,10 @@ bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
   if (vtkNewCells->GetNumberOfCells()<=0)
     return false;
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
   return true;
 }
 
@@ -2161,35 +2159,21 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
   if (pointDistance<=0)
     return;
 
-  vtkSmartPointer<vtkPoints> vtkSmoothPoints = vtkSmartPointer<vtkPoints>::New(); //in smoothpoints the interpolated points representing a fiber are stored.
-
-  //in vtkcells all polylines are stored, actually all id's of them are stored
-  vtkSmartPointer<vtkCellArray> vtkSmoothCells = vtkSmartPointer<vtkCellArray>::New(); //cellcontainer for smoothed lines
-
   MITK_INFO << "Smoothing fibers";
-  vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-  newFiberWeights->SetName("FIBER_WEIGHTS");
-  newFiberWeights->SetNumberOfValues(m_NumFibers);
-
-  std::vector< vtkSmartPointer<vtkPolyLine> > resampled_streamlines;
-  resampled_streamlines.resize(m_NumFibers);
+  std::vector< std::vector< float > > resampled_streamlines(m_NumFibers);
 
-  boost::progress_display disp(m_NumFibers);
+  mitk::ParallelProgressDisplay disp(m_NumFibers);
 #pragma omp parallel for
   for (int i=0; i<static_cast<int>(m_NumFibers); i++)
   {
+    ++disp;
+
+    float length = m_FiberLengths.at(static_cast<unsigned int>(i));
+    auto numPoints = static_cast<int>(this->GetNumberOfFiberPoints(static_cast<unsigned int>(i)));
+    const float* points = this->GetFiberPoint(static_cast<unsigned int>(i), 0);
     vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
-    float length = 0;
-#pragma omp critical
-    {
-      length = m_FiberLengths.at(static_cast<unsigned int>(i));
-      ++disp;
-      vtkCell* cell = m_FiberPolyData->GetCell(i);
-      auto numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
-      for (int j=0; j<numPoints; j++)
-        newPoints->InsertNextPoint(points->GetPoint(j));
-    }
+    for (int j=0; j<numPoints; j++)
+      newPoints->InsertNextPoint(points+3*j);
 
     int sampling = static_cast<int>(std::ceil(length/pointDistance));
 
@@ -2216,29 +2200,23 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
     vtkPolyData* outputFunction = functionSource->GetOutput();
     vtkPoints* tmpSmoothPnts = outputFunction->GetPoints(); //smoothPoints of current fiber
 
-    vtkSmartPointer<vtkPolyLine> smoothLine = vtkSmartPointer<vtkPolyLine>::New();
-
-#pragma omp critical
+    std::vector< float >& smoothLine = resampled_streamlines[static_cast<unsigned int>(i)];
+    smoothLine.reserve(3*static_cast<std::size_t>(tmpSmoothPnts->GetNumberOfPoints()));
+    for (int j=0; j<tmpSmoothPnts->GetNumberOfPoints(); j++)
     {
-      for (int j=0; j<tmpSmoothPnts->GetNumberOfPoints(); j++)
-      {
-        vtkIdType id = vtkSmoothPoints->InsertNextPoint(tmpSmoothPnts->GetPoint(j));
-        smoothLine->GetPointIds()->InsertNextId(id);
-      }
-
-      resampled_streamlines[static_cast<unsigned long>(i)] = smoothLine;
+      double p[3];
+      tmpSmoothPnts->GetPoint(j, p);
+      smoothLine.push_back(static_cast<float>(p[0]));
+      smoothLine.push_back(static_cast<float>(p[1]));
+      smoothLine.push_back(static_cast<float>(p[2]));
     }
   }
+  disp.Finish();
 
-  for (auto container : resampled_streamlines)
-  {
-    vtkSmoothCells->InsertNextCell(container);
-  }
-
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkSmoothPoints);
-  m_FiberPolyData->SetLines(vtkSmoothCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  std::vector< float > new_points;
+  std::vector< vtkIdType > new_offsets;
+  ConcatenateFibers(resampled_streamlines, new_points, new_offsets);
+  this->SetFiberStore(new_points, new_offsets);
 }
 
 void mitk::FiberBundle::ResampleSpline(float pointDistance)
@@ -2248,58 +2226,33 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance)
 
 unsigned int mitk::FiberBundle::GetNumberOfPoints() const
 {
-  unsigned int points = 0;
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
-  {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    points += cell->GetNumberOfPoints();
-  }
-  return points;
+  return static_cast<unsigned int>(m_FiberPointOffsets.back());
 }
 
 void mitk::FiberBundle::Compress(float error)
 {
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
   MITK_INFO << "Compressing fibers";
   unsigned int numRemovedPoints = 0;
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-  newFiberWeights->SetName("FIBER_WEIGHTS");
-  newFiberWeights->SetNumberOfValues(m_NumFibers);
+  mitk::ParallelProgressDisplay disp(m_NumFibers);
+  std::vector< std::vector< float > > compressed_streamlines(m_NumFibers);
 
-#pragma omp parallel for
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+#pragma omp parallel for reduction(+:numRemovedPoints)
+  for (int i=0; i<static_cast<int>(m_NumFibers); i++)
   {
+    ++disp;
 
     std::vector< vnl_vector_fixed< double, 3 > > vertices;
-    float weight = 1;
-
-#pragma omp critical
-    {
-      ++disp;
-      weight = m_FiberWeights->GetValue(i);
-      vtkCell* cell = m_FiberPolyData->GetCell(i);
-      auto numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
-
-      for (int j=0; j<numPoints; j++)
-      {
-        double cand[3];
-        points->GetPoint(j, cand);
-        vnl_vector_fixed< double, 3 > candV;
-        candV[0]=cand[0]; candV[1]=cand[1]; candV[2]=cand[2];
-        vertices.push_back(candV);
-      }
-    }
+    auto numPoints = this->GetNumberOfFiberPoints(static_cast<unsigned int>(i));
+    const float* points = this->GetFiberPoint(static_cast<unsigned int>(i), 0);
+    if (numPoints==0)
+      continue;
+    for (unsigned int j=0; j<numPoints; j++)
+      vertices.push_back(GetVnlPoint(points+3*j));
 
     // calculate curvatures
-    auto numPoints = vertices.size();
     std::vector< int > removedPoints; removedPoints.resize(numPoints, 0);
     removedPoints[0]=-1; removedPoints[numPoints-1]=-1;
 
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
     unsigned int remCounter = 0;
 
     bool pointFound = true;
@@ -2359,34 +2312,24 @@ void mitk::FiberBundle::Compress(float error)
       }
     }
 
+    std::vector< float >& container = compressed_streamlines[static_cast<unsigned int>(i)];
+    container.reserve(3*(numPoints-remCounter));
     for (unsigned int j=0; j<numPoints; j++)
     {
       if (removedPoints[j]<=0)
-      {
-#pragma omp critical
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(vertices.at(j).data_block());
-          container->GetPointIds()->InsertNextId(id);
-        }
-      }
-    }
-
-#pragma omp critical
-    {
-      newFiberWeights->SetValue(vtkNewCells->GetNumberOfCells(), weight);
-      numRemovedPoints += remCounter;
-      vtkNewCells->InsertNextCell(container);
+        container.insert(container.end(), points+3*j, points+3*j+3);
     }
+    numRemovedPoints += remCounter;
   }
+  disp.Finish();
 
-  if (vtkNewCells->GetNumberOfCells()>0)
+  if (m_NumFibers>0)
   {
     MITK_INFO << "Removed points: " << numRemovedPoints;
-    SetFiberWeights(newFiberWeights);
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    std::vector< float > new_points;
+    std::vector< vtkIdType > new_offsets;
+    ConcatenateFibers(compressed_streamlines, new_points, new_offsets);
+    this->SetFiberStore(new_points, new_offsets);
   }
 }
 
@@ -2409,7 +2352,7 @@ void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
 
     unequal_fibs = false;
 //#pragma omp parallel for
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    for (int i=0; i<GetFiberPolyData()->GetNumberOfCells(); i++)
     {
 
       std::vector< vnl_vector_fixed< double, 3 > > vertices;
@@ -2419,7 +2362,7 @@ void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
 //#pragma omp critical
       {
         weight = m_FiberWeights->GetValue(i);
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         auto numPoints = cell->GetNumberOfPoints();
         if (numPoints!=targetPoints)
           seg_len = static_cast<double>(this->GetFiberLength(i)/(targetPoints-1));
@@ -2508,59 +2451,44 @@ void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
     if (vtkNewCells->GetNumberOfCells()>0)
     {
       SetFiberWeights(newFiberWeights);
-      m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-      m_FiberPolyData->SetPoints(vtkNewPoints);
-      m_FiberPolyData->SetLines(vtkNewCells);
-      this->SetFiberPolyData(m_FiberPolyData, true);
+      vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+      newPolyData->SetPoints(vtkNewPoints);
+      newPolyData->SetLines(vtkNewCells);
+      this->SetFiberPolyData(newPolyData, true);
     }
   }
 }
 
 void mitk::FiberBundle::ResampleLinear(double pointDistance)
 {
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
   MITK_INFO << "Resampling fibers (linear)";
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-  newFiberWeights->SetName("FIBER_WEIGHTS");
-  newFiberWeights->SetNumberOfValues(m_NumFibers);
+  mitk::ParallelProgressDisplay disp(m_NumFibers);
+  std::vector< std::vector< float > > resampled_streamlines(m_NumFibers);
 
-  std::vector< vtkSmartPointer<vtkPolyLine> > resampled_streamlines;
-  resampled_streamlines.resize(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
+  auto insertPoint = [](std::vector< float >& container, const vnl_vector_fixed< double, 3 >& p)
+  {
+    container.push_back(static_cast<float>(p[0]));
+    container.push_back(static_cast<float>(p[1]));
+    container.push_back(static_cast<float>(p[2]));
+  };
 
 #pragma omp parallel for
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  for (int i=0; i<static_cast<int>(m_NumFibers); i++)
   {
+    ++disp;
 
     std::vector< vnl_vector_fixed< double, 3 > > vertices;
+    auto numPoints = this->GetNumberOfFiberPoints(static_cast<unsigned int>(i));
+    const float* points = this->GetFiberPoint(static_cast<unsigned int>(i), 0);
+    if (numPoints==0)
+      continue;
+    for (unsigned int j=0; j<numPoints; j++)
+      vertices.push_back(GetVnlPoint(points+3*j));
 
-#pragma omp critical
-    {
-      ++disp;
-      vtkCell* cell = m_FiberPolyData->GetCell(i);
-      auto numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
-
-      for (int j=0; j<numPoints; j++)
-      {
-        double cand[3];
-        points->GetPoint(j, cand);
-        vnl_vector_fixed< double, 3 > candV;
-        candV[0]=cand[0]; candV[1]=cand[1]; candV[2]=cand[2];
-        vertices.push_back(candV);
-      }
-    }
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+    std::vector< float >& container = resampled_streamlines[static_cast<unsigned int>(i)];
     vnl_vector_fixed< double, 3 > lastV = vertices.at(0);
+    insertPoint(container, lastV);
 
-#pragma omp critical
-    {
-      vtkIdType id = vtkNewPoints->InsertNextPoint(lastV.data_block());
-      container->GetPointIds()->InsertNextId(id);
-    }
     for (unsigned int j=1; j<vertices.size(); j++)
     {
       vnl_vector_fixed< double, 3 > vec = vertices.at(j) - lastV;
@@ -2597,40 +2525,23 @@ void mitk::FiberBundle::ResampleLinear(double pointDistance)
           j--;
         }
 
-#pragma omp critical
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(newV.data_block());
-          container->GetPointIds()->InsertNextId(id);
-        }
+        insertPoint(container, newV);
         lastV = newV;
       }
       else if (j==vertices.size()-1 && new_dist>0.0001)
       {
-#pragma omp critical
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(vertices.at(j).data_block());
-          container->GetPointIds()->InsertNextId(id);
-        }
+        insertPoint(container, vertices.at(j));
       }
     }
-
-#pragma omp critical
-    {
-      resampled_streamlines[static_cast<unsigned int>(i)] = container;
-    }
-  }
-
-  for (auto container : resampled_streamlines)
-  {
-    vtkNewCells->InsertNextCell(container);
   }
+  disp.Finish();
 
-  if (vtkNewCells->GetNumberOfCells()>0)
+  if (m_NumFibers>0)
   {
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    std::vector< float > new_points;
+    std::vector< vtkIdType > new_offsets;
+    ConcatenateFibers(resampled_streamlines, new_points, new_offsets);
+    this->SetFiberStore(new_points, new_offsets);
   }
 }
 
@@ -2652,7 +2563,7 @@ bool mitk::FiberBundle::Equals(mitk::FiberBundle* fib, double eps)
 
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = GetFiberPolyData()->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPixelTypeTraits.h>
 #include <mitkPlanarFigureComposite.h>
 #include <mitkPeakImage.h>
+#include <mitkFiberSpatialIndex.h>
 
 //includes storing fiberdata
 #include <vtkSmartPointer.h>
@@ -36,6 +37,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTransform.h>
 #include <vtkFloatArray.h>
 #include <itkScalableAffineTransform.h>
+#include <memory>
 
 namespace mitk {
 
@@ -120,6 +122,7 @@ public:
     void SetFiberWeight(unsigned int fiber, float weight);
     void SetFiberWeights(vtkSmartPointer<vtkFloatArray> weights);
     void SetFiberPolyData(vtkSmartPointer<vtkPolyData>, bool updateGeometry = true);
+    void SetFiberStore(std::vector< float >& points, std::vector< vtkIdType >& offsets);
     vtkSmartPointer<vtkPolyData> GetFiberPolyData() const;
     itkGetConstMacro( NumFibers, unsigned int)
     //itkGetMacro( FiberSampling, int)
@@ -136,6 +139,16 @@ public:
 
     unsigned int GetNumberOfPoints() const;
 
+    // contiguous fiber geometry: fiber i consists of the points GetFiberPointOffsets()[i] to GetFiberPointOffsets()[i+1]-1,
+    // stored as consecutive xyz triplets in GetFiberPoints()
+    const std::vector< float >& GetFiberPoints() const { return m_FiberPoints; }
+    const std::vector< vtkIdType >& GetFiberPointOffsets() const { return m_FiberPointOffsets; }
+    unsigned int GetNumberOfFiberPoints(unsigned int fiber) const { return static_cast<unsigned int>(m_FiberPointOffsets[fiber+1]-m_FiberPointOffsets[fiber]); }
+    const float* GetFiberPoint(unsigned int fiber, unsigned int point) const { return m_FiberPoints.data() + 3*(m_FiberPointOffsets[fiber]+point); }
+
+    // spatial index of the fibers, built on first access and discarded whenever the fiber geometry changes
+    const FiberSpatialIndex* GetSpatialIndex() const;
+
     // copy fiber bundle
     mitk::FiberBundle::Pointer GetDeepCopy();
 
@@ -152,17 +165,22 @@ protected:
     FiberBundle( vtkPolyData* fiberPolyData = nullptr );
     ~FiberBundle() override;
 
-    void                            GenerateFiberIds();
     void                            UpdateFiberGeometry();
+    void                            UpdateFiberStore();
+    void                            UpdateFiberStatistics();
+    FiberBundle::Pointer            GenerateFiberBundleByIds(const std::vector<unsigned int>& fiberIds);
     void                    PrintSelf(std::ostream &os, itk::Indent indent) const override;
 
 private:
 
-    // actual fiber container
-    vtkSmartPointer<vtkPolyData>  m_FiberPolyData;
+    // polydata view of the fiber store, built on first access by GetFiberPolyData() and discarded whenever the store changes
+    mutable vtkSmartPointer<vtkPolyData>  m_FiberPolyData;
 
-    // contains fiber ids
-    vtkSmartPointer<vtkDataSet>   m_FiberIdDataSet;
+    // actual fiber container: the fiber points (xyz) and the index of the first point of each fiber (plus the total number of points);
+    // the polydata uses the same point order, i.e. point j of fiber i has the point id m_FiberPointOffsets[i]+j
+    std::vector< float >          m_FiberPoints;
+    std::vector< vtkIdType >      m_FiberPointOffsets;
+    mutable std::shared_ptr< FiberSpatialIndex >  m_SpatialIndex;
 
     unsigned int m_NumFibers;
 
@@ -0,0 +1,148 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberSpatialIndex.h"
+#include <mitkFiberBundle.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+mitk::FiberSpatialIndex::FiberSpatialIndex(const mitk::FiberBundle* fib, float cellSize)
+  : m_CellSize(cellSize)
+  , m_NumFibers(fib->GetNumFibers())
+{
+  const std::vector< float >& points = fib->GetFiberPoints();
+
+  double min[3] = { 0, 0, 0 };
+  double max[3] = { 0, 0, 0 };
+  if (!points.empty())
+  {
+    for (int d=0; d<3; ++d)
+    {
+      min[d] = std::numeric_limits<double>::max();
+      max[d] = std::numeric_limits<double>::lowest();
+    }
+    for (std::size_t i=0; i<points.size(); i+=3)
+      for (int d=0; d<3; ++d)
+      {
+        min[d] = std::min(min[d], static_cast<double>(points[i+d]));
+        max[d] = std::max(max[d], static_cast<double>(points[i+d]));
+      }
+  }
+
+  // pad the grid by one cell and coarsen it if the bundle is huge compared to the cell size
+  std::size_t numCells = 0;
+  do
+  {
+    numCells = 1;
+    for (int d=0; d<3; ++d)
+    {
+      m_Origin[d] = min[d] - m_CellSize;
+      m_Size[d] = static_cast<int>(std::floor((max[d]-m_Origin[d])/m_CellSize)) + 2;
+      numCells *= static_cast<std::size_t>(m_Size[d]);
+    }
+    if (numCells > (std::size_t(1)<<26))
+      m_CellSize *= 2;
+  }
+  while (numCells > (std::size_t(1)<<26));
+
+  // collect the cells touched by the segment bounding boxes of each fiber
+  std::vector< std::vector< unsigned int > > fiberCells(m_NumFibers);
+#pragma omp parallel for schedule(dynamic, 100)
+  for (int i=0; i<static_cast<int>(m_NumFibers); ++i)
+  {
+    std::vector< unsigned int >& cells = fiberCells[static_cast<unsigned int>(i)];
+    unsigned int numPoints = fib->GetNumberOfFiberPoints(static_cast<unsigned int>(i));
+    for (unsigned int j=0; j<numPoints; ++j)
+    {
+      const float* p1 = fib->GetFiberPoint(static_cast<unsigned int>(i), j);
+      const float* p2 = fib->GetFiberPoint(static_cast<unsigned int>(i), std::min(j+1, numPoints-1));
+      double bmin[3], bmax[3];
+      for (int d=0; d<3; ++d)
+      {
+        bmin[d] = std::min(p1[d], p2[d]);
+        bmax[d] = std::max(p1[d], p2[d]);
+      }
+
+      int lo[3], hi[3];
+      if (!GetCellRange(bmin, bmax, lo, hi))
+        continue;
+      for (int z=lo[2]; z<=hi[2]; ++z)
+        for (int y=lo[1]; y<=hi[1]; ++y)
+          for (int x=lo[0]; x<=hi[0]; ++x)
+            cells.push_back(static_cast<unsigned int>(x + m_Size[0]*(y + m_Size[1]*z)));
+    }
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+  }
+
+  // compressed cell -> fiber lists; iterating the fibers in order keeps every list sorted
+  m_CellOffsets.assign(numCells+1, 0);
+  for (const auto& cells : fiberCells)
+    for (auto c : cells)
+      m_CellOffsets[c+1]++;
+  for (std::size_t c=0; c<numCells; ++c)
+    m_CellOffsets[c+1] += m_CellOffsets[c];
+
+  m_CellFibers.resize(m_CellOffsets.back());
+  std::vector< std::size_t > cursor(m_CellOffsets.begin(), m_CellOffsets.end()-1);
+  for (unsigned int i=0; i<m_NumFibers; ++i)
+  {
+    for (auto c : fiberCells[i])
+      m_CellFibers[cursor[c]++] = i;
+    std::vector< unsigned int >().swap(fiberCells[i]);
+  }
+}
+
+bool mitk::FiberSpatialIndex::GetCellRange(const double* min, const double* max, int* lo, int* hi) const
+{
+  for (int d=0; d<3; ++d)
+  {
+    double l = std::floor((min[d]-m_Origin[d])/m_CellSize);
+    double h = std::floor((max[d]-m_Origin[d])/m_CellSize);
+    if (h<0 || l>=m_Size[d])
+      return false;
+    lo[d] = static_cast<int>(std::max(l, 0.0));
+    hi[d] = static_cast<int>(std::min(h, static_cast<double>(m_Size[d]-1)));
+  }
+  return true;
+}
+
+void mitk::FiberSpatialIndex::MarkCells(const double* min, const double* max, std::vector< unsigned char >& cells) const
+{
+  int lo[3], hi[3];
+  if (!GetCellRange(min, max, lo, hi))
+    return;
+  for (int z=lo[2]; z<=hi[2]; ++z)
+    for (int y=lo[1]; y<=hi[1]; ++y)
+      for (int x=lo[0]; x<=hi[0]; ++x)
+        cells[static_cast<std::size_t>(x + m_Size[0]*(y + m_Size[1]*z))] = 1;
+}
+
+std::vector< unsigned int > mitk::FiberSpatialIndex::GetFibers(const std::vector< unsigned char >& cells) const
+{
+  std::vector< unsigned char > hit(m_NumFibers, 0);
+  for (std::size_t c=0; c<cells.size() && c+1<m_CellOffsets.size(); ++c)
+    if (cells[c])
+      for (std::size_t k=m_CellOffsets[c]; k<m_CellOffsets[c+1]; ++k)
+        hit[m_CellFibers[k]] = 1;
+
+  std::vector< unsigned int > fibers;
+  for (unsigned int i=0; i<m_NumFibers; ++i)
+    if (hit[i])
+      fibers.push_back(i);
+  return fibers;
+}
@@ -0,0 +1,64 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_FiberSpatialIndex_H
+#define _MITK_FiberSpatialIndex_H
+
+#include <MitkFiberTrackingExports.h>
+#include <vector>
+#include <cstddef>
+
+namespace mitk {
+
+class FiberBundle;
+
+/**
+   * \brief Inverted index mapping the cells of a regular world space grid to the fibers passing through them.
+   *
+   * Each fiber is registered in all cells overlapped by the bounding boxes of its segments, so the fibers
+   * returned for a set of marked cells are a superset of the fibers actually intersecting the marked region.
+   * Callers are expected to verify the candidates exactly.
+   */
+class MITKFIBERTRACKING_EXPORT FiberSpatialIndex
+{
+public:
+
+    FiberSpatialIndex(const mitk::FiberBundle* fib, float cellSize=2.0f);
+
+    float GetCellSize() const { return m_CellSize; }
+    std::size_t GetNumberOfCells() const { return m_CellOffsets.size()-1; }
+
+    /** Marks all cells overlapping the axis aligned world space box [min, max]. 'cells' needs GetNumberOfCells() entries. */
+    void MarkCells(const double* min, const double* max, std::vector< unsigned char >& cells) const;
+
+    /** Sorted ids of all fibers registered in at least one marked cell. */
+    std::vector< unsigned int > GetFibers(const std::vector< unsigned char >& cells) const;
+
+private:
+
+    bool GetCellRange(const double* min, const double* max, int* lo, int* hi) const;
+
+    double                          m_Origin[3];
+    float                           m_CellSize;
+    int                             m_Size[3];
+    unsigned int                    m_NumFibers;
+    std::vector< std::size_t >      m_CellOffsets;  ///< start of the fiber list of each cell in m_CellFibers
+    std::vector< unsigned int >     m_CellFibers;
+};
+
+}
+
+#endif
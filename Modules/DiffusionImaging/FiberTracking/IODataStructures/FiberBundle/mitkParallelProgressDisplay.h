@@ -0,0 +1,67 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_ParallelProgressDisplay_H
+#define _MITK_ParallelProgressDisplay_H
+
+#include <boost/progress.hpp>
+#include <omp.h>
+#include <atomic>
+
+namespace mitk {
+
+/**
+   * \brief Console progress display for OpenMP parallel loops.
+   *
+   * The worker threads only count the processed items atomically. The wrapped boost::progress_display is not
+   * thread safe and is only advanced by the master thread and by Finish(), which has to be called after the
+   * parallel loop. This replaces "#pragma omp critical ++disp;", which serializes the threads once per item.
+   */
+class ParallelProgressDisplay
+{
+public:
+
+    explicit ParallelProgressDisplay(unsigned long expectedCount)
+      : m_Display(expectedCount)
+      , m_Count(0)
+    {}
+
+    void operator++()
+    {
+      ++m_Count;
+      if (omp_get_thread_num()==0)
+        this->Update();
+    }
+
+    /** \brief Shows the final count. Call after the parallel loop. */
+    void Finish() { this->Update(); }
+
+private:
+
+    void Update()
+    {
+      unsigned long count = m_Count;
+      if (count>m_Display.count())
+        m_Display += count-m_Display.count();
+    }
+
+    boost::progress_display       m_Display;
+    std::atomic<unsigned long>    m_Count;
+};
+
+}
+
+#endif
@@ -0,0 +1,311 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTractogramFile.h"
+#include <mitkTrackvis.h>
+#include <mitkExceptionMacro.h>
+#include <itksys/SystemTools.hxx>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/lexical_cast.hpp>
+#include <vtkMatrix4x4.h>
+#include <cmath>
+#include <cstring>
+
+mitk::TractogramFile::TractogramFile()
+  : m_Data(nullptr)
+  , m_Size(0)
+  , m_TotalNumberOfPoints(0)
+  , m_PointStride(12)
+{
+  m_Flip[0] = 1; m_Flip[1] = 1; m_Flip[2] = 1;
+}
+
+mitk::TractogramFile::~TractogramFile()
+{
+  this->Close();
+}
+
+void mitk::TractogramFile::Open(const std::string& filename)
+{
+  this->Close();
+
+  std::string ext = itksys::SystemTools::LowerCase(itksys::SystemTools::GetFilenameLastExtension(filename));
+  if (ext!=".trk" && ext!=".tck")
+    mitkThrow() << "Unsupported tractogram format: " << filename;
+
+  try
+  {
+    m_Mapping.reset(new boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only));
+    m_Region.reset(new boost::interprocess::mapped_region(*m_Mapping, boost::interprocess::read_only));
+  }
+  catch (const boost::interprocess::interprocess_exception& e)
+  {
+    m_Region.reset();
+    m_Mapping.reset();
+    mitkThrow() << "Unable to map file " << filename << ": " << e.what();
+  }
+  m_Data = static_cast<const char*>(m_Region->get_address());
+  m_Size = m_Region->get_size();
+  m_FileName = filename;
+
+  try
+  {
+    if (ext==".trk")
+      this->IndexTrackVis();
+    else
+      this->IndexTck();
+  }
+  catch (...)
+  {
+    this->Close();
+    throw;
+  }
+}
+
+void mitk::TractogramFile::Close()
+{
+  m_Region.reset();
+  m_Mapping.reset();
+  m_Data = nullptr;
+  m_Size = 0;
+  m_Offsets.clear();
+  m_NumPoints.clear();
+  m_TotalNumberOfPoints = 0;
+  m_PointStride = 12;
+  m_Flip[0] = 1; m_Flip[1] = 1; m_Flip[2] = 1;
+  m_ReferenceGeometry = nullptr;
+}
+
+void mitk::TractogramFile::IndexTrackVis()
+{
+  if (m_Size<1000)
+    mitkThrow() << "TrackVis file " << m_FileName << " is too small to contain a header.";
+
+  TrackVis_header header;
+  std::memcpy(&header, m_Data, std::min(sizeof(TrackVis_header), std::size_t(1000)));
+  if (std::strncmp(header.id_string, "TRACK", 5)!=0)
+    mitkThrow() << m_FileName << " is not a TrackVis file.";
+
+  // every point is followed by its scalars and every streamline by its properties
+  m_PointStride = 4*(3+static_cast<std::size_t>(std::max<short>(header.n_scalars, 0)));
+  std::size_t propertyBytes = 4*static_cast<std::size_t>(std::max<short>(header.n_properties, 0));
+
+  if (header.n_count>0)
+  {
+    m_Offsets.reserve(static_cast<std::size_t>(header.n_count));
+    m_NumPoints.reserve(static_cast<std::size_t>(header.n_count));
+  }
+
+  std::size_t pos = 1000;
+  while (pos+4<=m_Size)
+  {
+    int numPoints = 0;
+    std::memcpy(&numPoints, m_Data+pos, 4);
+    if (numPoints<=0)
+      mitkThrow() << "TrackVis file " << m_FileName << " contains a streamline with " << numPoints << " points.";
+    pos += 4;
+    if (pos + numPoints*m_PointStride + propertyBytes > m_Size)
+      mitkThrow() << "TrackVis file " << m_FileName << " is truncated.";
+
+    m_Offsets.push_back(pos);
+    m_NumPoints.push_back(static_cast<unsigned int>(numPoints));
+    m_TotalNumberOfPoints += static_cast<std::size_t>(numPoints);
+    pos += numPoints*m_PointStride + propertyBytes;
+  }
+
+  if (header.voxel_order[0]=='R')
+    m_Flip[0] = -1;
+  if (header.voxel_order[1]=='A')
+    m_Flip[1] = -1;
+  if (header.voxel_order[2]=='I')
+    m_Flip[2] = -1;
+
+  mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
+  vtkSmartPointer< vtkMatrix4x4 > matrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  matrix->Identity();
+  for (int i=0; i<3; ++i)
+    matrix->SetElement(i,i,m_Flip[i]);
+  geometry->SetIndexToWorldTransformByVtkMatrix(matrix);
+
+  mitk::Point3D origin;
+  origin[0]=header.origin[0];
+  origin[1]=header.origin[1];
+  origin[2]=header.origin[2];
+  geometry->SetOrigin(origin);
+
+  mitk::Vector3D spacing;
+  spacing[0]=header.voxel_size[0];
+  spacing[1]=header.voxel_size[1];
+  spacing[2]=header.voxel_size[2];
+
+  if (spacing[0]>0 && spacing[1]>0 && spacing[2]>0 && header.dim[0]>0 && header.dim[1]>0 && header.dim[2]>0)
+  {
+    geometry->SetSpacing(spacing);
+    geometry->SetExtentInMM(0, header.voxel_size[0]*header.dim[0]);
+    geometry->SetExtentInMM(1, header.voxel_size[1]*header.dim[1]);
+    geometry->SetExtentInMM(2, header.voxel_size[2]*header.dim[2]);
+    m_ReferenceGeometry = geometry.GetPointer();
+  }
+}
+
+void mitk::TractogramFile::IndexTck()
+{
+  // the header is plain text terminated by a line containing END
+  const char* end = nullptr;
+  for (std::size_t i=0; i+3<=m_Size && end==nullptr; ++i)
+    if (std::strncmp(m_Data+i, "END", 3)==0 && (i==0 || m_Data[i-1]=='\n'))
+      end = m_Data+i;
+  if (end==nullptr)
+    mitkThrow() << "Could not find the end of the header in " << m_FileName;
+  std::string header(m_Data, end);
+
+  std::size_t pos = header.find("datatype: ");
+  if (pos!=std::string::npos && header.compare(pos+10, 9, "Float32LE")!=0)
+    mitkThrow() << "Unsupported datatype in " << m_FileName << ". Only Float32LE is supported.";
+
+  std::size_t dataOffset = 0;
+  try
+  {
+    std::string delimiter = "file: . ";
+    pos = header.find(delimiter);
+    if (pos==std::string::npos)
+      throw std::exception();
+    header.erase(0, pos + delimiter.length());
+    dataOffset = boost::lexical_cast<std::size_t>(header.substr(0, header.find("\n")));
+  }
+  catch(...)
+  {
+    mitkThrow() << "Could not parse header size from " << m_FileName;
+  }
+
+  // MRtrix stores RAS coordinates
+  m_Flip[0] = -1;
+  m_Flip[1] = -1;
+  m_PointStride = 12;
+
+  std::size_t start = dataOffset;
+  unsigned int numPoints = 0;
+  for (pos = dataOffset; pos+12<=m_Size; pos+=12)
+  {
+    float p[3];
+    std::memcpy(p, m_Data+pos, 12);
+    if (std::isinf(p[0]) || std::isinf(p[1]) || std::isinf(p[2]))
+      break;
+    else if (std::isnan(p[0]) || std::isnan(p[1]) || std::isnan(p[2]))
+    {
+      m_Offsets.push_back(start);
+      m_NumPoints.push_back(numPoints);
+      m_TotalNumberOfPoints += numPoints;
+      numPoints = 0;
+      start = pos+12;
+    }
+    else
+      numPoints++;
+  }
+}
+
+void mitk::TractogramFile::GetStreamline(unsigned int streamline, float* points) const
+{
+  const char* data = m_Data + m_Offsets.at(streamline);
+  for (unsigned int j=0; j<m_NumPoints[streamline]; ++j, data+=m_PointStride, points+=3)
+  {
+    std::memcpy(points, data, 12);
+    points[0] *= m_Flip[0];
+    points[1] *= m_Flip[1];
+    points[2] *= m_Flip[2];
+  }
+}
+
+mitk::FiberBundle::Pointer mitk::TractogramFile::ReadStreamlines(const std::vector<unsigned int>& streamlines) const
+{
+  if (!this->IsOpen())
+    mitkThrow() << "No tractogram file opened.";
+
+  std::vector< vtkIdType > offsets(streamlines.size()+1, 0);
+  for (std::size_t i=0; i<streamlines.size(); ++i)
+    offsets[i+1] = offsets[i] + this->GetNumberOfPoints(streamlines[i]);
+
+  std::vector< float > points(3*static_cast<std::size_t>(offsets.back()));
+#pragma omp parallel for
+  for (int i=0; i<static_cast<int>(streamlines.size()); ++i)
+    this->GetStreamline(streamlines[static_cast<std::size_t>(i)], points.data()+3*offsets[i]);
+
+  mitk::FiberBundle::Pointer fib = mitk::FiberBundle::New();
+  fib->SetFiberStore(points, offsets);
+  if (m_ReferenceGeometry.IsNotNull())
+    fib->SetReferenceGeometry(m_ReferenceGeometry);
+  return fib;
+}
+
+mitk::FiberBundle::Pointer mitk::TractogramFile::Read() const
+{
+  return this->ReadChunk(0, this->GetNumberOfStreamlines());
+}
+
+mitk::FiberBundle::Pointer mitk::TractogramFile::ReadChunk(unsigned int first, unsigned int count) const
+{
+  std::vector<unsigned int> streamlines;
+  for (unsigned int i=first; i<this->GetNumberOfStreamlines() && i-first<count; ++i)
+    streamlines.push_back(i);
+  return this->ReadStreamlines(streamlines);
+}
+
+mitk::FiberBundle::Pointer mitk::TractogramFile::ReadSubsample(unsigned int numStreamlines) const
+{
+  std::vector<unsigned int> streamlines;
+  unsigned int total = this->GetNumberOfStreamlines();
+  if (numStreamlines>=total)
+    return this->Read();
+
+  double step = static_cast<double>(total)/numStreamlines;
+  for (unsigned int i=0; i<numStreamlines; ++i)
+    streamlines.push_back(static_cast<unsigned int>(i*step));
+  return this->ReadStreamlines(streamlines);
+}
+
+std::vector<unsigned int> mitk::TractogramFile::GetStreamlinesInMask(ItkUcharImgType* mask) const
+{
+  std::vector< unsigned char > inside(this->GetNumberOfStreamlines(), 0);
+#pragma omp parallel for schedule(dynamic, 1000)
+  for (int i=0; i<static_cast<int>(this->GetNumberOfStreamlines()); ++i)
+  {
+    const char* data = m_Data + m_Offsets[static_cast<unsigned int>(i)];
+    for (unsigned int j=0; j<m_NumPoints[static_cast<unsigned int>(i)]; ++j, data+=m_PointStride)
+    {
+      float p[3];
+      std::memcpy(p, data, 12);
+      itk::Point<float, 3> itkP;
+      itkP[0] = p[0]*m_Flip[0];
+      itkP[1] = p[1]*m_Flip[1];
+      itkP[2] = p[2]*m_Flip[2];
+
+      itk::Index<3> idx;
+      mask->TransformPhysicalPointToIndex(itkP, idx);
+      if ( mask->GetLargestPossibleRegion().IsInside(idx) && mask->GetPixel(idx)!=0 )
+      {
+        inside[static_cast<unsigned int>(i)] = 1;
+        break;
+      }
+    }
+  }
+
+  std::vector<unsigned int> streamlines;
+  for (unsigned int i=0; i<inside.size(); ++i)
+    if (inside[i])
+      streamlines.push_back(i);
+  return streamlines;
+}
@@ -0,0 +1,91 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_TractogramFile_H
+#define _MITK_TractogramFile_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberBundle.h>
+#include <memory>
+
+namespace boost { namespace interprocess {
+class file_mapping;
+class mapped_region;
+} }
+
+namespace mitk {
+
+/**
+   * \brief Memory-mapped access to TrackVis (.trk) and MRtrix (.tck) tractograms.
+   *
+   * Open() maps the file and indexes the streamline offsets in one pass. Afterwards
+   * single streamlines, chunks, subsampled previews or ROI queries are read directly from the
+   * mapped file without loading the whole tractogram. All points are returned in MITK (LPS) world coordinates.
+   */
+class MITKFIBERTRACKING_EXPORT TractogramFile
+{
+public:
+
+    typedef itk::Image<unsigned char, 3> ItkUcharImgType;
+
+    TractogramFile();
+    ~TractogramFile();
+
+    void Open(const std::string& filename);
+    void Close();
+    bool IsOpen() const { return m_Data!=nullptr; }
+
+    unsigned int GetNumberOfStreamlines() const { return static_cast<unsigned int>(m_NumPoints.size()); }
+    unsigned int GetNumberOfPoints(unsigned int streamline) const { return m_NumPoints.at(streamline); }
+    std::size_t GetTotalNumberOfPoints() const { return m_TotalNumberOfPoints; }
+
+    /** Reference geometry stored in the TrackVis header (nullptr for .tck files). */
+    mitk::BaseGeometry::Pointer GetReferenceGeometry() const { return m_ReferenceGeometry; }
+
+    /** Copies the points of the streamline into 'points' (3*GetNumberOfPoints(streamline) values). */
+    void GetStreamline(unsigned int streamline, float* points) const;
+
+    mitk::FiberBundle::Pointer Read() const;
+    mitk::FiberBundle::Pointer ReadStreamlines(const std::vector<unsigned int>& streamlines) const;
+    mitk::FiberBundle::Pointer ReadChunk(unsigned int first, unsigned int count) const;
+    /** Preview of the tractogram containing (at most) numStreamlines evenly spaced streamlines. */
+    mitk::FiberBundle::Pointer ReadSubsample(unsigned int numStreamlines) const;
+
+    /** Ids of all streamlines with at least one point inside the mask. */
+    std::vector<unsigned int> GetStreamlinesInMask(ItkUcharImgType* mask) const;
+
+private:
+
+    void IndexTrackVis();
+    void IndexTck();
+
+    std::string                                                 m_FileName;
+    std::unique_ptr< boost::interprocess::file_mapping >        m_Mapping;
+    std::unique_ptr< boost::interprocess::mapped_region >       m_Region;
+    const char*                                                 m_Data;
+    std::size_t                                                 m_Size;
+
+    std::vector< std::size_t >      m_Offsets;        ///< byte offset of the first point of each streamline
+    std::vector< unsigned int >     m_NumPoints;
+    std::size_t                     m_TotalNumberOfPoints;
+    std::size_t                     m_PointStride;    ///< bytes between two consecutive points (TrackVis scalars are skipped)
+    float                           m_Flip[3];        ///< sign of each axis to convert the file coordinates to LPS
+    mitk::BaseGeometry::Pointer     m_ReferenceGeometry;
+};
+
+}
+
+#endif
@@ -0,0 +1,167 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTractogramFileWriter.h"
+#include <mitkTrackvis.h>
+#include <mitkExceptionMacro.h>
+#include <itksys/SystemTools.hxx>
+#include <cstring>
+#include <limits>
+
+mitk::TractogramFileWriter::TractogramFileWriter()
+  : m_FilePointer(nullptr)
+  , m_Tck(false)
+  , m_NumberOfStreamlines(0)
+{
+}
+
+mitk::TractogramFileWriter::~TractogramFileWriter()
+{
+  try
+  {
+    this->Close();
+  }
+  catch(...)
+  {
+    MITK_ERROR << "Error while closing tractogram " << m_FileName;
+  }
+}
+
+void mitk::TractogramFileWriter::Open(const std::string& filename, const mitk::BaseGeometry* reference)
+{
+  this->Close();
+
+  std::string ext = itksys::SystemTools::LowerCase(itksys::SystemTools::GetFilenameLastExtension(filename));
+  if (ext!=".trk" && ext!=".tck")
+    mitkThrow() << "Unsupported tractogram format: " << filename;
+  m_Tck = ext==".tck";
+
+  m_FilePointer = std::fopen(filename.c_str(), "w+b");
+  if (m_FilePointer==nullptr)
+    mitkThrow() << "Unable to create file " << filename;
+  m_FileName = filename;
+  m_NumberOfStreamlines = 0;
+
+  if (m_Tck)
+  {
+    this->WriteTckHeader();
+    return;
+  }
+
+  TrackVis_header header;
+  std::memset(&header, 0, sizeof(TrackVis_header));
+  sprintf(header.id_string,"TRACK");
+  if (reference!=nullptr)
+  {
+    for(int i=0; i<3 ;i++)
+    {
+      header.dim[i]            = reference->GetExtent(i);
+      header.voxel_size[i]     = reference->GetSpacing()[i];
+      header.origin[i]         = reference->GetOrigin()[i];
+    }
+  }
+  sprintf(header.voxel_order,"LPS");
+  header.image_orientation_patient[0] = 1.0;
+  header.image_orientation_patient[4] = 1.0;
+  header.version = 1;
+  header.hdr_size = 1000;
+
+  if (std::fwrite((char*)&header, 1, 1000, m_FilePointer) != 1000)
+    mitkThrow() << "Unable to write TrackVis header to " << filename;
+}
+
+void mitk::TractogramFileWriter::WriteTckHeader()
+{
+  // the data offset is part of the header, so its length depends on the number of digits of the offset itself
+  std::string header;
+  std::size_t offset = 0;
+  do
+  {
+    offset = header.size();
+    header = "mrtrix tracks\ndatatype: Float32LE\ncount: " + std::string(10, '0') + "\nfile: . " + std::to_string(offset) + "\nEND\n";
+  }
+  while (header.size()!=offset);
+
+  std::fseek(m_FilePointer, 0, SEEK_SET);
+  if (std::fwrite(header.c_str(), 1, header.size(), m_FilePointer) != header.size())
+    mitkThrow() << "Unable to write tck header to " << m_FileName;
+}
+
+void mitk::TractogramFileWriter::AppendStreamline(const float* points, unsigned int numPoints)
+{
+  if (!this->IsOpen())
+    mitkThrow() << "No tractogram file opened.";
+
+  if (m_Tck)
+  {
+    // MRtrix expects RAS coordinates and a NaN triplet after each streamline
+    m_Buffer.resize(3*static_cast<std::size_t>(numPoints)+3);
+    for (unsigned int j=0; j<numPoints; ++j)
+    {
+      m_Buffer[3*j]   = -points[3*j];
+      m_Buffer[3*j+1] = -points[3*j+1];
+      m_Buffer[3*j+2] = points[3*j+2];
+    }
+    m_Buffer[3*numPoints] = m_Buffer[3*numPoints+1] = m_Buffer[3*numPoints+2] = std::numeric_limits<float>::quiet_NaN();
+    if (std::fwrite((char*)m_Buffer.data(), 4, m_Buffer.size(), m_FilePointer) != m_Buffer.size())
+      mitkThrow() << "Unable to write streamline to " << m_FileName;
+  }
+  else
+  {
+    if (numPoints==0)
+      return;
+    int n = static_cast<int>(numPoints);
+    if ( std::fwrite((char*)&n, 1, 4, m_FilePointer) != 4 || std::fwrite((char*)points, 4, 3*numPoints, m_FilePointer) != 3*numPoints )
+      mitkThrow() << "Unable to write streamline to " << m_FileName;
+  }
+  m_NumberOfStreamlines++;
+}
+
+void mitk::TractogramFileWriter::Append(const mitk::FiberBundle* fib)
+{
+  for (unsigned int i=0; i<fib->GetNumFibers(); ++i)
+    this->AppendStreamline(fib->GetFiberPoint(i, 0), fib->GetNumberOfFiberPoints(i));
+}
+
+void mitk::TractogramFileWriter::Close()
+{
+  if (m_FilePointer==nullptr)
+    return;
+
+  bool ok = true;
+  if (m_Tck)
+  {
+    float end[3] = { std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+    ok = std::fwrite((char*)end, 4, 3, m_FilePointer) == 3;
+
+    std::string header = "mrtrix tracks\ndatatype: Float32LE\ncount: ";
+    char count[11];
+    sprintf(count, "%010u", m_NumberOfStreamlines);
+    ok = ok && std::fseek(m_FilePointer, static_cast<long>(header.size()), SEEK_SET)==0;
+    ok = ok && std::fwrite(count, 1, 10, m_FilePointer) == 10;
+  }
+  else
+  {
+    int n = static_cast<int>(m_NumberOfStreamlines);
+    ok = std::fseek(m_FilePointer, 1000-12, SEEK_SET)==0;
+    ok = ok && std::fwrite((char*)&n, 1, 4, m_FilePointer) == 4;
+  }
+
+  std::fclose(m_FilePointer);
+  m_FilePointer = nullptr;
+  if (!ok)
+    mitkThrow() << "Unable to finalize tractogram " << m_FileName;
+}
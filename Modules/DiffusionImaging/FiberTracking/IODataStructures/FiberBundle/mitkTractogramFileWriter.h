@@ -0,0 +1,62 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_TractogramFileWriter_H
+#define _MITK_TractogramFileWriter_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberBundle.h>
+#include <cstdio>
+
+namespace mitk {
+
+/**
+   * \brief Streaming writer for TrackVis (.trk) and MRtrix (.tck) tractograms.
+   *
+   * Streamlines are appended one by one or bundle by bundle, so arbitrarily large tractograms can be
+   * converted chunk-wise (e.g. using mitk::TractogramFile::ReadChunk) without holding them in memory.
+   * The streamline count in the header is patched in Close(). Points are expected in MITK (LPS) world coordinates.
+   */
+class MITKFIBERTRACKING_EXPORT TractogramFileWriter
+{
+public:
+
+    TractogramFileWriter();
+    ~TractogramFileWriter();
+
+    /** The reference geometry is stored in the TrackVis header and ignored for .tck files. */
+    void Open(const std::string& filename, const mitk::BaseGeometry* reference=nullptr);
+    void AppendStreamline(const float* points, unsigned int numPoints);
+    void Append(const mitk::FiberBundle* fib);
+    void Close();
+
+    bool IsOpen() const { return m_FilePointer!=nullptr; }
+    unsigned int GetNumberOfStreamlines() const { return m_NumberOfStreamlines; }
+
+private:
+
+    void WriteTckHeader();
+
+    std::string                 m_FileName;
+    std::FILE*                  m_FilePointer;
+    bool                        m_Tck;
+    unsigned int                m_NumberOfStreamlines;
+    std::vector< float >        m_Buffer;
+};
+
+}
+
+#endif
@@ -19,15 +19,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTractographyForest.h"
 #include <mitkExceptionMacro.h>
 #include <mitkGeometry3D.h>
+#include <cmath>
+#include <deque>
+#include <limits>
 
 namespace mitk
 {
 
 TractographyForest::TractographyForest( std::shared_ptr< vigra::RandomForest<int> > forest )
+  : m_FlatForestValid(false)
 {
   m_Forest = forest;
   mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
   SetGeometry(geometry);
+  FlattenForest();
 }
 
 TractographyForest::~TractographyForest()
@@ -35,9 +40,127 @@ TractographyForest::~TractographyForest()
 
 }
 
+void TractographyForest::FlattenForest()
+{
+  m_FlatNodes.clear();
+  m_FlatTreeRoots.clear();
+  m_FlatLeafWeights.clear();
+  m_FlatForestValid = false;
+  if (!HasForest())
+    return;
+
+  int numClasses = GetNumClasses();
+  int weighted = m_Forest->options_.predict_weighted_;
+  for (int t=0; t<GetNumTrees(); t++)
+  {
+    const auto& topology = m_Forest->tree(t).topology_;
+    const auto& parameters = m_Forest->tree(t).parameters_;
+
+    // breadth-first traversal, the root node is stored after the two header entries of the vigra topology array
+    std::deque< std::pair<int, int> > queue;  // (topology index, flat node index)
+    m_FlatTreeRoots.push_back(m_FlatNodes.size());
+    m_FlatNodes.push_back(FlatNode());
+    queue.push_back(std::make_pair(2, m_FlatTreeRoots.back()));
+    while (!queue.empty())
+    {
+      int topologyIndex = queue.front().first;
+      int flatIndex = queue.front().second;
+      queue.pop_front();
+
+      int nodeType = topology[topologyIndex];
+      const double* nodeParameters = &parameters[topology[topologyIndex+1]];
+      if (nodeType==vigra::e_ConstProbNode)
+      {
+        m_FlatNodes[flatIndex].Feature = -1;
+        m_FlatNodes[flatIndex].Threshold = 0;
+        m_FlatNodes[flatIndex].Child[0] = m_FlatLeafWeights.size();
+        m_FlatNodes[flatIndex].Child[1] = -1;
+
+        // same weighting as in vigra::RandomForest::predictProbabilities
+        for (int c=0; c<numClasses; c++)
+          m_FlatLeafWeights.push_back(nodeParameters[1+c] * (weighted * nodeParameters[0] + (1-weighted)));
+      }
+      else if (nodeType==vigra::i_ThresholdNode)
+      {
+        // the features are floats, so the smallest float that is not below the threshold yields the same decisions as the double threshold
+        float threshold = static_cast<float>(nodeParameters[1]);
+        if (threshold<nodeParameters[1])
+          threshold = std::nextafter(threshold, std::numeric_limits<float>::infinity());
+
+        m_FlatNodes[flatIndex].Feature = topology[topologyIndex+4];
+        m_FlatNodes[flatIndex].Threshold = threshold;
+        for (int i=0; i<2; i++)
+        {
+          m_FlatNodes[flatIndex].Child[i] = m_FlatNodes.size();
+          m_FlatNodes.push_back(FlatNode());
+          queue.push_back(std::make_pair(topology[topologyIndex+2+i], m_FlatNodes[flatIndex].Child[i]));
+        }
+      }
+      else
+      {
+        MITK_INFO << "Random forest contains nodes that are not threshold splits. Prediction is performed by vigra.";
+        m_FlatNodes.clear();
+        m_FlatTreeRoots.clear();
+        m_FlatLeafWeights.clear();
+        return;
+      }
+    }
+  }
+  m_FlatForestValid = true;
+}
+
 void TractographyForest::PredictProbabilities(vigra::MultiArray<2, float>& features, vigra::MultiArray<2, float>& probabilities) const
 {
-  m_Forest->predictProbabilities(features, probabilities);
+  if (!m_FlatForestValid)
+  {
+    m_Forest->predictProbabilities(features, probabilities);
+    return;
+  }
+
+  int numSamples = features.shape(0);
+  int numFeatures = features.shape(1);
+  int numClasses = GetNumClasses();
+  if (numFeatures<GetNumFeatures() || probabilities.shape(0)!=numSamples || probabilities.shape(1)!=numClasses)
+    mitkThrow() << "Feature matrix or probability matrix has the wrong size.";
+
+  // vigra arrays are column major, copy the samples into contiguous rows
+  std::vector< float > samples(numSamples*numFeatures);
+  std::vector< bool > valid(numSamples, true);
+  for (int f=0; f<numFeatures; f++)
+    for (int s=0; s<numSamples; s++)
+    {
+      samples[s*numFeatures + f] = features(s, f);
+      if (std::isnan(features(s, f)))
+        valid[s] = false;   // like vigra, samples containing NaNs get zero probability for all classes
+    }
+
+  probabilities.init(0.0);
+  std::vector< double > totalWeights(numSamples, 0.0);
+
+  // trees in the outer loop, so the nodes of one tree stay in cache for the whole batch
+  for (int root : m_FlatTreeRoots)
+    for (int s=0; s<numSamples; s++)
+    {
+      if (!valid[s])
+        continue;
+
+      const float* sample = &samples[s*numFeatures];
+      const FlatNode* node = &m_FlatNodes[root];
+      while (node->Feature>=0)
+        node = &m_FlatNodes[node->Child[sample[node->Feature] < node->Threshold ? 0 : 1]];
+
+      const double* weights = &m_FlatLeafWeights[node->Child[0]];
+      for (int c=0; c<numClasses; c++)
+      {
+        probabilities(s, c) += static_cast<float>(weights[c]);
+        totalWeights[s] += weights[c];
+      }
+    }
+
+  for (int s=0; s<numSamples; s++)
+    if (valid[s])
+      for (int c=0; c<numClasses; c++)
+        probabilities(s, c) /= static_cast<float>(totalWeights[s]);
 }
 
 int TractographyForest::GetNumFeatures() const
@@ -50,7 +50,7 @@ public:
   int GetMaxTreeDepth() const;
   int IndexToClassLabel(int idx) const;
   bool HasForest() const;
-  void PredictProbabilities(vigra::MultiArray<2, float>& features, vigra::MultiArray<2, float>& probabilities) const;
+  void PredictProbabilities(vigra::MultiArray<2, float>& features, vigra::MultiArray<2, float>& probabilities) const;   ///< one row per sample; all rows are classified in one pass over the flattened trees
   std::shared_ptr< const vigra::RandomForest<int> > GetForest() const
   { return m_Forest; }
 
@@ -63,8 +63,23 @@ protected:
 
 private:
 
+  /** Tree node in the flattened forest. Nodes of a tree are stored in breadth-first order so that the top levels, which are visited by every sample, share few cache lines. */
+  struct FlatNode
+  {
+    int   Feature;      ///< split feature, -1 for leaf nodes
+    float Threshold;    ///< samples with feature value < threshold go to the left child
+    int   Child[2];     ///< indices of the child nodes in m_FlatNodes, leaf nodes store the offset of their class weights in m_FlatLeafWeights in Child[0]
+  };
+
+  void FlattenForest();
+
   std::shared_ptr< vigra::RandomForest<int> > m_Forest;   ///< random forest classifier
 
+  std::vector< FlatNode >   m_FlatNodes;          ///< nodes of all trees
+  std::vector< int >        m_FlatTreeRoots;      ///< index of the root node of each tree in m_FlatNodes
+  std::vector< double >     m_FlatLeafWeights;    ///< weighted class probabilities of all leaf nodes
+  bool                      m_FlatForestValid;    ///< false if the forest contains node types that are not supported by the flattened layout
+
 };
 
 } // namespace mitk
@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itksys/SystemTools.hxx>
 #include <mitkTestingConfig.h>
 #include <mitkIOUtil.h>
+#include <mitkTractogramFile.h>
+#include <mitkTractogramFileWriter.h>
 
 #include "mitkTestFixture.h"
 
@@ -28,6 +30,8 @@ class mitkFiberBundleReaderWriterTestSuite : public mitk::TestFixture
 
   CPPUNIT_TEST_SUITE(mitkFiberBundleReaderWriterTestSuite);
   MITK_TEST(Equal_SaveLoad_ReturnsTrue);
+  MITK_TEST(Equal_StreamingTrk_ReturnsTrue);
+  MITK_TEST(Equal_StreamingTck_ReturnsTrue);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -66,6 +70,75 @@ public:
     //MITK_ASSERT_EQUAL(fib1, fib2, "A saved and re-loaded file should be equal");
   }
 
+  void StreamingSaveLoad(const std::string& filename)
+  {
+    mitk::TractogramFileWriter writer;
+    writer.Open(filename, fib1->GetReferenceGeometry());
+    for (unsigned int i=0; i<fib1->GetNumFibers(); ++i)
+      writer.AppendStreamline(fib1->GetFiberPoint(i, 0), fib1->GetNumberOfFiberPoints(i));
+    writer.Close();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Number of written streamlines", fib1->GetNumFibers(), writer.GetNumberOfStreamlines());
+
+    mitk::TractogramFile file;
+    file.Open(filename);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Number of indexed streamlines", fib1->GetNumFibers(), file.GetNumberOfStreamlines());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Number of indexed points", static_cast<std::size_t>(fib1->GetNumberOfPoints()), file.GetTotalNumberOfPoints());
+
+    fib2 = file.Read();
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", fib1->Equals(fib2));
+
+    // chunk-wise read
+    unsigned int half = fib1->GetNumFibers()/2;
+    mitk::FiberBundle::Pointer first = file.ReadChunk(0, half);
+    mitk::FiberBundle::Pointer second = file.ReadChunk(half, fib1->GetNumFibers());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Chunk sizes", fib1->GetNumFibers(), first->GetNumFibers()+second->GetNumFibers());
+    CPPUNIT_ASSERT_MESSAGE("Chunks should be equal", first->AddBundle(second)->Equals(fib1));
+
+    // subsampled preview
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Subsample size", 10u, file.ReadSubsample(10)->GetNumFibers());
+
+    // ROI query compared to a brute force search
+    mitk::FiberBundle::ItkUcharImgType::Pointer mask = mitk::FiberBundle::ItkUcharImgType::New();
+    mitk::FiberBundle::ItkUcharImgType::RegionType::SizeType size; size.Fill(10);
+    mitk::FiberBundle::ItkUcharImgType::SpacingType spacing; spacing.Fill(2);
+    itk::Point<double, 3> origin;
+    const float* p = fib1->GetFiberPoint(0, fib1->GetNumberOfFiberPoints(0)/2);
+    for (int d=0; d<3; ++d)
+      origin[d] = p[d] - 9;
+    mask->SetRegions(size);
+    mask->SetSpacing(spacing);
+    mask->SetOrigin(origin);
+    mask->Allocate();
+    mask->FillBuffer(1);
+
+    std::vector<unsigned int> expected;
+    for (unsigned int i=0; i<fib1->GetNumFibers(); ++i)
+      for (unsigned int j=0; j<fib1->GetNumberOfFiberPoints(i); ++j)
+      {
+        itk::Point<float, 3> itkP;
+        itkP[0] = fib1->GetFiberPoint(i, j)[0]; itkP[1] = fib1->GetFiberPoint(i, j)[1]; itkP[2] = fib1->GetFiberPoint(i, j)[2];
+        itk::Index<3> idx;
+        mask->TransformPhysicalPointToIndex(itkP, idx);
+        if (mask->GetLargestPossibleRegion().IsInside(idx))
+        {
+          expected.push_back(i);
+          break;
+        }
+      }
+    CPPUNIT_ASSERT_MESSAGE("ROI query should not be empty", !expected.empty());
+    CPPUNIT_ASSERT_MESSAGE("ROI query should match brute force search", expected==file.GetStreamlinesInMask(mask));
+  }
+
+  void Equal_StreamingTrk_ReturnsTrue()
+  {
+    StreamingSaveLoad(std::string(MITK_TEST_OUTPUT_DIR)+"/writerTest.trk");
+  }
+
+  void Equal_StreamingTck_ReturnsTrue()
+  {
+    StreamingSaveLoad(std::string(MITK_TEST_OUTPUT_DIR)+"/writerTest.tck");
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberBundleReaderWriter)
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIOUtil.h>
 #include <omp.h>
 #include <itkFitFibersToImageFilter.h>
+#include <itkTimeProbe.h>
 #include <mitkTestFixture.h>
 #include <mitkPeakImage.h>
 #include <mitkPreferenceListReaderOptionsFunctor.h>
@@ -40,6 +41,7 @@ class mitkFiberFitTestSuite : public mitk::TestFixture
   MITK_TEST(Fit4);
   MITK_TEST(Fit5);
   MITK_TEST(Fit6);
+  MITK_TEST(Fit7);
   CPPUNIT_TEST_SUITE_END();
 
   typedef itk::Image<float, 3> ItkFloatImgType;
@@ -50,6 +52,8 @@ private:
 
   typedef itk::FitFibersToImageFilter FitterType;
   FitterType::Pointer fitter;
+  mitk::PeakImage::ItkPeakImageType::Pointer peak_image;
+  std::vector<mitk::FiberBundle::Pointer> tracts;
 
 public:
 
@@ -63,7 +67,7 @@ public:
 
   void setUp() override
   {
-    std::vector<mitk::FiberBundle::Pointer> tracts;
+    tracts.clear();
     tracts.push_back(LoadFib("Cluster_0.fib"));
     tracts.push_back(LoadFib("Cluster_1.fib"));
     tracts.push_back(LoadFib("Cluster_2.fib"));
@@ -78,7 +82,7 @@ public:
     CasterType::Pointer caster = CasterType::New();
     caster->SetInput(peaks);
     caster->Update();
-    mitk::PeakImage::ItkPeakImageType::Pointer peak_image = caster->GetOutput();
+    peak_image = caster->GetOutput();
 
     fitter = FitterType::New();
     fitter->SetPeakImage(peak_image);
@@ -261,6 +265,51 @@ public:
     CompareImages(fitter->GetResidualImage(), "GroupLasso_residual_image.nrrd");
   }
 
+  void Fit7()
+  {
+    // parallel assembly and matrix products have to reproduce the serial result
+    FitterType::Pointer parallel_fitter = FitterType::New();
+    parallel_fitter->SetPeakImage(peak_image);
+    parallel_fitter->SetTractograms(tracts);
+    parallel_fitter->SetLambda(0.1);
+    parallel_fitter->SetFilterOutliers(false);
+    parallel_fitter->SetRegularization(VnlCostFunction::VOXEL_VARIANCE);
+    int num_threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    itk::TimeProbe lbfgsb_clock;
+    lbfgsb_clock.Start();
+    parallel_fitter->Update();
+    lbfgsb_clock.Stop();
+    omp_set_num_threads(num_threads);
+
+    std::vector< mitk::FiberBundle::Pointer > output_tracts = parallel_fitter->GetTractograms();
+    mitk::FiberBundle::Pointer test = mitk::FiberBundle::New();
+    test = test->AddBundles(output_tracts);
+    mitk::FiberBundle::Pointer ref = LoadFib("out/LocalMSE_fitted.fib");
+    CompareFibs(test, ref, "LocalMSE_fitted_parallel.fib");
+
+    FitterType::Pointer pg_fitter = FitterType::New();
+    pg_fitter->SetPeakImage(peak_image);
+    pg_fitter->SetTractograms(output_tracts);
+    pg_fitter->SetLambda(0.1);
+    pg_fitter->SetFilterOutliers(false);
+    pg_fitter->SetRegularization(VnlCostFunction::VOXEL_VARIANCE);
+    pg_fitter->SetSolver(FitterType::PROJECTED_GRADIENT);
+    pg_fitter->SetMaxIterations(200);
+    pg_fitter->SetVerbose(false);
+    omp_set_num_threads(4);
+    itk::TimeProbe pg_clock;
+    pg_clock.Start();
+    pg_fitter->Update();
+    pg_clock.Stop();
+    omp_set_num_threads(num_threads);
+
+    // both times include the assembly of the same system
+    MITK_INFO << "LBFGSB: " << lbfgsb_clock.GetTotal() << "s, RMSE " << parallel_fitter->GetRMSE();
+    MITK_INFO << "Projected gradient: " << pg_clock.GetTotal() << "s, RMSE " << pg_fitter->GetRMSE();
+    CPPUNIT_ASSERT_MESSAGE("Projected gradient solver should reach the accuracy of LBFGSB", pg_fitter->GetRMSE() <= 1.1*parallel_fitter->GetRMSE());
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberFit)
@@ -21,7 +21,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTestingConfig.h>
 #include <mitkIOUtil.h>
 #include <itkFiberCurvatureFilter.h>
+#include <itkFiberExtractionFilter.h>
 #include <omp.h>
+#include <vtkCell.h>
 #include "mitkTestFixture.h"
 
 class mitkFiberProcessingTestSuite : public mitk::TestFixture
@@ -46,6 +48,8 @@ class mitkFiberProcessingTestSuite : public mitk::TestFixture
     MITK_TEST(Test16);
     MITK_TEST(Test17);
     MITK_TEST(Test18);
+    MITK_TEST(Test19);
+    MITK_TEST(Test20);
     CPPUNIT_TEST_SUITE_END();
 
     typedef itk::Image<unsigned char, 3> ItkUcharImgType;
@@ -299,6 +303,120 @@ public:
         CPPUNIT_ASSERT_MESSAGE("Should be equal", ref->Equals(fib));
     }
 
+    void Test19()
+    {
+        MITK_INFO << "TEST 19: Contiguous fiber store and parallel processing";
+
+        mitk::FiberBundle::Pointer fib = original->GetDeepCopy();
+        vtkSmartPointer<vtkPolyData> poly = fib->GetFiberPolyData();
+        CPPUNIT_ASSERT_MESSAGE("Number of points", fib->GetNumberOfPoints()==poly->GetNumberOfPoints());
+        for (unsigned int i=0; i<fib->GetNumFibers(); i++)
+        {
+            vtkCell* cell = poly->GetCell(i);
+            CPPUNIT_ASSERT_MESSAGE("Number of fiber points", static_cast<unsigned int>(cell->GetNumberOfPoints())==fib->GetNumberOfFiberPoints(i));
+            for (int j=0; j<cell->GetNumberOfPoints(); j++)
+            {
+                double* p = cell->GetPoints()->GetPoint(j);
+                const float* p2 = fib->GetFiberPoint(i, static_cast<unsigned int>(j));
+                CPPUNIT_ASSERT_MESSAGE("Fiber point", static_cast<float>(p[0])==p2[0] && static_cast<float>(p[1])==p2[1] && static_cast<float>(p[2])==p2[2]);
+            }
+        }
+
+        // the polydata is rebuilt from the store after the fibers have changed
+        fib->ResampleSpline(2);
+        CPPUNIT_ASSERT_MESSAGE("Polydata should be rebuilt", poly!=fib->GetFiberPolyData());
+        CPPUNIT_ASSERT_MESSAGE("Number of points after resampling", fib->GetNumberOfPoints()==fib->GetFiberPolyData()->GetNumberOfPoints());
+
+        // fibers with less than two points are removed, as for polydata input
+        std::vector< float > points = {0,0,0, 1,0,0, 2,0,0, 5,5,5, 0,1,0, 0,2,0};
+        std::vector< vtkIdType > offsets = {0, 3, 4, 4, 6};
+        mitk::FiberBundle::Pointer degenerate = mitk::FiberBundle::New();
+        degenerate->SetFiberStore(points, offsets);
+        CPPUNIT_ASSERT_MESSAGE("Degenerate fibers should be removed", degenerate->GetNumFibers()==2);
+        CPPUNIT_ASSERT_MESSAGE("Number of points without degenerate fibers", degenerate->GetNumberOfPoints()==5);
+        CPPUNIT_ASSERT_MESSAGE("Number of cells without degenerate fibers", degenerate->GetFiberPolyData()->GetNumberOfCells()==2);
+        CPPUNIT_ASSERT_MESSAGE("Second fiber", degenerate->GetNumberOfFiberPoints(1)==2 && degenerate->GetFiberPoint(1, 1)[1]==2);
+
+        // the result of the parallel operations must not depend on the number of threads
+        mitk::FiberBundle::Pointer fib1 = original->GetDeepCopy();
+        fib1->Compress(0.1f);
+        fib1->ResampleSpline(2);
+        fib1 = fib1->RemoveFibersOutside(mask);
+
+        omp_set_num_threads(4);
+        mitk::FiberBundle::Pointer fib4 = original->GetDeepCopy();
+        fib4->Compress(0.1f);
+        fib4->ResampleSpline(2);
+        fib4 = fib4->RemoveFibersOutside(mask);
+        omp_set_num_threads(1);
+
+        CPPUNIT_ASSERT_MESSAGE("Should be equal", fib1->Equals(fib4, 0.0));
+        for (unsigned int i=0; i<fib1->GetNumFibers(); i++)
+            CPPUNIT_ASSERT_MESSAGE("Fiber weights", fib1->GetFiberWeight(i) == fib4->GetFiberWeight(i));
+    }
+
+    void Test20()
+    {
+        MITK_INFO << "TEST 20: Spatial index and ROI extraction";
+
+        // every fiber with a point inside the mask has to be found in the index
+        mitk::FiberBundle::Pointer fib = original->GetDeepCopy();
+        const mitk::FiberSpatialIndex* index = fib->GetSpatialIndex();
+        std::vector< unsigned char > cells(index->GetNumberOfCells(), 0);
+        itk::ImageRegionConstIteratorWithIndex< ItkUcharImgType > it(mask, mask->GetLargestPossibleRegion());
+        for (; !it.IsAtEnd(); ++it)
+        {
+            if (it.Get()==0)
+                continue;
+            itk::Point<double, 3> p;
+            mask->TransformIndexToPhysicalPoint(it.GetIndex(), p);
+            double min[3], max[3];
+            for (int d=0; d<3; ++d)
+            {
+                min[d] = p[d] - mask->GetSpacing()[d];
+                max[d] = p[d] + mask->GetSpacing()[d];
+            }
+            index->MarkCells(min, max, cells);
+        }
+        std::vector< unsigned int > candidates = index->GetFibers(cells);
+        for (unsigned int i=0; i<fib->GetNumFibers(); i++)
+            for (unsigned int j=0; j<fib->GetNumberOfFiberPoints(i); j++)
+            {
+                const float* p = fib->GetFiberPoint(i, j);
+                itk::Point<float, 3> itkP; itkP[0] = p[0]; itkP[1] = p[1]; itkP[2] = p[2];
+                itk::Index<3> idx;
+                mask->TransformPhysicalPointToIndex(itkP, idx);
+                if (mask->GetLargestPossibleRegion().IsInside(idx) && mask->GetPixel(idx)>0)
+                {
+                    CPPUNIT_ASSERT_MESSAGE("Fiber missing in index", std::binary_search(candidates.begin(), candidates.end(), i));
+                    break;
+                }
+            }
+
+        // parallel extraction has to yield the same result as the serial one
+        itk::FiberExtractionFilter<unsigned char>::Pointer extractor = itk::FiberExtractionFilter<unsigned char>::New();
+        extractor->SetInputFiberBundle(original);
+        extractor->SetRoiImages({mask});
+        extractor->SetOverlapFraction(0.5);
+        extractor->SetThreshold(1);
+        extractor->Update();
+        mitk::FiberBundle::Pointer pos1 = extractor->GetPositives().at(0);
+        mitk::FiberBundle::Pointer neg1 = extractor->GetNegatives().at(0);
+
+        omp_set_num_threads(4);
+        extractor = itk::FiberExtractionFilter<unsigned char>::New();
+        extractor->SetInputFiberBundle(original);
+        extractor->SetRoiImages({mask});
+        extractor->SetOverlapFraction(0.5);
+        extractor->SetThreshold(1);
+        extractor->Update();
+        omp_set_num_threads(1);
+
+        CPPUNIT_ASSERT_MESSAGE("Fibers should be split", pos1->GetNumFibers()+neg1->GetNumFibers()==original->GetNumFibers());
+        CPPUNIT_ASSERT_MESSAGE("Positives should be equal", pos1->Equals(extractor->GetPositives().at(0), 0.0));
+        CPPUNIT_ASSERT_MESSAGE("Negatives should be equal", neg1->Equals(extractor->GetNegatives().at(0), 0.0));
+    }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberProcessing)
@@ -81,6 +81,17 @@ int mitkGibbsTrackingTest(int argc, char* argv[])
     gibbsTracker->Update();
     fib2 = mitk::FiberBundle::New(gibbsTracker->GetFiberBundle());
     MITK_TEST_CONDITION_REQUIRED(!fib1->Equals(fib2), "check if gibbs tracking has changed after wrong seed");
+
+    // tempered chains run in parallel, the result has to depend on the seed only
+    gibbsTracker->SetNumberOfChains(3);
+    gibbsTracker->SetSwapInterval(1000);
+    gibbsTracker->SetRandomSeed(1);
+    gibbsTracker->Update();
+    fib2 = mitk::FiberBundle::New(gibbsTracker->GetFiberBundle());
+    gibbsTracker->Update();
+    mitk::FiberBundle::Pointer fib3 = mitk::FiberBundle::New(gibbsTracker->GetFiberBundle());
+    MITK_TEST_CONDITION_REQUIRED(fib2->Equals(fib3), "check if tempered gibbs tracking is reproducible");
+    MITK_TEST_CONDITION(gibbsTracker->GetSwapAcceptance()>=0 && gibbsTracker->GetSwapAcceptance()<=1, "check swap acceptance rate");
   }
   catch(...)
   {
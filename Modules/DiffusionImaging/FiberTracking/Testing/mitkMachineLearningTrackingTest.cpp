@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageCast.h>
 #include <mitkImageToItk.h>
 #include <omp.h>
+#include <cstdlib>
 #include <mitkTractographyForest.h>
 
 #include "mitkTestFixture.h"
@@ -34,6 +35,8 @@ class mitkMachineLearningTrackingTestSuite : public mitk::TestFixture
 
     CPPUNIT_TEST_SUITE(mitkMachineLearningTrackingTestSuite);
     MITK_TEST(Track1);
+    MITK_TEST(Track1_LockStep);
+    MITK_TEST(PredictProbabilities_EqualsVigra);
     CPPUNIT_TEST_SUITE_END();
 
     typedef itk::Image<float, 3> ItkFloatImgType;
@@ -45,6 +48,36 @@ private:
     mitk::TrackingHandlerRandomForest<6, 100>* tfh;
     mitk::Image::Pointer dwi;
     ItkFloatImgType::Pointer seed;
+    mitk::TractographyForest::Pointer forest;
+
+    void Track(unsigned int lockStepBatchSize, std::string outFile)
+    {
+        omp_set_num_threads(1);
+        typedef itk::StreamlineTrackingFilter TrackerType;
+        TrackerType::Pointer tracker = TrackerType::New();
+        tracker->SetDemoMode(false);
+        tracker->SetInterpolateMasks(false);
+        tracker->SetSeedImage(seed);
+        tracker->SetSeedsPerVoxel(1);
+        tracker->SetStepSize(-1);
+        tracker->SetAngularThreshold(45);
+        tracker->SetMinTractLength(20);
+        tracker->SetMaxTractLength(400);
+        tracker->SetTrackingHandler(tfh);
+        tracker->SetAvoidStop(true);
+        tracker->SetSamplingDistance(0.5);
+        tracker->SetRandomSampling(false);
+        tracker->SetLockStepBatchSize(lockStepBatchSize);
+        tracker->Update();
+        vtkSmartPointer< vtkPolyData > poly = tracker->GetFiberPolyData();
+        mitk::FiberBundle::Pointer outFib = mitk::FiberBundle::New(poly);
+
+        //MITK_INFO << mitk::IOUtil::GetTempPath() << "ReferenceTracts.fib";
+        if (!ref->Equals(outFib))
+          mitk::IOUtil::Save(outFib, mitk::IOUtil::GetTempPath()+outFile);
+
+        CPPUNIT_ASSERT_MESSAGE("Should be equal", ref->Equals(outFib));
+    }
 
 public:
 
@@ -64,7 +97,7 @@ public:
         seed = ItkFloatImgType::New();
         mitk::CastToItkImage(img, seed);
 
-        mitk::TractographyForest::Pointer forest = mitk::IOUtil::Load<mitk::TractographyForest>(GetTestDataFilePath("DiffusionImaging/MachineLearningTracking/forest.rf"));
+        forest = mitk::IOUtil::Load<mitk::TractographyForest>(GetTestDataFilePath("DiffusionImaging/MachineLearningTracking/forest.rf"));
 
         tfh->SetForest(forest);
         tfh->AddDwi(dwi);
@@ -74,34 +107,36 @@ public:
     {
         delete tfh;
         ref = nullptr;
+        forest = nullptr;
     }
 
     void Track1()
     {
-        omp_set_num_threads(1);
-        typedef itk::StreamlineTrackingFilter TrackerType;
-        TrackerType::Pointer tracker = TrackerType::New();
-        tracker->SetDemoMode(false);
-        tracker->SetInterpolateMasks(false);
-        tracker->SetSeedImage(seed);
-        tracker->SetSeedsPerVoxel(1);
-        tracker->SetStepSize(-1);
-        tracker->SetAngularThreshold(45);
-        tracker->SetMinTractLength(20);
-        tracker->SetMaxTractLength(400);
-        tracker->SetTrackingHandler(tfh);
-        tracker->SetAvoidStop(true);
-        tracker->SetSamplingDistance(0.5);
-        tracker->SetRandomSampling(false);
-        tracker->Update();
-        vtkSmartPointer< vtkPolyData > poly = tracker->GetFiberPolyData();
-        mitk::FiberBundle::Pointer outFib = mitk::FiberBundle::New(poly);
+        Track(1, "ML_Track1.fib");
+    }
 
-        //MITK_INFO << mitk::IOUtil::GetTempPath() << "ReferenceTracts.fib";
-        if (!ref->Equals(outFib))
-          mitk::IOUtil::Save(outFib, mitk::IOUtil::GetTempPath()+"ML_Track1.fib");
+    void Track1_LockStep()
+    {
+        Track(32, "ML_Track1_LockStep.fib");
+    }
 
-        CPPUNIT_ASSERT_MESSAGE("Should be equal", ref->Equals(outFib));
+    void PredictProbabilities_EqualsVigra()
+    {
+        int numSamples = 1000;
+        vigra::MultiArray<2, float> features(vigra::Shape2(numSamples, forest->GetNumFeatures()));
+        std::srand(0);
+        for (int f=0; f<forest->GetNumFeatures(); f++)
+          for (int s=0; s<numSamples; s++)
+            features(s, f) = 2.0f * std::rand() / RAND_MAX - 1.0f;
+
+        vigra::MultiArray<2, float> probs(vigra::Shape2(numSamples, forest->GetNumClasses()));
+        vigra::MultiArray<2, float> vigraProbs(vigra::Shape2(numSamples, forest->GetNumClasses()));
+        forest->PredictProbabilities(features, probs);
+        forest->GetForest()->predictProbabilities(features, vigraProbs);
+
+        for (int c=0; c<forest->GetNumClasses(); c++)
+          for (int s=0; s<numSamples; s++)
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Flattened forest should predict the same probabilities as vigra", vigraProbs(s, c), probs(s, c), 1e-6);
     }
 
 };
@@ -5,6 +5,9 @@ set(CPP_FILES
   ## IO datastructures
   IODataStructures/FiberBundle/mitkFiberBundle.cpp
   IODataStructures/FiberBundle/mitkTrackvis.cpp
+  IODataStructures/FiberBundle/mitkTractogramFile.cpp
+  IODataStructures/FiberBundle/mitkTractogramFileWriter.cpp
+  IODataStructures/FiberBundle/mitkFiberSpatialIndex.cpp
   IODataStructures/PlanarFigureComposite/mitkPlanarFigureComposite.cpp
   IODataStructures/mitkTractographyForest.cpp
   IODataStructures/mitkFiberfoxParameters.cpp
@@ -30,6 +33,10 @@ set(H_FILES
   # DataStructures -> FiberBundle
   IODataStructures/FiberBundle/mitkFiberBundle.h
   IODataStructures/FiberBundle/mitkTrackvis.h
+  IODataStructures/FiberBundle/mitkTractogramFile.h
+  IODataStructures/FiberBundle/mitkTractogramFileWriter.h
+  IODataStructures/FiberBundle/mitkFiberSpatialIndex.h
+  IODataStructures/FiberBundle/mitkParallelProgressDisplay.h
   IODataStructures/mitkFiberfoxParameters.h
   IODataStructures/mitkTractographyForest.h
 
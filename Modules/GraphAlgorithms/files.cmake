@@ -6,5 +6,6 @@ set(H_FILES
   itkShortestPathCostFunctionTbss.h
   itkShortestPathNode.h
   itkShortestPathImageFilter.h
+  itkShortestPathTree.h
   itkShortestPathCostFunctionLiveWire.h
 )
@@ -72,6 +72,7 @@ namespace itk
     typedef typename TInputImageType::PixelType InputImagePixelType;
     typedef typename TInputImageType::SizeType InputImageSizeType;
     typedef typename TInputImageType::IndexType IndexType;
+    typedef typename TInputImageType::OffsetType OffsetType;
     typedef typename itk::ImageRegionIteratorWithIndex<InputImageType> InputImageIteratorType;
 
     typedef TOutputImageType OutputImageType;
@@ -159,6 +160,16 @@ namespace itk
     itkGetObjectMacro(CostFunction, CostFunctionType);
 
   protected:
+    // Entry of the open list. Nodes with equal keys are ordered by insertion.
+    struct HeapEntry
+    {
+      DistanceType key;
+      unsigned long long sequence;
+      NodeNumType node;
+    };
+
+    static const NodeNumType InvalidHeapPosition = static_cast<NodeNumType>(-1);
+
     std::vector<IndexType>
       m_endPoints; // if you fill this vector, the algo will not rest until all endPoints have been reached
     std::vector<IndexType> m_endPointsClosed;
@@ -194,6 +205,14 @@ namespace itk
 
     std::vector<NodeNumType> m_VectorOrder;
 
+    std::vector<HeapEntry> m_Heap;           // open list
+    std::vector<NodeNumType> m_HeapPosition; // position of each node in m_Heap, InvalidHeapPosition if not contained
+    unsigned long long m_HeapSequence;
+    std::vector<OffsetType> m_NeighborCoordOffsets;
+    std::vector<long long> m_NeighborNodeOffsets;
+    InputImageSizeType m_GraphSize;
+    double m_MinCost;
+
     ShortestPathImageFilter();
 
     ~ShortestPathImageFilter() override;
@@ -215,8 +234,17 @@ namespace itk
     // \brief Convert image coordinate to a indexnumber of a node in m_Nodes
     unsigned int CoordToNode(IndexType);
 
-    // \brief Returns the neighbors of a node
-    std::vector<ShortestPathNode *> GetNeighbors(NodeNumType nodeNum, bool FullNeighbors);
+    // \brief Precomputes the index and node offsets of the neighbors of a node
+    void InitNeighborOffsets(bool FullNeighbors);
+
+    // \brief Indexed binary heap used as open list of the search
+    bool HeapLess(const HeapEntry &a, const HeapEntry &b) const;
+    void HeapSiftUp(NodeNumType position);
+    void HeapSiftDown(NodeNumType position);
+    void HeapPush(NodeNumType node);
+    void HeapUpdate(NodeNumType node);
+    NodeNumType HeapPop();
+    void HeapClear();
 
     // \brief Check if coords are in bounds of image
     bool CoordIsInBounds(IndexType);
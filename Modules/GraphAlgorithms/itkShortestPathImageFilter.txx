@@ -26,18 +26,24 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 namespace itk
 {
+  template <class TInputImageType, class TOutputImageType>
+  const NodeNumType ShortestPathImageFilter<TInputImageType, TOutputImageType>::InvalidHeapPosition;
+
   // Constructor  (initialize standard values)
   template <class TInputImageType, class TOutputImageType>
   ShortestPathImageFilter<TInputImageType, TOutputImageType>::ShortestPathImageFilter()
     : m_Nodes(nullptr),
       m_Graph_NumberOfNodes(0),
+      m_Graph_fullNeighbors(false),
       m_FullNeighborsMode(false),
       m_MakeOutputImage(true),
       m_StoreVectorOrder(false),
       m_CalcAllDistances(false),
       multipleEndPoints(false),
       m_ActivateTimeOut(false),
-      m_Initialized(false)
+      m_Initialized(false),
+      m_HeapSequence(0),
+      m_MinCost(0)
   {
     m_endPoints.clear();
     m_endPointsClosed.clear();
@@ -142,235 +148,137 @@ namespace itk
   }
 
   template <class TInputImageType, class TOutputImageType>
-  inline std::vector<ShortestPathNode *> ShortestPathImageFilter<TInputImageType, TOutputImageType>::GetNeighbors(
-    unsigned int nodeNum, bool FullNeighbors)
+  void ShortestPathImageFilter<TInputImageType, TOutputImageType>::InitNeighborOffsets(bool FullNeighbors)
   {
-    // returns a vector of nodepointers.. these nodes are the neighbors
-    int dim = InputImageType::ImageDimension;
-    IndexType Coord = NodeToCoord(nodeNum);
-    IndexType NeighborCoord;
-    std::vector<ShortestPathNode *> nodeList;
-
-    int neighborDistance = 1; // if i increase that, i might not hit the endnote
-
-    // maybe use itkNeighborhoodIterator here, might be faster
-
-    if (dim == 2)
+    // The order of the neighbors determines which of several equally short paths is found,
+    // therefore it must not be changed.
+    static const int offsets2D[8][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}, {-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+    static const int offsets3D[26][3] = {
+      // N6
+      {0, -1, 0}, {1, 0, 0}, {0, 1, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1},
+      // middle slice
+      {-1, -1, 0}, {1, -1, 0}, {-1, 1, 0}, {1, 1, 0},
+      // back slice (diagonal)
+      {-1, -1, -1}, {1, -1, -1}, {-1, 1, -1}, {1, 1, -1},
+      // back slice (non-diagonal)
+      {0, -1, -1}, {1, 0, -1}, {0, 1, -1}, {-1, 0, -1},
+      // front slice (diagonal)
+      {-1, -1, 1}, {1, -1, 1}, {-1, 1, 1}, {1, 1, 1},
+      // front slice (non-diagonal)
+      {0, -1, 1}, {1, 0, 1}, {0, 1, 1}, {-1, 0, 1}};
+
+    m_NeighborCoordOffsets.clear();
+    m_NeighborNodeOffsets.clear();
+
+    const int dim = InputImageType::ImageDimension;
+    if (dim != 2 && dim != 3)
+      return;
+
+    const unsigned int numberOfNeighbors = (dim == 2) ? (FullNeighbors ? 8 : 4) : (FullNeighbors ? 26 : 6);
+    for (unsigned int n = 0; n < numberOfNeighbors; ++n)
     {
-      // N4
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1] - neighborDistance;
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0] + neighborDistance;
-      NeighborCoord[1] = Coord[1];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1] + neighborDistance;
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0] - neighborDistance;
-      NeighborCoord[1] = Coord[1];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      if (FullNeighbors)
+      OffsetType offset;
+      long long nodeOffset = 0;
+      long long stride = 1;
+      for (int d = 0; d < dim; ++d)
       {
-        // N8
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
+        offset[d] = (dim == 2) ? offsets2D[n][d] : offsets3D[n][d];
+        nodeOffset += offset[d] * stride;
+        stride *= m_GraphSize[d];
       }
+      m_NeighborCoordOffsets.push_back(offset);
+      m_NeighborNodeOffsets.push_back(nodeOffset);
     }
-    if (dim == 3)
+  }
+
+  template <class TInputImageType, class TOutputImageType>
+  inline bool ShortestPathImageFilter<TInputImageType, TOutputImageType>::HeapLess(const HeapEntry &a,
+                                                                                   const HeapEntry &b) const
+  {
+    // equal keys are ordered by insertion, like in a multimap
+    return (a.key < b.key) || (a.key == b.key && a.sequence < b.sequence);
+  }
+
+  template <class TInputImageType, class TOutputImageType>
+  inline void ShortestPathImageFilter<TInputImageType, TOutputImageType>::HeapSiftUp(NodeNumType position)
+  {
+    HeapEntry entry = m_Heap[position];
+    while (position > 0)
     {
-      // N6
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1] - neighborDistance;
-      NeighborCoord[2] = Coord[2];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0] + neighborDistance;
-      NeighborCoord[1] = Coord[1];
-      NeighborCoord[2] = Coord[2];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1] + neighborDistance;
-      NeighborCoord[2] = Coord[2];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0] - neighborDistance;
-      NeighborCoord[1] = Coord[1];
-      NeighborCoord[2] = Coord[2];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1];
-      NeighborCoord[2] = Coord[2] + neighborDistance;
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1];
-      NeighborCoord[2] = Coord[2] - neighborDistance;
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      if (FullNeighbors)
-      {
-        // N26
-        // Middle Slice
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2];
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2];
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2];
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2];
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        // BackSlice (Diagonal)
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        // BackSlice (Non-Diag)
-        NeighborCoord[0] = Coord[0];
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1];
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0];
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1];
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        // FrontSlice (Diagonal)
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        // FrontSlice(Non-Diag)
-        NeighborCoord[0] = Coord[0];
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1];
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0];
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1];
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-      }
+      NodeNumType parent = (position - 1) / 2;
+      if (!HeapLess(entry, m_Heap[parent]))
+        break;
+      m_Heap[position] = m_Heap[parent];
+      m_HeapPosition[m_Heap[position].node] = position;
+      position = parent;
     }
-    return nodeList;
+    m_Heap[position] = entry;
+    m_HeapPosition[entry.node] = position;
+  }
+
+  template <class TInputImageType, class TOutputImageType>
+  inline void ShortestPathImageFilter<TInputImageType, TOutputImageType>::HeapSiftDown(NodeNumType position)
+  {
+    const NodeNumType size = m_Heap.size();
+    HeapEntry entry = m_Heap[position];
+    while (true)
+    {
+      NodeNumType child = 2 * position + 1;
+      if (child >= size)
+        break;
+      if (child + 1 < size && HeapLess(m_Heap[child + 1], m_Heap[child]))
+        ++child;
+      if (!HeapLess(m_Heap[child], entry))
+        break;
+      m_Heap[position] = m_Heap[child];
+      m_HeapPosition[m_Heap[position].node] = position;
+      position = child;
+    }
+    m_Heap[position] = entry;
+    m_HeapPosition[entry.node] = position;
+  }
+
+  template <class TInputImageType, class TOutputImageType>
+  inline void ShortestPathImageFilter<TInputImageType, TOutputImageType>::HeapPush(NodeNumType node)
+  {
+    HeapEntry entry;
+    entry.key = m_Nodes[node].distAndEst;
+    entry.sequence = m_HeapSequence++;
+    entry.node = node;
+    m_Heap.push_back(entry);
+    HeapSiftUp(m_Heap.size() - 1);
+  }
+
+  template <class TInputImageType, class TOutputImageType>
+  inline void ShortestPathImageFilter<TInputImageType, TOutputImageType>::HeapUpdate(NodeNumType node)
+  {
+    // the node is treated as if it was removed and inserted again
+    NodeNumType position = m_HeapPosition[node];
+    m_Heap[position].key = m_Nodes[node].distAndEst;
+    m_Heap[position].sequence = m_HeapSequence++;
+    HeapSiftUp(position);
+    HeapSiftDown(m_HeapPosition[node]);
+  }
+
+  template <class TInputImageType, class TOutputImageType>
+  inline NodeNumType ShortestPathImageFilter<TInputImageType, TOutputImageType>::HeapPop()
+  {
+    NodeNumType node = m_Heap.front().node;
+    m_HeapPosition[node] = InvalidHeapPosition;
+    m_Heap.front() = m_Heap.back();
+    m_Heap.pop_back();
+    if (!m_Heap.empty())
+      HeapSiftDown(0);
+    return node;
+  }
+
+  template <class TInputImageType, class TOutputImageType>
+  void ShortestPathImageFilter<TInputImageType, TOutputImageType>::HeapClear()
+  {
+    for (auto &entry : m_Heap)
+      m_HeapPosition[entry.node] = InvalidHeapPosition;
+    m_Heap.clear();
+    m_HeapSequence = 0;
   }
 
   template <class TInputImageType, class TOutputImageType>
@@ -420,11 +328,11 @@ namespace itk
   {
     // Returns the minimal possible costs for a path from "a" to targetnode.
     itk::Vector<float, 3> v;
-    v[0] = m_EndIndex[0] - a[0];
-    v[1] = m_EndIndex[1] - a[1];
-    v[2] = m_EndIndex[2] - a[2];
+    v.Fill(0);
+    for (unsigned int i = 0; i < TInputImageType::ImageDimension && i < 3; ++i)
+      v[i] = m_EndIndex[i] - a[i];
 
-    return m_CostFunction->GetMinCost() * v.GetNorm();
+    return m_MinCost * v.GetNorm();
   }
 
   template <class TInputImageType, class TOutputImageType>
@@ -444,6 +352,9 @@ namespace itk
 
       // Initialize mainNodeList with that number
       m_Nodes = new ShortestPathNode[m_Graph_NumberOfNodes];
+      m_GraphSize = size;
+      m_HeapPosition.assign(m_Graph_NumberOfNodes, InvalidHeapPosition);
+      m_Heap.clear();
 
       // Initialize each node in nodelist
       for (NodeNumType i = 0; i < m_Graph_NumberOfNodes; i++)
@@ -480,43 +391,26 @@ namespace itk
     DistanceType curNodeDistance = 0;
     NodeNumType numberOfNodesChecked = 0;
 
-    // Create Multimap (tree structure for fast searching)
-    std::multimap<double, ShortestPathNode *> myMap;
-    std::pair<std::multimap<double, ShortestPathNode *>::iterator, std::multimap<double, ShortestPathNode *>::iterator>
-      ret;
-    std::multimap<double, ShortestPathNode *>::iterator it;
+    // The open list is an indexed binary heap, so a decreased distance is updated in place
+    HeapClear();
+    InitNeighborOffsets(m_Graph_fullNeighbors);
+    m_MinCost = m_CostFunction->GetMinCost();
+    const unsigned int numberOfNeighbors = m_NeighborNodeOffsets.size();
+    const int dim = InputImageType::ImageDimension;
 
     // At first, only startNote is discovered.
-    myMap.insert(
-      std::pair<double, ShortestPathNode *>(m_Nodes[m_Graph_StartNode].distAndEst, &m_Nodes[m_Graph_StartNode]));
+    HeapPush(m_Graph_StartNode);
 
     // While there are discovered Nodes, pick the one with lowest distance,
     // update its neighbors and eventually delete it from the discovered Nodes list.
-    while (!myMap.empty())
+    while (!m_Heap.empty())
     {
       numberOfNodesChecked++;
-      /*if ( (numberOfNodesChecked % (m_Graph_NumberOfNodes/100)) == 0)
-      {
-        MITK_INFO << "Checked " << ( numberOfNodesChecked / (m_Graph_NumberOfNodes/100) ) << "% List: " << myMap.size()
-      << "\n";
-      }*/
-
-      // Get element with lowest score
-      mainNodeListIndex = myMap.begin()->second->mainListIndex;
-      curNodeDistance = myMap.begin()->second->distance;
-      myMap.begin()->second->closed = true; // close it
-
-      // Debug:
-      // MITK_INFO << "INFO: size " << myMap.size();
-      /*
-      for (it = myMap.begin(); it != myMap.end(); ++it)
-      {
-      MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-      }
-      */
 
-      // Kicks out element with lowest score
-      myMap.erase(myMap.begin());
+      // Get element with lowest score and kick it out of the open list
+      mainNodeListIndex = HeapPop();
+      curNodeDistance = m_Nodes[mainNodeListIndex].distance;
+      m_Nodes[mainNodeListIndex].closed = true; // close it
 
       // if wanted, store vector order
       if (m_StoreVectorOrder)
@@ -525,138 +419,46 @@ namespace itk
       }
 
       // Check neighbors
-      std::vector<ShortestPathNode *> neighborNodes = GetNeighbors(mainNodeListIndex, m_Graph_fullNeighbors);
-      for (NodeNumType i = 0; i < neighborNodes.size(); i++)
+      const IndexType coordCurNode = NodeToCoord(mainNodeListIndex);
+      for (unsigned int n = 0; n < numberOfNeighbors; ++n)
       {
-        if (neighborNodes[i]->closed)
-          continue; // this nodes is already closed, go to next neighbor
+        const IndexType coordNeighborNode = coordCurNode + m_NeighborCoordOffsets[n];
+        bool inBounds = true;
+        for (int d = 0; d < dim; ++d)
+        {
+          if (coordNeighborNode[d] < 0 || static_cast<unsigned long>(coordNeighborNode[d]) >= m_GraphSize[d])
+          {
+            inBounds = false;
+            break;
+          }
+        }
+        if (!inBounds)
+          continue;
 
-        IndexType coordCurNode = NodeToCoord(mainNodeListIndex);
-        IndexType coordNeighborNode = NodeToCoord(neighborNodes[i]->mainListIndex);
+        const NodeNumType neighborIndex = static_cast<NodeNumType>(mainNodeListIndex + m_NeighborNodeOffsets[n]);
+        ShortestPathNode &neighborNode = m_Nodes[neighborIndex];
+        if (neighborNode.closed)
+          continue; // this nodes is already closed, go to next neighbor
 
         // calculate the new Distance to the current neighbor
         double newDistance = curNodeDistance + (m_CostFunction->GetCost(coordCurNode, coordNeighborNode));
 
         // if it is shorter than any yet known path to this neighbor, than the current path is better. Save that!
-        if ((newDistance < neighborNodes[i]->distance) || (neighborNodes[i]->distance == -1))
+        if ((newDistance < neighborNode.distance) || (neighborNode.distance == -1))
         {
-          // if that neighbornode is not in discoverednodeList yet, Push it there and update
-          if (neighborNodes[i]->distance == -1)
-          {
-            neighborNodes[i]->distance = newDistance;
-            neighborNodes[i]->distAndEst = newDistance + getEstimatedCostsToTarget(coordNeighborNode);
-            neighborNodes[i]->prevNode = mainNodeListIndex;
-            myMap.insert(std::pair<double, ShortestPathNode *>(m_Nodes[neighborNodes[i]->mainListIndex].distAndEst,
-                                                               &m_Nodes[neighborNodes[i]->mainListIndex]));
-            /*
-            MITK_INFO << "Inserted: " << m_Nodes[neighborNodes[i]->mainListIndex].distAndEst << "|" <<
-            m_Nodes[neighborNodes[i]->mainListIndex].mainListIndex;
-            MITK_INFO << "INFO: size " << myMap.size();
-            for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-            }
-            */
-          }
-          // or if is already in discoverednodelist, update
-          else
-          {
-            /*
-            it = myMap.find(neighborNodes[i]->distAndEst);
-            if (it == myMap.end() )
-            {
-            MITK_INFO << "Nothing!";
-            // look further
-            for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            if ((*it).second->mainListIndex == lookForId)
-            {
-            MITK_INFO << "But it is there!!!";
-            MITK_INFO << "Searched for: " << lookFor << "   but had: " << (*it).second->distAndEst;
-            }
-
-            }
-            }
-            */
+          const bool discovered = (neighborNode.distance != -1);
+          if (discovered && m_HeapPosition[neighborIndex] == InvalidHeapPosition)
+            continue; // not part of the discovered nodes of this search
 
-            // 1st : find and delete old element
-            bool found = false;
-            ret = myMap.equal_range(neighborNodes[i]->distAndEst);
+          neighborNode.distance = newDistance;
+          neighborNode.distAndEst = newDistance + getEstimatedCostsToTarget(coordNeighborNode);
+          neighborNode.prevNode = mainNodeListIndex;
 
-            if ((ret.first == ret.second))
-            {
-              /*+++++++++++++ no exact match +++++++++++++*/
-              // MITK_INFO << "No exact match!"; // if this happens, you are screwed
-              /*
-              MITK_INFO << "Was looking for: " << lookFor << "  ID: " << lookForId;
-              if (ret.first != myMap.end() )
-              {
-              it = ret.first;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              ++it;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              --it;
-              --it;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              }
-
-              // look if that ID is found in the map
-              for (it = myMap.begin(); it != myMap.end(); ++it)
-              {
-              if ((*it).second->mainListIndex == lookForId)
-              {
-              MITK_INFO << "But it is there!!!";
-              MITK_INFO << "Searched dist: " << lookFor << "  found dist: " << (*it).second->distAndEst;
-              }
-
-              }
-              */
-            }
-            else
-            {
-              for (it = ret.first; it != ret.second; ++it)
-              {
-                if (it->second->mainListIndex == neighborNodes[i]->mainListIndex)
-                {
-                  found = true;
-                  myMap.erase(it);
-                  /*
-                  MITK_INFO << "INFO: size " << myMap.size();
-                  MITK_INFO << "Erase: " << it->first << "|" << it->second->mainListIndex;
-
-                  MITK_INFO << "INFO: size " << myMap.size();
-                  for (it = myMap.begin(); it != myMap.end(); ++it)
-                  {
-                  MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-                  }
-                  */
-                  break;
-                }
-              }
-            }
-
-            if (!found)
-            {
-              // MITK_INFO << "Could not find it! :(";
-              continue;
-            }
-
-            // 2nd: update and insert new element
-            neighborNodes[i]->distance = newDistance;
-            neighborNodes[i]->distAndEst = newDistance + getEstimatedCostsToTarget(coordNeighborNode);
-            neighborNodes[i]->prevNode = mainNodeListIndex;
-            // myMap.insert( std::pair<double,ShortestPathNode*> (neighborNodes[i]->distAndEst, neighborNodes[i]));
-            myMap.insert(std::pair<double, ShortestPathNode *>(m_Nodes[neighborNodes[i]->mainListIndex].distAndEst,
-                                                               &m_Nodes[neighborNodes[i]->mainListIndex]));
-
-            // MITK_INFO << "Re-Inserted: " << m_Nodes[neighborNodes[i]->mainListIndex].distAndEst << "|" <<
-            // m_Nodes[neighborNodes[i]->mainListIndex].mainListIndex;
-            // MITK_INFO << "INFO: size " << myMap.size();
-            /*for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-            }*/
-          }
+          // if that neighbornode is not in discoverednodeList yet, Push it there, otherwise update its position
+          if (discovered)
+            HeapUpdate(neighborIndex);
+          else
+            HeapPush(neighborIndex);
         }
       }
       // finished with checking all neighbors.
@@ -864,6 +666,10 @@ namespace itk
 
     if (m_Nodes)
       delete[] m_Nodes;
+    m_Nodes = nullptr;
+
+    m_Heap.clear();
+    m_HeapPosition.clear();
   }
 
   template <class TInputImageType, class TOutputImageType>
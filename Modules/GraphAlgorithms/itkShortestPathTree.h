@@ -0,0 +1,130 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __itkShortestPathTree_h
+#define __itkShortestPathTree_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkShortestPathCostFunction.h"
+#include "itkShortestPathNode.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace itk
+{
+  /** \brief Computes the shortest paths from a single seed to all pixels of an image region.
+
+  The tree is computed by a background thread which expands it outward from the seed in the
+  order of increasing path costs (Dijkstra). While the tree grows, the shortest path from the
+  seed to every pixel that was already reached can be queried with GetPath(). A query only
+  backtracks the predecessors of the pixel, so its runtime is proportional to the path length.
+
+  The paths have the same costs as the ones computed by ShortestPathImageFilter. If several
+  paths are equally short, a different one may be chosen.
+
+  The cost function is used by the background thread. It must not be modified between Start()
+  and Stop().
+  */
+  template <class TInputImageType>
+  class ShortestPathTree : public Object
+  {
+  public:
+    typedef ShortestPathTree Self;
+    typedef Object Superclass;
+    typedef SmartPointer<Self> Pointer;
+    typedef SmartPointer<const Self> ConstPointer;
+
+    typedef ShortestPathCostFunction<TInputImageType> CostFunctionType;
+    typedef typename TInputImageType::IndexType IndexType;
+    typedef typename TInputImageType::OffsetType OffsetType;
+    typedef typename TInputImageType::RegionType RegionType;
+
+    itkFactorylessNewMacro(Self);
+    itkTypeMacro(ShortestPathTree, Object);
+
+    itkSetObjectMacro(CostFunction, CostFunctionType);
+    itkGetObjectMacro(CostFunction, CostFunctionType);
+
+    // \brief false = no diagonal neighbors, in 2D this means N4 Neigborhood. true = would be N8 in 2D
+    itkSetMacro(FullNeighborsMode, bool);
+    itkGetMacro(FullNeighborsMode, bool);
+
+    // \brief Stops a running computation and starts computing the tree of the given seed in the background
+    void Start(const RegionType &region, const IndexType &seed);
+
+    // \brief Stops the background computation. Paths to pixels which were already reached can still be queried.
+    void Stop();
+
+    // \brief Returns true if the background computation is running
+    bool IsRunning() const;
+
+    // \brief Returns true if the tree was computed for all pixels of the region
+    bool IsFinished() const;
+
+    IndexType GetSeed() const { return m_Seed; }
+
+    // \brief Returns the number of pixels whose shortest path is known
+    NodeNumType GetNumberOfReachedNodes() const { return m_NumberOfReachedNodes.load(); }
+
+    // \brief Returns true if the given pixel was already reached. In that case the shortest path
+    // from the seed to the pixel (both included) is returned in path.
+    bool GetPath(const IndexType &target, std::vector<IndexType> &path) const;
+
+  protected:
+    ShortestPathTree();
+    ~ShortestPathTree() override;
+
+    ShortestPathTree(const Self &); // intentionally not implemented
+    void operator=(const Self &);   // intentionally not implemented
+
+    // \brief Main loop of the background thread
+    void Run();
+
+    void InitNeighborOffsets();
+    bool IsInside(const IndexType &index) const;
+    NodeNumType IndexToNode(const IndexType &index) const;
+    IndexType NodeToIndex(NodeNumType node) const;
+
+    typename CostFunctionType::Pointer m_CostFunction;
+    bool m_FullNeighborsMode;
+
+    RegionType m_Region;
+    IndexType m_Seed;
+    NodeNumType m_NumberOfNodes;
+
+    std::vector<OffsetType> m_NeighborOffsets;
+    std::vector<long long> m_NeighborNodeOffsets;
+
+    // written by the background thread only; the predecessor and distance of a node are final
+    // once its reached flag was set
+    std::unique_ptr<std::atomic<unsigned char>[]> m_Reached;
+    std::vector<NodeNumType> m_Previous;
+    std::vector<DistanceType> m_Distance;
+    std::atomic<NodeNumType> m_NumberOfReachedNodes;
+
+    std::thread m_Thread;
+    std::atomic<bool> m_StopRequested;
+    std::atomic<bool> m_Running;
+    std::atomic<bool> m_Finished;
+  };
+} // end of namespace itk
+
+#include "itkShortestPathTree.txx"
+
+#endif
@@ -0,0 +1,244 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __itkShortestPathTree_txx
+#define __itkShortestPathTree_txx
+
+#include "itkShortestPathTree.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace itk
+{
+  template <class TInputImageType>
+  ShortestPathTree<TInputImageType>::ShortestPathTree()
+    : m_FullNeighborsMode(false),
+      m_NumberOfNodes(0),
+      m_NumberOfReachedNodes(0),
+      m_StopRequested(false),
+      m_Running(false),
+      m_Finished(false)
+  {
+    m_Seed.Fill(0);
+  }
+
+  template <class TInputImageType>
+  ShortestPathTree<TInputImageType>::~ShortestPathTree()
+  {
+    this->Stop();
+  }
+
+  template <class TInputImageType>
+  void ShortestPathTree<TInputImageType>::Start(const RegionType &region, const IndexType &seed)
+  {
+    this->Stop();
+
+    if (m_CostFunction.IsNull())
+    {
+      itkExceptionMacro(<< "No cost function set.");
+    }
+    if (!region.IsInside(seed))
+    {
+      itkExceptionMacro(<< "Seed " << seed << " is outside of the region.");
+    }
+
+    m_Region = region;
+    m_Seed = seed;
+    m_NumberOfNodes = static_cast<NodeNumType>(region.GetNumberOfPixels());
+    this->InitNeighborOffsets();
+
+    m_Reached.reset(new std::atomic<unsigned char>[m_NumberOfNodes]);
+    for (NodeNumType i = 0; i < m_NumberOfNodes; ++i)
+      m_Reached[i].store(0, std::memory_order_relaxed);
+    m_Previous.assign(m_NumberOfNodes, 0);
+    m_Distance.assign(m_NumberOfNodes, -1);
+    m_NumberOfReachedNodes = 0;
+
+    m_StopRequested = false;
+    m_Finished = false;
+    m_Running = true;
+    m_Thread = std::thread(&ShortestPathTree::Run, this);
+  }
+
+  template <class TInputImageType>
+  void ShortestPathTree<TInputImageType>::Stop()
+  {
+    m_StopRequested = true;
+    if (m_Thread.joinable())
+      m_Thread.join();
+    m_Running = false;
+  }
+
+  template <class TInputImageType>
+  bool ShortestPathTree<TInputImageType>::IsRunning() const
+  {
+    return m_Running;
+  }
+
+  template <class TInputImageType>
+  bool ShortestPathTree<TInputImageType>::IsFinished() const
+  {
+    return m_Finished;
+  }
+
+  template <class TInputImageType>
+  bool ShortestPathTree<TInputImageType>::GetPath(const IndexType &target, std::vector<IndexType> &path) const
+  {
+    path.clear();
+    if (!m_Reached || !m_Region.IsInside(target))
+      return false;
+
+    NodeNumType node = this->IndexToNode(target);
+    if (!m_Reached[node].load(std::memory_order_acquire))
+      return false;
+
+    // all predecessors of a reached node were reached before it
+    const NodeNumType seedNode = this->IndexToNode(m_Seed);
+    path.push_back(target);
+    while (node != seedNode)
+    {
+      node = m_Previous[node];
+      path.push_back(this->NodeToIndex(node));
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+  }
+
+  template <class TInputImageType>
+  void ShortestPathTree<TInputImageType>::InitNeighborOffsets()
+  {
+    // same neighbor order as in ShortestPathImageFilter
+    static const int offsets2D[8][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}, {-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+    static const int offsets3D[26][3] = {
+      {0, -1, 0},   {1, 0, 0},   {0, 1, 0},   {-1, 0, 0},  {0, 0, 1},    {0, 0, -1},  {-1, -1, 0},
+      {1, -1, 0},   {-1, 1, 0},  {1, 1, 0},   {-1, -1, -1}, {1, -1, -1}, {-1, 1, -1}, {1, 1, -1},
+      {0, -1, -1},  {1, 0, -1},  {0, 1, -1},  {-1, 0, -1}, {-1, -1, 1},  {1, -1, 1},  {-1, 1, 1},
+      {1, 1, 1},    {0, -1, 1},  {1, 0, 1},   {0, 1, 1},   {-1, 0, 1}};
+
+    m_NeighborOffsets.clear();
+    m_NeighborNodeOffsets.clear();
+
+    const int dim = TInputImageType::ImageDimension;
+    if (dim != 2 && dim != 3)
+      return;
+
+    const unsigned int numberOfNeighbors = (dim == 2) ? (m_FullNeighborsMode ? 8 : 4) : (m_FullNeighborsMode ? 26 : 6);
+    for (unsigned int n = 0; n < numberOfNeighbors; ++n)
+    {
+      OffsetType offset;
+      long long nodeOffset = 0;
+      long long stride = 1;
+      for (int d = 0; d < dim; ++d)
+      {
+        offset[d] = (dim == 2) ? offsets2D[n][d] : offsets3D[n][d];
+        nodeOffset += offset[d] * stride;
+        stride *= m_Region.GetSize(d);
+      }
+      m_NeighborOffsets.push_back(offset);
+      m_NeighborNodeOffsets.push_back(nodeOffset);
+    }
+  }
+
+  template <class TInputImageType>
+  inline bool ShortestPathTree<TInputImageType>::IsInside(const IndexType &index) const
+  {
+    return m_Region.IsInside(index);
+  }
+
+  template <class TInputImageType>
+  inline NodeNumType ShortestPathTree<TInputImageType>::IndexToNode(const IndexType &index) const
+  {
+    NodeNumType node = 0;
+    NodeNumType stride = 1;
+    for (unsigned int d = 0; d < TInputImageType::ImageDimension; ++d)
+    {
+      node += static_cast<NodeNumType>(index[d] - m_Region.GetIndex(d)) * stride;
+      stride *= static_cast<NodeNumType>(m_Region.GetSize(d));
+    }
+    return node;
+  }
+
+  template <class TInputImageType>
+  inline typename ShortestPathTree<TInputImageType>::IndexType ShortestPathTree<TInputImageType>::NodeToIndex(
+    NodeNumType node) const
+  {
+    IndexType index;
+    for (unsigned int d = 0; d < TInputImageType::ImageDimension; ++d)
+    {
+      const NodeNumType size = static_cast<NodeNumType>(m_Region.GetSize(d));
+      index[d] = m_Region.GetIndex(d) + static_cast<typename IndexType::IndexValueType>(node % size);
+      node /= size;
+    }
+    return index;
+  }
+
+  template <class TInputImageType>
+  void ShortestPathTree<TInputImageType>::Run()
+  {
+    // Dijkstra with lazy deletion: outdated queue entries are skipped when they are popped
+    typedef std::pair<DistanceType, NodeNumType> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+
+    const NodeNumType seedNode = this->IndexToNode(m_Seed);
+    m_Distance[seedNode] = 0;
+    m_Previous[seedNode] = seedNode;
+    queue.push(QueueEntry(0, seedNode));
+
+    const unsigned int numberOfNeighbors = m_NeighborOffsets.size();
+    while (!queue.empty())
+    {
+      if (m_StopRequested)
+        return;
+
+      const QueueEntry entry = queue.top();
+      queue.pop();
+      const NodeNumType node = entry.second;
+      if (m_Reached[node].load(std::memory_order_relaxed) || entry.first > m_Distance[node])
+        continue;
+
+      // the path to this node is final now, publish it
+      m_Reached[node].store(1, std::memory_order_release);
+      ++m_NumberOfReachedNodes;
+
+      const IndexType index = this->NodeToIndex(node);
+      for (unsigned int n = 0; n < numberOfNeighbors; ++n)
+      {
+        const IndexType neighbor = index + m_NeighborOffsets[n];
+        if (!this->IsInside(neighbor))
+          continue;
+
+        const NodeNumType neighborNode = static_cast<NodeNumType>(node + m_NeighborNodeOffsets[n]);
+        if (m_Reached[neighborNode].load(std::memory_order_relaxed))
+          continue;
+
+        const DistanceType newDistance = entry.first + m_CostFunction->GetCost(index, neighbor);
+        if (m_Distance[neighborNode] == -1 || newDistance < m_Distance[neighborNode])
+        {
+          m_Distance[neighborNode] = newDistance;
+          m_Previous[neighborNode] = node;
+          queue.push(QueueEntry(newDistance, neighborNode));
+        }
+      }
+    }
+
+    m_Finished = true;
+    m_Running = false;
+  }
+} // end of namespace itk
+
+#endif
@@ -24,7 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 mitk::NavigationDataPlayer::NavigationDataPlayer()
   : m_CurPlayerState(PlayerStopped),
-  m_StartPlayingTimeStamp(0.0), m_PauseTimeStamp(0.0)
+  m_StartPlayingTimeStamp(0.0), m_PauseTimeStamp(0.0), m_Interpolate(false)
 {
   // to get a start time
   mitk::IGTTimeStamp::GetInstance()->Start(this);
@@ -58,18 +58,14 @@ void mitk::NavigationDataPlayer::GenerateData()
   // imediatly with the first navigation data (not to wait till the first time
   // stamp is reached)
   TimeStampType timeStampSinceStartWithOffset = m_TimeStampSinceStart
-      + m_NavigationDataSet->Begin()->at(0)->GetIGTTimeStamp();
+      + m_NavigationDataSet->GetNavigationDataForIndex(0, 0)->GetIGTTimeStamp();
 
-  // iterate through all NavigationData objects of the given tool index
-  // till the timestamp of the NavigationData is greater then the given timestamp
-  for (; m_NavigationDataSetIterator != m_NavigationDataSet->End(); ++m_NavigationDataSetIterator)
+  // find the last NavigationData objects whose timestamp is not greater than
+  // the given timestamp (binary search), but never go back in time
+  int timeStepIndex = m_NavigationDataSet->GetIndexBeforeTimeStamp(timeStampSinceStartWithOffset, 0);
+  if (timeStepIndex > static_cast<int>(m_NavigationDataSetIterator.GetIndex()))
   {
-    // test if the timestamp of the successor is greater than the time stamp
-    if ( m_NavigationDataSetIterator+1 == m_NavigationDataSet->End() ||
-        (m_NavigationDataSetIterator+1)->at(0)->GetIGTTimeStamp() > timeStampSinceStartWithOffset )
-    {
-      break;
-    }
+    m_NavigationDataSetIterator = m_NavigationDataSet->Begin() + timeStepIndex;
   }
 
   for (unsigned int index = 0; index < GetNumberOfOutputs(); index++)
@@ -77,7 +73,14 @@ void mitk::NavigationDataPlayer::GenerateData()
     mitk::NavigationData* output = this->GetOutput(index);
     if( !output ) { mitkThrowException(mitk::IGTException) << "Output of index "<<index<<" is null."; }
 
-    output->Graft(m_NavigationDataSetIterator->at(index));
+    if (m_Interpolate)
+    {
+      m_NavigationDataSet->InterpolateNavigationData(timeStampSinceStartWithOffset, index, output);
+    }
+    else
+    {
+      m_NavigationDataSet->CopyNavigationDataForIndex(m_NavigationDataSetIterator.GetIndex(), index, output);
+    }
   }
 
   // stop playing if the last NavigationData objects were grafted
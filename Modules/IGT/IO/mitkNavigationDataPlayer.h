@@ -75,6 +75,15 @@ namespace mitk {
 
     TimeStampType GetTimeStampSinceStart();
 
+    /**
+    * \brief If set to true, the outputs are interpolated between the recorded time steps.
+    *
+    * Positions are interpolated linearly and orientations spherically. Otherwise the last
+    * recorded NavigationData before the current playing time is used. Default is false.
+    */
+    itkSetMacro(Interpolate, bool);
+    itkGetConstMacro(Interpolate, bool);
+
   protected:
     NavigationDataPlayer();
     ~NavigationDataPlayer() override;
@@ -97,6 +106,8 @@ namespace mitk {
     TimeStampType m_PauseTimeStamp;
 
     TimeStampType m_TimeStampSinceStart;
+
+    bool m_Interpolate;
   };
 } // namespace mitk
 
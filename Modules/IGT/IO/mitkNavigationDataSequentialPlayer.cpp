@@ -85,7 +85,8 @@ void mitk::NavigationDataSequentialPlayer::GenerateData()
       mitk::NavigationData* output = this->GetOutput(index);
       if( !output ) { mitkThrowException(mitk::IGTException) << "Output of index "<<index<<" is null."; }
 
-      output->Graft(m_NavigationDataSetIterator->at(index));
+      // copy directly from the set instead of creating the whole time step for every output
+      m_NavigationDataSet->CopyNavigationDataForIndex(m_NavigationDataSetIterator.GetIndex(), index, output);
     }
   }
 }
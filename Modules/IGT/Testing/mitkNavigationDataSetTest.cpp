@@ -63,22 +63,77 @@ static void TestSetAndGet()
   MITK_TEST_CONDITION_REQUIRED(!(navigationDataSet->AddNavigationDatas(step3)),
     "Adding an invalid third set, should be unsusuccessful.");
 
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(0, 0) == nd11,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(0, 0), *nd11),
     "First NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(0, 1) == nd21,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(0, 1), *nd21),
     "Second NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(1, 0) == nd12,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(1, 0), *nd12),
     "First NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(1, 1) == nd22,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(1, 1), *nd22),
     "Second NavigationData object for tool 0 should be the same as added previously.");
 
   std::vector<mitk::NavigationData::Pointer> result = navigationDataSet->GetTimeStep(1);
-  MITK_TEST_CONDITION_REQUIRED(nd12 == result[0],"Comparing returned datas from GetTimeStep().");
-  MITK_TEST_CONDITION_REQUIRED(nd22 == result[1],"Comparing returned datas from GetTimeStep().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd12, *result[0]),"Comparing returned datas from GetTimeStep().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd22, *result[1]),"Comparing returned datas from GetTimeStep().");
 
   result = navigationDataSet->GetDataStreamForTool(1);
-  MITK_TEST_CONDITION_REQUIRED(nd21 == result[0],"Comparing returned datas from GetStreamForTool().");
-  MITK_TEST_CONDITION_REQUIRED(nd22 == result[1],"Comparing returned datas from GetStreamForTool().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd21, *result[0]),"Comparing returned datas from GetStreamForTool().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd22, *result[1]),"Comparing returned datas from GetStreamForTool().");
+
+  // the set stores the data, not the added objects, so returned objects are independent copies
+  mitk::NavigationData::Pointer returned = navigationDataSet->GetNavigationDataForIndex(0, 0);
+  MITK_TEST_CONDITION_REQUIRED(returned != nd11, "Returned NavigationData should not be the added object.");
+  mitk::NavigationData::PositionType changedPosition;
+  changedPosition.Fill(1000);
+  returned->SetPosition(changedPosition);
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(0, 0), *nd11),
+    "Changing a returned NavigationData should not change the set.");
+  nd11->SetPosition(changedPosition);
+  MITK_TEST_CONDITION_REQUIRED(!mitk::Equal(navigationDataSet->GetNavigationDataForIndex(0, 0)->GetPosition(), changedPosition),
+    "Changing an added NavigationData should not change the set.");
+}
+
+static void TestSeekAndInterpolate()
+{
+  mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(1);
+
+  for (unsigned int i = 0; i < 10; ++i)
+  {
+    mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+    mitk::NavigationData::PositionType position;
+    position.Fill(i);
+    nd->SetPosition(position);
+    nd->SetIGTTimeStamp(10 * i);
+    nd->SetDataValid(true);
+    nd->SetName("Tool");
+    std::vector<mitk::NavigationData::Pointer> step;
+    step.push_back(nd);
+    navigationDataSet->AddNavigationDatas(step);
+  }
+
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIndexBeforeTimeStamp(-1) == -1,
+    "No index should be found before the first timestamp.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIndexBeforeTimeStamp(0) == 0,
+    "Timestamp of first time step should return first index.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIndexBeforeTimeStamp(35) == 3,
+    "Timestamp between two time steps should return the index of the first one.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIndexBeforeTimeStamp(1000) == 9,
+    "Timestamp after the last time step should return the last index.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataBeforeTimestamp(55, 0)->GetPosition()[0] == 5,
+    "Testing GetNavigationDataBeforeTimestamp().");
+
+  mitk::NavigationData::Pointer interpolated = mitk::NavigationData::New();
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->InterpolateNavigationData(25, 0, interpolated),
+    "Interpolation should be successful.");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(interpolated->GetPosition()[1], 2.5),
+    "Position should be interpolated linearly.");
+  MITK_TEST_CONDITION_REQUIRED(interpolated->IsDataValid() && interpolated->GetName() == "Tool",
+    "Other values should be taken from the time step before.");
+
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->End() - navigationDataSet->Begin() == 10,
+    "Iterators should span all time steps.");
+  MITK_TEST_CONDITION_REQUIRED((navigationDataSet->Begin() + 4)->at(0)->GetIGTTimeStamp() == 40,
+    "Iterator should return the time step it points to.");
 }
 
 /**
@@ -90,6 +145,7 @@ int mitkNavigationDataSetTest(int /* argc */, char* /*argv*/[])
 
   TestEmptySet();
   TestSetAndGet();
+  TestSeekAndInterpolate();
 
   MITK_TEST_END();
 }
\ No newline at end of file
@@ -85,9 +85,11 @@ void mitk::NavigationDataSetWriterXML::StreamData (std::ostream* stream, mitk::N
   // For each time step in the Dataset
   for (auto it = data->Begin(); it != data->End(); it++)
   {
-    for (std::size_t toolIndex = 0; toolIndex < it->size(); toolIndex++)
+    // dereferencing creates the data of all tools, so this is done once per time step
+    const std::vector<mitk::NavigationData::Pointer> step = *it;
+    for (std::size_t toolIndex = 0; toolIndex < step.size(); toolIndex++)
     {
-      mitk::NavigationData::Pointer nd = it->at(toolIndex);
+      mitk::NavigationData::Pointer nd = step[toolIndex];
       auto  elem = new TiXmlElement("ND");
 
       elem->SetDoubleAttribute("Time", nd->GetIGTTimeStamp());
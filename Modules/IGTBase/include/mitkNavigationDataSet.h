@@ -21,6 +21,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseData.h"
 #include "mitkNavigationData.h"
 
+#include <iterator>
+#include <string>
+#include <vector>
+
 namespace mitk {
   /**
   * \brief Data structure which stores streams of mitk::NavigationData for
@@ -29,18 +33,84 @@ namespace mitk {
   * Use mitk::NavigationDataRecorder to create these sets easily from pipelines.
   * Use mitk::NavigationDataPlayer to stream from these sets easily.
   *
+  * The data is not stored as mitk::NavigationData objects but in columns per tool
+  * (timestamps, positions, orientations, error matrices and flags). Error matrices
+  * and names are only stored once as long as they do not change. All methods which
+  * return mitk::NavigationData objects create new objects (views) from these columns,
+  * so changing them does not change the set.
+  *
+  * As timestamps are increasing for every tool, the time step of a given timestamp
+  * can be found by a binary search (see GetIndexBeforeTimeStamp()).
   */
   class MITKIGTBASE_EXPORT NavigationDataSet : public BaseData
   {
   public:
 
+    /**
+    * \brief Random access iterator over the distinct time steps in this set.
+    *
+    * Dereferencing returns an array of the length equal to GetNumberOfTools(), containing a
+    * newly created mitk::NavigationData for each tool. As every call of operator*() and operator->()
+    * creates the whole time step, dereference once per time step (e.g. const auto step = *it;)
+    * or use CopyNavigationDataForIndex() with GetIndex() to access single tools.
+    */
+    class MITKIGTBASE_EXPORT ConstIterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef std::vector<mitk::NavigationData::Pointer> value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef value_type reference;
+
+      /** \brief Holds the time step, so that it can be accessed by operator->(). */
+      class pointer
+      {
+      public:
+        explicit pointer(const value_type& value) : m_Value(value) {}
+        const value_type* operator->() const { return &m_Value; }
+      private:
+        value_type m_Value;
+      };
+
+      ConstIterator() : m_Set(nullptr), m_Index(0) {}
+      ConstIterator(const NavigationDataSet* set, difference_type index) : m_Set(set), m_Index(index) {}
+
+      reference operator*() const { return m_Set->GetTimeStep(static_cast<unsigned int>(m_Index)); }
+      pointer operator->() const { return pointer(**this); }
+      reference operator[](difference_type n) const { return *(*this + n); }
+
+      ConstIterator& operator++() { ++m_Index; return *this; }
+      ConstIterator operator++(int) { ConstIterator tmp(*this); ++m_Index; return tmp; }
+      ConstIterator& operator--() { --m_Index; return *this; }
+      ConstIterator operator--(int) { ConstIterator tmp(*this); --m_Index; return tmp; }
+      ConstIterator& operator+=(difference_type n) { m_Index += n; return *this; }
+      ConstIterator& operator-=(difference_type n) { m_Index -= n; return *this; }
+      ConstIterator operator+(difference_type n) const { return ConstIterator(m_Set, m_Index + n); }
+      ConstIterator operator-(difference_type n) const { return ConstIterator(m_Set, m_Index - n); }
+      difference_type operator-(const ConstIterator& other) const { return m_Index - other.m_Index; }
+
+      bool operator==(const ConstIterator& other) const { return m_Set == other.m_Set && m_Index == other.m_Index; }
+      bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+      bool operator<(const ConstIterator& other) const { return m_Index < other.m_Index; }
+      bool operator>(const ConstIterator& other) const { return m_Index > other.m_Index; }
+      bool operator<=(const ConstIterator& other) const { return m_Index <= other.m_Index; }
+      bool operator>=(const ConstIterator& other) const { return m_Index >= other.m_Index; }
+
+      /** \brief Returns the index of the time step this iterator points to. */
+      unsigned int GetIndex() const { return static_cast<unsigned int>(m_Index); }
+
+    private:
+      const NavigationDataSet* m_Set;
+      difference_type m_Index;
+    };
+
     /**
     * \brief This iterator iterates over the distinct time steps in this set.
     *
     * It returns an array of the length equal to GetNumberOfTools(), containing a
     * mitk::NavigationData for each tool..
     */
-    typedef std::vector< std::vector<mitk::NavigationData::Pointer> >::iterator NavigationDataSetIterator;
+    typedef ConstIterator NavigationDataSetIterator;
 
     /**
     * \brief This iterator iterates over the distinct time steps in this set. And is const.
@@ -48,7 +118,7 @@ namespace mitk {
     * It returns an array of the length equal to GetNumberOfTools(), containing a
     * mitk::NavigationData for each tool..
     */
-    typedef std::vector< std::vector<mitk::NavigationData::Pointer> >::const_iterator NavigationDataSetConstIterator;
+    typedef ConstIterator NavigationDataSetConstIterator;
 
     mitkClassMacro(NavigationDataSet, BaseData);
 
@@ -66,20 +136,52 @@ namespace mitk {
     /**
     * \brief Get mitk::NavigationData from the given tool at given index.
     *
+    * The returned object is newly created from the data of the set and not the object which was
+    * added by AddNavigationDatas(). Changing it does not change the set, and two calls with the same
+    * indices return different (but equal) objects.
+    *
     * @param toolIndex Index of the tool from which mitk::NavigationData should be returned.
     * @param index Index of the mitk::NavigationData object that should be returned.
     * @return mitk::NavigationData at the specified indices, 0 if there is no object at the indices.
     */
     NavigationData::Pointer GetNavigationDataForIndex( unsigned int index, unsigned int toolIndex ) const;
 
-    ///**
-    //* \brief Get last mitk::Navigation object for given tool whose timestamp is less than the given timestamp.
-    //* @param toolIndex Index of the tool from which mitk::NavigationData should be returned.
-    //* @param timestamp Timestamp for selecting last object before.
-    //* @return Last mitk::NavigationData with timestamp less than given timestamp, 0 if there is no adequate object.
-    //*/
-    // Method not yet supported!
-    //NavigationData::Pointer GetNavigationDataBeforeTimestamp( mitk::NavigationData::TimeStampType timestamp , unsigned int toolIndex ) const;
+    /**
+    * \brief Copies the data of the given tool at the given index to an existing mitk::NavigationData.
+    *
+    * This avoids the creation of a new object, e.g. for the outputs of a player.
+    *
+    * @return false if there is no data at the given indices.
+    */
+    bool CopyNavigationDataForIndex( unsigned int index, unsigned int toolIndex, NavigationData* output ) const;
+
+    /**
+    * \brief Get last mitk::Navigation object for given tool whose timestamp is less than or equal to the given timestamp.
+    * @param toolIndex Index of the tool from which mitk::NavigationData should be returned.
+    * @param timestamp Timestamp for selecting last object before.
+    * @return Last mitk::NavigationData with timestamp less than or equal to the given timestamp, 0 if there is no adequate object.
+    */
+    NavigationData::Pointer GetNavigationDataBeforeTimestamp( mitk::NavigationData::TimeStampType timestamp , unsigned int toolIndex ) const;
+
+    /**
+    * \brief Returns the index of the last time step whose timestamp for the given tool is less than or equal to the given timestamp.
+    *
+    * The index is found by a binary search, so this method has logarithmic complexity.
+    *
+    * @return The index of the time step or -1 if the first timestamp is greater than the given timestamp.
+    */
+    int GetIndexBeforeTimeStamp( mitk::NavigationData::TimeStampType timestamp, unsigned int toolIndex = 0 ) const;
+
+    /**
+    * \brief Interpolates the data of the given tool at the given timestamp.
+    *
+    * The position is interpolated linearly and the orientation spherically between the two time steps
+    * around the timestamp. All other values are taken from the time step before the timestamp. Timestamps
+    * outside of the recorded range are clamped to the first or last time step.
+    *
+    * @return false if the set is empty or the tool index is invalid.
+    */
+    bool InterpolateNavigationData( mitk::NavigationData::TimeStampType timestamp, unsigned int toolIndex, NavigationData* output ) const;
 
     /**
     * \brief Returns a vector that contains all tracking data for a given tool.
@@ -157,12 +259,39 @@ namespace mitk {
     ~NavigationDataSet( ) override;
 
     /**
-    * \brief Holds all the mitk::NavigationData objects managed by this class.
-    *
-    * The first dimension is the index of the navigation data, the second is the
-    * tool to which this data belongs. i.e. the first dimension is usually the longer one.
+    * \brief Holds the data of one tool in separate arrays with one entry per time step.
+    */
+    struct ToolData
+    {
+      std::vector<NavigationData::TimeStampType> m_TimeStamps;
+      std::vector<NavigationData::PositionType> m_Positions;
+      std::vector<NavigationData::OrientationType> m_Orientations;
+      std::vector<unsigned int> m_CovErrorMatrixIndices; ///< index into m_CovErrorMatrices of the set
+      std::vector<unsigned int> m_NameIndices;           ///< index into m_Names of the set
+      std::vector<unsigned char> m_Flags;                ///< combination of the Flag values
+    };
+
+    enum Flag
+    {
+      DataValidFlag = 1,
+      HasPositionFlag = 2,
+      HasOrientationFlag = 4
+    };
+
+    /**
+    * \brief Data of all tools, the index is the tool index.
+    */
+    std::vector<ToolData> m_ToolData;
+
+    /**
+    * \brief All distinct error matrices. Successive equal matrices of a tool are only stored once.
+    */
+    std::vector<NavigationData::CovarianceMatrixType> m_CovErrorMatrices;
+
+    /**
+    * \brief All distinct tool names. Successive equal names of a tool are only stored once.
     */
-    std::vector<std::vector<NavigationData::Pointer> > m_NavigationDataVectors;
+    std::vector<std::string> m_Names;
 
     /**
     * \brief The Number of Tools that this class is going to support.
@@ -18,8 +18,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkPointSet.h"
 #include "mitkBaseRenderer.h"
 
+#include <algorithm>
+#include <cmath>
+
 mitk::NavigationDataSet::NavigationDataSet( unsigned int numberOfTools )
-  : m_NavigationDataVectors(std::vector<std::vector<mitk::NavigationData::Pointer> >()), m_NumberOfTools(numberOfTools)
+  : m_ToolData(numberOfTools), m_NumberOfTools(numberOfTools)
 {
 }
 
@@ -37,67 +40,183 @@ bool mitk::NavigationDataSet::AddNavigationDatas( std::vector<mitk::NavigationDa
   }
 
   // test for consistent timestamp
-  if ( m_NavigationDataVectors.size() > 0)
+  if ( this->Size() > 0)
   {
     for (std::vector<mitk::NavigationData::Pointer>::size_type i = 0; i < navigationDatas.size(); i++)
-      if (navigationDatas[i]->GetIGTTimeStamp() <= m_NavigationDataVectors.back()[i]->GetIGTTimeStamp())
+      if (navigationDatas[i]->GetIGTTimeStamp() <= m_ToolData[i].m_TimeStamps.back())
       {
         MITK_WARN("NavigationDataSet") << "IGTTimeStamp of new NavigationData should be newer than timestamp of last NavigationData.";
         return false;
       }
   }
 
-  m_NavigationDataVectors.push_back(navigationDatas);
+  for (std::vector<mitk::NavigationData::Pointer>::size_type i = 0; i < navigationDatas.size(); i++)
+  {
+    const mitk::NavigationData* nd = navigationDatas[i];
+    ToolData& toolData = m_ToolData[i];
+
+    toolData.m_TimeStamps.push_back(nd->GetIGTTimeStamp());
+    toolData.m_Positions.push_back(nd->GetPosition());
+    toolData.m_Orientations.push_back(nd->GetOrientation());
+
+    unsigned char flags = 0;
+    if (nd->IsDataValid()) { flags |= DataValidFlag; }
+    if (nd->GetHasPosition()) { flags |= HasPositionFlag; }
+    if (nd->GetHasOrientation()) { flags |= HasOrientationFlag; }
+    toolData.m_Flags.push_back(flags);
+
+    // error matrix and name usually do not change, so the entry of the last time step is reused
+    if (toolData.m_CovErrorMatrixIndices.empty() || m_CovErrorMatrices[toolData.m_CovErrorMatrixIndices.back()] != nd->GetCovErrorMatrix())
+    {
+      m_CovErrorMatrices.push_back(nd->GetCovErrorMatrix());
+      toolData.m_CovErrorMatrixIndices.push_back(static_cast<unsigned int>(m_CovErrorMatrices.size() - 1));
+    }
+    else
+    {
+      toolData.m_CovErrorMatrixIndices.push_back(toolData.m_CovErrorMatrixIndices.back());
+    }
+
+    if (toolData.m_NameIndices.empty() || m_Names[toolData.m_NameIndices.back()] != nd->GetName())
+    {
+      m_Names.push_back(nd->GetName());
+      toolData.m_NameIndices.push_back(static_cast<unsigned int>(m_Names.size() - 1));
+    }
+    else
+    {
+      toolData.m_NameIndices.push_back(toolData.m_NameIndices.back());
+    }
+  }
   return true;
 }
 
 mitk::NavigationData::Pointer mitk::NavigationDataSet::GetNavigationDataForIndex( unsigned int index, unsigned int toolIndex ) const
 {
-  if ( index >= m_NavigationDataVectors.size() )
+  if ( index >= this->Size() )
   {
     MITK_WARN("NavigationDataSet") << "There is no NavigationData available at index " << index << ".";
     return nullptr;
   }
 
-  if ( toolIndex >= m_NavigationDataVectors.at(index).size() )
+  if ( toolIndex >= m_NumberOfTools )
   {
     MITK_WARN("NavigationDataSet") << "There is NavigatitionData available at index " << index << " for tool " << toolIndex << ".";
     return nullptr;
   }
 
-  return m_NavigationDataVectors.at(index).at(toolIndex);
-}
-
-// Method not yet supported, code below compiles but delivers wrong results
-//mitk::NavigationData::Pointer mitk::NavigationDataSet::GetNavigationDataBeforeTimestamp(
-//  mitk::NavigationData::TimeStampType timestamp, unsigned int toolIndex) const
-//{
-//  if ( toolIndex >= m_NavigationDataVectors.size() )
-//  {
-//    MITK_WARN("NavigationDataSet") << "There is no tool with index " << toolIndex << ".";
-//    return nullptr;
-//  }
-//
-//  std::vector<mitk::NavigationData::Pointer>::const_iterator it;
-//
-//  // iterate through all NavigationData objects of the given tool index
-//  // till the timestamp of the NavigationData is greater then the given timestamp
-//  for (it = m_NavigationDataVectors.at(toolIndex).begin();
-//    it != m_NavigationDataVectors.at(toolIndex).end(); ++it)
-//  {
-//    if ( (*it)->GetIGTTimeStamp() > timestamp) { break; }
-//  }
-//
-//  // first element was greater than timestamp -> return null
-//  if ( it == m_NavigationDataVectors.at(toolIndex).begin() )
-//  {
-//    MITK_WARN("NavigationDataSet") << "No NavigationData was recorded before given timestamp.";
-//    return nullptr;
-//  }
-//
-//  // return last element smaller than the given timestamp
-//  return *(it-1);
-//}
+  mitk::NavigationData::Pointer result = mitk::NavigationData::New();
+  this->CopyNavigationDataForIndex(index, toolIndex, result);
+  return result;
+}
+
+bool mitk::NavigationDataSet::CopyNavigationDataForIndex( unsigned int index, unsigned int toolIndex, NavigationData* output ) const
+{
+  if ( index >= this->Size() || toolIndex >= m_NumberOfTools || output == nullptr )
+  {
+    return false;
+  }
+
+  const ToolData& toolData = m_ToolData[toolIndex];
+  output->SetIGTTimeStamp(toolData.m_TimeStamps[index]);
+  output->SetPosition(toolData.m_Positions[index]);
+  output->SetOrientation(toolData.m_Orientations[index]);
+  output->SetCovErrorMatrix(m_CovErrorMatrices[toolData.m_CovErrorMatrixIndices[index]]);
+  output->SetName(m_Names[toolData.m_NameIndices[index]]);
+  output->SetDataValid((toolData.m_Flags[index] & DataValidFlag) != 0);
+  output->SetHasPosition((toolData.m_Flags[index] & HasPositionFlag) != 0);
+  output->SetHasOrientation((toolData.m_Flags[index] & HasOrientationFlag) != 0);
+  return true;
+}
+
+int mitk::NavigationDataSet::GetIndexBeforeTimeStamp( mitk::NavigationData::TimeStampType timestamp, unsigned int toolIndex ) const
+{
+  if ( toolIndex >= m_NumberOfTools )
+  {
+    MITK_WARN("NavigationDataSet") << "There is no tool with index " << toolIndex << ".";
+    return -1;
+  }
+
+  // timestamps are strictly increasing (see AddNavigationDatas()), so a binary search can be used
+  const std::vector<NavigationData::TimeStampType>& timeStamps = m_ToolData[toolIndex].m_TimeStamps;
+  auto it = std::upper_bound(timeStamps.begin(), timeStamps.end(), timestamp);
+  return static_cast<int>(it - timeStamps.begin()) - 1;
+}
+
+mitk::NavigationData::Pointer mitk::NavigationDataSet::GetNavigationDataBeforeTimestamp(
+  mitk::NavigationData::TimeStampType timestamp, unsigned int toolIndex) const
+{
+  int index = this->GetIndexBeforeTimeStamp(timestamp, toolIndex);
+
+  // first element was greater than timestamp -> return null
+  if ( index < 0 )
+  {
+    MITK_WARN("NavigationDataSet") << "No NavigationData was recorded before given timestamp.";
+    return nullptr;
+  }
+
+  return this->GetNavigationDataForIndex(static_cast<unsigned int>(index), toolIndex);
+}
+
+bool mitk::NavigationDataSet::InterpolateNavigationData( mitk::NavigationData::TimeStampType timestamp, unsigned int toolIndex, NavigationData* output ) const
+{
+  if ( this->Size() == 0 || toolIndex >= m_NumberOfTools || output == nullptr )
+  {
+    return false;
+  }
+
+  int index = this->GetIndexBeforeTimeStamp(timestamp, toolIndex);
+  if ( index < 0 )
+  {
+    return this->CopyNavigationDataForIndex(0, toolIndex, output);
+  }
+  if ( static_cast<unsigned int>(index) + 1 >= this->Size() )
+  {
+    return this->CopyNavigationDataForIndex(static_cast<unsigned int>(index), toolIndex, output);
+  }
+
+  this->CopyNavigationDataForIndex(static_cast<unsigned int>(index), toolIndex, output);
+
+  const ToolData& toolData = m_ToolData[toolIndex];
+  const NavigationData::TimeStampType t0 = toolData.m_TimeStamps[index];
+  const NavigationData::TimeStampType t1 = toolData.m_TimeStamps[index + 1];
+  const double alpha = (timestamp - t0) / (t1 - t0);
+
+  const NavigationData::PositionType& p0 = toolData.m_Positions[index];
+  const NavigationData::PositionType& p1 = toolData.m_Positions[index + 1];
+  NavigationData::PositionType position;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    position[i] = (1.0 - alpha) * p0[i] + alpha * p1[i];
+  }
+
+  // spherical linear interpolation of the orientation
+  const NavigationData::OrientationType& q0 = toolData.m_Orientations[index];
+  NavigationData::OrientationType q1 = toolData.m_Orientations[index + 1];
+  double cosTheta = q0.x() * q1.x() + q0.y() * q1.y() + q0.z() * q1.z() + q0.r() * q1.r();
+  if (cosTheta < 0.0)
+  {
+    q1 = NavigationData::OrientationType(-q1.x(), -q1.y(), -q1.z(), -q1.r());
+    cosTheta = -cosTheta;
+  }
+  double w0 = 1.0 - alpha;
+  double w1 = alpha;
+  if (cosTheta < 1.0 - mitk::eps)
+  {
+    const double theta = std::acos(cosTheta);
+    const double sinTheta = std::sin(theta);
+    w0 = std::sin((1.0 - alpha) * theta) / sinTheta;
+    w1 = std::sin(alpha * theta) / sinTheta;
+  }
+  NavigationData::OrientationType orientation(w0 * q0.x() + w1 * q1.x(),
+                                              w0 * q0.y() + w1 * q1.y(),
+                                              w0 * q0.z() + w1 * q1.z(),
+                                              w0 * q0.r() + w1 * q1.r());
+  orientation.normalize();
+
+  output->SetPosition(position);
+  output->SetOrientation(orientation);
+  output->SetIGTTimeStamp(timestamp);
+  return true;
+}
 
 std::vector< mitk::NavigationData::Pointer > mitk::NavigationDataSet::GetDataStreamForTool(unsigned int toolIndex)
 {
@@ -108,16 +227,23 @@ std::vector< mitk::NavigationData::Pointer > mitk::NavigationDataSet::GetDataStr
   }
 
   std::vector< mitk::NavigationData::Pointer > result;
+  result.reserve(this->Size());
 
-  for(std::vector<std::vector<NavigationData::Pointer> >::size_type i = 0; i < m_NavigationDataVectors.size(); i++)
-    result.push_back(m_NavigationDataVectors[i][toolIndex]);
+  for(unsigned int i = 0; i < this->Size(); i++)
+    result.push_back(this->GetNavigationDataForIndex(i, toolIndex));
 
   return result;
 }
 
 std::vector< mitk::NavigationData::Pointer > mitk::NavigationDataSet::GetTimeStep(unsigned int index) const
 {
-  return m_NavigationDataVectors[index];
+  std::vector< mitk::NavigationData::Pointer > result;
+  result.reserve(m_NumberOfTools);
+
+  for(unsigned int toolIndex = 0; toolIndex < m_NumberOfTools; toolIndex++)
+    result.push_back(this->GetNavigationDataForIndex(index, toolIndex));
+
+  return result;
 }
 
 unsigned int mitk::NavigationDataSet::GetNumberOfTools() const
@@ -127,7 +253,7 @@ unsigned int mitk::NavigationDataSet::GetNumberOfTools() const
 
 unsigned int mitk::NavigationDataSet::Size() const
 {
-  return m_NavigationDataVectors.size();
+  return m_ToolData.empty() ? 0 : static_cast<unsigned int>(m_ToolData[0].m_TimeStamps.size());
 }
 
 // ---> methods necessary for BaseData
@@ -161,10 +287,10 @@ void mitk::NavigationDataSet::ConvertNavigationDataToPointSet() const
   {
     mitk::PointSet::Pointer _tempPointSet = mitk::PointSet::New();
     //iterate over all time steps
-    for (unsigned int time = 0; time < m_NavigationDataVectors.size(); time++)
+    for (unsigned int time = 0; time < this->Size(); time++)
     {
-      _tempPointSet->InsertPoint(time,m_NavigationDataVectors[time][toolIndex]->GetPosition());
-      MITK_DEBUG << m_NavigationDataVectors[time][toolIndex]->GetPosition() << " --- " << _tempPointSet->GetPoint(time);
+      _tempPointSet->InsertPoint(time,m_ToolData[toolIndex].m_Positions[time]);
+      MITK_DEBUG << m_ToolData[toolIndex].m_Positions[time] << " --- " << _tempPointSet->GetPoint(time);
     }
     mitk::DataNode::Pointer dn = mitk::DataNode::New();
     std::stringstream str;
@@ -181,10 +307,10 @@ void mitk::NavigationDataSet::ConvertNavigationDataToPointSet() const
 
 mitk::NavigationDataSet::NavigationDataSetConstIterator mitk::NavigationDataSet::Begin() const
 {
-  return m_NavigationDataVectors.cbegin();
+  return NavigationDataSetConstIterator(this, 0);
 }
 
 mitk::NavigationDataSet::NavigationDataSetConstIterator mitk::NavigationDataSet::End() const
 {
-  return m_NavigationDataVectors.cend();
+  return NavigationDataSetConstIterator(this, this->Size());
 }
@@ -0,0 +1,305 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+//TEST
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+//STD
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+//ITK
+#include <itkCommand.h>
+
+//MITK
+#include "mitkIGTLMessageQueue.h"
+#include "mitkIGTLServer.h"
+#include "mitkIGTLClient.h"
+
+//IGTL
+#include "igtlImageMessage.h"
+#include "igtlTimeStamp.h"
+#include "igtlTransformMessage.h"
+
+static const std::string HOSTNAME = "localhost";
+
+class mitkOpenIGTLinkMessageQueueTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkOpenIGTLinkMessageQueueTestSuite);
+  MITK_TEST(TestInfinitBuffering_KeepsOrder);
+  MITK_TEST(TestNoBuffering_ReturnsLatestMessage);
+  MITK_TEST(TestSwitchingBufferingMode_DropsOutdatedMessages);
+  MITK_TEST(TestConcurrentPushAndPull_KeepsOrder);
+  MITK_TEST(TestLoopbackServerClient_Benchmark);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::SimpleMemberCommand<mitkOpenIGTLinkMessageQueueTestSuite> DeviceCommand;
+
+  mitk::IGTLMessageQueue::Pointer m_Queue;
+
+  // counts the events of the observed devices of the loopback benchmark
+  std::mutex m_EventMutex;
+  std::condition_variable m_EventCondition;
+  unsigned int m_NumberOfEvents;
+
+  void OnDeviceEvent()
+  {
+    std::lock_guard<std::mutex> lock(m_EventMutex);
+    ++m_NumberOfEvents;
+    m_EventCondition.notify_all();
+  }
+
+  unsigned int GetNumberOfEvents()
+  {
+    std::lock_guard<std::mutex> lock(m_EventMutex);
+    return m_NumberOfEvents;
+  }
+
+  /**
+  * Blocks until an observed device invoked another event than the given number of
+  * events or until the deadline is reached. Returns the current number of events.
+  */
+  unsigned int WaitForEvent(unsigned int numberOfEvents, std::chrono::steady_clock::time_point deadline)
+  {
+    std::unique_lock<std::mutex> lock(m_EventMutex);
+    m_EventCondition.wait_until(lock, deadline, [&]() { return m_NumberOfEvents != numberOfEvents; });
+    return m_NumberOfEvents;
+  }
+
+  igtl::TransformMessage::Pointer CreateTransformMessage(unsigned int number)
+  {
+    igtl::TransformMessage::Pointer msg = igtl::TransformMessage::New();
+    msg->SetDeviceName(std::to_string(number).c_str());
+    return msg;
+  }
+
+  unsigned int GetNumber(igtl::MessageBase* msg)
+  {
+    return static_cast<unsigned int>(std::stoul(msg->GetDeviceName()));
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_Queue = mitk::IGTLMessageQueue::New();
+    m_NumberOfEvents = 0;
+  }
+
+  void tearDown() override
+  {
+    m_Queue = nullptr;
+  }
+
+  void TestInfinitBuffering_KeepsOrder()
+  {
+    m_Queue->EnableNoBufferingMode(false);
+    for (unsigned int i = 0; i < 10; ++i)
+      m_Queue->PushMessage(CreateTransformMessage(i).GetPointer());
+
+    CPPUNIT_ASSERT_EQUAL(10, m_Queue->GetSize());
+    for (unsigned int i = 0; i < 10; ++i)
+    {
+      igtl::TransformMessage::Pointer msg = m_Queue->PullTransformMessage();
+      CPPUNIT_ASSERT_MESSAGE("Queue ran empty too early.", msg.IsNotNull());
+      CPPUNIT_ASSERT_EQUAL(i, GetNumber(msg));
+    }
+    CPPUNIT_ASSERT_MESSAGE("Queue should be empty.", m_Queue->PullTransformMessage().IsNull());
+    CPPUNIT_ASSERT_EQUAL(0, m_Queue->GetSize());
+  }
+
+  void TestNoBuffering_ReturnsLatestMessage()
+  {
+    m_Queue->EnableNoBufferingMode(true);
+    for (unsigned int i = 0; i < 5; ++i)
+      m_Queue->PushMessage(CreateTransformMessage(i).GetPointer());
+
+    CPPUNIT_ASSERT_EQUAL(1, m_Queue->GetSize());
+    igtl::TransformMessage::Pointer msg = m_Queue->PullTransformMessage();
+    CPPUNIT_ASSERT(msg.IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(4u, GetNumber(msg));
+    CPPUNIT_ASSERT_MESSAGE("Only the latest message should be stored.", m_Queue->PullTransformMessage().IsNull());
+    CPPUNIT_ASSERT_MESSAGE("Other message types must not be affected.", m_Queue->PullTrackingMessage().IsNull());
+  }
+
+  void TestSwitchingBufferingMode_DropsOutdatedMessages()
+  {
+    m_Queue->EnableNoBufferingMode(false);
+    m_Queue->PushMessage(CreateTransformMessage(0).GetPointer());
+    m_Queue->PushMessage(CreateTransformMessage(1).GetPointer());
+    m_Queue->EnableNoBufferingMode(true);
+    m_Queue->PushMessage(CreateTransformMessage(2).GetPointer());
+    m_Queue->EnableNoBufferingMode(false);
+    m_Queue->PushMessage(CreateTransformMessage(3).GetPointer());
+    m_Queue->PushMessage(CreateTransformMessage(4).GetPointer());
+
+    CPPUNIT_ASSERT_EQUAL(2u, GetNumber(m_Queue->PullTransformMessage()));
+    CPPUNIT_ASSERT_EQUAL(3u, GetNumber(m_Queue->PullTransformMessage()));
+    CPPUNIT_ASSERT_EQUAL(4u, GetNumber(m_Queue->PullTransformMessage()));
+    CPPUNIT_ASSERT(m_Queue->PullTransformMessage().IsNull());
+  }
+
+  void TestConcurrentPushAndPull_KeepsOrder()
+  {
+    const unsigned int numberOfMessages = 20000;
+    m_Queue->EnableNoBufferingMode(false);
+
+    std::thread producer([this, numberOfMessages]()
+    {
+      for (unsigned int i = 0; i < numberOfMessages; ++i)
+        m_Queue->PushMessage(CreateTransformMessage(i).GetPointer());
+    });
+
+    unsigned int expected = 0;
+    bool ordered = true;
+    auto start = std::chrono::steady_clock::now();
+    while (expected < numberOfMessages && std::chrono::steady_clock::now() - start < std::chrono::seconds(30))
+    {
+      igtl::TransformMessage::Pointer msg = m_Queue->PullTransformMessage();
+      if (msg.IsNull())
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      ordered = ordered && GetNumber(msg) == expected;
+      ++expected;
+    }
+    producer.join();
+
+    CPPUNIT_ASSERT_MESSAGE("Messages were pulled in the wrong order.", ordered);
+    CPPUNIT_ASSERT_EQUAL(numberOfMessages, expected);
+    CPPUNIT_ASSERT(m_Queue->PullTransformMessage().IsNull());
+  }
+
+  /**
+  * Streams 3D images together with transforms from a server to a client over the
+  * loopback device and reports throughput and latency. Only the arrival of the
+  * messages is tested, the numbers depend on the machine.
+  */
+  void TestLoopbackServerClient_Benchmark()
+  {
+    mitk::IGTLServer::Pointer server = mitk::IGTLServer::New(true);
+    mitk::IGTLClient::Pointer client = mitk::IGTLClient::New(true);
+    DeviceCommand::Pointer command = DeviceCommand::New();
+    command->SetCallbackFunction(this, &mitkOpenIGTLinkMessageQueueTestSuite::OnDeviceEvent);
+    server->AddObserver(mitk::NewClientConnectionEvent(), command);
+    client->AddObserver(mitk::MessageReceivedEvent(), command);
+
+    // port 0 lets the operating system choose a free port
+    server->SetHostname(HOSTNAME);
+    server->SetPortNumber(0);
+    server->SetName("Benchmark Server");
+    server->EnableNoBufferingMode(false);
+    CPPUNIT_ASSERT_MESSAGE("Could not open Connection with Server", server->OpenConnection());
+    CPPUNIT_ASSERT_MESSAGE("The server should report the port it is listening on.", server->GetPortNumber() > 0);
+
+    client->SetHostname(HOSTNAME);
+    client->SetPortNumber(server->GetPortNumber());
+    client->SetName("Benchmark Client");
+    client->EnableNoBufferingMode(false);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    unsigned int numberOfEvents = GetNumberOfEvents();
+    server->StartCommunication();
+    CPPUNIT_ASSERT_MESSAGE("Could not connect to Server", client->OpenConnection());
+    CPPUNIT_ASSERT_MESSAGE("Could not start communication with client", client->StartCommunication());
+
+    // the server only sends to clients it has registered
+    while (server->GetNumberOfConnections() == 0 && std::chrono::steady_clock::now() < deadline)
+      numberOfEvents = WaitForEvent(numberOfEvents, deadline);
+    CPPUNIT_ASSERT_MESSAGE("The server did not register the client.", server->GetNumberOfConnections() > 0);
+
+    const unsigned int numberOfImages = 50;
+    const unsigned int transformsPerImage = 7;
+    igtl::TimeStamp::Pointer sendTime = igtl::TimeStamp::New();
+    igtl::TimeStamp::Pointer receiveTime = igtl::TimeStamp::New();
+
+    unsigned int receivedImages = 0;
+    unsigned int receivedTransforms = 0;
+    double latencySum = 0.0;
+    auto pullAll = [&]()
+    {
+      igtl::TimeStamp::Pointer messageTime = igtl::TimeStamp::New();
+      while (igtl::ImageMessage::Pointer image = client->GetNextImage3dMessage())
+      {
+        receiveTime->GetTime();
+        image->GetTimeStamp(messageTime);
+        latencySum += receiveTime->GetTimeStamp() - messageTime->GetTimeStamp();
+        ++receivedImages;
+      }
+      while (igtl::TransformMessage::Pointer transform = client->GetNextTransformMessage())
+      {
+        receiveTime->GetTime();
+        transform->GetTimeStamp(messageTime);
+        latencySum += receiveTime->GetTimeStamp() - messageTime->GetTimeStamp();
+        ++receivedTransforms;
+      }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < numberOfImages; ++i)
+    {
+      igtl::ImageMessage::Pointer image = igtl::ImageMessage::New();
+      image->SetDimensions(128, 128, 32);
+      image->SetScalarTypeToUint8();
+      image->SetDeviceName("Image");
+      image->AllocateScalars();
+      sendTime->GetTime();
+      image->SetTimeStamp(sendTime);
+      server->SendMessage(mitk::IGTLMessage::New(image.GetPointer()));
+
+      for (unsigned int t = 0; t < transformsPerImage; ++t)
+      {
+        igtl::TransformMessage::Pointer transform = CreateTransformMessage(t);
+        sendTime->GetTime();
+        transform->SetTimeStamp(sendTime);
+        server->SendMessage(mitk::IGTLMessage::New(transform.GetPointer()));
+        pullAll();
+      }
+    }
+
+    // each received message is followed by an event, so no message arrives unnoticed between pulling and waiting
+    const unsigned int numberOfMessages = numberOfImages * (transformsPerImage + 1);
+    numberOfEvents = GetNumberOfEvents();
+    pullAll();
+    while (receivedImages + receivedTransforms < numberOfMessages && std::chrono::steady_clock::now() < deadline)
+    {
+      numberOfEvents = WaitForEvent(numberOfEvents, deadline);
+      pullAll();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    unsigned int received = receivedImages + receivedTransforms;
+
+    MITK_INFO << "Loopback benchmark: received " << receivedImages << " images and " << receivedTransforms
+              << " transforms in " << seconds << " s (" << received / seconds << " messages/s), mean latency "
+              << (received > 0 ? 1000.0 * latencySum / received : 0.0) << " ms";
+
+    CPPUNIT_ASSERT(client->StopCommunication());
+    CPPUNIT_ASSERT(server->StopCommunication());
+    CPPUNIT_ASSERT(client->CloseConnection());
+    CPPUNIT_ASSERT(server->CloseConnection());
+
+    CPPUNIT_ASSERT_MESSAGE("No image was received.", receivedImages > 0);
+    CPPUNIT_ASSERT_MESSAGE("No transform was received.", receivedTransforms > 0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkOpenIGTLinkMessageQueue)
@@ -41,6 +41,7 @@ m_StopCommunication(false),
 m_Hostname("127.0.0.1"),
 m_PortNumber(-1),
 m_LogMessages(false),
+m_MessagePoolSize(8),
 m_MultiThreader(nullptr), m_SendThreadID(0), m_ReceiveThreadID(0), m_ConnectThreadID(0)
 {
   m_ReadFully = ReadFully;
@@ -123,9 +124,13 @@ bool mitk::IGTLDevice::TestConnection()
 
 unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
 {
-  // Create a message buffer to receive header
-  igtl::MessageHeader::Pointer headerMsg;
-  headerMsg = igtl::MessageHeader::New();
+  // Create a message buffer to receive header, the buffer of the previous call
+  // is reused if it was not passed to the command queue
+  if (m_HeaderMessage.IsNull() || m_HeaderMessage->GetReferenceCount() > 1)
+  {
+    m_HeaderMessage = igtl::MessageHeader::New();
+  }
+  igtl::MessageHeader::Pointer headerMsg = m_HeaderMessage;
 
   // Initialize receive buffer
   headerMsg->InitPack();
@@ -190,9 +195,9 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
         return IGTL_STATUS_OK;
       }
 
-      //Create a message according to the header message
+      //Create a message according to the header message or reuse a released one
       igtl::MessageBase::Pointer curMessage;
-      curMessage = m_MessageFactory->CreateInstance(headerMsg);
+      curMessage = this->GetPooledMessage(headerMsg);
 
       //check if the curMessage is created properly, if not the message type is
       //not supported and the message has to be skipped
@@ -263,6 +268,31 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
   }
 }
 
+igtl::MessageBase::Pointer mitk::IGTLDevice::GetPooledMessage(igtl::MessageHeader* header)
+{
+  if (m_MessagePoolSize == 0)
+  {
+    return m_MessageFactory->CreateInstance(header);
+  }
+
+  std::vector<igtl::MessageBase::Pointer>& pool = m_MessagePool[header->GetDeviceType()];
+  for (auto& message : pool)
+  {
+    // the pool holds the only reference, neither the queue nor a consumer uses this message
+    if (message->GetReferenceCount() == 1)
+    {
+      return message;
+    }
+  }
+
+  igtl::MessageBase::Pointer message = m_MessageFactory->CreateInstance(header);
+  if (message.IsNotNull() && pool.size() < m_MessagePoolSize)
+  {
+    pool.push_back(message);
+  }
+  return message;
+}
+
 void mitk::IGTLDevice::SendMessage(mitk::IGTLMessage::Pointer msg)
 {
   m_MessageQueue->PushSendMessage(msg);
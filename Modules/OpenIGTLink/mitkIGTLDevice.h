@@ -35,6 +35,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIGTLMessageQueue.h"
 #include "mitkIGTLMessage.h"
 
+//std
+#include <map>
+#include <vector>
+
 namespace mitk {
   /**
   * \brief Interface for all OpenIGTLink Devices
@@ -252,6 +256,15 @@ namespace mitk {
     itkGetMacro(LogMessages, bool);
     itkSetMacro(LogMessages, bool);
 
+    /**
+    * \brief Sets the number of received messages per message type that are kept
+    * for reuse. A message is only reused once it is not referenced anymore by the
+    * queue or any consumer, thus its pack buffer does not have to be allocated
+    * again for messages of the same size. A size of zero disables the reuse.
+    */
+    itkSetMacro(MessagePoolSize, unsigned int);
+    itkGetConstMacro(MessagePoolSize, unsigned int);
+
   protected:
     /**
      * \brief Sends a message.
@@ -293,6 +306,13 @@ namespace mitk {
     */
     unsigned int ReceivePrivate(igtl::Socket* device);
 
+    /**
+    * \brief Returns a message for the given header, either an unused message of
+    * the pool or a new one created by the message factory. Only called by the
+    * receiving thread.
+    */
+    igtl::MessageBase::Pointer GetPooledMessage(igtl::MessageHeader* header);
+
     /**
     * \brief Call this method to send a message. The message will be read from
     * the queue.
@@ -356,6 +376,12 @@ namespace mitk {
 
     bool m_LogMessages;
 
+    /** Received messages per device type which are reused once they are released */
+    std::map<std::string, std::vector<igtl::MessageBase::Pointer> > m_MessagePool;
+    /** The header message which is reused for receiving */
+    igtl::MessageHeader::Pointer m_HeaderMessage;
+    unsigned int m_MessagePoolSize;
+
   private:
 
     /** creates worker thread that continuously polls interface for new
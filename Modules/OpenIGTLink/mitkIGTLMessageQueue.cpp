@@ -30,88 +30,46 @@ void mitk::IGTLMessageQueue::PushSendMessage(mitk::IGTLMessage::Pointer message)
 
 void mitk::IGTLMessageQueue::PushCommandMessage(igtl::MessageBase::Pointer message)
 {
-  this->m_Mutex->Lock();
-  if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-    m_CommandQueue.clear();
-
-  m_CommandQueue.push_back(message);
-  this->m_Mutex->Unlock();
+  m_CommandQueue.Push(message.GetPointer(), this->m_BufferingType == IGTLMessageQueue::NoBuffering);
 }
 
 void mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
 {
-  this->m_Mutex->Lock();
+  const bool latestOnly = this->m_BufferingType == IGTLMessageQueue::NoBuffering;
 
-  std::stringstream infolog;
-
-  infolog << "Received message of type ";
-
-  if (dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()) != nullptr)
+  if (auto trackingDataMsg = dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()))
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_TrackingDataQueue.clear();
-
-    this->m_TrackingDataQueue.push_back(dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()));
-
-    infolog << "TDATA";
+    this->m_TrackingDataQueue.Push(trackingDataMsg, latestOnly);
   }
-  else if (dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()) != nullptr)
+  else if (auto transformMsg = dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()))
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_TransformQueue.clear();
-
-    this->m_TransformQueue.push_back(dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()));
-
-    infolog << "TRANSFORM";
+    this->m_TransformQueue.Push(transformMsg, latestOnly);
   }
-  else if (dynamic_cast<igtl::StringMessage*>(msg.GetPointer()) != nullptr)
+  else if (auto stringMsg = dynamic_cast<igtl::StringMessage*>(msg.GetPointer()))
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_StringQueue.clear();
-
-    this->m_StringQueue.push_back(dynamic_cast<igtl::StringMessage*>(msg.GetPointer()));
-
-    infolog << "STRING";
+    this->m_StringQueue.Push(stringMsg, latestOnly);
   }
-  else if (dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()) != nullptr)
+  else if (auto imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()))
   {
-    igtl::ImageMessage::Pointer imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer());
-    int* dim = new int[3];
+    int dim[3];
     imageMsg->GetDimensions(dim);
     if (dim[2] > 1)
     {
-      if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-        m_Image3dQueue.clear();
-
-      this->m_Image3dQueue.push_back(dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()));
-
-      infolog << "IMAGE3D";
+      this->m_Image3dQueue.Push(imageMsg, latestOnly);
     }
     else
     {
-      if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-        m_Image2dQueue.clear();
-
-      this->m_Image2dQueue.push_back(dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()));
-
-      infolog << "IMAGE2D";
+      this->m_Image2dQueue.Push(imageMsg, latestOnly);
     }
   }
   else
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_MiscQueue.clear();
-
-    this->m_MiscQueue.push_back(msg);
-
-    infolog << "OTHER";
+    this->m_MiscQueue.Push(msg.GetPointer(), latestOnly);
   }
 
+  this->m_LatestMessageMutex->Lock();
   m_Latest_Message = msg;
-
-  //MITK_INFO << infolog.str();
-
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
 }
 
 mitk::IGTLMessage::Pointer mitk::IGTLMessageQueue::PullSendMessage()
@@ -129,98 +87,42 @@ mitk::IGTLMessage::Pointer mitk::IGTLMessageQueue::PullSendMessage()
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullMiscMessage()
 {
-  igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_MiscQueue.size() > 0)
-  {
-    ret = this->m_MiscQueue.front();
-    this->m_MiscQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->m_MiscQueue.Pull();
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage2dMessage()
 {
-  igtl::ImageMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_Image2dQueue.size() > 0)
-  {
-    ret = this->m_Image2dQueue.front();
-    this->m_Image2dQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->m_Image2dQueue.Pull();
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage3dMessage()
 {
-  igtl::ImageMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_Image3dQueue.size() > 0)
-  {
-    ret = this->m_Image3dQueue.front();
-    this->m_Image3dQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->m_Image3dQueue.Pull();
 }
 
 igtl::TrackingDataMessage::Pointer mitk::IGTLMessageQueue::PullTrackingMessage()
 {
-  igtl::TrackingDataMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_TrackingDataQueue.size() > 0)
-  {
-    ret = this->m_TrackingDataQueue.front();
-    this->m_TrackingDataQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->m_TrackingDataQueue.Pull();
 }
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullCommandMessage()
 {
-  igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_CommandQueue.size() > 0)
-  {
-    ret = this->m_CommandQueue.front();
-    this->m_CommandQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->m_CommandQueue.Pull();
 }
 
 igtl::StringMessage::Pointer mitk::IGTLMessageQueue::PullStringMessage()
 {
-  igtl::StringMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_StringQueue.size() > 0)
-  {
-    ret = this->m_StringQueue.front();
-    this->m_StringQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->m_StringQueue.Pull();
 }
 
 igtl::TransformMessage::Pointer mitk::IGTLMessageQueue::PullTransformMessage()
 {
-  igtl::TransformMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_TransformQueue.size() > 0)
-  {
-    ret = this->m_TransformQueue.front();
-    this->m_TransformQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->m_TransformQueue.Pull();
 }
 
 std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
 {
-  this->m_Mutex->Lock();
+  this->m_LatestMessageMutex->Lock();
   std::stringstream s;
   if (this->m_Latest_Message != nullptr)
   {
@@ -231,13 +133,13 @@ std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
   {
     s << "No Msg";
   }
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetNextMsgDeviceType()
 {
-  this->m_Mutex->Lock();
+  this->m_LatestMessageMutex->Lock();
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -247,13 +149,13 @@ std::string mitk::IGTLMessageQueue::GetNextMsgDeviceType()
   {
     s << "";
   }
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetLatestMsgInformationString()
 {
-  this->m_Mutex->Lock();
+  this->m_LatestMessageMutex->Lock();
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -264,13 +166,13 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgInformationString()
   {
     s << "No Msg";
   }
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
 {
-  this->m_Mutex->Lock();
+  this->m_LatestMessageMutex->Lock();
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -280,33 +182,31 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
   {
     s << "";
   }
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
   return s.str();
 }
 
 int mitk::IGTLMessageQueue::GetSize()
 {
-  return (this->m_CommandQueue.size() + this->m_Image2dQueue.size() + this->m_Image3dQueue.size() + this->m_MiscQueue.size()
-    + this->m_StringQueue.size() + this->m_TrackingDataQueue.size() + this->m_TransformQueue.size());
+  return (this->m_CommandQueue.GetSize() + this->m_Image2dQueue.GetSize() + this->m_Image3dQueue.GetSize() + this->m_MiscQueue.GetSize()
+    + this->m_StringQueue.GetSize() + this->m_TrackingDataQueue.GetSize() + this->m_TransformQueue.GetSize());
 }
 
 void mitk::IGTLMessageQueue::EnableNoBufferingMode(bool enable)
 {
-  this->m_Mutex->Lock();
   if (enable)
     this->m_BufferingType = IGTLMessageQueue::BufferingType::NoBuffering;
   else
     this->m_BufferingType = IGTLMessageQueue::BufferingType::Infinit;
-  this->m_Mutex->Unlock();
 }
 
 mitk::IGTLMessageQueue::IGTLMessageQueue()
 {
   this->m_Mutex = itk::FastMutexLock::New();
+  this->m_LatestMessageMutex = itk::FastMutexLock::New();
   this->m_BufferingType = IGTLMessageQueue::NoBuffering;
 }
 
 mitk::IGTLMessageQueue::~IGTLMessageQueue()
 {
-  this->m_Mutex->Unlock();
 }
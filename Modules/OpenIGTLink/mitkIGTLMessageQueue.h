@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkFastMutexLock.h"
 #include "mitkCommon.h"
 
+#include <atomic>
 #include <deque>
 #include <mitkIGTLMessage.h>
 
@@ -38,6 +39,14 @@ namespace mitk {
   * \class IGTLMessageQueue
   * \brief Thread safe message queue to store OpenIGTLink messages.
   *
+  * Received messages are stored in one lock-free single-producer/single-consumer
+  * channel per message type. The receive thread of the device is the only producer,
+  * each Pull method may be called by one consumer thread at a time. Different message
+  * types can be pulled from different threads without blocking each other or the
+  * receive thread. In the NoBuffering mode a channel only keeps the latest message,
+  * older messages are dropped. Messages that have to be sent are stored in a mutex
+  * guarded queue, because they may be pushed by several threads.
+  *
   * \ingroup OpenIGTLink
   */
   class MITKOPENIGTLINK_EXPORT IGTLMessageQueue : public itk::Object
@@ -78,7 +87,8 @@ namespace mitk {
     mitk::IGTLMessage::Pointer PullSendMessage();
 
     /**
-    * \brief Get the number of messages in the queue
+    * \brief Get the number of received messages in the queue. The value is only
+    * approximate while messages are pushed or pulled concurrently.
     */
     int GetSize();
 
@@ -112,22 +122,174 @@ namespace mitk {
     IGTLMessageQueue();
     ~IGTLMessageQueue() override;
 
-  protected:
     /**
-    * \brief Mutex to take car of the queue
+    * \brief Lock-free single-producer/single-consumer channel for one message type.
+    *
+    * The messages are stored in a linked list of nodes. Nodes which were consumed are
+    * recycled by the producer, thus no memory is allocated once the channel has
+    * reached its maximum fill level. In addition the channel has a slot for the
+    * latest message which is used in the NoBuffering mode: pushing into the slot
+    * replaces the previous message and marks all older queued messages as dropped.
+    */
+    template <class TMessage>
+    class MessageChannel
+    {
+    public:
+      typedef typename TMessage::Pointer MessagePointer;
+
+      MessageChannel() : m_NextSequence(0), m_DropBefore(0), m_Latest(nullptr), m_Size(0)
+      {
+        Node* node = new Node();
+        m_Tail = node;
+        m_Head = node;
+        m_First = node;
+        m_TailCopy = node;
+      }
+
+      ~MessageChannel()
+      {
+        TMessage* latest = m_Latest.exchange(nullptr);
+        if (latest != nullptr)
+          latest->UnRegister();
+
+        Node* node = m_First;
+        while (node != nullptr)
+        {
+          Node* next = node->next.load(std::memory_order_relaxed);
+          delete node;
+          node = next;
+        }
+      }
+
+      /** \brief Adds a message. May only be called by the producer thread. */
+      void Push(TMessage* message, bool latestOnly)
+      {
+        unsigned long long sequence = m_NextSequence++;
+        if (latestOnly)
+        {
+          // everything pushed before is older than the new message
+          m_DropBefore.store(sequence, std::memory_order_release);
+          message->Register();
+          TMessage* previous = m_Latest.exchange(message, std::memory_order_acq_rel);
+          if (previous != nullptr)
+            previous->UnRegister();
+          return;
+        }
+
+        Node* node = this->AllocateNode();
+        node->message = message;
+        node->sequence = sequence;
+        node->next.store(nullptr, std::memory_order_relaxed);
+        m_Size.fetch_add(1, std::memory_order_relaxed);
+        m_Head->next.store(node, std::memory_order_release);
+        m_Head = node;
+      }
+
+      /** \brief Returns and removes the oldest message. May only be called by the consumer thread. */
+      MessagePointer Pull()
+      {
+        TMessage* latest = m_Latest.exchange(nullptr, std::memory_order_acq_rel);
+        this->DropOutdated(m_DropBefore.load(std::memory_order_acquire));
+        if (latest != nullptr)
+        {
+          MessagePointer result = latest;
+          latest->UnRegister();
+          return result;
+        }
+
+        Node* next = m_Tail.load(std::memory_order_relaxed)->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+          return nullptr;
+        return this->PopFront(next);
+      }
+
+      unsigned int GetSize() const
+      {
+        return m_Size.load(std::memory_order_relaxed) + (m_Latest.load(std::memory_order_relaxed) != nullptr ? 1 : 0);
+      }
+
+    private:
+      struct Node
+      {
+        Node() : next(nullptr), sequence(0) {}
+        std::atomic<Node*> next;
+        MessagePointer message;
+        unsigned long long sequence;
+      };
+
+      MessagePointer PopFront(Node* next)
+      {
+        // the first node is the dummy node, the message is moved out of its successor
+        // which becomes the new dummy node
+        MessagePointer result = next->message;
+        next->message = nullptr;
+        m_Size.fetch_sub(1, std::memory_order_relaxed);
+        m_Tail.store(next, std::memory_order_release);
+        return result;
+      }
+
+      void DropOutdated(unsigned long long dropBefore)
+      {
+        Node* next = m_Tail.load(std::memory_order_relaxed)->next.load(std::memory_order_acquire);
+        while (next != nullptr && next->sequence < dropBefore)
+        {
+          this->PopFront(next);
+          next = next->next.load(std::memory_order_acquire);
+        }
+      }
+
+      /** \brief Reuses a consumed node if possible. Only called by the producer thread. */
+      Node* AllocateNode()
+      {
+        if (m_First != m_TailCopy)
+        {
+          Node* node = m_First;
+          m_First = m_First->next.load(std::memory_order_relaxed);
+          return node;
+        }
+        m_TailCopy = m_Tail.load(std::memory_order_acquire);
+        if (m_First != m_TailCopy)
+        {
+          Node* node = m_First;
+          m_First = m_First->next.load(std::memory_order_relaxed);
+          return node;
+        }
+        return new Node();
+      }
+
+      // consumer side
+      std::atomic<Node*> m_Tail;
+      // producer side
+      Node* m_Head;
+      Node* m_First;
+      Node* m_TailCopy;
+      unsigned long long m_NextSequence;
+
+      std::atomic<unsigned long long> m_DropBefore;
+      std::atomic<TMessage*> m_Latest;
+      std::atomic<unsigned int> m_Size;
+    };
+
+    /**
+    * \brief Mutex to take care of the send queue
     */
     itk::FastMutexLock::Pointer m_Mutex;
 
     /**
-    * \brief the queue that stores pointer to the inserted messages
+    * \brief Mutex to take care of the latest received message
+    */
+    itk::FastMutexLock::Pointer m_LatestMessageMutex;
+
+    /**
+    * \brief the channels that store pointer to the received messages
     */
-    std::deque< igtl::MessageBase::Pointer > m_CommandQueue;
-    std::deque< igtl::ImageMessage::Pointer > m_Image2dQueue;
-    std::deque< igtl::ImageMessage::Pointer > m_Image3dQueue;
-    std::deque< igtl::TransformMessage::Pointer > m_TransformQueue;
-    std::deque< igtl::TrackingDataMessage::Pointer > m_TrackingDataQueue;
-    std::deque< igtl::StringMessage::Pointer > m_StringQueue;
-    std::deque< igtl::MessageBase::Pointer > m_MiscQueue;
+    MessageChannel< igtl::MessageBase > m_CommandQueue;
+    MessageChannel< igtl::ImageMessage > m_Image2dQueue;
+    MessageChannel< igtl::ImageMessage > m_Image3dQueue;
+    MessageChannel< igtl::TransformMessage > m_TransformQueue;
+    MessageChannel< igtl::TrackingDataMessage > m_TrackingDataQueue;
+    MessageChannel< igtl::StringMessage > m_StringQueue;
+    MessageChannel< igtl::MessageBase > m_MiscQueue;
 
     std::deque< mitk::IGTLMessage::Pointer > m_SendQueue;
 
@@ -136,7 +298,7 @@ namespace mitk {
     /**
     * \brief defines the kind of buffering
     */
-    BufferingType m_BufferingType;
+    std::atomic<BufferingType> m_BufferingType;
   };
 }
 
@@ -59,8 +59,8 @@ bool mitk::IGTLServer::OpenConnection()
   m_Socket = igtl::ServerSocket::New();
 
   //try to create the igtl server
-  int response = dynamic_cast<igtl::ServerSocket*>(m_Socket.GetPointer())->
-    CreateServer(portNumber);
+  igtl::ServerSocket* serverSocket = dynamic_cast<igtl::ServerSocket*>(m_Socket.GetPointer());
+  int response = serverSocket->CreateServer(portNumber);
 
   //check the response
   if (response != 0)
@@ -70,6 +70,12 @@ bool mitk::IGTLServer::OpenConnection()
     return false;
   }
 
+  //port 0 lets the operating system choose a free port
+  if (portNumber == 0)
+  {
+    this->SetPortNumber(serverSocket->GetServerPort());
+  }
+
   // everything is initialized and connected so the communication can be started
   this->SetState(Ready);
 
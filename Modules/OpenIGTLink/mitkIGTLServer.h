@@ -49,7 +49,8 @@ namespace mitk
     *
     *
     * OpenConnection() starts the IGTLServer socket so that clients can connect
-    * to it.
+    * to it. If the port number is 0, the operating system chooses a free port
+    * and GetPortNumber() returns it afterwards.
     * @throw mitk::Exception Throws an exception if the given port is occupied.
     */
     bool OpenConnection() override;
@@ -33,10 +33,17 @@ mitk::ImageLiveWireContourModelFilter::ImageLiveWireContourModelFilter()
   m_ShortestPathFilter->SetCostFunction(m_CostFunction);
   m_UseDynamicCostMap = false;
   m_TimeStep = 0;
+  m_UseShortestPathTree = false;
+  m_ShortestPathTree = ShortestPathTreeType::New();
+  m_ShortestPathTree->SetCostFunction(m_CostFunction);
+  m_ShortestPathTree->SetFullNeighborsMode(true);
+  m_ShortestPathTreeValid = false;
+  m_ShortestPathTreeUsesCostMap = false;
 }
 
 mitk::ImageLiveWireContourModelFilter::~ImageLiveWireContourModelFilter()
 {
+  this->StopShortestPathTree();
 }
 
 mitk::ImageLiveWireContourModelFilter::OutputType *mitk::ImageLiveWireContourModelFilter::GetOutput()
@@ -124,6 +131,8 @@ void mitk::ImageLiveWireContourModelFilter::ItkPreProcessImage(const itk::Image<
   typedef itk::Image<TPixel, VImageDimension> InputImageType;
   typedef itk::CastImageFilter<InputImageType, InternalImageType> CastFilterType;
 
+  this->StopShortestPathTree();
+
   typename CastFilterType::Pointer castFilter = CastFilterType::New();
   castFilter->SetInput(inputImage);
   castFilter->Update();
@@ -134,11 +143,13 @@ void mitk::ImageLiveWireContourModelFilter::ItkPreProcessImage(const itk::Image<
 
 void mitk::ImageLiveWireContourModelFilter::ClearRepulsivePoints()
 {
+  this->StopShortestPathTree();
   m_CostFunction->ClearRepulsivePoints();
 }
 
 void mitk::ImageLiveWireContourModelFilter::AddRepulsivePoint(const itk::Index<2> &idx)
 {
+  this->StopShortestPathTree();
   m_CostFunction->AddRepulsivePoint(idx);
 }
 
@@ -152,11 +163,13 @@ void mitk::ImageLiveWireContourModelFilter::DumpMaskImage()
 
 void mitk::ImageLiveWireContourModelFilter::RemoveRepulsivePoint(const itk::Index<2> &idx)
 {
+  this->StopShortestPathTree();
   m_CostFunction->RemoveRepulsivePoint(idx);
 }
 
 void mitk::ImageLiveWireContourModelFilter::SetRepulsivePoints(const ShortestPathType &points)
 {
+  this->StopShortestPathTree();
   m_CostFunction->ClearRepulsivePoints();
 
   auto iter = points.begin();
@@ -198,22 +211,30 @@ void mitk::ImageLiveWireContourModelFilter::UpdateLiveWire()
   m_CostFunction->SetStartIndex(startPoint);
   m_CostFunction->SetEndIndex(endPoint);
   m_CostFunction->SetRequestedRegion(region);
-  m_CostFunction->SetUseCostMap(m_UseDynamicCostMap);
 
-  // calculate shortest path between start and end point
-  m_ShortestPathFilter->SetFullNeighborsMode(true);
-  // m_ShortestPathFilter->SetInput( m_CostFunction->SetImage(m_InternalImage) );
-  m_ShortestPathFilter->SetMakeOutputImage(false);
+  ShortestPathType shortestPath;
+  if (!m_UseShortestPathTree || !this->GetPathFromShortestPathTree(startPoint, endPoint, shortestPath))
+  {
+    // the cost map must not change while the shortest path tree uses the cost function
+    if (!m_UseShortestPathTree)
+      m_CostFunction->SetUseCostMap(m_UseDynamicCostMap);
+
+    // calculate shortest path between start and end point
+    m_ShortestPathFilter->SetFullNeighborsMode(true);
+    m_ShortestPathFilter->SetGraph_fullNeighbors(true);
+    // m_ShortestPathFilter->SetInput( m_CostFunction->SetImage(m_InternalImage) );
+    m_ShortestPathFilter->SetMakeOutputImage(false);
 
-  // m_ShortestPathFilter->SetCalcAllDistances(true);
-  m_ShortestPathFilter->SetStartIndex(startPoint);
-  m_ShortestPathFilter->SetEndIndex(endPoint);
+    // m_ShortestPathFilter->SetCalcAllDistances(true);
+    m_ShortestPathFilter->SetStartIndex(startPoint);
+    m_ShortestPathFilter->SetEndIndex(endPoint);
 
-  m_ShortestPathFilter->Update();
+    m_ShortestPathFilter->Update();
 
-  // construct contour from path image
-  // get the shortest path as vector
-  ShortestPathType shortestPath = m_ShortestPathFilter->GetVectorPath();
+    // construct contour from path image
+    // get the shortest path as vector
+    shortestPath = m_ShortestPathFilter->GetVectorPath();
+  }
 
   // fill the output contour with control points from the path
   OutputType::Pointer output = dynamic_cast<OutputType *>(this->MakeOutput(0).GetPointer());
@@ -242,12 +263,42 @@ void mitk::ImageLiveWireContourModelFilter::UpdateLiveWire()
   }
 }
 
+bool mitk::ImageLiveWireContourModelFilter::GetPathFromShortestPathTree(const InternalImageType::IndexType &startPoint,
+                                                                        const InternalImageType::IndexType &endPoint,
+                                                                        ShortestPathType &path)
+{
+  if (!m_ShortestPathTreeValid || m_ShortestPathTree->GetSeed() != startPoint ||
+      m_ShortestPathTreeUsesCostMap != m_UseDynamicCostMap)
+  {
+    this->StopShortestPathTree();
+
+    m_CostFunction->SetStartIndex(startPoint);
+    m_CostFunction->SetEndIndex(startPoint);
+    m_CostFunction->SetUseCostMap(m_UseDynamicCostMap);
+    m_CostFunction->Initialize();
+
+    m_ShortestPathTree->Start(m_InternalImage->GetLargestPossibleRegion(), startPoint);
+    m_ShortestPathTreeValid = true;
+    m_ShortestPathTreeUsesCostMap = m_UseDynamicCostMap;
+  }
+
+  return m_ShortestPathTree->GetPath(endPoint, path);
+}
+
+void mitk::ImageLiveWireContourModelFilter::StopShortestPathTree()
+{
+  m_ShortestPathTree->Stop();
+  m_ShortestPathTreeValid = false;
+}
+
 bool mitk::ImageLiveWireContourModelFilter::CreateDynamicCostMap(mitk::ContourModel *path)
 {
   mitk::Image::ConstPointer input = dynamic_cast<const mitk::Image *>(this->GetInput());
   if (!input)
     return false;
 
+  this->StopShortestPathTree();
+
   try
   {
     AccessFixedDimensionByItk_1(input, CreateDynamicCostMapByITK, 2, path);
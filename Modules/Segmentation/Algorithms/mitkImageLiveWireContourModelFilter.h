@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkShortestPathCostFunctionLiveWire.h>
 #include <itkShortestPathImageFilter.h>
+#include <itkShortestPathTree.h>
 
 namespace mitk
 {
@@ -43,6 +44,12 @@ namespace mitk
    \Note On the fly training will only be used for next update.
    The computation uses the last calculated segment to map cost according to features in the area of the segment.
 
+   If UseShortestPathTree is enabled, the shortest paths from the start point to all pixels of the image are computed
+   once in a background thread. As long as the start point does not change, every update only backtracks the path
+   from the end point, which is much faster for interactive use. Updates for end points that were not yet reached by
+   the background thread are computed as usual.
+   \sa itk::ShortestPathTree
+
    For time resolved purposes use ImageLiveWireContourModelFilter::SetTimestep( unsigned int ) to create the LiveWire
    contour
    at a specific timestep.
@@ -63,6 +70,7 @@ namespace mitk
     typedef itk::Image<float, 2> InternalImageType;
     typedef itk::ShortestPathImageFilter<InternalImageType, InternalImageType> ShortestPathImageFilterType;
     typedef itk::ShortestPathCostFunctionLiveWire<InternalImageType> CostFunctionType;
+    typedef itk::ShortestPathTree<InternalImageType> ShortestPathTreeType;
     typedef std::vector<itk::Index<2>> ShortestPathType;
 
     /** \brief start point in world coordinates*/
@@ -80,6 +88,12 @@ namespace mitk
     itkSetMacro(UseDynamicCostMap, bool);
     itkGetMacro(UseDynamicCostMap, bool);
 
+    /** \brief Reuse the shortest paths from the start point for all end points, see class description.
+    */
+    itkSetMacro(UseShortestPathTree, bool);
+    itkGetMacro(UseShortestPathTree, bool);
+    itkBooleanMacro(UseShortestPathTree);
+
     /** \brief Actual time step
     */
     itkSetMacro(TimeStep, unsigned int);
@@ -128,6 +142,18 @@ namespace mitk
 
     void UpdateLiveWire();
 
+    /** \brief Gets the path from the shortest path tree of the start point. The tree is (re)started if necessary.
+    \return false if the end point was not yet reached by the tree
+    */
+    bool GetPathFromShortestPathTree(const InternalImageType::IndexType &startPoint,
+                                     const InternalImageType::IndexType &endPoint,
+                                     ShortestPathType &path);
+
+    /** \brief Stops the background computation of the shortest path tree. Must be called before the cost function
+    is changed.
+    */
+    void StopShortestPathTree();
+
     /** \brief start point in worldcoordinates*/
     mitk::Point3D m_StartPoint;
 
@@ -151,6 +177,17 @@ namespace mitk
 
     unsigned int m_TimeStep;
 
+    bool m_UseShortestPathTree;
+
+    /** \brief Shortest paths from the start point, computed in the background*/
+    ShortestPathTreeType::Pointer m_ShortestPathTree;
+
+    /** \brief Flag if m_ShortestPathTree was started with the current image and cost function*/
+    bool m_ShortestPathTreeValid;
+
+    /** \brief Value of m_UseDynamicCostMap the tree was started with*/
+    bool m_ShortestPathTreeUsesCostMap;
+
     template <typename TPixel, unsigned int VImageDimension>
     void ItkPreProcessImage(const itk::Image<TPixel, VImageDimension> *inputImage);
 
@@ -35,12 +35,28 @@ mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::Interpolate(
   unsigned int /*timeStep*/,
   Image::ConstPointer /*referenceImage*/)
 {
-  mitk::Image::Pointer lowerDistanceImage = mitk::Image::New();
-  AccessFixedDimensionByItk_1(lowerSlice, ComputeDistanceMap, 2, lowerDistanceImage);
+  mitk::Image::Pointer lowerDistanceImage = this->ComputeDistanceMap(lowerSlice);
+  mitk::Image::Pointer upperDistanceImage = this->ComputeDistanceMap(upperSlice);
 
-  mitk::Image::Pointer upperDistanceImage = mitk::Image::New();
-  AccessFixedDimensionByItk_1(upperSlice, ComputeDistanceMap, 2, upperDistanceImage);
+  return this->InterpolateFromDistanceMaps(
+    lowerDistanceImage, lowerSliceIndex, upperDistanceImage, upperSliceIndex, requestedIndex, resultImage);
+}
+
+mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::ComputeDistanceMap(const Image *binarySlice)
+{
+  mitk::Image::Pointer distanceImage = mitk::Image::New();
+  AccessFixedDimensionByItk_1(binarySlice, ComputeDistanceMap, 2, distanceImage);
+  return distanceImage;
+}
 
+mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::InterpolateFromDistanceMaps(
+  const Image *lowerDistanceImage,
+  unsigned int lowerSliceIndex,
+  const Image *upperDistanceImage,
+  unsigned int upperSliceIndex,
+  unsigned int requestedIndex,
+  Image::Pointer resultImage)
+{
   // calculate where the current slice is in comparison to the lower and upper neighboring slices
   float ratio = (float)(requestedIndex - lowerSliceIndex) / (float)(upperSliceIndex - lowerSliceIndex);
   AccessFixedDimensionByItk_3(
@@ -99,8 +115,8 @@ void mitk::ShapeBasedInterpolationAlgorithm::ComputeDistanceMap(const itk::Image
 
 template <typename TPixel, unsigned int VImageDimension>
 void mitk::ShapeBasedInterpolationAlgorithm::InterpolateIntermediateSlice(itk::Image<TPixel, VImageDimension> *result,
-                                                                          const mitk::Image::Pointer &lower,
-                                                                          const mitk::Image::Pointer &upper,
+                                                                          const mitk::Image *lower,
+                                                                          const mitk::Image *upper,
                                                                           float ratio)
 {
   typename DistanceFilterImageType::Pointer lowerITK = DistanceFilterImageType::New();
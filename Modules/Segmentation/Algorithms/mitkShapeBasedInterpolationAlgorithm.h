@@ -50,6 +50,25 @@ namespace mitk
                                  unsigned int timeStep,
                                  Image::ConstPointer referenceImage) override;
 
+    /**
+     * \brief Computes the signed distance map of a binary 2D slice (negative inside, positive outside).
+     *
+     * The distance map only depends on the slice, so callers that interpolate several slices
+     * between the same bounding slices can compute it once and pass it to InterpolateFromDistanceMaps().
+     */
+    Image::Pointer ComputeDistanceMap(const Image *binarySlice);
+
+    /**
+     * \brief Same as Interpolate(), but uses distance maps created by ComputeDistanceMap() for the
+     * lower and upper slice.
+     */
+    Image::Pointer InterpolateFromDistanceMaps(const Image *lowerDistanceImage,
+                                               unsigned int lowerSliceIndex,
+                                               const Image *upperDistanceImage,
+                                               unsigned int upperSliceIndex,
+                                               unsigned int requestedIndex,
+                                               Image::Pointer resultImage);
+
   private:
     typedef itk::Image<mitk::ScalarType, 2> DistanceFilterImageType;
 
@@ -58,8 +77,8 @@ namespace mitk
 
     template <typename TPixel, unsigned int VImageDimension>
     void InterpolateIntermediateSlice(itk::Image<TPixel, VImageDimension> *result,
-                                      const mitk::Image::Pointer &lowerDistanceImage,
-                                      const mitk::Image::Pointer &upperDistanceImage,
+                                      const mitk::Image *lowerDistanceImage,
+                                      const mitk::Image *upperDistanceImage,
                                       float ratio);
   };
 
@@ -21,7 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageTimeSelector.h"
 #include <mitkExtractSliceFilter.h>
 #include <mitkImageAccessByItk.h>
-//#include <mitkPlaneGeometry.h>
+#include <mitkPlaneGeometry.h>
 
 #include "mitkShapeBasedInterpolationAlgorithm.h"
 
@@ -29,6 +29,35 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkImage.h>
 #include <itkImageSliceConstIteratorWithIndex.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+  // a distance map of a 512x512 slice needs 2 MB
+  const std::size_t MaximumNumberOfCachedDistanceMaps = 64;
+
+  // runs function(i) for all i in [0, count) on numberOfThreads threads
+  template <typename FunctionType>
+  void ParallelFor(std::size_t count, unsigned int numberOfThreads, const FunctionType &function)
+  {
+    std::atomic<std::size_t> nextIndex(0);
+    auto worker = [&]() {
+      for (std::size_t i = nextIndex++; i < count; i = nextIndex++)
+        function(i);
+    };
+
+    numberOfThreads = static_cast<unsigned int>(std::min<std::size_t>(numberOfThreads, count));
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfThreads; ++i)
+      threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+      thread.join();
+  }
+}
+
 mitk::SegmentationInterpolationController::InterpolatorMapType
   mitk::SegmentationInterpolationController::s_InterpolatorForImage; // static member initialization
 
@@ -81,6 +110,12 @@ mitk::SegmentationInterpolationController::~SegmentationInterpolationController(
 
 void mitk::SegmentationInterpolationController::OnImageModified(const itk::EventObject &)
 {
+  // changes of a blocked image are reported by SetChangedSlice() or SetChangedVolume()
+  if (!m_BlockModified)
+  {
+    ClearDistanceMapCache();
+  }
+
   if (!m_BlockModified && m_Segmentation.IsNotNull() && m_2DInterpolationActivated)
   {
     SetSegmentationVolume(m_Segmentation);
@@ -96,6 +131,7 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
 {
   // clear old information (remove all time steps
   m_SegmentationCountInSlice.clear();
+  ClearDistanceMapCache();
 
   // delete this from the list of interpolators
   auto iter = s_InterpolatorForImage.find(segmentation);
@@ -192,6 +228,7 @@ void mitk::SegmentationInterpolationController::SetChangedVolume(const Image *sl
     return;
 
   AccessFixedDimensionByItk_1(sliceDiff, ScanChangedVolume, 3, timeStep);
+  ClearDistanceMapCache();
 
   // PrintStatus();
   Modified();
@@ -239,6 +276,7 @@ void mitk::SegmentationInterpolationController::SetChangedSlice(const Image *sli
 
   AccessFixedDimensionByItk_1(
     sliceDiff, ScanChangedSlice, 2, SetChangedSliceOptions(sliceDimension, sliceIndex, dim0, dim1, timeStep, rawSlice));
+  InvalidateDistanceMap(timeStep, sliceDimension, sliceIndex);
 
   Modified();
 }
@@ -267,6 +305,10 @@ void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Imag
   unsigned int dim0max = m_SegmentationCountInSlice[timeStep][dim0].size();
   unsigned int dim1max = m_SegmentationCountInSlice[timeStep][dim1].size();
 
+  // slices of the other two dimensions that intersect changed pixels, their distance maps are outdated
+  std::vector<bool> changedDim0(dim0max, false);
+  std::vector<bool> changedDim1(dim1max, false);
+
   // scan the slice from two directions
   // and set the flags for the two dimensions of the slice
   for (unsigned int v = 0; v < dim1max; ++v)
@@ -284,9 +326,22 @@ void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Imag
       m_SegmentationCountInSlice[timeStep][dim1][v] =
         static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][dim1][v] + value);
       numberOfPixels += static_cast<int>(value);
+
+      if (value != 0)
+      {
+        changedDim0[u] = true;
+        changedDim1[v] = true;
+      }
     }
   }
 
+  for (unsigned int u = 0; u < dim0max; ++u)
+    if (changedDim0[u])
+      InvalidateDistanceMap(timeStep, dim0, u);
+  for (unsigned int v = 0; v < dim1max; ++v)
+    if (changedDim1[v])
+      InvalidateDistanceMap(timeStep, dim1, v);
+
   // flag for the dimension of the slice itself
   assert((signed)m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] + numberOfPixels >= 0);
   m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] += numberOfPixels;
@@ -432,39 +487,27 @@ void mitk::SegmentationInterpolationController::PrintStatus()
   }
 }
 
-mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsigned int sliceDimension,
-                                                                            unsigned int sliceIndex,
-                                                                            const mitk::PlaneGeometry *currentPlane,
-                                                                            unsigned int timeStep)
+bool mitk::SegmentationInterpolationController::FindBoundingSlices(unsigned int sliceDimension,
+                                                                   unsigned int sliceIndex,
+                                                                   unsigned int timeStep,
+                                                                   unsigned int &lowerBound,
+                                                                   unsigned int &upperBound) const
 {
-  if (m_Segmentation.IsNull())
-    return nullptr;
-
-  if (!currentPlane)
-  {
-    return nullptr;
-  }
-
-  if (timeStep >= m_SegmentationCountInSlice.size())
-    return nullptr;
-  if (sliceDimension > 2)
-    return nullptr;
-  unsigned int upperLimit = m_SegmentationCountInSlice[timeStep][sliceDimension].size();
+  const DirtyVectorType &segmentationCount = m_SegmentationCountInSlice[timeStep][sliceDimension];
+  unsigned int upperLimit = segmentationCount.size();
   if (sliceIndex >= upperLimit - 1)
-    return nullptr; // can't interpolate first and last slice
+    return false; // can't interpolate first and last slice
   if (sliceIndex < 1)
-    return nullptr;
+    return false;
 
-  if (m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] > 0)
-    return nullptr; // slice contains a segmentation, won't interpolate anything then
+  if (segmentationCount[sliceIndex] > 0)
+    return false; // slice contains a segmentation, won't interpolate anything then
 
-  unsigned int lowerBound(0);
-  unsigned int upperBound(0);
   bool bounds(false);
 
   for (lowerBound = sliceIndex - 1; /*lowerBound >= 0*/; --lowerBound)
   {
-    if (m_SegmentationCountInSlice[timeStep][sliceDimension][lowerBound] > 0)
+    if (segmentationCount[lowerBound] > 0)
     {
       bounds = true;
       break;
@@ -475,19 +518,143 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   }
 
   if (!bounds)
-    return nullptr;
+    return false;
 
   bounds = false;
   for (upperBound = sliceIndex + 1; upperBound < upperLimit; ++upperBound)
   {
-    if (m_SegmentationCountInSlice[timeStep][sliceDimension][upperBound] > 0)
+    if (segmentationCount[upperBound] > 0)
     {
       bounds = true;
       break;
     }
   }
 
-  if (!bounds)
+  return bounds;
+}
+
+mitk::Image::Pointer mitk::SegmentationInterpolationController::ExtractSlice(
+  const PlaneGeometry *currentPlane,
+  unsigned int sliceDimension,
+  unsigned int sliceIndex,
+  unsigned int timeStep,
+  itk::SmartPointer<const PlaneGeometry> *reslicePlane) const
+{
+  // Creating PlaneGeometry for the slice
+  mitk::PlaneGeometry::Pointer plane = currentPlane->Clone();
+
+  // Transforming the current origin so that it matches the slice
+  mitk::Point3D origin = currentPlane->GetOrigin();
+  m_Segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
+  origin[sliceDimension] = sliceIndex;
+  m_Segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
+  plane->SetOrigin(origin);
+
+  mitk::ExtractSliceFilter::Pointer extractor = ExtractSliceFilter::New();
+  extractor->SetInput(m_Segmentation);
+  extractor->SetTimeStep(timeStep);
+  extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
+  extractor->SetVtkOutputRequest(false);
+
+  extractor->SetWorldGeometry(plane);
+  extractor->Modified();
+  extractor->Update();
+  mitk::Image::Pointer slice = extractor->GetOutput();
+  slice->DisconnectPipeline();
+
+  if (reslicePlane)
+    *reslicePlane = plane.GetPointer();
+
+  return slice;
+}
+
+mitk::Image::Pointer mitk::SegmentationInterpolationController::GetCachedDistanceMap(const DistanceMapKeyType &key,
+                                                                                     const PlaneGeometry *reslicePlane)
+{
+  std::lock_guard<std::mutex> lock(m_DistanceMapCacheMutex);
+
+  auto iter = m_DistanceMapCache.find(key);
+  if (iter == m_DistanceMapCache.end())
+    return nullptr;
+
+  // the orientation of the reslice plane may change, e.g. if the render window is rotated
+  if (!mitk::Equal(*iter->second.plane, *reslicePlane, mitk::eps, false))
+    return nullptr;
+
+  return iter->second.distanceMap;
+}
+
+void mitk::SegmentationInterpolationController::CacheDistanceMap(const DistanceMapKeyType &key,
+                                                                 const PlaneGeometry *reslicePlane,
+                                                                 Image *distanceMap)
+{
+  std::lock_guard<std::mutex> lock(m_DistanceMapCacheMutex);
+
+  if (m_DistanceMapCache.size() >= MaximumNumberOfCachedDistanceMaps &&
+      m_DistanceMapCache.find(key) == m_DistanceMapCache.end())
+    m_DistanceMapCache.clear();
+
+  DistanceMapCacheEntry &entry = m_DistanceMapCache[key];
+  entry.plane = reslicePlane;
+  entry.distanceMap = distanceMap;
+}
+
+mitk::Image::Pointer mitk::SegmentationInterpolationController::GetDistanceMap(const PlaneGeometry *currentPlane,
+                                                                               unsigned int sliceDimension,
+                                                                               unsigned int sliceIndex,
+                                                                               unsigned int timeStep)
+{
+  // the slice itself is needed to compare the plane, extracting it is cheap compared to the distance map
+  itk::SmartPointer<const PlaneGeometry> reslicePlane;
+  mitk::Image::Pointer slice = ExtractSlice(currentPlane, sliceDimension, sliceIndex, timeStep, &reslicePlane);
+  if (slice.IsNull())
+    return nullptr;
+
+  const DistanceMapKeyType key(timeStep, sliceDimension, sliceIndex);
+  mitk::Image::Pointer distanceMap = GetCachedDistanceMap(key, reslicePlane);
+  if (distanceMap.IsNull())
+  {
+    distanceMap = mitk::ShapeBasedInterpolationAlgorithm::New()->ComputeDistanceMap(slice);
+    CacheDistanceMap(key, reslicePlane, distanceMap);
+  }
+  return distanceMap;
+}
+
+void mitk::SegmentationInterpolationController::InvalidateDistanceMap(unsigned int timeStep,
+                                                                      unsigned int sliceDimension,
+                                                                      unsigned int sliceIndex)
+{
+  std::lock_guard<std::mutex> lock(m_DistanceMapCacheMutex);
+  m_DistanceMapCache.erase(DistanceMapKeyType(timeStep, sliceDimension, sliceIndex));
+}
+
+void mitk::SegmentationInterpolationController::ClearDistanceMapCache()
+{
+  std::lock_guard<std::mutex> lock(m_DistanceMapCacheMutex);
+  m_DistanceMapCache.clear();
+}
+
+mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsigned int sliceDimension,
+                                                                            unsigned int sliceIndex,
+                                                                            const mitk::PlaneGeometry *currentPlane,
+                                                                            unsigned int timeStep)
+{
+  if (m_Segmentation.IsNull())
+    return nullptr;
+
+  if (!currentPlane)
+  {
+    return nullptr;
+  }
+
+  if (timeStep >= m_SegmentationCountInSlice.size())
+    return nullptr;
+  if (sliceDimension > 2)
+    return nullptr;
+
+  unsigned int lowerBound(0);
+  unsigned int upperBound(0);
+  if (!FindBoundingSlices(sliceDimension, sliceIndex, timeStep, lowerBound, upperBound))
     return nullptr;
 
   // ok, we have found two neighboring slices with segmentations (and we made sure that the current slice does NOT
@@ -495,8 +662,8 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   // MITK_INFO << "Interpolate in timestep " << timeStep << ", dimension " << sliceDimension << ": estimate slice " <<
   // sliceIndex << " from slices " << lowerBound << " and " << upperBound << std::endl;
 
-  mitk::Image::Pointer lowerMITKSlice;
-  mitk::Image::Pointer upperMITKSlice;
+  mitk::Image::Pointer lowerDistanceImage;
+  mitk::Image::Pointer upperDistanceImage;
   mitk::Image::Pointer resultImage;
 
   try
@@ -515,49 +682,11 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
     resultImage = extractor->GetOutput();
     resultImage->DisconnectPipeline();
 
-    // Creating PlaneGeometry for lower slice
-    mitk::PlaneGeometry::Pointer reslicePlane = currentPlane->Clone();
-
-    // Transforming the current origin so that it matches the lower slice
-    mitk::Point3D origin = currentPlane->GetOrigin();
-    m_Segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
-    origin[sliceDimension] = lowerBound;
-    m_Segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
-    reslicePlane->SetOrigin(origin);
-
-    // Extract the lower slice
-    extractor = ExtractSliceFilter::New();
-    extractor->SetInput(m_Segmentation);
-    extractor->SetTimeStep(timeStep);
-    extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
-    extractor->SetVtkOutputRequest(false);
-
-    extractor->SetWorldGeometry(reslicePlane);
-    extractor->Modified();
-    extractor->Update();
-    lowerMITKSlice = extractor->GetOutput();
-    lowerMITKSlice->DisconnectPipeline();
-
-    // Transforming the current origin so that it matches the upper slice
-    m_Segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
-    origin[sliceDimension] = upperBound;
-    m_Segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
-    reslicePlane->SetOrigin(origin);
-
-    // Extract the upper slice
-    extractor = ExtractSliceFilter::New();
-    extractor->SetInput(m_Segmentation);
-    extractor->SetTimeStep(timeStep);
-    extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
-    extractor->SetVtkOutputRequest(false);
-
-    extractor->SetWorldGeometry(reslicePlane);
-    extractor->Modified();
-    extractor->Update();
-    upperMITKSlice = extractor->GetOutput();
-    upperMITKSlice->DisconnectPipeline();
+    // The distance maps of the lower and upper slice are reused if they did not change
+    lowerDistanceImage = GetDistanceMap(currentPlane, sliceDimension, lowerBound, timeStep);
+    upperDistanceImage = GetDistanceMap(currentPlane, sliceDimension, upperBound, timeStep);
 
-    if (lowerMITKSlice.IsNull() || upperMITKSlice.IsNull())
+    if (lowerDistanceImage.IsNull() || upperDistanceImage.IsNull())
       return nullptr;
   }
   catch (const std::exception &e)
@@ -570,20 +699,200 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   //   two segmentations (guaranteed to be of the same data type, but no special data type guaranteed)
   //   orientation (sliceDimension) of the segmentations
   //   position of the two slices (sliceIndices)
-  //   one volume image (original patient image)
   //
-  // interpolation algorithm can use e.g. itk::ImageSliceConstIteratorWithIndex to
-  //   inspect the original patient image at appropriate positions
-
-  mitk::SegmentationInterpolationAlgorithm::Pointer algorithm =
-    mitk::ShapeBasedInterpolationAlgorithm::New().GetPointer();
-  return algorithm->Interpolate(lowerMITKSlice.GetPointer(),
-                                lowerBound,
-                                upperMITKSlice.GetPointer(),
-                                upperBound,
-                                sliceIndex,
-                                sliceDimension,
-                                resultImage,
-                                timeStep,
-                                m_ReferenceImage);
+  // the shape based interpolation does not consider the original patient image, so the
+  // distance maps of the two segmentations are all it needs
+
+  mitk::ShapeBasedInterpolationAlgorithm::Pointer algorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
+  return algorithm->InterpolateFromDistanceMaps(
+    lowerDistanceImage, lowerBound, upperDistanceImage, upperBound, sliceIndex, resultImage);
+}
+
+mitk::SegmentationInterpolationController::InterpolationMapType
+  mitk::SegmentationInterpolationController::InterpolateAll(unsigned int sliceDimension,
+                                                            const mitk::PlaneGeometry *currentPlane,
+                                                            unsigned int timeStep,
+                                                            unsigned int numberOfThreads)
+{
+  InterpolationMapType interpolations;
+
+  if (m_Segmentation.IsNull() || !currentPlane)
+    return interpolations;
+  if (timeStep >= m_SegmentationCountInSlice.size())
+    return interpolations;
+  if (sliceDimension > 2)
+    return interpolations;
+
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  struct BoundingSlice
+  {
+    unsigned int sliceIndex;
+    itk::SmartPointer<const PlaneGeometry> reslicePlane;
+    mitk::Image::Pointer slice;
+    mitk::Image::Pointer distanceMap;
+  };
+
+  struct InterpolatedSlice
+  {
+    unsigned int sliceIndex;
+    std::size_t lowerBound; ///< position in boundingSlices
+    std::size_t upperBound; ///< position in boundingSlices
+    mitk::Image::Pointer result;
+  };
+
+  // Only segmented slices that bound a gap need a distance map.
+  std::vector<std::pair<unsigned int, unsigned int>> gaps;
+  {
+    const DirtyVectorType &segmentationCount = m_SegmentationCountInSlice[timeStep][sliceDimension];
+    bool hasLowerBound = false;
+    unsigned int lowerBound = 0;
+    for (unsigned int sliceIndex = 0; sliceIndex < segmentationCount.size(); ++sliceIndex)
+    {
+      if (segmentationCount[sliceIndex] == 0)
+        continue;
+
+      if (hasLowerBound && sliceIndex > lowerBound + 1)
+        gaps.emplace_back(lowerBound, sliceIndex);
+
+      lowerBound = sliceIndex;
+      hasLowerBound = true;
+    }
+  }
+
+  if (gaps.empty())
+    return interpolations;
+
+  auto extractBoundingSlice = [&](unsigned int sliceIndex) {
+    BoundingSlice boundingSlice;
+    boundingSlice.sliceIndex = sliceIndex;
+    boundingSlice.slice = ExtractSlice(currentPlane, sliceDimension, sliceIndex, timeStep, &boundingSlice.reslicePlane);
+    boundingSlice.distanceMap =
+      GetCachedDistanceMap(DistanceMapKeyType(timeStep, sliceDimension, sliceIndex), boundingSlice.reslicePlane);
+    return boundingSlice;
+  };
+
+  // The gaps are processed in order, in batches whose bounding slices fit into the distance map cache. Caching the
+  // maps of one batch therefore never evicts a map that the same batch still needs, and the upper bound of a batch is
+  // handed over to the next one directly.
+  BoundingSlice previousUpperBound;
+  bool hasPreviousUpperBound = false;
+  std::size_t gapIndex = 0;
+  while (gapIndex < gaps.size())
+  {
+    std::vector<BoundingSlice> boundingSlices;
+    std::vector<InterpolatedSlice> interpolatedSlices;
+
+    // Extracting the slices is done serially, it is cheap and the ExtractSliceFilter shares the input image.
+    // Each gap between two segmented slices is one range of slices that is interpolated from the same distance maps.
+    try
+    {
+      for (; gapIndex < gaps.size(); ++gapIndex)
+      {
+        const unsigned int lowerIndex = gaps[gapIndex].first;
+        const unsigned int upperIndex = gaps[gapIndex].second;
+        const bool sharesLowerBound = !boundingSlices.empty() && boundingSlices.back().sliceIndex == lowerIndex;
+        const std::size_t numberOfNewBounds = sharesLowerBound ? 1 : 2;
+        if (!boundingSlices.empty() &&
+            boundingSlices.size() + numberOfNewBounds > MaximumNumberOfCachedDistanceMaps)
+          break;
+
+        if (!sharesLowerBound)
+        {
+          if (hasPreviousUpperBound && previousUpperBound.sliceIndex == lowerIndex &&
+              previousUpperBound.distanceMap.IsNotNull())
+            boundingSlices.push_back(previousUpperBound);
+          else
+            boundingSlices.push_back(extractBoundingSlice(lowerIndex));
+        }
+        boundingSlices.push_back(extractBoundingSlice(upperIndex));
+
+        for (unsigned int sliceIndex = lowerIndex + 1; sliceIndex < upperIndex; ++sliceIndex)
+        {
+          InterpolatedSlice interpolatedSlice;
+          interpolatedSlice.sliceIndex = sliceIndex;
+          interpolatedSlice.lowerBound = boundingSlices.size() - 2;
+          interpolatedSlice.upperBound = boundingSlices.size() - 1;
+          interpolatedSlice.result = ExtractSlice(currentPlane, sliceDimension, sliceIndex, timeStep);
+          interpolatedSlices.push_back(interpolatedSlice);
+        }
+      }
+    }
+    catch (const std::exception &e)
+    {
+      MITK_ERROR << "Error in 2D interpolation: " << e.what();
+      return InterpolationMapType();
+    }
+
+    // compute the missing distance maps of the bounding slices of this batch
+    std::vector<std::size_t> missingDistanceMaps;
+    for (std::size_t i = 0; i < boundingSlices.size(); ++i)
+    {
+      if (boundingSlices[i].distanceMap.IsNull())
+        missingDistanceMaps.push_back(i);
+    }
+
+    // exceptions must not leave the worker threads, failed slices are just not interpolated
+    ParallelFor(missingDistanceMaps.size(), numberOfThreads, [&](std::size_t i) {
+      BoundingSlice &boundingSlice = boundingSlices[missingDistanceMaps[i]];
+      try
+      {
+        boundingSlice.distanceMap =
+          mitk::ShapeBasedInterpolationAlgorithm::New()->ComputeDistanceMap(boundingSlice.slice);
+      }
+      catch (const std::exception &e)
+      {
+        MITK_ERROR << "Error in 2D interpolation: " << e.what();
+      }
+    });
+
+    for (std::size_t i : missingDistanceMaps)
+    {
+      const BoundingSlice &boundingSlice = boundingSlices[i];
+      if (boundingSlice.distanceMap.IsNull())
+        continue;
+      CacheDistanceMap(DistanceMapKeyType(timeStep, sliceDimension, boundingSlice.sliceIndex),
+                       boundingSlice.reslicePlane,
+                       boundingSlice.distanceMap);
+    }
+
+    // interpolate all slices of this batch
+    ParallelFor(interpolatedSlices.size(), numberOfThreads, [&](std::size_t i) {
+      InterpolatedSlice &interpolatedSlice = interpolatedSlices[i];
+      const BoundingSlice &lower = boundingSlices[interpolatedSlice.lowerBound];
+      const BoundingSlice &upper = boundingSlices[interpolatedSlice.upperBound];
+      if (lower.distanceMap.IsNull() || upper.distanceMap.IsNull())
+      {
+        interpolatedSlice.result = nullptr;
+        return;
+      }
+
+      try
+      {
+        mitk::ShapeBasedInterpolationAlgorithm::New()->InterpolateFromDistanceMaps(lower.distanceMap,
+                                                                                   lower.sliceIndex,
+                                                                                   upper.distanceMap,
+                                                                                   upper.sliceIndex,
+                                                                                   interpolatedSlice.sliceIndex,
+                                                                                   interpolatedSlice.result);
+      }
+      catch (const std::exception &e)
+      {
+        MITK_ERROR << "Error in 2D interpolation: " << e.what();
+        interpolatedSlice.result = nullptr;
+      }
+    });
+
+    for (const InterpolatedSlice &interpolatedSlice : interpolatedSlices)
+    {
+      if (interpolatedSlice.result.IsNotNull())
+        interpolations[interpolatedSlice.sliceIndex] = interpolatedSlice.result;
+    }
+
+    previousUpperBound = boundingSlices.back();
+    hasPreviousUpperBound = true;
+  }
+
+  return interpolations;
 }
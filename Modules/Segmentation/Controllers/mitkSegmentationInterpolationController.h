@@ -19,12 +19,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkCommon.h"
 #include "mitkImage.h"
+#include "mitkPlaneGeometry.h"
 #include <MitkSegmentationExports.h>
 
 #include <itkImage.h>
 #include <itkObjectFactory.h>
 
 #include <map>
+#include <mutex>
+#include <tuple>
 #include <vector>
 
 namespace mitk
@@ -59,6 +62,11 @@ namespace mitk
     is an interpolator
     instance for a specified image. OverwriteImageFilter uses this to get to know its interpolator.
 
+    The signed distance maps of the slices that bound an interpolation are cached, so that consecutive
+    calls of Interpolate() between the same two slices do not compute them again. A cached map is dropped
+    when SetChangedSlice() reports a change of its slice, SetChangedVolume() or SetSegmentationVolume() drop
+    all cached maps. InterpolateAll() interpolates all gaps of one orientation at once and uses several threads.
+
     SegmentationInterpolationController needs to maintain some information about the image slices (in every dimension).
     This information is stored internally in m_SegmentationCountInSlice, which is basically three std::vectors (one for
     each dimension).
@@ -148,6 +156,30 @@ namespace mitk
                                const mitk::PlaneGeometry *currentPlane,
                                unsigned int timeStep);
 
+    typedef std::map<unsigned int, Image::Pointer> InterpolationMapType;
+
+    /**
+      \brief Generates the interpolations of all slices of the given orientation.
+
+      All slices that lie between two segmented slices and do not contain a segmentation themselves are interpolated.
+      The distance maps of the bounding slices and the interpolations are computed in parallel.
+
+      \param sliceDimension Number of the dimension which is constant for all pixels of the meant slices.
+
+      \param currentPlane One of the planes of the orientation. The planes of the interpolated slices are
+             derived from it by moving its origin along sliceDimension.
+
+      \param timeStep Which time step to use
+
+      \param numberOfThreads Number of threads used for the interpolation, if 0 the number of cores is used.
+
+      \return The interpolated slices by slice index. The map is empty if nothing can be interpolated.
+    */
+    InterpolationMapType InterpolateAll(unsigned int sliceDimension,
+                                        const mitk::PlaneGeometry *currentPlane,
+                                        unsigned int timeStep,
+                                        unsigned int numberOfThreads = 0);
+
     void OnImageModified(const itk::EventObject &);
 
     /**
@@ -187,6 +219,15 @@ namespace mitk
     typedef std::vector<std::vector<DirtyVectorType>> TimeResolvedDirtyVectorType;
     typedef std::map<const Image *, SegmentationInterpolationController *> InterpolatorMapType;
 
+    /// time step, slice dimension and slice index of a cached distance map
+    typedef std::tuple<unsigned int, unsigned int, unsigned int> DistanceMapKeyType;
+    struct DistanceMapCacheEntry
+    {
+      itk::SmartPointer<const PlaneGeometry> plane; ///< plane the slice was extracted with
+      Image::Pointer distanceMap;
+    };
+    typedef std::map<DistanceMapKeyType, DistanceMapCacheEntry> DistanceMapCacheType;
+
     SegmentationInterpolationController(); // purposely hidden
     ~SegmentationInterpolationController() override;
 
@@ -202,6 +243,30 @@ namespace mitk
 
     void PrintStatus();
 
+    /// finds the next segmented slices below and above sliceIndex, returns false if there are none
+    bool FindBoundingSlices(unsigned int sliceDimension,
+                            unsigned int sliceIndex,
+                            unsigned int timeStep,
+                            unsigned int &lowerBound,
+                            unsigned int &upperBound) const;
+
+    /// extracts the slice with the given index along sliceDimension, using the orientation of currentPlane
+    Image::Pointer ExtractSlice(const PlaneGeometry *currentPlane,
+                                unsigned int sliceDimension,
+                                unsigned int sliceIndex,
+                                unsigned int timeStep,
+                                itk::SmartPointer<const PlaneGeometry> *reslicePlane = nullptr) const;
+
+    /// returns the cached distance map of a slice or computes and caches it
+    Image::Pointer GetDistanceMap(const PlaneGeometry *currentPlane,
+                                  unsigned int sliceDimension,
+                                  unsigned int sliceIndex,
+                                  unsigned int timeStep);
+    Image::Pointer GetCachedDistanceMap(const DistanceMapKeyType &key, const PlaneGeometry *reslicePlane);
+    void CacheDistanceMap(const DistanceMapKeyType &key, const PlaneGeometry *reslicePlane, Image *distanceMap);
+    void InvalidateDistanceMap(unsigned int timeStep, unsigned int sliceDimension, unsigned int sliceIndex);
+    void ClearDistanceMapCache();
+
     /**
       An array of flags. One for each dimension of the image. A flag is set, when a slice in a certain dimension
       has at least one pixel that is not 0 (which would mean that it has to be considered by the interpolation
@@ -215,6 +280,10 @@ namespace mitk
 
     static InterpolatorMapType s_InterpolatorForImage;
 
+    /// signed distance maps of bounding slices, see GetDistanceMap()
+    DistanceMapCacheType m_DistanceMapCache;
+    std::mutex m_DistanceMapCacheMutex;
+
     Image::ConstPointer m_Segmentation;
     Image::ConstPointer m_ReferenceImage;
     bool m_BlockModified;
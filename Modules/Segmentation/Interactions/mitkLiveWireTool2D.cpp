@@ -304,6 +304,7 @@ void mitk::LiveWireTool2D::OnInitLiveWire(StateMachineAction *, InteractionEvent
   m_WorkingSlice->GetSlicedGeometry()->SetOrigin(newOrigin);
 
   m_LiveWireFilter = mitk::ImageLiveWireContourModelFilter::New();
+  m_LiveWireFilter->SetUseShortestPathTree(true);
   m_LiveWireFilter->SetInput(m_WorkingSlice);
 
   // map click to pixel coordinates
@@ -0,0 +1,135 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImageGenerator.h>
+#include <mitkImageLiveWireContourModelFilter.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+class mitkImageLiveWireContourModelFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageLiveWireContourModelFilterTestSuite);
+  MITK_TEST(TestPathConnectsStartAndEndPoint);
+  MITK_TEST(TestShortestPathTree_PathConnectsStartAndEndPoint);
+  MITK_TEST(TestBenchmark512);
+  MITK_TEST(TestBenchmark1024);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Point3D IndexToWorld(mitk::Image *image, unsigned int x, unsigned int y)
+  {
+    mitk::Point3D index, world;
+    index.Fill(0);
+    index[0] = x;
+    index[1] = y;
+    image->GetGeometry()->IndexToWorld(index, world);
+    return world;
+  }
+
+  /** Checks that the output of the filter is a connected path from start to end point. */
+  void CheckContour(mitk::Image *image, mitk::ImageLiveWireContourModelFilter *filter)
+  {
+    mitk::ContourModel::Pointer contour = filter->GetOutput();
+    CPPUNIT_ASSERT_MESSAGE("LiveWire contour is empty.", contour->GetNumberOfVertices() > 1);
+    CPPUNIT_ASSERT_MESSAGE("Contour does not begin at the start point.",
+                           mitk::Equal(contour->GetVertexAt(0)->Coordinates, filter->GetStartPoint()));
+    CPPUNIT_ASSERT_MESSAGE(
+      "Contour does not end at the end point.",
+      mitk::Equal(contour->GetVertexAt(contour->GetNumberOfVertices() - 1)->Coordinates, filter->GetEndPoint()));
+
+    mitk::Point3D previous;
+    image->GetGeometry()->WorldToIndex(contour->GetVertexAt(0)->Coordinates, previous);
+    for (int i = 1; i < contour->GetNumberOfVertices(); ++i)
+    {
+      mitk::Point3D current;
+      image->GetGeometry()->WorldToIndex(contour->GetVertexAt(i)->Coordinates, current);
+      CPPUNIT_ASSERT_MESSAGE("Contour is not connected.",
+                             std::abs(current[0] - previous[0]) < 1.5 && std::abs(current[1] - previous[1]) < 1.5);
+      previous = current;
+    }
+  }
+
+  /** Computes a LiveWire contour between two corners of a random slice, checks that the
+   *  contour is a connected path from start to end point and returns the runtime in ms.
+   */
+  double ComputeLiveWire(unsigned int size)
+  {
+    mitk::Image::Pointer image = mitk::ImageGenerator::GenerateRandomImage<float>(size, size);
+
+    mitk::ImageLiveWireContourModelFilter::Pointer filter = mitk::ImageLiveWireContourModelFilter::New();
+    filter->SetInput(image);
+    filter->SetStartPoint(IndexToWorld(image, size / 8, size / 8));
+    filter->SetEndPoint(IndexToWorld(image, size - size / 8, size - size / 8));
+
+    auto startTime = std::chrono::steady_clock::now();
+    filter->Update();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    CheckContour(image, filter);
+    return ms;
+  }
+
+public:
+  void TestPathConnectsStartAndEndPoint() { ComputeLiveWire(64); }
+
+  void TestShortestPathTree_PathConnectsStartAndEndPoint()
+  {
+    const unsigned int size = 128;
+    mitk::Image::Pointer image = mitk::ImageGenerator::GenerateRandomImage<float>(size, size);
+
+    mitk::ImageLiveWireContourModelFilter::Pointer filter = mitk::ImageLiveWireContourModelFilter::New();
+    filter->SetUseShortestPathTree(true);
+    filter->SetInput(image);
+    filter->SetStartPoint(IndexToWorld(image, size / 2, size / 2));
+
+    // the first updates are answered while the tree is still growing, later ones by backtracking
+    auto startTime = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+      filter->SetEndPoint(IndexToWorld(image, (i * 37) % size, (i * 91) % size));
+      filter->Update();
+      CheckContour(image, filter);
+      if (i == 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    MITK_INFO << "16 LiveWire updates with shortest path tree on 128x128 slice: " << ms << " ms";
+
+    // moving the start point restarts the tree
+    filter->SetStartPoint(IndexToWorld(image, 3, 5));
+    filter->SetEndPoint(IndexToWorld(image, size - 1, size - 2));
+    filter->Update();
+    CheckContour(image, filter);
+  }
+
+  void TestBenchmark512()
+  {
+    double ms = ComputeLiveWire(512);
+    MITK_INFO << "LiveWire on 512x512 slice: " << ms << " ms";
+  }
+
+  void TestBenchmark1024()
+  {
+    double ms = ComputeLiveWire(1024);
+    MITK_INFO << "LiveWire on 1024x1024 slice: " << ms << " ms";
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageLiveWireContourModelFilter)
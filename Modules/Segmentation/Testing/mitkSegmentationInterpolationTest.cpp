@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImage.h>
 #include <mitkImagePixelReadAccessor.h>
 #include <mitkImagePixelWriteAccessor.h>
+#include <mitkImageReadAccessor.h>
 #include <mitkSegmentationInterpolationController.h>
 #include <mitkSliceNavigationController.h>
 #include <mitkTool.h>
@@ -35,6 +36,8 @@ class mitkSegmentationInterpolationTestSuite : public mitk::TestFixture
   MITK_TEST(Equal_Axial_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Frontal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Sagittal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
+  MITK_TEST(Equal_InterpolateAllAndInterpolate_ReturnsTrue);
+  MITK_TEST(Interpolate_AfterSetChangedSlice_UsesChangedSlice);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -148,6 +151,47 @@ private:
     }
   }
 
+  /** Sets a square of the given size in an axial slice of the segmentation, starting at the center point. */
+  void FillAxialSquare(unsigned int sliceIndex, int size)
+  {
+    mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 3> writeAccessor(m_SegmentationImage);
+    itk::Index<3> currentPoint = m_CenterPoint;
+    currentPoint[2] = sliceIndex;
+    for (int i = 0; i < size; ++i)
+    {
+      for (int j = 0; j < size; ++j)
+      {
+        currentPoint[0] = m_CenterPoint[0] + i;
+        currentPoint[1] = m_CenterPoint[1] + j;
+        writeAccessor.SetPixelByIndexSafe(currentPoint, 1);
+      }
+    }
+  }
+
+  /** Compares only the pixels, the geometries of slices extracted with different planes may differ by rounding. */
+  bool EqualPixels(mitk::Image *image1, mitk::Image *image2)
+  {
+    if (image1->GetDimension(0) != image2->GetDimension(0) || image1->GetDimension(1) != image2->GetDimension(1))
+      return false;
+    mitk::ImageReadAccessor accessor1(image1);
+    mitk::ImageReadAccessor accessor2(image2);
+    std::size_t size = image1->GetPixelType().GetSize() * image1->GetDimension(0) * image1->GetDimension(1);
+    return memcmp(accessor1.GetData(), accessor2.GetData(), size) == 0;
+  }
+
+  mitk::PlaneGeometry::ConstPointer GetAxialPlane(unsigned int sliceIndex)
+  {
+    mitk::SliceNavigationController::Pointer navigationController = mitk::SliceNavigationController::New();
+    navigationController->SetInputWorldTimeGeometry(m_SegmentationImage->GetTimeGeometry());
+    navigationController->Update(mitk::SliceNavigationController::Axial);
+    itk::Index<3> index = m_CenterPoint;
+    index[2] = sliceIndex;
+    mitk::Point3D pointMM;
+    m_SegmentationImage->GetTimeGeometry()->GetGeometryForTimeStep(0)->IndexToWorld(index, pointMM);
+    navigationController->SelectSliceByPoint(pointMM);
+    return navigationController->GetCurrentPlaneGeometry();
+  }
+
   mitk::Image::Pointer m_ReferenceImage;
   mitk::Image::Pointer m_SegmentationImage;
   itk::Index<3> m_CenterPoint;
@@ -203,6 +247,84 @@ public:
     mitk::SliceNavigationController::ViewDirection viewDirection = mitk::SliceNavigationController::Sagittal;
     testRoutine(viewDirection);
   }
+
+  void Equal_InterpolateAllAndInterpolate_ReturnsTrue()
+  {
+    // two gaps: 20..24 and 24..30
+    FillAxialSquare(20, 9);
+    FillAxialSquare(24, 1);
+    FillAxialSquare(30, 5);
+    m_InterpolationController->SetSegmentationVolume(m_SegmentationImage);
+
+    mitk::SegmentationInterpolationController::InterpolationMapType interpolations =
+      m_InterpolationController->InterpolateAll(2, GetAxialPlane(25), 0, 4);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(8), interpolations.size());
+
+    for (unsigned int sliceIndex = 0; sliceIndex < m_SegmentationImage->GetDimension(2); ++sliceIndex)
+    {
+      mitk::Image::Pointer interpolation =
+        m_InterpolationController->Interpolate(2, sliceIndex, GetAxialPlane(sliceIndex), 0);
+      auto iter = interpolations.find(sliceIndex);
+      if (interpolation.IsNull())
+      {
+        CPPUNIT_ASSERT_MESSAGE("Slice without interpolation was interpolated.", iter == interpolations.end());
+      }
+      else
+      {
+        CPPUNIT_ASSERT_MESSAGE("Interpolated slice is missing.", iter != interpolations.end());
+        CPPUNIT_ASSERT_MESSAGE("InterpolateAll differs from Interpolate.", EqualPixels(interpolation, iter->second));
+      }
+    }
+  }
+
+  void Interpolate_AfterSetChangedSlice_UsesChangedSlice()
+  {
+    FillAxialSquare(20, 9);
+    FillAxialSquare(24, 1);
+    m_InterpolationController->SetSegmentationVolume(m_SegmentationImage);
+
+    // fills the distance map cache with the maps of slices 20 and 24
+    mitk::Image::Pointer before = m_InterpolationController->Interpolate(2, 22, GetAxialPlane(22), 0);
+    CPPUNIT_ASSERT(before.IsNotNull());
+
+    // enlarge the segmentation of slice 24 and report the difference
+    m_InterpolationController->BlockModified(true);
+    FillAxialSquare(24, 5);
+    m_InterpolationController->BlockModified(false);
+
+    mitk::Image::Pointer sliceDiff = mitk::Image::New();
+    const mitk::PixelType pixelType(mitk::MakeScalarPixelType<mitk::Tool::DefaultSegmentationDataType>());
+    unsigned int dimensions[2] = {m_SegmentationImage->GetDimension(0), m_SegmentationImage->GetDimension(1)};
+    sliceDiff->Initialize(pixelType, 2, dimensions);
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 2> writeAccessor(sliceDiff);
+      memset(writeAccessor.GetData(), 0, sizeof(mitk::Tool::DefaultSegmentationDataType) * dimensions[0] * dimensions[1]);
+      itk::Index<2> index;
+      for (int i = 0; i < 5; ++i)
+      {
+        for (int j = 0; j < 5; ++j)
+        {
+          index[0] = m_CenterPoint[0] + i;
+          index[1] = m_CenterPoint[1] + j;
+          if (i > 0 || j > 0)
+            writeAccessor.SetPixelByIndex(index, 1);
+        }
+      }
+    }
+    m_InterpolationController->SetChangedSlice(sliceDiff, 2, 24, 0);
+
+    mitk::Image::Pointer after = m_InterpolationController->Interpolate(2, 22, GetAxialPlane(22), 0);
+
+    // a new controller has no cached distance maps
+    mitk::SegmentationInterpolationController::Pointer newController = mitk::SegmentationInterpolationController::New();
+    newController->Activate2DInterpolation(true);
+    newController->SetSegmentationVolume(m_SegmentationImage);
+    mitk::Image::Pointer expected = newController->Interpolate(2, 22, GetAxialPlane(22), 0);
+
+    CPPUNIT_ASSERT(after.IsNotNull() && expected.IsNotNull());
+    CPPUNIT_ASSERT_MESSAGE("Interpolation uses an outdated distance map.", EqualPixels(after, expected));
+    CPPUNIT_ASSERT_MESSAGE("Changed slice was not considered.", !EqualPixels(after, before));
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkSegmentationInterpolation)
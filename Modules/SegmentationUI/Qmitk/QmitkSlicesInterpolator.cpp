@@ -728,20 +728,25 @@ void QmitkSlicesInterpolator::AcceptAllInterpolations(mitk::SliceNavigationContr
     mitk::Point3D origin = reslicePlane->GetOrigin();
     unsigned int totalChangedSlices(0);
 
+    // all gaps are interpolated at once and in parallel, writing the results back is done slice by slice
+    mitk::SegmentationInterpolationController::InterpolationMapType interpolations =
+      m_Interpolator->InterpolateAll(sliceDimension, reslicePlane, timeStep);
+
     for (unsigned int sliceIndex = 0; sliceIndex < zslices; ++sliceIndex)
     {
-      // Transforming the current origin of the reslice plane
-      // so that it matches the one of the next slice
-      m_Segmentation->GetSlicedGeometry()->WorldToIndex(origin, origin);
-      origin[sliceDimension] = sliceIndex;
-      m_Segmentation->GetSlicedGeometry()->IndexToWorld(origin, origin);
-      reslicePlane->SetOrigin(origin);
-      // Set the slice as 'input'
-      mitk::Image::Pointer interpolation =
-        m_Interpolator->Interpolate(sliceDimension, sliceIndex, reslicePlane, timeStep);
-
-      if (interpolation.IsNotNull()) // we don't check if interpolation is necessary/sensible - but m_Interpolator does
+      auto interpolationIter = interpolations.find(sliceIndex);
+      // we don't check if interpolation is necessary/sensible - but m_Interpolator does
+      if (interpolationIter != interpolations.end())
       {
+        mitk::Image::Pointer interpolation = interpolationIter->second;
+
+        // Transforming the current origin of the reslice plane
+        // so that it matches the one of the next slice
+        m_Segmentation->GetSlicedGeometry()->WorldToIndex(origin, origin);
+        origin[sliceDimension] = sliceIndex;
+        m_Segmentation->GetSlicedGeometry()->IndexToWorld(origin, origin);
+        reslicePlane->SetOrigin(origin);
+
         // Setting up the reslicing pipeline which allows us to write the interpolation results back into
         // the image volume
         vtkSmartPointer<mitkVtkImageOverwrite> reslice = vtkSmartPointer<mitkVtkImageOverwrite>::New();
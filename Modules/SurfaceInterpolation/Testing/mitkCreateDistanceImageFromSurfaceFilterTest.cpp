@@ -18,17 +18,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkCreateDistanceImageFromSurfaceFilter.h>
 #include <mitkIOUtil.h>
 #include <mitkImageAccessByItk.h>
+#include <mitkImageReadAccessor.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingMacros.h>
 
 #include <vtkDebugLeaks.h>
 
+#include <chrono>
+
 class mitkCreateDistanceImageFromSurfaceFilterTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkCreateDistanceImageFromSurfaceFilterTestSuite);
   vtkDebugLeaks::SetExitError(0);
   MITK_TEST(TestCreateDistanceImageForLiver);
   MITK_TEST(TestCreateDistanceImageForTube);
+  MITK_TEST(TestCreateDistanceImageForLiverWithCompactlySupportedRBF);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -131,6 +135,73 @@ public:
     CPPUNIT_ASSERT_MESSAGE("HolesDistanceImages are not equal!",
                            mitk::Equal(*(holesDistanceImageReference), *(holeDistanceImage), 0.0001, true));
   }
+
+  // The compactly supported RBF gives a different distance function, but the same inside and outside
+  void TestCreateDistanceImageForLiverWithCompactlySupportedRBF()
+  {
+    unsigned int NUMBER_OF_LIVER_CONTOURS = 18;
+
+    for (unsigned int i = 0; i <= NUMBER_OF_LIVER_CONTOURS; ++i)
+    {
+      std::stringstream s;
+      s << "SurfaceInterpolation/InterpolateLiver/LiverContourWithNormals_";
+      s << i;
+      s << ".vtk";
+      mitk::Surface::Pointer contour = mitk::IOUtil::Load<mitk::Surface>(GetTestDataFilePath(s.str()));
+      contourList.push_back(contour);
+    }
+
+    mitk::Image::Pointer segmentationImage =
+      mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("SurfaceInterpolation/Reference/LiverSegmentation.nrrd"));
+
+    mitk::ComputeContourSetNormalsFilter::Pointer m_NormalsFilter = mitk::ComputeContourSetNormalsFilter::New();
+    mitk::CreateDistanceImageFromSurfaceFilter::Pointer m_InterpolateSurfaceFilter =
+      mitk::CreateDistanceImageFromSurfaceFilter::New();
+    m_InterpolateSurfaceFilter->UseCompactlySupportedRBFOn();
+
+    itk::ImageBase<3>::Pointer itkImage = itk::ImageBase<3>::New();
+    AccessFixedDimensionByItk_1(segmentationImage, GetImageBase, 3, itkImage);
+    m_InterpolateSurfaceFilter->SetReferenceImage(itkImage.GetPointer());
+
+    for (unsigned int j = 0; j < contourList.size(); j++)
+    {
+      m_NormalsFilter->SetInput(j, contourList.at(j));
+      m_InterpolateSurfaceFilter->SetInput(j, m_NormalsFilter->GetOutput(j));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    m_InterpolateSurfaceFilter->Update();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    MITK_INFO << "Liver distance image with compactly supported RBF: " << ms << " ms";
+
+    mitk::Image::Pointer liverDistanceImage = m_InterpolateSurfaceFilter->GetOutput();
+    CPPUNIT_ASSERT(liverDistanceImage.IsNotNull());
+
+    mitk::Image::Pointer liverDistanceImageReference =
+      mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("SurfaceInterpolation/Reference/LiverDistanceImage.nrrd"));
+
+    std::size_t numberOfPixels = 1;
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+      CPPUNIT_ASSERT_EQUAL(liverDistanceImageReference->GetDimension(dim), liverDistanceImage->GetDimension(dim));
+      numberOfPixels *= liverDistanceImage->GetDimension(dim);
+    }
+
+    mitk::ImageReadAccessor referenceAccessor(liverDistanceImageReference);
+    mitk::ImageReadAccessor accessor(liverDistanceImage);
+    auto referenceData = static_cast<const double *>(referenceAccessor.GetData());
+    auto data = static_cast<const double *>(accessor.GetData());
+
+    std::size_t differentSigns = 0;
+    for (std::size_t i = 0; i < numberOfPixels; ++i)
+    {
+      if ((referenceData[i] < 0) != (data[i] < 0))
+        ++differentSigns;
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Inside and outside of the liver differ too much from the reference!",
+                           differentSigns < numberOfPixels / 50);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkCreateDistanceImageFromSurfaceFilter)
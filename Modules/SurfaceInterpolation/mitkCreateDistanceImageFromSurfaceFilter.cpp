@@ -24,9 +24,49 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkSmartPointer.h"
 
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkNeighborhoodIterator.h"
 
-#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <tuple>
+
+namespace
+{
+  /// Wendland function Phi(r) = (1 - r)^4 * (4r + 1) for r < 1, r is the distance divided by the support radius
+  inline double WendlandFunction(double r)
+  {
+    double oneMinusR = 1.0 - r;
+    double oneMinusRSquared = oneMinusR * oneMinusR;
+    return oneMinusRSquared * oneMinusRSquared * (4.0 * r + 1.0);
+  }
+
+  /// calls function(centerId) for all centers in the cells around p (including the cell of p)
+  template <typename GridType, typename FunctionType>
+  void ForEachCenterInNeighborCells(const GridType &grid, const double *p, const FunctionType &function)
+  {
+    int cell[3];
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      cell[d] = static_cast<int>(std::floor((p[d] - grid.origin[d]) / grid.cellSize));
+      if (cell[d] < -1 || cell[d] > grid.dimensions[d])
+        return; // p is farther than one cell from all centers
+    }
+
+    for (int z = std::max(cell[2] - 1, 0); z <= std::min(cell[2] + 1, grid.dimensions[2] - 1); ++z)
+    {
+      for (int y = std::max(cell[1] - 1, 0); y <= std::min(cell[1] + 1, grid.dimensions[1] - 1); ++y)
+      {
+        for (int x = std::max(cell[0] - 1, 0); x <= std::min(cell[0] + 1, grid.dimensions[0] - 1); ++x)
+        {
+          int cellIndex = x + grid.dimensions[0] * (y + grid.dimensions[1] * z);
+          for (unsigned int i = grid.cellStart[cellIndex]; i < grid.cellStart[cellIndex + 1]; ++i)
+            function(grid.centerIds[i]);
+        }
+      }
+    }
+  }
+}
 
 void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 {
@@ -109,6 +149,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 }
 
 mitk::CreateDistanceImageFromSurfaceFilter::CreateDistanceImageFromSurfaceFilter()
+  : m_UseCompactlySupportedRBF(false), m_SupportRadius(0.0), m_CurrentSupportRadius(0.0)
 {
   m_DistanceImageVolume = 50000;
   this->m_UseProgressBar = false;
@@ -133,7 +174,20 @@ void mitk::CreateDistanceImageFromSurfaceFilter::GenerateData()
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(1);
 
-  m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  if (m_UseCompactlySupportedRBF)
+  {
+    // the Wendland function is positive definite, so the sparse matrix can be factorized with a Cholesky decomposition
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(m_SparseSolutionMatrix);
+    if (solver.info() != Eigen::Success)
+    {
+      itkExceptionMacro("mitk::CreateDistanceImageFromSurfaceFilter: Could not factorize the sparse equation system!");
+    }
+    m_Weights = solver.solve(m_FunctionValues);
+  }
+  else
+  {
+    m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  }
 
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(2);
@@ -146,6 +200,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::GenerateData()
 
   m_Centers.clear();
   m_Normals.clear();
+  m_ContourIds.clear();
 }
 
 void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
@@ -171,6 +226,9 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
   PointType currentPoint;
   PointType normal;
 
+  // the points which are already stored in m_Centers
+  std::set<std::tuple<double, double, double>> existingCenters;
+
   for (unsigned int i = 0; i < numberOfInputs; i++)
   {
     auto currentSurface = this->GetInput(i);
@@ -202,9 +260,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
 
         currentPoint.copy_in(p);
 
-        int count = std::count(m_Centers.begin(), m_Centers.end(), currentPoint);
-
-        if (count == 0)
+        if (existingCenters.insert(std::make_tuple(p[0], p[1], p[2])).second)
         {
           double currentNormal[3];
           currentCellNormals->GetTuple(cell[j], currentNormal);
@@ -214,6 +270,8 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
           m_Normals.push_back(normal);
 
           m_Centers.push_back(currentPoint);
+
+          m_ContourIds.push_back(i);
         }
 
       } // end for all points
@@ -267,47 +325,202 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateSolutionMatrixAndFunction
   // Now we have created all centers and all function values. Next step is to create the solution matrix
   numberOfCenters = m_Centers.size();
 
-  m_SolutionMatrix.resize(numberOfCenters, numberOfCenters);
-
   m_Weights.resize(numberOfCenters);
 
-  PointType p1;
-  PointType p2;
-  double norm;
+  if (m_UseCompactlySupportedRBF)
+  {
+    m_SolutionMatrix.resize(0, 0);
+    this->CreateSparseSolutionMatrix();
+    return;
+  }
 
-  for (unsigned int i = 0; i < numberOfCenters; i++)
+  m_SolutionMatrix.resize(numberOfCenters, numberOfCenters);
+
+  const int numberOfRows = static_cast<int>(numberOfCenters);
+#pragma omp parallel for
+  for (int i = 0; i < numberOfRows; i++)
   {
     for (unsigned int j = 0; j < numberOfCenters; j++)
     {
       // Calculate the RBF value. Currently using Phi(r) = r with r is the euclidian distance between two points
-      p1 = m_Centers.at(i);
-      p2 = m_Centers.at(j);
-      p1 = p1 - p2;
-      norm = p1.two_norm();
-      m_SolutionMatrix(i, j) = norm;
+      m_SolutionMatrix(i, j) = (m_Centers[i] - m_Centers[j]).two_norm();
     }
   }
 }
 
+void mitk::CreateDistanceImageFromSurfaceFilter::CreateSparseSolutionMatrix()
+{
+  m_CurrentSupportRadius = this->DetermineSupportRadius();
+  BuildCenterGrid(m_Centers, m_Centers.size(), m_CurrentSupportRadius, m_CenterGrid);
+
+  const int numberOfCenters = static_cast<int>(m_Centers.size());
+  std::vector<std::vector<Eigen::Triplet<double>>> rows(numberOfCenters);
+
+#pragma omp parallel for
+  for (int i = 0; i < numberOfCenters; i++)
+  {
+    const PointType &center = m_Centers[i];
+    ForEachCenterInNeighborCells(m_CenterGrid, center.data_block(), [&](unsigned int j) {
+      double r = (center - m_Centers[j]).two_norm() / m_CurrentSupportRadius;
+      if (r < 1.0)
+        rows[i].emplace_back(i, j, WendlandFunction(r));
+    });
+  }
+
+  std::size_t numberOfEntries = 0;
+  for (const auto &row : rows)
+    numberOfEntries += row.size();
+
+  std::vector<Eigen::Triplet<double>> entries;
+  entries.reserve(numberOfEntries);
+  for (const auto &row : rows)
+    entries.insert(entries.end(), row.begin(), row.end());
+
+  m_SparseSolutionMatrix.resize(numberOfCenters, numberOfCenters);
+  m_SparseSolutionMatrix.setFromTriplets(entries.begin(), entries.end());
+
+  MITK_DEBUG << "Sparse RBF system with " << numberOfCenters << " centers, " << numberOfEntries
+             << " non-zero entries and support radius " << m_CurrentSupportRadius;
+}
+
+double mitk::CreateDistanceImageFromSurfaceFilter::DetermineSupportRadius() const
+{
+  if (m_SupportRadius > 0.0)
+    return m_SupportRadius;
+
+  const double minimumRadius = 4 * m_DistanceImageSpacing;
+  const unsigned int numberOfContourPoints = m_ContourIds.size();
+
+  // for each contour point, find the nearest point of another contour by searching the cells ring by ring
+  CenterGrid grid;
+  BuildCenterGrid(m_Centers, numberOfContourPoints, 2 * m_DistanceImageSpacing, grid);
+  const int maximumRing = std::max(grid.dimensions[0], std::max(grid.dimensions[1], grid.dimensions[2]));
+
+  std::vector<double> nearestDistances(numberOfContourPoints, std::numeric_limits<double>::max());
+
+#pragma omp parallel for
+  for (int i = 0; i < static_cast<int>(numberOfContourPoints); i++)
+  {
+    const PointType &point = m_Centers[i];
+    int cell[3];
+    for (unsigned int d = 0; d < 3; ++d)
+      cell[d] = static_cast<int>(std::floor((point[d] - grid.origin[d]) / grid.cellSize));
+
+    double &nearest = nearestDistances[i];
+    // points in ring k are at least (k - 1) cells away
+    for (int ring = 0; ring <= maximumRing && (ring - 1) * grid.cellSize <= nearest; ++ring)
+    {
+      for (int z = std::max(cell[2] - ring, 0); z <= std::min(cell[2] + ring, grid.dimensions[2] - 1); ++z)
+      {
+        for (int y = std::max(cell[1] - ring, 0); y <= std::min(cell[1] + ring, grid.dimensions[1] - 1); ++y)
+        {
+          for (int x = std::max(cell[0] - ring, 0); x <= std::min(cell[0] + ring, grid.dimensions[0] - 1); ++x)
+          {
+            if (std::abs(x - cell[0]) != ring && std::abs(y - cell[1]) != ring && std::abs(z - cell[2]) != ring)
+              continue; // inner cell, already checked
+
+            int cellIndex = x + grid.dimensions[0] * (y + grid.dimensions[1] * z);
+            for (unsigned int k = grid.cellStart[cellIndex]; k < grid.cellStart[cellIndex + 1]; ++k)
+            {
+              unsigned int j = grid.centerIds[k];
+              if (m_ContourIds[j] != m_ContourIds[i])
+                nearest = std::min(nearest, (point - m_Centers[j]).two_norm());
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<double> distances;
+  for (double distance : nearestDistances)
+  {
+    if (distance < std::numeric_limits<double>::max())
+      distances.push_back(distance);
+  }
+
+  // a single contour has no neighbors
+  if (distances.empty())
+    return 2 * minimumRadius;
+
+  auto quantile = distances.begin() + (distances.size() * 95) / 100;
+  if (quantile == distances.end())
+    --quantile;
+  std::nth_element(distances.begin(), quantile, distances.end());
+
+  return std::max(minimumRadius, 1.5 * (*quantile));
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::BuildCenterGrid(const CenterList &centers,
+                                                                 unsigned int numberOfCenters,
+                                                                 double cellSize,
+                                                                 CenterGrid &grid)
+{
+  double minimum[3] = {0.0, 0.0, 0.0};
+  double maximum[3] = {0.0, 0.0, 0.0};
+  for (unsigned int i = 0; i < numberOfCenters; ++i)
+  {
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      if (i == 0 || centers[i][d] < minimum[d])
+        minimum[d] = centers[i][d];
+      if (i == 0 || centers[i][d] > maximum[d])
+        maximum[d] = centers[i][d];
+    }
+  }
+
+  // limit the number of cells for very small cell sizes, larger cells only mean that more centers are checked
+  double maximumExtent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+  grid.cellSize = std::max(cellSize, maximumExtent / 256.0);
+  if (grid.cellSize <= 0.0)
+    grid.cellSize = 1.0;
+
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    grid.origin[d] = minimum[d];
+    grid.dimensions[d] = static_cast<int>((maximum[d] - minimum[d]) / grid.cellSize) + 1;
+  }
+
+  // counting sort of the centers by cell
+  std::vector<unsigned int> cellOfCenter(numberOfCenters);
+  grid.cellStart.assign(grid.dimensions[0] * grid.dimensions[1] * grid.dimensions[2] + 1, 0);
+  for (unsigned int i = 0; i < numberOfCenters; ++i)
+  {
+    int cell[3];
+    for (unsigned int d = 0; d < 3; ++d)
+      cell[d] = std::min(static_cast<int>((centers[i][d] - grid.origin[d]) / grid.cellSize), grid.dimensions[d] - 1);
+    cellOfCenter[i] = cell[0] + grid.dimensions[0] * (cell[1] + grid.dimensions[1] * cell[2]);
+    ++grid.cellStart[cellOfCenter[i] + 1];
+  }
+  for (std::size_t cell = 1; cell < grid.cellStart.size(); ++cell)
+    grid.cellStart[cell] += grid.cellStart[cell - 1];
+
+  std::vector<unsigned int> nextPosition(grid.cellStart.begin(), grid.cellStart.end() - 1);
+  grid.centerIds.resize(numberOfCenters);
+  for (unsigned int i = 0; i < numberOfCenters; ++i)
+    grid.centerIds[nextPosition[cellOfCenter[i]]++] = i;
+}
+
 void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
 {
   /*
   * Now we must calculate the distance for each pixel. But instead of calculating the distance value
   * for all of the image's pixels we proceed similar to the region growing algorithm:
   *
-  * 1. Take the first pixel from the narrowband_point_list and calculate the distance for each neighbor (6er)
-  * 2. If the current index's distance value is below a certain threshold push it into the list
-  * 3. Next iteration take the next index from the list and originAsIndex with 1. again
+  * 1. Take the pixels of the current narrowband front and calculate the distance for each neighbor (6er)
+  * 2. If the current index's distance value is below a certain threshold push it into the next front
+  * 3. Next iteration take the next front and start with 1. again
   *
-  * This is done until the narrowband_point_list is empty.
+  * This is done until the front is empty. The distances of all pixels of a front are independent
+  * of each other and are calculated in parallel. A pixel that was rejected once would be rejected
+  * again, so each pixel is checked only once.
   */
 
   typedef itk::ImageRegionIteratorWithIndex<DistanceImageType> ImageIterator;
-  typedef itk::NeighborhoodIterator<DistanceImageType> NeighborhoodImageIterator;
 
-  std::queue<DistanceImageType::IndexType> narrowbandPoints;
   PointType currentPoint = m_Centers.at(0);
-  double distance = this->CalculateDistanceValue(currentPoint);
+  bool supported(true);
+  double distance = this->CalculateDistanceValue(currentPoint, supported);
 
   // create itk::Point from vnl_vector
   DistanceImageType::PointType currentPointAsPoint;
@@ -319,49 +532,75 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   DistanceImageType::IndexType currentIndex;
   m_DistanceImageITK->TransformPhysicalPointToIndex(currentPointAsPoint, currentIndex);
 
-  assert(
-    m_DistanceImageITK->GetLargestPossibleRegion().IsInside(currentIndex)); // we are quite certain this should hold
+  const DistanceImageType::RegionType region = m_DistanceImageITK->GetLargestPossibleRegion();
+  assert(region.IsInside(currentIndex)); // we are quite certain this should hold
 
-  narrowbandPoints.push(currentIndex);
   m_DistanceImageITK->SetPixel(currentIndex, distance);
 
-  NeighborhoodImageIterator::RadiusType radius;
-  radius.Fill(1);
-  NeighborhoodImageIterator nIt(radius, m_DistanceImageITK, m_DistanceImageITK->GetLargestPossibleRegion());
-  unsigned int relativeNbIdx[] = {4, 10, 12, 14, 16, 22};
+  std::vector<bool> checkedPixels(region.GetNumberOfPixels(), false);
+  checkedPixels[m_DistanceImageITK->ComputeOffset(currentIndex)] = true;
 
-  bool isInBounds = false;
-  while (!narrowbandPoints.empty())
-  {
-    nIt.SetLocation(narrowbandPoints.front());
-    narrowbandPoints.pop();
+  std::vector<DistanceImageType::IndexType> narrowbandFront(1, currentIndex);
+  std::vector<DistanceImageType::IndexType> candidates;
+  std::vector<double> candidateDistances;
+  std::vector<char> candidateAccepted;
 
-    unsigned int *relativeNb = &relativeNbIdx[0];
-    for (int i = 0; i < 6; i++)
+  while (!narrowbandFront.empty())
+  {
+    candidates.clear();
+    for (const auto &frontIndex : narrowbandFront)
     {
-      nIt.GetPixel(*relativeNb, isInBounds);
-      if (isInBounds && nIt.GetPixel(*relativeNb) == m_DistanceImageDefaultBufferValue)
+      for (unsigned int dim = 0; dim < 3; ++dim)
       {
-        currentIndex = nIt.GetIndex(*relativeNb);
-
-        // Transform the currently checked point from index-coordinates to
-        // world-coordinates
-        m_DistanceImageITK->TransformIndexToPhysicalPoint(currentIndex, currentPointAsPoint);
+        for (int step = -1; step <= 1; step += 2)
+        {
+          currentIndex = frontIndex;
+          currentIndex[dim] += step;
+          if (!region.IsInside(currentIndex))
+            continue;
 
-        // create a vnl_vector
-        currentPoint[0] = currentPointAsPoint[0];
-        currentPoint[1] = currentPointAsPoint[1];
-        currentPoint[2] = currentPointAsPoint[2];
+          auto offset = m_DistanceImageITK->ComputeOffset(currentIndex);
+          if (checkedPixels[offset] || m_DistanceImageITK->GetPixel(currentIndex) != m_DistanceImageDefaultBufferValue)
+            continue;
 
-        // and check the distance
-        distance = this->CalculateDistanceValue(currentPoint);
-        if (std::fabs(distance) <= m_DistanceImageSpacing * 2)
-        {
-          nIt.SetPixel(*relativeNb, distance);
-          narrowbandPoints.push(currentIndex);
+          checkedPixels[offset] = true;
+          candidates.push_back(currentIndex);
         }
       }
-      relativeNb++;
+    }
+
+    const int numberOfCandidates = static_cast<int>(candidates.size());
+    candidateDistances.resize(numberOfCandidates);
+    candidateAccepted.resize(numberOfCandidates);
+
+#pragma omp parallel for
+    for (int i = 0; i < numberOfCandidates; ++i)
+    {
+      // Transform the currently checked point from index-coordinates to
+      // world-coordinates
+      DistanceImageType::PointType candidatePoint;
+      m_DistanceImageITK->TransformIndexToPhysicalPoint(candidates[i], candidatePoint);
+
+      // create a vnl_vector
+      PointType p;
+      p[0] = candidatePoint[0];
+      p[1] = candidatePoint[1];
+      p[2] = candidatePoint[2];
+
+      // and check the distance
+      bool supported(true);
+      candidateDistances[i] = this->CalculateDistanceValue(p, supported);
+      candidateAccepted[i] = supported && std::fabs(candidateDistances[i]) <= m_DistanceImageSpacing * 2;
+    }
+
+    narrowbandFront.clear();
+    for (int i = 0; i < numberOfCandidates; ++i)
+    {
+      if (candidateAccepted[i])
+      {
+        m_DistanceImageITK->SetPixel(candidates[i], candidateDistances[i]);
+        narrowbandFront.push_back(candidates[i]);
+      }
     }
   }
 
@@ -422,14 +661,14 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   CastToMitkImage(m_DistanceImageITK, resultImage);
 }
 
-double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(PointType p)
+double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(PointType p) const
 {
   double distanceValue(0);
   PointType p1;
   PointType p2;
   double norm;
 
-  CenterList::iterator centerIter;
+  CenterList::const_iterator centerIter;
 
   unsigned int count(0);
   for (centerIter = m_Centers.begin(); centerIter != m_Centers.end(); centerIter++)
@@ -443,12 +682,36 @@ double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(PointT
   return distanceValue;
 }
 
+double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(const PointType &p, bool &supported) const
+{
+  if (!m_UseCompactlySupportedRBF)
+  {
+    supported = true;
+    return this->CalculateDistanceValue(p);
+  }
+
+  double distanceValue(0);
+  supported = false;
+  ForEachCenterInNeighborCells(m_CenterGrid, p.data_block(), [&](unsigned int centerId) {
+    double r = (p - m_Centers[centerId]).two_norm() / m_CurrentSupportRadius;
+    if (r < 1.0)
+    {
+      distanceValue += WendlandFunction(r) * m_Weights[centerId];
+      supported = true;
+    }
+  });
+  return distanceValue;
+}
+
 void mitk::CreateDistanceImageFromSurfaceFilter::GenerateOutputInformation()
 {
 }
 
 void mitk::CreateDistanceImageFromSurfaceFilter::PrintEquationSystem()
 {
+  if (m_UseCompactlySupportedRBF)
+    m_SolutionMatrix = Eigen::MatrixXd(m_SparseSolutionMatrix);
+
   std::stringstream out;
   out << "Nummber of rows: " << m_SolutionMatrix.rows() << " ****** Number of columns: " << m_SolutionMatrix.cols()
       << endl;
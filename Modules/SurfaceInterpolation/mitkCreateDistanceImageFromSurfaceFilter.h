@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImageBase.h"
 
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 
 namespace mitk
 {
@@ -56,6 +57,12 @@ namespace mitk
          with the marching cubes algorithm. (Within the  distance image the surface goes exactly where the pixelvalues
   are zero)
 
+         By default the radial basis function Phi(r) = r is used, which leads to a dense equation system. For contours
+         with many points, SetUseCompactlySupportedRBF(true) switches to the Wendland function
+         Phi(r) = (1 - r/R)^4 * (4r/R + 1), which is zero beyond the support radius R. The equation system is then
+         sparse and each pixel only depends on the centers within R, which are found with a uniform grid.
+         R has to span the gaps between neighboring contours, see SetSupportRadius().
+
          Note that the obtained distance image has always an isotropig spacing. The size (in this case volume) of the
   image can be
          adjusted by calling SetDistanceImageVolume(unsigned int volume) which specifies the number ob pixels enclosed
@@ -103,6 +110,22 @@ namespace mitk
     */
     itkSetMacro(DistanceImageVolume, unsigned int);
 
+    /**
+    \brief Use the compactly supported Wendland function instead of Phi(r) = r. Default is false.
+    */
+    itkSetMacro(UseCompactlySupportedRBF, bool);
+    itkGetMacro(UseCompactlySupportedRBF, bool);
+    itkBooleanMacro(UseCompactlySupportedRBF);
+
+    /**
+    \brief Set the support radius (in mm) of the compactly supported RBF.
+
+    If the radius is 0 (default), it is set to 1.5 times the distance to the nearest point on another contour
+    that 95% of the contour points do not exceed, but at least 4 times the spacing of the distance image.
+    */
+    itkSetMacro(SupportRadius, double);
+    itkGetMacro(SupportRadius, double);
+
     void PrintEquationSystem();
 
     // Resets the filter, i.e. removes all inputs and outputs
@@ -131,8 +154,28 @@ namespace mitk
     void GenerateOutputInformation() override;
 
   private:
+    /**
+    \brief Uniform grid over the centers with cells of the size of the support radius, so only
+    the centers in the 27 cells around a point have to be checked.
+    */
+    struct CenterGrid
+    {
+      double origin[3];
+      double cellSize;
+      int dimensions[3];
+      std::vector<unsigned int> cellStart; ///< first position of each cell in centerIds
+      std::vector<unsigned int> centerIds; ///< ids of the centers, sorted by cell
+    };
+
     void CreateSolutionMatrixAndFunctionValues();
-    double CalculateDistanceValue(PointType p);
+    void CreateSparseSolutionMatrix();
+    double CalculateDistanceValue(PointType p) const;
+
+    /// for the compactly supported RBF, supported is false if no center is within the support radius
+    double CalculateDistanceValue(const PointType &p, bool &supported) const;
+
+    double DetermineSupportRadius() const;
+    static void BuildCenterGrid(const CenterList &centers, unsigned int numberOfCenters, double cellSize, CenterGrid &grid);
 
     void FillDistanceImage();
 
@@ -162,10 +205,18 @@ namespace mitk
     CenterList m_Centers;
     NormalList m_Normals;
 
+    std::vector<unsigned int> m_ContourIds; ///< input index of each contour point
+
     Eigen::MatrixXd m_SolutionMatrix;
+    Eigen::SparseMatrix<double> m_SparseSolutionMatrix;
     Eigen::VectorXd m_FunctionValues;
     Eigen::VectorXd m_Weights;
 
+    bool m_UseCompactlySupportedRBF;
+    double m_SupportRadius;
+    double m_CurrentSupportRadius;
+    CenterGrid m_CenterGrid;
+
     DistanceImageType::Pointer m_DistanceImageITK;
     itk::ImageBase<3>::Pointer m_ReferenceImage;
 
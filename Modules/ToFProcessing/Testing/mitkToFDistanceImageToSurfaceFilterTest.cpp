@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkImage.h>
 #include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
 #include <mitkImageGenerator.h>
 #include <mitkSurface.h>
 #include <mitkToFProcessingCommon.h>
@@ -379,6 +380,45 @@ int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
   }
   MITK_TEST_CONDITION_REQUIRED(compareToInput,"Testing backward transformation compared to original image with interpixeldistance");
 
+  // the topology of the mesh is reused as long as the same pixels are valid
+  filter->SetTriangulationThreshold(0.0);
+  filter->SetGenerateTriangularMesh(true);
+  filter->Modified();
+  filter->Update();
+  vtkSmartPointer<vtkPolyData> firstMesh = filter->GetOutput()->GetVtkPolyData();
+  mitk::Image::Pointer scaledImage = image->Clone();
+  {
+    mitk::ImagePixelWriteAccessor<float,2> writeAccess(scaledImage, scaledImage->GetSliceData());
+    for (unsigned int j=0; j<dimY; j++)
+    {
+      for (unsigned int i=0; i<dimX; i++)
+      {
+        itk::Index<2> index = {{ static_cast<itk::IndexValueType>(i), static_cast<itk::IndexValueType>(j) }};
+        writeAccess.SetPixelByIndex(index, 2.0f*writeAccess.GetPixelByIndex(index) + 1.0f);
+      }
+    }
+  }
+  filter->SetInput(scaledImage);
+  filter->Update();
+  vtkSmartPointer<vtkPolyData> secondMesh = filter->GetOutput()->GetVtkPolyData();
+  MITK_TEST_CONDITION_REQUIRED(firstMesh->GetPolys() == secondMesh->GetPolys(),"Testing reuse of the triangles for an unchanged validity mask");
+  MITK_TEST_CONDITION_REQUIRED(firstMesh->GetNumberOfPoints() == secondMesh->GetNumberOfPoints(),"Testing number of points for an unchanged validity mask");
+
+  vtkIdType idBehindPixel = filter->GetVertexIdList()->GetId(10+10*dimX+1);
+
+  // invalidating a pixel removes its point and the triangles using it
+  {
+    mitk::ImagePixelWriteAccessor<float,2> writeAccess(scaledImage, scaledImage->GetSliceData());
+    itk::Index<2> index = {{ 10, 10 }};
+    writeAccess.SetPixelByIndex(index, 0.0f);
+  }
+  scaledImage->Modified();
+  filter->Update();
+  vtkSmartPointer<vtkPolyData> thirdMesh = filter->GetOutput()->GetVtkPolyData();
+  MITK_TEST_CONDITION_REQUIRED(thirdMesh->GetNumberOfPoints() == secondMesh->GetNumberOfPoints()-1,"Testing number of points after invalidating a pixel");
+  MITK_TEST_CONDITION_REQUIRED(thirdMesh->GetNumberOfPolys() == secondMesh->GetNumberOfPolys()-8,"Testing number of triangles after invalidating a pixel");
+  MITK_TEST_CONDITION_REQUIRED(filter->GetVertexIdList()->GetId(10+10*dimX+1) == idBehindPixel-1,"Testing vertex IDs after invalidating a pixel");
+
   //clean up
   delete[] point;
   //  expectedResult->Delete();
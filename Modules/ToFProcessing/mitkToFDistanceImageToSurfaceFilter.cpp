@@ -29,13 +29,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <vtkMath.h>
 
 mitk::ToFDistanceImageToSurfaceFilter::ToFDistanceImageToSurfaceFilter() :
   m_IplScalarImage(nullptr), m_CameraIntrinsics(), m_TextureImageWidth(0), m_TextureImageHeight(0), m_InterPixelDistance(), m_TextureIndex(0),
-  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0)
+  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0), m_CachedTopologyMode(NoTopology)
 {
+  m_MaskDimensions[0] = -1;
+  m_MaskDimensions[1] = -1;
   m_InterPixelDistance.Fill(0.045);
   m_CameraIntrinsics = mitk::CameraIntrinsics::New();
   m_CameraIntrinsics->SetFocalLength(273.138946533,273.485900879);
@@ -89,6 +93,83 @@ mitk::Image* mitk::ToFDistanceImageToSurfaceFilter::GetInput( unsigned int idx )
   return static_cast< mitk::Image*>(this->ProcessObject::GetInput(idx));
 }
 
+void mitk::ToFDistanceImageToSurfaceFilter::UpdateRayTable(int xDimension, int yDimension, const mitk::Point3D& origin, const mitk::Vector3D& spacing)
+{
+  std::vector<double> parameters = { static_cast<double>(m_ReconstructionMode),
+                                     static_cast<double>(xDimension), static_cast<double>(yDimension),
+                                     origin[0], origin[1], spacing[0], spacing[1],
+                                     m_CameraIntrinsics->GetFocalLengthX(), m_CameraIntrinsics->GetFocalLengthY(),
+                                     m_CameraIntrinsics->GetPrincipalPointX(), m_CameraIntrinsics->GetPrincipalPointY(),
+                                     m_InterPixelDistance[0], m_InterPixelDistance[1] };
+  if (parameters == m_RayTableParameters)
+  {
+    return;
+  }
+
+  const double focalLengthX = m_CameraIntrinsics->GetFocalLengthX();
+  const double focalLengthY = m_CameraIntrinsics->GetFocalLengthY();
+  const double principalPointX = m_CameraIntrinsics->GetPrincipalPointX();
+  const double principalPointY = m_CameraIntrinsics->GetPrincipalPointY();
+  //convert focallength from pixel to mm
+  const double focalLengthInMm = (focalLengthX*m_InterPixelDistance[0]+focalLengthY*m_InterPixelDistance[1])/2.0;
+
+  m_RayTable.resize(3*static_cast<std::size_t>(xDimension)*yDimension);
+  if ((m_ReconstructionMode != WithOutInterPixelDistance) && (m_ReconstructionMode != WithInterPixelDistance) && (m_ReconstructionMode != Kinect))
+  {
+    MITK_ERROR << "Incorrect reconstruction mode!";
+    std::fill(m_RayTable.begin(), m_RayTable.end(), 0.0);
+  }
+  else
+  {
+#pragma omp parallel for
+    for (int j = 0; j < yDimension; j++)
+    {
+      for (int i = 0; i < xDimension; i++)
+      {
+        double* ray = &m_RayTable[3*(static_cast<std::size_t>(j)*xDimension+i)];
+
+        /** Here we have to incorporate spacing and origin to allow processing of cropped/resampled images
+        * Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but just in case the image is moved
+        * due to cropping or the spacing differes due to up- or downsampling.*/
+        unsigned int completeIndexX = i*spacing[0]+origin[0];
+        unsigned int completeIndexY = j*spacing[1]+origin[1];
+
+        // The same formulas as in ToFProcessingCommon, evaluated for a distance of 1
+        switch (m_ReconstructionMode)
+        {
+        case WithOutInterPixelDistance:
+        {
+          double imageX = completeIndexX - principalPointX;
+          double imageY_in_pX = (completeIndexY - principalPointY) * (focalLengthX / focalLengthY);
+          double d_in_pX = sqrt(imageX*imageX + imageY_in_pX*imageY_in_pX + focalLengthX*focalLengthX);
+          ray[0] = imageX / d_in_pX;
+          ray[1] = imageY_in_pX / d_in_pX;
+          ray[2] = focalLengthX / d_in_pX;
+          break;
+        }
+        case WithInterPixelDistance:
+        {
+          double imageX = (completeIndexX - principalPointX) * m_InterPixelDistance[0];
+          double imageY = (completeIndexY - principalPointY) * m_InterPixelDistance[1];
+          double d = sqrt(imageX*imageX + imageY*imageY + focalLengthInMm*focalLengthInMm);
+          ray[0] = imageX / d;
+          ray[1] = imageY / d;
+          ray[2] = focalLengthInMm / d;
+          break;
+        }
+        default: // Kinect
+        {
+          ray[0] = (completeIndexX - principalPointX) / focalLengthX;
+          ray[1] = (completeIndexY - principalPointY) / focalLengthY;
+          ray[2] = 1.0;
+        }
+        }
+      }
+    }
+  }
+  m_RayTableParameters.swap(parameters);
+}
+
 void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
 {
   mitk::Surface::Pointer output = this->GetOutput();
@@ -98,217 +179,208 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   // mesh points
   int xDimension = input->GetDimension(0);
   int yDimension = input->GetDimension(1);
-  unsigned int size = xDimension*yDimension; //size of the image-array
-  std::vector<bool> isPointValid;
-  isPointValid.resize(size);
-  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-  points->SetDataTypeToDouble();
-  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkCellArray> vertices = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
-  vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
-  textureCoords->SetNumberOfComponents(2);
-  textureCoords->Allocate(size);
-
-  //Make a vtkIdList to save the ID's of the polyData corresponding to the image
-  //pixel ID's. See below for more documentation.
-  m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
-  //Allocate the object once else it would automatically allocate new memory
-  //for every vertex and perform a copy which is expensive.
-  m_VertexIdList->Allocate(size);
-  m_VertexIdList->SetNumberOfIds(size);
-  for(unsigned int i = 0; i < size; ++i)
-  {
-    m_VertexIdList->SetId(i, 0);
-  }
+  int size = xDimension*yDimension; //size of the image-array
 
   float* scalarFloatData = nullptr;
-
+  std::unique_ptr<ImageReadAccessor> textureAcc;
   if (this->m_IplScalarImage) // if scalar image is defined use it for texturing
   {
     scalarFloatData = (float*)this->m_IplScalarImage->imageData;
   }
   else if (this->GetInput(m_TextureIndex)) // otherwise use intensity image (input(2))
   {
-    ImageReadAccessor inputAcc(this->GetInput(m_TextureIndex));
-    scalarFloatData = (float*)inputAcc.GetData();
+    textureAcc.reset(new ImageReadAccessor(this->GetInput(m_TextureIndex)));
+    scalarFloatData = (float*)textureAcc->GetData();
   }
 
   ImageReadAccessor inputAcc(input, input->GetSliceData(0,0,0));
-  float* inputFloatData = (float*)inputAcc.GetData();
-  //calculate world coordinates
-  mitk::ToFProcessingCommon::ToFPoint2D focalLengthInPixelUnits;
-  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm;
-  if((m_ReconstructionMode == WithOutInterPixelDistance) || (m_ReconstructionMode == Kinect))
+  const float* inputFloatData = (const float*)inputAcc.GetData();
+
+  this->UpdateRayTable(xDimension, yDimension, input->GetGeometry()->GetOrigin(), input->GetGeometry()->GetSpacing());
+
+  //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
+  std::vector<unsigned char> validityMask(size);
+#pragma omp parallel for
+  for (int pixelID = 0; pixelID < size; ++pixelID)
   {
-    focalLengthInPixelUnits[0] = m_CameraIntrinsics->GetFocalLengthX();
-    focalLengthInPixelUnits[1] = m_CameraIntrinsics->GetFocalLengthY();
-    focalLengthInMm = 0.0;
+    validityMask[pixelID] = !(static_cast<double>(inputFloatData[pixelID]) <= mitk::eps);
   }
-  else if( m_ReconstructionMode == WithInterPixelDistance)
+
+  // The vertex IDs and texture coordinates only depend on the validity mask, so they are
+  // recomputed only if the mask differs from the one of the previous frame.
+  bool maskChanged = (xDimension != m_MaskDimensions[0]) || (yDimension != m_MaskDimensions[1]) || (validityMask != m_ValidityMask);
+  if (maskChanged)
   {
-    //convert focallength from pixel to mm
-    focalLengthInPixelUnits[0] = 0.0;
-    focalLengthInPixelUnits[1] = 0.0;
-    focalLengthInMm = (m_CameraIntrinsics->GetFocalLengthX()*m_InterPixelDistance[0]+m_CameraIntrinsics->GetFocalLengthY()*m_InterPixelDistance[1])/2.0;
+    m_ValidityMask.swap(validityMask);
+    m_MaskDimensions[0] = xDimension;
+    m_MaskDimensions[1] = yDimension;
+
+    //VTK would insert empty points into the polydata if we use
+    //points->InsertPoint(pixelID, cartesianCoordinates.GetDataPointer()).
+    //Points are appended instead and thus the ID's do not correspond to the
+    //image pixel ID's. Thus, we have to save them in the vertexIdList.
+    m_CachedVertexIdList = vtkSmartPointer<vtkIdList>::New();
+    m_CachedVertexIdList->SetNumberOfIds(size);
+    vtkIdType* vertexIds = m_CachedVertexIdList->GetPointer(0);
+    vtkIdType numberOfPoints = 0;
+    for (int pixelID = 0; pixelID < size; ++pixelID)
+    {
+      vertexIds[pixelID] = m_ValidityMask[pixelID] ? numberOfPoints++ : 0;
+    }
+
+    //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
+    m_CachedTextureCoords = vtkSmartPointer<vtkFloatArray>::New();
+    m_CachedTextureCoords->SetNumberOfComponents(2);
+    m_CachedTextureCoords->SetNumberOfTuples(numberOfPoints);
+    float* textureCoordData = m_CachedTextureCoords->GetPointer(0);
+#pragma omp parallel for
+    for (int j = 0; j < yDimension; j++)
+    {
+      for (int i = 0; i < xDimension; i++)
+      {
+        int pixelID = i+j*xDimension;
+        if (m_ValidityMask[pixelID])
+        {
+          textureCoordData[2*vertexIds[pixelID]] = ((float)i)/xDimension; // correct video texture scale for kinect
+          textureCoordData[2*vertexIds[pixelID]+1] = ((float)j)/yDimension; //don't flip. we don't need to flip.
+        }
+      }
+    }
+    m_CachedTopologyMode = NoTopology;
   }
-  else
+  m_VertexIdList = m_CachedVertexIdList;
+  const vtkIdType* vertexIds = m_CachedVertexIdList->GetPointer(0);
+  const vtkIdType numberOfPoints = m_CachedTextureCoords->GetNumberOfTuples();
+
+  //calculate world coordinates: every point is the distance times the precomputed ray of its pixel
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numberOfPoints);
+  double* pointData = static_cast<double*>(points->GetData()->GetVoidPointer(0));
+  vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
+  float* scalarData = nullptr;
+  if (scalarFloatData)
+  {
+    //Scalar values are necessary for mapping colors/texture onto the surface
+    scalarArray->SetNumberOfValues(numberOfPoints);
+    scalarData = scalarArray->GetPointer(0);
+  }
+  const double* rayTable = m_RayTable.data();
+#pragma omp parallel for
+  for (int pixelID = 0; pixelID < size; ++pixelID)
   {
-    focalLengthInPixelUnits[0] = 0.0;
-    focalLengthInPixelUnits[1] = 0.0;
-    focalLengthInMm = 0.0;
+    if (m_ValidityMask[pixelID])
+    {
+      const double distance = inputFloatData[pixelID];
+      double* point = pointData + 3*vertexIds[pixelID];
+      const double* ray = rayTable + 3*static_cast<std::size_t>(pixelID);
+      point[0] = distance * ray[0];
+      point[1] = distance * ray[1];
+      point[2] = distance * ray[2];
+      if (scalarData)
+      {
+        scalarData[vertexIds[pixelID]] = scalarFloatData[pixelID];
+      }
+    }
   }
 
-  mitk::ToFProcessingCommon::ToFPoint2D principalPoint;
-  principalPoint[0] = m_CameraIntrinsics->GetPrincipalPointX();
-  principalPoint[1] = m_CameraIntrinsics->GetPrincipalPointY();
+  // Without a triangulation threshold the cells only depend on the validity mask as well
+  TopologyMode topologyMode = !m_GenerateTriangularMesh ? VertexTopology
+      : (mitk::Equal(m_TriangulationThreshold, 0.0) ? TriangleTopology : NoTopology);
+  if (topologyMode == NoTopology || topologyMode != m_CachedTopologyMode)
+  {
+    m_CachedPolys = vtkSmartPointer<vtkCellArray>::New();
+    m_CachedVertices = vtkSmartPointer<vtkCellArray>::New();
+    this->BuildTopology(xDimension, yDimension, pointData);
+    m_CachedTopologyMode = topologyMode;
+  }
 
-  mitk::Point3D origin = input->GetGeometry()->GetOrigin();
-  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->SetPoints(points);
+  mesh->SetPolys(m_CachedPolys);
+  mesh->SetVerts(m_CachedVertices);
+  //Pass the scalars to the polydata (if they were set).
+  if (scalarArray->GetNumberOfTuples()>0)
+  {
+    mesh->GetPointData()->SetScalars(scalarArray);
+  }
+  //Pass the TextureCoords to the polydata anyway (to save them).
+  mesh->GetPointData()->SetTCoords(m_CachedTextureCoords);
+  output->SetVtkPolyData(mesh);
+}
 
+void mitk::ToFDistanceImageToSurfaceFilter::BuildTopology(int xDimension, int yDimension, const double* pointData)
+{
+  const vtkIdType* vertexIds = m_CachedVertexIdList->GetPointer(0);
   for (int j=0; j<yDimension; j++)
   {
     for (int i=0; i<xDimension; i++)
     {
-      unsigned int pixelID = i+j*xDimension;
-
-      mitk::ToFProcessingCommon::ToFScalarType distance = (double)inputFloatData[pixelID];
-
-      /** Here we have to incorporate spacing and origin to allow processing of cropped/resampled images
-      * Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but just in case the image is moved
-      * due to cropping or the spacing differes due to up- or downsampling.*/
-      unsigned int completeIndexX = i*spacing[0]+origin[0];
-      unsigned int completeIndexY = j*spacing[1]+origin[1];
-
-      mitk::ToFProcessingCommon::ToFPoint3D cartesianCoordinates;
-      switch (m_ReconstructionMode)
+      int pixelID = i+j*xDimension;
+      if (!m_ValidityMask[pixelID])
       {
-      case WithOutInterPixelDistance:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
+        continue;
       }
-      case WithInterPixelDistance:
+      if (!m_GenerateTriangularMesh)
       {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(completeIndexX,completeIndexY,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
-        break;
+        //We dont want triangulation, we only want vertices
+        m_CachedVertices->InsertNextCell(1, &vertexIds[pixelID]);
+        continue;
       }
-      case Kinect:
+      if((i < 1) || (j < 1))
       {
-        cartesianCoordinates = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
+        continue;
       }
-      default:
+      //This little piece of art explains the ID's:
+      //
+      // P(x_1y_1)---P(xy_1)
+      // |           |
+      // |           |
+      // |           |
+      // P(x_1y)-----P(xy)
+      //
+      //We can only start triangulation if we are at vertex (1,1),
+      //because we need the other 3 vertices near this one.
+      //To go one pixel line back in the image array, we have to
+      //subtract 1x xDimension.
+      int xy = pixelID;
+      int x_1y = pixelID-1;
+      int xy_1 = pixelID-xDimension;
+      int x_1y_1 = xy_1-1;
+
+      if (!(m_ValidityMask[x_1y]&&m_ValidityMask[x_1y_1]&&m_ValidityMask[xy_1])) // check if points of cell are valid
       {
-        MITK_ERROR << "Incorrect reconstruction mode!";
-      }
+        continue;
       }
-      //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
-      if (distance<=mitk::eps)
+
+      //Find the corresponding vertex ID's in the saved vertexIdList:
+      vtkIdType xyV = vertexIds[xy];
+      vtkIdType x_1yV = vertexIds[x_1y];
+      vtkIdType xy_1V = vertexIds[xy_1];
+      vtkIdType x_1y_1V = vertexIds[x_1y_1];
+
+      const double* pointXY = pointData + 3*xyV;
+      const double* pointX_1Y = pointData + 3*x_1yV;
+      const double* pointXY_1 = pointData + 3*xy_1V;
+      const double* pointX_1Y_1 = pointData + 3*x_1y_1V;
+
+      if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
+                                                           && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
+                                                           && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
+                                                           && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
       {
-        isPointValid[pixelID] = false;
+        const vtkIdType firstTriangle[3] = { x_1yV, xyV, x_1y_1V };
+        const vtkIdType secondTriangle[3] = { x_1y_1V, xyV, xy_1V };
+        m_CachedPolys->InsertNextCell(3, firstTriangle);
+        m_CachedPolys->InsertNextCell(3, secondTriangle);
       }
       else
       {
-        isPointValid[pixelID] = true;
-        //VTK would insert empty points into the polydata if we use
-        //points->InsertPoint(pixelID, cartesianCoordinates.GetDataPointer()).
-        //If we use points->InsertNextPoint(...) instead, the ID's do not
-        //correspond to the image pixel ID's. Thus, we have to save them
-        //in the vertexIdList.
-        m_VertexIdList->SetId(pixelID, points->InsertNextPoint(cartesianCoordinates.GetDataPointer()));
-
-        if (m_GenerateTriangularMesh)
-        {
-          if((i >= 1) && (j >= 1))
-          {
-            //This little piece of art explains the ID's:
-            //
-            // P(x_1y_1)---P(xy_1)
-            // |           |
-            // |           |
-            // |           |
-            // P(x_1y)-----P(xy)
-            //
-            //We can only start triangulation if we are at vertex (1,1),
-            //because we need the other 3 vertices near this one.
-            //To go one pixel line back in the image array, we have to
-            //subtract 1x xDimension.
-            vtkIdType xy = pixelID;
-            vtkIdType x_1y = pixelID-1;
-            vtkIdType xy_1 = pixelID-xDimension;
-            vtkIdType x_1y_1 = xy_1-1;
-
-            //Find the corresponding vertex ID's in the saved vertexIdList:
-            vtkIdType xyV = m_VertexIdList->GetId(xy);
-            vtkIdType x_1yV = m_VertexIdList->GetId(x_1y);
-            vtkIdType xy_1V = m_VertexIdList->GetId(xy_1);
-            vtkIdType x_1y_1V = m_VertexIdList->GetId(x_1y_1);
-
-            if (isPointValid[xy]&&isPointValid[x_1y]&&isPointValid[x_1y_1]&&isPointValid[xy_1]) // check if points of cell are valid
-            {
-              double pointXY[3], pointX_1Y[3], pointXY_1[3], pointX_1Y_1[3];
-
-              points->GetPoint(xyV, pointXY);
-              points->GetPoint(x_1yV, pointX_1Y);
-              points->GetPoint(xy_1V, pointXY_1);
-              points->GetPoint(x_1y_1V, pointX_1Y_1);
-
-              if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
-              {
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1yV);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(x_1y_1V);
-
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1y_1V);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(xy_1V);
-              }
-              else
-              {
-                //We dont want triangulation, but we want to keep the vertex
-                vertices->InsertNextCell(1);
-                vertices->InsertCellPoint(xyV);
-              }
-            }
-          }
-        }
-        else
-        {
-          //We dont want triangulation, we only want vertices
-          vertices->InsertNextCell(1);
-          vertices->InsertCellPoint(m_VertexIdList->GetId(pixelID));
-        }
-        //Scalar values are necessary for mapping colors/texture onto the surface
-        if (scalarFloatData)
-        {
-          scalarArray->InsertTuple1(m_VertexIdList->GetId(pixelID), scalarFloatData[pixelID]);
-        }
-        //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
-        float xNorm = (((float)i)/xDimension);// correct video texture scale for kinect
-        float yNorm = ((float)j)/yDimension; //don't flip. we don't need to flip.
-        textureCoords->InsertTuple2(m_VertexIdList->GetId(pixelID), xNorm, yNorm);
+        //We dont want triangulation, but we want to keep the vertex
+        m_CachedVertices->InsertNextCell(1, &xyV);
       }
     }
   }
-
-  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-  mesh->SetPoints(points);
-  mesh->SetPolys(polys);
-  mesh->SetVerts(vertices);
-  //Pass the scalars to the polydata (if they were set).
-  if (scalarArray->GetNumberOfTuples()>0)
-  {
-    mesh->GetPointData()->SetScalars(scalarArray);
-  }
-  //Pass the TextureCoords to the polydata anyway (to save them).
-  mesh->GetPointData()->SetTCoords(textureCoords);
-  output->SetVtkPolyData(mesh);
 }
 
 void mitk::ToFDistanceImageToSurfaceFilter::CreateOutputsForAllInputs()
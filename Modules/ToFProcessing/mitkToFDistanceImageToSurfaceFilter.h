@@ -27,6 +27,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+
+#include <vector>
 
 namespace mitk
 {
@@ -42,6 +46,12 @@ namespace mitk
   * The definition of the image plane and its coordinate systems (pixel and mm) is depicted in the following image
   * \image html ../Modules/ToFProcessing/Documentation/ImagePlane.png
   *
+  * The direction of the viewing ray of every pixel is computed once and reused until the intrinsics, the
+  * reconstruction mode or the geometry of the input change, so a frame only costs one multiplication per coordinate.
+  * The vertex IDs, texture coordinates and cells of the mesh only depend on which pixels are valid (distance > 0)
+  * if no triangulation threshold is set. They are shared by successive outputs as long as the validity mask does
+  * not change, so the cell arrays of an output must not be modified.
+  *
   * @ingroup SurfaceFilters
   * @ingroup ToFProcessing
   */
@@ -173,6 +183,19 @@ namespace mitk
     */
     void CreateOutputsForAllInputs();
 
+    /**
+    * \brief Recomputes the viewing ray of every pixel if the parameters of the reconstruction changed.
+    * The cartesian coordinates of a pixel are its distance multiplied with its ray.
+    */
+    void UpdateRayTable(int xDimension, int yDimension, const mitk::Point3D& origin, const mitk::Vector3D& spacing);
+
+    /**
+    * \brief Fills m_CachedPolys and m_CachedVertices for the current validity mask and points.
+    */
+    void BuildTopology(int xDimension, int yDimension, const double* pointData);
+
+    enum TopologyMode{ NoTopology, VertexTopology, TriangleTopology };
+
     IplImage* m_IplScalarImage; ///< Scalar image used for surface texturing
 
     mitk::CameraIntrinsics::Pointer m_CameraIntrinsics; ///< Specifies the intrinsic parameters
@@ -190,6 +213,17 @@ namespace mitk
 
     double m_TriangulationThreshold;
 
+    std::vector<double> m_RayTable; ///< Viewing ray (x, y, z) of every pixel
+    std::vector<double> m_RayTableParameters; ///< Reconstruction parameters m_RayTable was computed for
+
+    std::vector<unsigned char> m_ValidityMask; ///< Valid pixels of the last frame
+    int m_MaskDimensions[2]; ///< Image size m_ValidityMask belongs to
+    vtkSmartPointer<vtkIdList> m_CachedVertexIdList; ///< Vertex IDs of m_ValidityMask
+    vtkSmartPointer<vtkFloatArray> m_CachedTextureCoords; ///< Texture coordinates of m_ValidityMask
+    vtkSmartPointer<vtkCellArray> m_CachedPolys; ///< Triangles of the last frame
+    vtkSmartPointer<vtkCellArray> m_CachedVertices; ///< Vertex cells of the last frame
+    TopologyMode m_CachedTopologyMode; ///< Whether the cells can be reused for the current validity mask
+
   };
 } //END mitk namespace
 #endif
@@ -15,6 +15,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkUSImageLoggingFilter.h"
+#include "mitkUSImageStreamReader.h"
 #include <mitkTestingMacros.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingConfig.h>
@@ -40,6 +41,7 @@ class mitkUSImageLoggingFilterTestSuite : public mitk::TestFixture
   MITK_TEST(TestSavingAfterMupltipleUpdateCalls);
   MITK_TEST(TestFilterWithEmptyImages);
   MITK_TEST(TestFilterWithInvalidPath);
+  MITK_TEST(TestStreamingRecording);
   //MITK_TEST(TestJpgFileExtension); //bug 19614
   CPPUNIT_TEST_SUITE_END();
 
@@ -162,6 +164,46 @@ public:
                                mitk::Exception);
   }
 
+  void TestStreamingRecording()
+  {
+  std::string filename = m_TemporaryTestDirectory + "/USImageLoggingFilterTest_Stream.usrec";
+  m_TestFilter->SetInput(m_RandomSingleSliceImage);
+  m_TestFilter->StartStreaming(filename, 2, 10 * 1024 * 1024);
+  CPPUNIT_ASSERT_MESSAGE("Testing if streaming mode is active.", m_TestFilter->GetIsStreaming());
+
+  for(int i=0; i<5; i++)
+    {
+    m_RandomSingleSliceImage->Modified();
+    m_TestFilter->Update();
+    std::stringstream testmessage;
+    testmessage << "testmessage" << i;
+    m_TestFilter->AddMessageToCurrentImage(testmessage.str());
+    }
+  m_TestFilter->StopStreaming();
+  CPPUNIT_ASSERT_MESSAGE("Testing if streaming mode is stopped.", !m_TestFilter->GetIsStreaming());
+  CPPUNIT_ASSERT_MESSAGE("Testing if preallocated space was removed.", Poco::File(filename).getSize() < 10 * 1024 * 1024);
+
+  mitk::USImageStreamReader::Pointer reader = mitk::USImageStreamReader::New();
+  reader->Open(filename);
+  unsigned int numberOfImages = 0;
+  double lastTimestamp = 0;
+  while (reader->ReadNextImage())
+    {
+    CPPUNIT_ASSERT_MESSAGE("Testing if images are read in order.", reader->GetCurrentIndex() == numberOfImages);
+    CPPUNIT_ASSERT_MESSAGE("Testing if timestamps increase.", reader->GetCurrentTimestamp() >= lastTimestamp);
+    CPPUNIT_ASSERT_MESSAGE("Testing if read image equals logged image.", mitk::Equal(*m_RandomSingleSliceImage, *reader->GetCurrentImage(), mitk::eps, true));
+    std::stringstream testmessage;
+    testmessage << "testmessage" << numberOfImages;
+    CPPUNIT_ASSERT_MESSAGE("Testing if message was read.", reader->GetCurrentMessages().size() == 1 && reader->GetCurrentMessages().at(0) == testmessage.str());
+    lastTimestamp = reader->GetCurrentTimestamp();
+    ++numberOfImages;
+    }
+  CPPUNIT_ASSERT_MESSAGE("Testing if all images were read.", numberOfImages == 5);
+  reader->Close();
+
+  std::remove(filename.c_str());
+  }
+
   void TestJpgFileExtension()
   {
   CPPUNIT_ASSERT_MESSAGE("Testing setting of jpg extension.",m_TestFilter->SetImageFilesExtension(".jpg"));
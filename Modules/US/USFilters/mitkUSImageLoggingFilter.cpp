@@ -26,7 +26,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 
 mitk::USImageLoggingFilter::USImageLoggingFilter() : m_SystemTimeClock(RealTimeClock::New()),
-                                                     m_ImageExtension(".nrrd")
+                                                     m_ImageExtension(".nrrd"),
+                                                     m_StreamWriter(USImageStreamWriter::New())
 {
 }
 
@@ -45,6 +46,13 @@ void mitk::USImageLoggingFilter::GenerateData()
     return;
     }
 
+  if (m_StreamWriter->IsOpen())
+    {
+    //the writer copies the pixel data to its buffer, so no clone is needed
+    m_StreamWriter->AddImage(inputImage, m_SystemTimeClock->GetCurrentStamp());
+    return;
+    }
+
   //a clone is needed for a output and to store it.
   mitk::Image::Pointer inputClone = inputImage->Clone();
 
@@ -83,6 +91,11 @@ void mitk::USImageLoggingFilter::GenerateData()
 
 void mitk::USImageLoggingFilter::AddMessageToCurrentImage(std::string message)
 {
+  if (m_StreamWriter->IsOpen())
+    {
+    m_StreamWriter->AddMessage(m_StreamWriter->GetNumberOfImages()-1, message);
+    return;
+    }
   m_LoggedMessages.insert(std::make_pair(static_cast<int>(m_LoggedImages.size()-1),message));
 }
 
@@ -163,3 +176,18 @@ bool mitk::USImageLoggingFilter::SetImageFilesExtension(std::string extension)
   }
   return false;
  }
+
+void mitk::USImageLoggingFilter::StartStreaming(std::string filename, unsigned int bufferSize, std::size_t preallocatedBytes)
+{
+  m_StreamWriter->Open(filename, bufferSize, preallocatedBytes);
+}
+
+void mitk::USImageLoggingFilter::StopStreaming()
+{
+  m_StreamWriter->Close();
+}
+
+bool mitk::USImageLoggingFilter::GetIsStreaming() const
+{
+  return m_StreamWriter->IsOpen();
+}
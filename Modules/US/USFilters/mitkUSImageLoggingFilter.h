@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <MitkUSExports.h>
 #include <mitkImageToImageFilter.h>
 #include <mitkRealTimeClock.h>
+#include "mitkUSImageStreamWriter.h"
 
 
 namespace mitk {
@@ -29,6 +30,10 @@ namespace mitk {
    *  add messages. All data (images, timestamps and messages) is written to the harddisc when
    *  the method SaveImages(...) is called.
    *
+   *  For long recordings a streaming mode can be started with StartStreaming(...). In this mode the
+   *  images are not kept in memory but written to a single recording file by a background thread
+   *  (see mitk::USImageStreamWriter). Recordings can be played back with mitk::USImageStreamReader.
+   *
    *  Caution: only supports logging of one input at the moment, multiple inputs are ignored!
    *
    *  \ingroup US
@@ -76,6 +81,23 @@ namespace mitk {
      */
     bool SetImageFilesExtension(std::string extension);
 
+    /** Starts the streaming mode. All following images, timestamps and messages are written to the
+     *  given recording file instead of being stored in memory until SaveImages(...) is called.
+     *  @param filename           The recording file. An existing file is overwritten.
+     *  @param bufferSize         Maximum number of images which are buffered in memory before they are written.
+     *  @param preallocatedBytes  Size the recording file is preallocated to. Nothing is preallocated if zero.
+     *  @throw mitk::Exception    Throws an exception if the file cannot be created or streaming is already active.
+     */
+    void StartStreaming(std::string filename, unsigned int bufferSize = 64, std::size_t preallocatedBytes = 0);
+
+    /** Writes all buffered images and closes the recording file.
+     *  @throw mitk::Exception Throws an exception if there was a problem during writing.
+     */
+    void StopStreaming();
+
+    /** @return True if the streaming mode is active. */
+    bool GetIsStreaming() const;
+
 
   protected:
     USImageLoggingFilter();
@@ -88,6 +110,7 @@ namespace mitk {
     std::map<int, std::string> m_LoggedMessages; ///< (Optional) messages for every logged image
     std::vector<double> m_LoggedMITKSystemTimes; ///< Logged system times for every logged image
     std::string m_ImageExtension; ///< stores the image extension, default is ".nrrd"
+    mitk::USImageStreamWriter::Pointer m_StreamWriter; ///< writes the images in streaming mode
 
   };
 } // namespace mitk
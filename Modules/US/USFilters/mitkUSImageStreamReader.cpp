@@ -0,0 +1,230 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageStreamReader.h"
+#include "mitkUSImageStreamWriter.h"
+#include <mitkExceptionMacro.h>
+
+#include <itkNrrdImageIO.h>
+
+#include <cstring>
+
+template <typename T>
+static T ReadValue(std::istream& stream)
+{
+  T value = T();
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return value;
+}
+
+mitk::USImageStreamReader::USImageStreamReader() : m_FirstRecordPosition(0),
+                                                   m_CurrentTimestamp(0),
+                                                   m_CurrentIndex(0)
+{
+}
+
+mitk::USImageStreamReader::~USImageStreamReader()
+{
+  this->Close();
+}
+
+void mitk::USImageStreamReader::Open(const std::string& filename)
+{
+  this->Close();
+
+  m_File.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!m_File.good())
+  {
+    mitkThrow() << "Cannot open US image stream file " << filename << ".";
+  }
+
+  const std::size_t signatureLength = std::strlen(USImageStreamWriter::GetFileSignature());
+  std::vector<char> signature(signatureLength);
+  m_File.read(signature.data(), signatureLength);
+  uint32_t version = ReadValue<uint32_t>(m_File);
+  if (!m_File.good() || std::memcmp(signature.data(), USImageStreamWriter::GetFileSignature(), signatureLength) != 0)
+  {
+    m_File.close();
+    mitkThrow() << "File " << filename << " is not a US image stream.";
+  }
+  if (version > USImageStreamWriter::FileVersion)
+  {
+    m_File.close();
+    mitkThrow() << "US image stream " << filename << " has the unsupported version " << version << ".";
+  }
+
+  m_FileName = filename;
+  m_FirstRecordPosition = m_File.tellg();
+}
+
+void mitk::USImageStreamReader::Close()
+{
+  if (m_File.is_open())
+  {
+    m_File.close();
+  }
+  m_CurrentImage = nullptr;
+  m_CurrentMessages.clear();
+}
+
+void mitk::USImageStreamReader::Rewind()
+{
+  m_File.clear();
+  m_File.seekg(m_FirstRecordPosition);
+  m_CurrentImage = nullptr;
+  m_CurrentMessages.clear();
+}
+
+bool mitk::USImageStreamReader::ReadNextImage()
+{
+  if (!m_File.is_open())
+  {
+    mitkThrow() << "Cannot read image, no US image stream is open.";
+  }
+
+  m_CurrentMessages.clear();
+
+  // skip messages which belong to no image (e.g. messages added before the first image)
+  bool imageFound = false;
+  while (!imageFound)
+  {
+    uint8_t type = ReadValue<uint8_t>(m_File);
+    if (!m_File.good() || type == USImageStreamWriter::EndRecord)
+    {
+      m_CurrentImage = nullptr;
+      return false;
+    }
+    if (type == USImageStreamWriter::ImageRecord)
+    {
+      this->ReadImageRecord();
+      imageFound = true;
+    }
+    else if (type == USImageStreamWriter::MessageRecord)
+    {
+      ReadValue<uint32_t>(m_File);
+      uint32_t length = ReadValue<uint32_t>(m_File);
+      m_File.seekg(length, std::ios::cur);
+    }
+    else
+    {
+      mitkThrow() << "US image stream " << m_FileName << " is corrupt: unknown record type " << static_cast<int>(type) << ".";
+    }
+  }
+
+  // collect the messages which follow the image
+  while (true)
+  {
+    std::streamoff position = m_File.tellg();
+    uint8_t type = ReadValue<uint8_t>(m_File);
+    if (!m_File.good() || type != USImageStreamWriter::MessageRecord)
+    {
+      m_File.clear();
+      m_File.seekg(position);
+      break;
+    }
+    uint32_t index = ReadValue<uint32_t>(m_File);
+    uint32_t length = ReadValue<uint32_t>(m_File);
+    std::string message(length, '\0');
+    m_File.read(&message[0], length);
+    if (index == m_CurrentIndex)
+    {
+      m_CurrentMessages.push_back(message);
+    }
+  }
+
+  return true;
+}
+
+void mitk::USImageStreamReader::ReadImageRecord()
+{
+  m_CurrentIndex = ReadValue<uint32_t>(m_File);
+  m_CurrentTimestamp = ReadValue<double>(m_File);
+  int32_t componentType = ReadValue<int32_t>(m_File);
+  int32_t pixelType = ReadValue<int32_t>(m_File);
+  uint32_t numberOfComponents = ReadValue<uint32_t>(m_File);
+  uint32_t dimension = ReadValue<uint32_t>(m_File);
+  if (!m_File.good() || dimension == 0 || dimension > 4)
+  {
+    mitkThrow() << "US image stream " << m_FileName << " is corrupt: invalid image header.";
+  }
+
+  std::vector<unsigned int> dimensions(dimension);
+  for (uint32_t i = 0; i < dimension; ++i)
+  {
+    dimensions[i] = ReadValue<uint32_t>(m_File);
+  }
+  mitk::Vector3D spacing;
+  mitk::Point3D origin;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    spacing[i] = ReadValue<double>(m_File);
+  }
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    origin[i] = ReadValue<double>(m_File);
+  }
+  uint64_t numberOfBytes = ReadValue<uint64_t>(m_File);
+
+  m_Data.resize(numberOfBytes);
+  m_File.read(m_Data.data(), numberOfBytes);
+  if (!m_File.good())
+  {
+    mitkThrow() << "US image stream " << m_FileName << " is corrupt: image " << m_CurrentIndex << " is incomplete.";
+  }
+
+  // the pixel type is restored in the same way as for images read by an ITK image IO
+  itk::NrrdImageIO::Pointer imageIO = itk::NrrdImageIO::New();
+  imageIO->SetComponentType(static_cast<itk::ImageIOBase::IOComponentType>(componentType));
+  imageIO->SetPixelType(static_cast<itk::ImageIOBase::IOPixelType>(pixelType));
+  imageIO->SetNumberOfComponents(numberOfComponents);
+
+  mitk::PixelType imagePixelType = mitk::MakePixelType(imageIO);
+  uint64_t expectedNumberOfBytes = imagePixelType.GetSize();
+  for (unsigned int size : dimensions)
+  {
+    expectedNumberOfBytes *= size;
+  }
+  if (expectedNumberOfBytes != numberOfBytes)
+  {
+    mitkThrow() << "US image stream " << m_FileName << " is corrupt: size of image " << m_CurrentIndex << " does not match its pixel data.";
+  }
+
+  m_CurrentImage = mitk::Image::New();
+  m_CurrentImage->Initialize(imagePixelType, dimension, dimensions.data());
+  m_CurrentImage->SetImportChannel(m_Data.data(), 0, mitk::Image::CopyMemory);
+  m_CurrentImage->SetSpacing(spacing);
+  m_CurrentImage->SetOrigin(origin);
+}
+
+mitk::Image::Pointer mitk::USImageStreamReader::GetCurrentImage() const
+{
+  return m_CurrentImage;
+}
+
+double mitk::USImageStreamReader::GetCurrentTimestamp() const
+{
+  return m_CurrentTimestamp;
+}
+
+unsigned int mitk::USImageStreamReader::GetCurrentIndex() const
+{
+  return m_CurrentIndex;
+}
+
+std::vector<std::string> mitk::USImageStreamReader::GetCurrentMessages() const
+{
+  return m_CurrentMessages;
+}
@@ -0,0 +1,87 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageStreamReader_H_HEADER_INCLUDED_
+#define MITKUSImageStreamReader_H_HEADER_INCLUDED_
+
+// MITK
+#include <MitkUSExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+
+// ITK
+#include <itkObject.h>
+
+// STL
+#include <fstream>
+#include <vector>
+
+namespace mitk {
+  /** An object of this class reads recordings written by mitk::USImageStreamWriter
+   *  (e.g. by the streaming mode of mitk::USImageLoggingFilter) frame by frame.
+   *  Only the current frame is kept in memory, so recordings of any length can be played back.
+   *
+   *  \ingroup US
+   */
+  class MITKUS_EXPORT USImageStreamReader : public itk::Object
+  {
+  public:
+
+    mitkClassMacroItkParent(USImageStreamReader, itk::Object);
+
+    itkNewMacro(USImageStreamReader);
+
+    /** Opens the given recording and checks its signature.
+     *  @throw mitk::Exception Throws an exception if the file cannot be opened or is not a valid recording.
+     */
+    void Open(const std::string& filename);
+
+    void Close();
+
+    /** Reads the next frame together with its messages.
+     *  @return False if the end of the recording is reached.
+     *  @throw mitk::Exception Throws an exception if the recording is corrupt.
+     */
+    bool ReadNextImage();
+
+    /** Sets the reader back to the first frame of the recording. */
+    void Rewind();
+
+    /** @return The current frame. Every call of ReadNextImage() creates a new image object. */
+    mitk::Image::Pointer GetCurrentImage() const;
+    double GetCurrentTimestamp() const;
+    unsigned int GetCurrentIndex() const;
+    /** @return All messages which were added to the current frame. */
+    std::vector<std::string> GetCurrentMessages() const;
+
+  protected:
+    USImageStreamReader();
+    ~USImageStreamReader() override;
+
+    void ReadImageRecord();
+
+    std::ifstream m_File;
+    std::string m_FileName;
+    std::streamoff m_FirstRecordPosition;
+
+    mitk::Image::Pointer m_CurrentImage;
+    double m_CurrentTimestamp;
+    unsigned int m_CurrentIndex;
+    std::vector<std::string> m_CurrentMessages;
+    std::vector<char> m_Data; ///< buffer for the pixel data, reused for all frames
+  };
+} // namespace mitk
+#endif /* MITKUSImageStreamReader_H_HEADER_INCLUDED_ */
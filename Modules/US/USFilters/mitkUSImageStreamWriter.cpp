@@ -0,0 +1,317 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageStreamWriter.h"
+#include <mitkImageReadAccessor.h>
+#include <mitkExceptionMacro.h>
+
+#include <Poco/File.h>
+
+#include <cstring>
+
+template <typename T>
+static void WriteValue(std::ostream& stream, T value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+const char* mitk::USImageStreamWriter::GetFileSignature()
+{
+  return "MITKUSRC";
+}
+
+mitk::USImageStreamWriter::USImageStreamWriter() : m_PreallocatedBytes(0),
+                                                   m_BufferHead(0),
+                                                   m_BufferCount(0),
+                                                   m_IsOpen(false),
+                                                   m_StopRequested(false),
+                                                   m_WriterFailed(false),
+                                                   m_NumberOfImages(0)
+{
+}
+
+mitk::USImageStreamWriter::~USImageStreamWriter()
+{
+  if (m_IsOpen)
+  {
+    try
+    {
+      this->Close();
+    }
+    catch (const mitk::Exception& e)
+    {
+      MITK_ERROR << "Error while closing US image stream " << m_FileName << ": " << e.GetDescription();
+    }
+  }
+}
+
+void mitk::USImageStreamWriter::Open(const std::string& filename, unsigned int bufferSize, std::size_t preallocatedBytes)
+{
+  if (m_IsOpen)
+  {
+    mitkThrow() << "US image stream writer is already writing to " << m_FileName << ".";
+  }
+  if (bufferSize == 0)
+  {
+    mitkThrow() << "The buffer size of the US image stream writer must not be zero.";
+  }
+
+  // create (or truncate) the file first, so that it can be preallocated before it is opened for writing
+  {
+    std::ofstream createFile(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!createFile.good())
+    {
+      mitkThrow() << "Cannot create US image stream file " << filename << ".";
+    }
+  }
+  if (preallocatedBytes > 0)
+  {
+    try
+    {
+      Poco::File(filename).setSize(preallocatedBytes);
+    }
+    catch (const Poco::Exception& e)
+    {
+      mitkThrow() << "Cannot preallocate US image stream file " << filename << ": " << e.displayText();
+    }
+  }
+
+  m_File.open(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  if (!m_File.good())
+  {
+    mitkThrow() << "Cannot open US image stream file " << filename << ".";
+  }
+  m_File.write(GetFileSignature(), std::strlen(GetFileSignature()));
+  WriteValue<uint32_t>(m_File, FileVersion);
+
+  m_FileName = filename;
+  m_PreallocatedBytes = preallocatedBytes;
+  m_Buffer = std::vector<Record>(bufferSize);
+  m_BufferHead = 0;
+  m_BufferCount = 0;
+  m_StopRequested = false;
+  m_WriterFailed = false;
+  m_WriterError.clear();
+  m_NumberOfImages = 0;
+  m_IsOpen = true;
+
+  m_WriterThread = std::thread(&USImageStreamWriter::WriterThread, this);
+}
+
+void mitk::USImageStreamWriter::AddImage(const mitk::Image* image, double timestamp)
+{
+  if (!m_IsOpen)
+  {
+    mitkThrow() << "Cannot add image, US image stream writer is not open.";
+  }
+
+  Record& record = this->WaitForFreeRecord();
+
+  const mitk::PixelType pixelType = image->GetPixelType();
+  record.type = ImageRecord;
+  record.index = m_NumberOfImages;
+  record.timestamp = timestamp;
+  record.componentType = pixelType.GetComponentType();
+  record.pixelType = pixelType.GetPixelType();
+  record.numberOfComponents = pixelType.GetNumberOfComponents();
+  record.dimensions.assign(image->GetDimensions(), image->GetDimensions() + image->GetDimension());
+
+  mitk::Vector3D spacing = image->GetGeometry()->GetSpacing();
+  mitk::Point3D origin = image->GetGeometry()->GetOrigin();
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    record.spacing[i] = spacing[i];
+    record.origin[i] = origin[i];
+  }
+
+  std::size_t numberOfBytes = pixelType.GetSize();
+  for (unsigned int dimension : record.dimensions)
+  {
+    numberOfBytes *= dimension;
+  }
+
+  // the data vector of the slot keeps its capacity, so there is no allocation for frames of the same size
+  mitk::ImageReadAccessor accessor(image);
+  const char* data = static_cast<const char*>(accessor.GetData());
+  record.data.assign(data, data + numberOfBytes);
+
+  ++m_NumberOfImages;
+  this->CommitRecord();
+}
+
+void mitk::USImageStreamWriter::AddMessage(unsigned int imageIndex, const std::string& message)
+{
+  if (!m_IsOpen)
+  {
+    mitkThrow() << "Cannot add message, US image stream writer is not open.";
+  }
+
+  Record& record = this->WaitForFreeRecord();
+  record.type = MessageRecord;
+  record.index = imageIndex;
+  record.data.assign(message.begin(), message.end());
+  this->CommitRecord();
+}
+
+void mitk::USImageStreamWriter::Close()
+{
+  if (!m_IsOpen)
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_StopRequested = true;
+  }
+  m_RecordAvailable.notify_one();
+  m_WriterThread.join();
+
+  // mark the end of the data and remove the unused preallocated space
+  std::streamoff endPosition = m_File.tellp();
+  WriteValue<uint8_t>(m_File, EndRecord);
+  m_File.close();
+  m_IsOpen = false;
+
+  if (m_PreallocatedBytes > 0 && endPosition >= 0)
+  {
+    try
+    {
+      Poco::File(m_FileName).setSize(static_cast<Poco::File::FileSize>(endPosition) + 1);
+    }
+    catch (const Poco::Exception& e)
+    {
+      mitkThrow() << "Cannot truncate US image stream file " << m_FileName << ": " << e.displayText();
+    }
+  }
+
+  // release the memory of the ring buffer
+  m_Buffer = std::vector<Record>();
+
+  this->ThrowIfWriterFailed();
+}
+
+bool mitk::USImageStreamWriter::IsOpen() const
+{
+  return m_IsOpen;
+}
+
+unsigned int mitk::USImageStreamWriter::GetNumberOfImages() const
+{
+  return m_NumberOfImages;
+}
+
+mitk::USImageStreamWriter::Record& mitk::USImageStreamWriter::WaitForFreeRecord()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_RecordWritten.wait(lock, [this] { return m_BufferCount < m_Buffer.size() || m_WriterFailed; });
+  if (m_WriterFailed)
+  {
+    mitkThrow() << "Writing US image stream " << m_FileName << " failed: " << m_WriterError;
+  }
+  return m_Buffer[(m_BufferHead + m_BufferCount) % m_Buffer.size()];
+}
+
+void mitk::USImageStreamWriter::CommitRecord()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    ++m_BufferCount;
+  }
+  m_RecordAvailable.notify_one();
+}
+
+void mitk::USImageStreamWriter::WriterThread()
+{
+  while (true)
+  {
+    std::size_t position;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_RecordAvailable.wait(lock, [this] { return m_BufferCount > 0 || m_StopRequested; });
+      if (m_BufferCount == 0)
+      {
+        return; // stop was requested and all records are written
+      }
+      position = m_BufferHead;
+    }
+
+    // the record at the head is owned by this thread until the head is moved
+    this->WriteRecord(m_Buffer[position]);
+
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (!m_File.good())
+      {
+        m_WriterFailed = true;
+        m_WriterError = "Error while writing to the file.";
+        m_BufferCount = 0;
+      }
+      else
+      {
+        m_BufferHead = (m_BufferHead + 1) % m_Buffer.size();
+        --m_BufferCount;
+      }
+    }
+    m_RecordWritten.notify_one();
+
+    if (m_WriterFailed)
+    {
+      return;
+    }
+  }
+}
+
+void mitk::USImageStreamWriter::WriteRecord(const Record& record)
+{
+  WriteValue<uint8_t>(m_File, static_cast<uint8_t>(record.type));
+  WriteValue<uint32_t>(m_File, record.index);
+  if (record.type == ImageRecord)
+  {
+    WriteValue<double>(m_File, record.timestamp);
+    WriteValue<int32_t>(m_File, record.componentType);
+    WriteValue<int32_t>(m_File, record.pixelType);
+    WriteValue<uint32_t>(m_File, record.numberOfComponents);
+    WriteValue<uint32_t>(m_File, static_cast<uint32_t>(record.dimensions.size()));
+    for (unsigned int dimension : record.dimensions)
+    {
+      WriteValue<uint32_t>(m_File, dimension);
+    }
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      WriteValue<double>(m_File, record.spacing[i]);
+    }
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      WriteValue<double>(m_File, record.origin[i]);
+    }
+    WriteValue<uint64_t>(m_File, record.data.size());
+  }
+  else
+  {
+    WriteValue<uint32_t>(m_File, static_cast<uint32_t>(record.data.size()));
+  }
+  m_File.write(record.data.data(), record.data.size());
+}
+
+void mitk::USImageStreamWriter::ThrowIfWriterFailed()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_WriterFailed)
+  {
+    mitkThrow() << "Writing US image stream " << m_FileName << " failed: " << m_WriterError;
+  }
+}
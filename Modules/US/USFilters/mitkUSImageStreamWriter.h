@@ -0,0 +1,151 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageStreamWriter_H_HEADER_INCLUDED_
+#define MITKUSImageStreamWriter_H_HEADER_INCLUDED_
+
+// MITK
+#include <MitkUSExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+
+// ITK
+#include <itkObject.h>
+
+// STL
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mitk {
+  /** An object of this class writes a stream of images, timestamps and messages to a single
+   *  recording file. The data is handed over to a background thread through a ring buffer of
+   *  fixed size, so the memory consumption does not grow with the length of the recording.
+   *  If the ring buffer is full, AddImage(...) waits until the writer thread has written a frame.
+   *  AddImage(...) and AddMessage(...) have to be called from the same thread.
+   *
+   *  The file can optionally be preallocated to avoid fragmentation during long recordings.
+   *  It is truncated to the written size when Close() is called. Recordings can be read
+   *  with mitk::USImageStreamReader.
+   *
+   *  File layout (native byte order):
+   *  - Signature (8 bytes, see GetFileSignature()) followed by the format version (uint32).
+   *  - A sequence of records, each starting with a record type (uint8):
+   *    - Image record: image index (uint32), timestamp (double), component type (int32),
+   *      pixel type (int32), number of components (uint32), dimension (uint32),
+   *      size of each dimension (uint32 each), spacing (3 doubles), origin (3 doubles),
+   *      size of the pixel data in bytes (uint64) and the pixel data.
+   *    - Message record: image index (uint32), length (uint32) and the characters of the message.
+   *    - End record (a zero byte): marks the end of the data, e.g. in preallocated space.
+   *
+   *  \ingroup US
+   */
+  class MITKUS_EXPORT USImageStreamWriter : public itk::Object
+  {
+  public:
+
+    mitkClassMacroItkParent(USImageStreamWriter, itk::Object);
+
+    itkNewMacro(USImageStreamWriter);
+
+    enum RecordType
+    {
+      EndRecord = 0,
+      ImageRecord = 1,
+      MessageRecord = 2
+    };
+
+    static const char* GetFileSignature();
+    static const unsigned int FileVersion = 1;
+
+    /** Creates the recording file and starts the writer thread.
+     *  @param filename           The file the recording is written to. An existing file is overwritten.
+     *  @param bufferSize         Maximum number of frames and messages that are kept in memory.
+     *  @param preallocatedBytes  Size the file is preallocated to. Nothing is preallocated if zero.
+     *  @throw mitk::Exception    Throws an exception if the file cannot be created or if the writer is already open.
+     */
+    void Open(const std::string& filename, unsigned int bufferSize = 64, std::size_t preallocatedBytes = 0);
+
+    /** Copies the image to the ring buffer. The image is written by the background thread.
+     *  @throw mitk::Exception Throws an exception if the writer is not open or if writing failed.
+     */
+    void AddImage(const mitk::Image* image, double timestamp);
+
+    /** Adds a message to the image with the given index.
+     *  @throw mitk::Exception Throws an exception if the writer is not open or if writing failed.
+     */
+    void AddMessage(unsigned int imageIndex, const std::string& message);
+
+    /** Writes all buffered data, stops the writer thread and truncates the file to its final size.
+     *  @throw mitk::Exception Throws an exception if writing failed.
+     */
+    void Close();
+
+    bool IsOpen() const;
+
+    /** @return The number of images added since the writer was opened. */
+    unsigned int GetNumberOfImages() const;
+
+  protected:
+    USImageStreamWriter();
+    ~USImageStreamWriter() override;
+
+    struct Record
+    {
+      RecordType type;
+      unsigned int index;
+      double timestamp;
+      int componentType;
+      int pixelType;
+      unsigned int numberOfComponents;
+      std::vector<unsigned int> dimensions;
+      double spacing[3];
+      double origin[3];
+      std::vector<char> data; ///< pixel data or characters of the message, reused for the next records
+    };
+
+    /** Waits for a free slot of the ring buffer and returns it. The slot is not touched by the
+     *  writer thread until it is passed to the writer thread by CommitRecord().
+     */
+    Record& WaitForFreeRecord();
+    void CommitRecord();
+    void WriterThread();
+    void WriteRecord(const Record& record);
+    void ThrowIfWriterFailed();
+
+    std::string m_FileName;
+    std::fstream m_File;
+    std::size_t m_PreallocatedBytes;
+
+    std::vector<Record> m_Buffer; ///< ring buffer of records which are not yet written
+    std::size_t m_BufferHead;     ///< position of the next record to write
+    std::size_t m_BufferCount;    ///< number of records in the ring buffer
+
+    bool m_IsOpen;
+    bool m_StopRequested;
+    bool m_WriterFailed;
+    std::string m_WriterError;
+    unsigned int m_NumberOfImages;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_RecordAvailable;
+    std::condition_variable m_RecordWritten;
+    std::thread m_WriterThread;
+  };
+} // namespace mitk
+#endif /* MITKUSImageStreamWriter_H_HEADER_INCLUDED_ */
@@ -17,6 +17,8 @@ USModel/mitkUSDeviceWriterXML.cpp
 
 ## Filters and Sources
 USFilters/mitkUSImageLoggingFilter.cpp
+USFilters/mitkUSImageStreamWriter.cpp
+USFilters/mitkUSImageStreamReader.cpp
 USFilters/mitkUSImageSource.cpp
 USFilters/mitkUSImageVideoSource.cpp
 USFilters/mitkIGTLMessageToUSImageFilter.cpp